@@ -0,0 +1,11 @@
+include(FetchContent)
+
+FetchContent_Declare(
+  lz4
+  GIT_REPOSITORY https://github.com/lz4/lz4.git
+  GIT_TAG        v1.9.4
+  SOURCE_DIR ${CMAKE_CURRENT_SOURCE_DIR}/third_party/lz4
+  SOURCE_SUBDIR build/cmake
+)
+
+FetchContent_MakeAvailable(lz4)
@@ -0,0 +1,11 @@
+include(FetchContent)
+
+FetchContent_Declare(
+  zstd
+  GIT_REPOSITORY https://github.com/facebook/zstd.git
+  GIT_TAG        v1.5.5
+  SOURCE_DIR ${CMAKE_CURRENT_SOURCE_DIR}/third_party/zstd
+  SOURCE_SUBDIR build/cmake
+)
+
+FetchContent_MakeAvailable(zstd)
@@ -379,6 +379,7 @@ bool Checkpoint::SaveModelMetaData(const std::string& path,
       t_j["dimension"] = table_mdata.dimension;
       t_j["init_type"] = InitializerTypeName(table_mdata.init_type);
       t_j["init_conf"] = table_mdata.init_conf;
+      t_j["table_conf"] = table_mdata.table_conf;
     }
 
     tables_j.push_back(std::move(t_j));
@@ -440,6 +441,14 @@ bool Checkpoint::SaveModelMetaDataBinary(const std::string& path,
     }
   }
 
+  // The table_conf is appended after all tables, the old checkpoint does not
+  // have it.
+  for (const auto& [k, v] : model_mdata.table_mdatas) {
+    if ((serialize << k) == false || (serialize << v.table_conf) == false) {
+      return false;
+    }
+  }
+
   return true;
 }
 
@@ -485,24 +494,34 @@ bool Checkpoint::SaveSparseTable(const std::string& path, SparseTable* table) {
   uint64_t slot_count = parallel_vals->slot_count();
 
   // Serialize SlotCount.
-  // ParallelSipList is special so we need serialize slot by slot.
+  // SparseStorage is special so we need serialize slot by slot.
   if (serialize << slot_count == false) {
     return false;
   }
 
   // Below is thread-safe.
   for (uint64_t slot = 0; slot < slot_count; ++slot) {
-    auto h = parallel_vals->SharedSkipListHandler(slot);
-    uint64_t skip_list_size = h.skip_list.Size();
+    auto h = parallel_vals->SharedSlotHandler(slot);
+    uint64_t slot_size =
+        parallel_vals->Size(slot) + parallel_vals->ColdSize(slot);
 
-    if (serialize << skip_list_size == false) {
+    if (serialize << slot_size == false) {
       return false;
     }
 
-    for (auto it = h.skip_list.Begin(); it.Valid(); it.Next()) {
-      if (serialize << it.key() == false || serialize << it.value() == false) {
-        return false;
-      }
+    const RowLayout& layout = parallel_vals->layout();
+
+    auto func = [&serialize, &layout](uint64_t sparse_id, const char* row) {
+      Value value;
+      layout.ToValue(row, &value);
+
+      return (serialize << sparse_id) && (serialize << value);
+    };
+
+    // Include the rows spilled to the cold file.
+    if (parallel_vals->ForEach(slot, func) == false ||
+        parallel_vals->ForEachCold(slot, func) == false) {
+      return false;
     }
   }
 
@@ -553,6 +572,28 @@ bool Checkpoint::LoadModelMetaDataBinary(const std::string& path,
     model_mdata->table_mdatas.emplace(table_id, std::move(table_mdata));
   }
 
+  // Old checkpoint without table_conf, use the empty one.
+  if (deserialize.IsEnd()) {
+    return true;
+  }
+
+  for (uint64_t i = 0; i < table_size; ++i) {
+    uint64_t table_id;
+    std::unordered_map<std::string, std::string> table_conf;
+
+    if ((deserialize >> table_id) == false ||
+        (deserialize >> table_conf) == false) {
+      return false;
+    }
+
+    auto it = model_mdata->table_mdatas.find(table_id);
+    if (it == model_mdata->table_mdatas.end()) {
+      return false;
+    }
+
+    it->second.table_conf = std::move(table_conf);
+  }
+
   return true;
 }
 
@@ -463,6 +463,16 @@ bool CheckpointExec::Load(Ps* ps, const std::string& load_dir) {
     return false;
   }
 
+  // The SparseTable's row layout depend on the Optim, so create it at first.
+  std::unique_ptr<Optim> optim =
+      Optim::Create(model_mdata.optim_type, model_mdata.optim_conf);
+  if (optim == nullptr) {
+    LOG_ERROR("Unsupported optim, type:["
+              << model_mdata.optim_type << "], conf:[" << model_mdata.optim_conf
+              << "]");
+    return false;
+  }
+
   // Before load sparse table we need create sparse table instance.
   for (const auto& [id, table_mdata] : model_mdata.table_mdatas) {
     if (table_mdata.table_type != TableType::kSparse) {
@@ -485,9 +495,10 @@ bool CheckpointExec::Load(Ps* ps, const std::string& load_dir) {
       return false;
     }
 
-    std::unique_ptr<SparseTable> table(
-        new SparseTable(table_mdata.id, table_mdata.name, table_mdata.dimension,
-                        table_mdata.element_type, std::move(initializer)));
+    std::unique_ptr<SparseTable> table(new SparseTable(
+        table_mdata.id, table_mdata.name, table_mdata.dimension,
+        table_mdata.element_type, std::move(initializer),
+        table_mdata.table_conf, optim.get(), ps->node_id_));
 
     ps->tables_.Insert(table_mdata.id, std::move(table));
   }
@@ -504,14 +515,7 @@ bool CheckpointExec::Load(Ps* ps, const std::string& load_dir) {
     return false;
   }
 
-  ps->optim_ = Optim::Create(model_mdata.optim_type, model_mdata.optim_conf);
-  if (ps->optim_ == nullptr) {
-    LOG_ERROR("Unsupported optim, type:["
-              << model_mdata.optim_type << "], conf:[" << model_mdata.optim_conf
-              << "]");
-    return false;
-  }
-
+  ps->optim_ = std::move(optim);
   ps->model_name_ = model_mdata.name;
   ps->model_init_ = true;
 
@@ -23,5 +23,9 @@ bool FileReader::Read(void* target, size_t size) {
   return false;
 }
 
+bool FileReader::IsEnd() {
+  return fs_.peek() == std::ifstream::traits_type::eof();
+}
+
 }  // namespace io
 }  // namespace kraken
@@ -22,6 +22,8 @@ public:
   bool IsOpen() const;
 
   bool Read(void* target, size_t size) override;
+
+  bool IsEnd() override;
 };
 
 }  // namespace io
@@ -0,0 +1,332 @@
+#include "common/compress.h"
+
+#include <lz4.h>
+#include <snappy-sinksource.h>
+#include <snappy.h>
+#include <zstd.h>
+
+#include <cstring>
+#include <limits>
+
+#include "common/snappy.h"
+
+namespace kraken {
+
+namespace {
+
+// ZSTD context is expensive to create, reuse it in every thread.
+ZSTD_CCtx* ThreadZSTDCCtx() {
+  thread_local std::unique_ptr<ZSTD_CCtx, size_t (*)(ZSTD_CCtx*)> cctx(
+      ZSTD_createCCtx(), ZSTD_freeCCtx);
+
+  return cctx.get();
+}
+
+ZSTD_DCtx* ThreadZSTDDCtx() {
+  thread_local std::unique_ptr<ZSTD_DCtx, size_t (*)(ZSTD_DCtx*)> dctx(
+      ZSTD_createDCtx(), ZSTD_freeDCtx);
+
+  return dctx.get();
+}
+
+size_t TotalSize(const std::vector<IOVec>& iovs) {
+  size_t size = 0;
+  for (const auto& iov : iovs) {
+    size += iov.size;
+  }
+
+  return size;
+}
+
+// Return the contiguous bytes of iovs, copy them into scratch if they are
+// scattered.
+const char* Gather(const std::vector<IOVec>& iovs, size_t size,
+                   std::unique_ptr<char[]>* scratch) {
+  if (iovs.size() == 1) {
+    return iovs[0].ptr;
+  }
+
+  scratch->reset(new char[size]);
+
+  size_t offset = 0;
+  for (const auto& iov : iovs) {
+    memcpy(scratch->get() + offset, iov.ptr, iov.size);
+    offset += iov.size;
+  }
+
+  return scratch->get();
+}
+
+// The width is known so the inner loop is unrolled.
+template <size_t W>
+void ShuffleImpl(const char* src, size_t count, char* dst) {
+  for (size_t i = 0; i < count; ++i) {
+    for (size_t b = 0; b < W; ++b) {
+      dst[b * count + i] = src[i * W + b];
+    }
+  }
+}
+
+template <size_t W>
+void UnShuffleImpl(const char* src, size_t count, char* dst) {
+  for (size_t i = 0; i < count; ++i) {
+    for (size_t b = 0; b < W; ++b) {
+      dst[i * W + b] = src[b * count + i];
+    }
+  }
+}
+
+bool SnappyCompress(const std::vector<IOVec>& body, size_t size,
+                    MemBuffer* buf) {
+  buf->Reserve(snappy::MaxCompressedLength(size));
+
+  SnappySource source(body);
+  snappy::UncheckedByteArraySink sink(buf->ptr() + buf->offset());
+
+  buf->Extend(snappy::Compress(&source, &sink));
+
+  return true;
+}
+
+bool LZ4Compress(const std::vector<IOVec>& body, size_t size, int32_t level,
+                 MemBuffer* buf) {
+  if (size > LZ4_MAX_INPUT_SIZE) {
+    return false;
+  }
+
+  std::unique_ptr<char[]> scratch;
+  const char* src = Gather(body, size, &scratch);
+
+  int bound = LZ4_compressBound((int)size);
+  buf->Reserve(bound);
+
+  int n = LZ4_compress_fast(src, buf->ptr() + buf->offset(), (int)size, bound,
+                            level > 0 ? level : 1);
+  if (n <= 0) {
+    return false;
+  }
+
+  buf->Extend(n);
+
+  return true;
+}
+
+bool ZSTDCompress(const std::vector<IOVec>& body, size_t size, int32_t level,
+                  MemBuffer* buf) {
+  ZSTD_CCtx* cctx = ThreadZSTDCCtx();
+
+  ZSTD_CCtx_reset(cctx, ZSTD_reset_session_and_parameters);
+  ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, level != 0 ? level : 1);
+  ZSTD_CCtx_setPledgedSrcSize(cctx, size);
+
+  size_t bound = ZSTD_compressBound(size);
+  buf->Reserve(bound);
+
+  ZSTD_outBuffer output{buf->ptr() + buf->offset(), bound, 0};
+
+  // Stream the segments into one frame, no need to gather them.
+  std::vector<IOVec> iovs = body;
+  if (iovs.empty()) {
+    iovs.emplace_back(IOVec{nullptr, 0});
+  }
+
+  for (size_t i = 0; i < iovs.size(); ++i) {
+    ZSTD_inBuffer input{iovs[i].ptr, iovs[i].size, 0};
+    ZSTD_EndDirective mode =
+        (i + 1 == iovs.size()) ? ZSTD_e_end : ZSTD_e_continue;
+
+    for (;;) {
+      size_t remain = ZSTD_compressStream2(cctx, &output, &input, mode);
+      if (ZSTD_isError(remain)) {
+        return false;
+      }
+
+      if (mode == ZSTD_e_end ? remain == 0 : input.pos == input.size) {
+        break;
+      }
+
+      if (output.pos == output.size) {
+        return false;
+      }
+    }
+  }
+
+  buf->Extend(output.pos);
+
+  return true;
+}
+
+}  // namespace
+
+bool Compress::Support(CompressType type) {
+  return type == CompressType::kNo || type == CompressType::kSnappy ||
+         type == CompressType::kLZ4 || type == CompressType::kZSTD;
+}
+
+void Compress::Shuffle(const std::vector<IOVec>& src, uint8_t width,
+                       char* dst) {
+  size_t size = TotalSize(src);
+
+  std::unique_ptr<char[]> scratch;
+  const char* ptr = Gather(src, size, &scratch);
+
+  size_t count = size / width;
+
+  if (width == 4) {
+    ShuffleImpl<4>(ptr, count, dst);
+  } else if (width == 8) {
+    ShuffleImpl<8>(ptr, count, dst);
+  } else if (width == 2) {
+    ShuffleImpl<2>(ptr, count, dst);
+  } else {
+    for (size_t i = 0; i < count; ++i) {
+      for (size_t b = 0; b < width; ++b) {
+        dst[b * count + i] = ptr[i * width + b];
+      }
+    }
+  }
+
+  memcpy(dst + count * width, ptr + count * width, size - count * width);
+}
+
+void Compress::UnShuffle(const char* src, size_t size, uint8_t width,
+                         char* dst) {
+  size_t count = size / width;
+
+  if (width == 4) {
+    UnShuffleImpl<4>(src, count, dst);
+  } else if (width == 8) {
+    UnShuffleImpl<8>(src, count, dst);
+  } else if (width == 2) {
+    UnShuffleImpl<2>(src, count, dst);
+  } else {
+    for (size_t i = 0; i < count; ++i) {
+      for (size_t b = 0; b < width; ++b) {
+        dst[i * width + b] = src[b * count + i];
+      }
+    }
+  }
+
+  memcpy(dst + count * width, src + count * width, size - count * width);
+}
+
+bool Compress::CompressBody(const CompressPolicy& policy,
+                            const std::vector<IOVec>& body, MemBuffer* buf) {
+  uint64_t size = TotalSize(body);
+
+  // Keep the old snappy layout so the old peers can talk to the new ones.
+  if (policy.type == CompressType::kSnappy) {
+    return SnappyCompress(body, size, buf);
+  }
+  uint8_t shuffle = policy.shuffle > 1 ? policy.shuffle : 0;
+
+  if (buf->Write((const char*)&shuffle, sizeof(shuffle)) == false ||
+      buf->Write((const char*)&size, sizeof(size)) == false) {
+    return false;
+  }
+
+  std::vector<IOVec> input = body;
+
+  std::unique_ptr<char[]> shuffled;
+  if (shuffle > 1) {
+    shuffled.reset(new char[size]);
+    Shuffle(body, shuffle, shuffled.get());
+
+    input = {{shuffled.get(), size}};
+  }
+
+  switch (policy.type) {
+    case CompressType::kLZ4:
+      return LZ4Compress(input, size, policy.level, buf);
+    case CompressType::kZSTD:
+      return ZSTDCompress(input, size, policy.level, buf);
+    default:
+      return false;
+  }
+}
+
+bool Compress::UnCompressBody(CompressType type,
+                              const std::vector<IOVec>& body,
+                              std::shared_ptr<MemBuffer>* raw) {
+  size_t body_size = TotalSize(body);
+
+  // Usually the compressed body is one frame.
+  std::unique_ptr<char[]> scratch;
+  const char* ptr = Gather(body, body_size, &scratch);
+
+  // The snappy body has no prefix.
+  if (type == CompressType::kSnappy) {
+    size_t length;
+    if (snappy::GetUncompressedLength(ptr, body_size, &length) == false) {
+      return false;
+    }
+
+    auto buf = std::make_shared<MemBuffer>(length);
+    if (snappy::RawUncompress(ptr, body_size, buf->Extend(length)) == false) {
+      return false;
+    }
+
+    *raw = std::move(buf);
+
+    return true;
+  }
+
+  if (body_size < kBodyPrefixBytes) {
+    return false;
+  }
+
+  uint8_t shuffle;
+  uint64_t size;
+  memcpy(&shuffle, ptr, sizeof(shuffle));
+  memcpy(&size, ptr + sizeof(shuffle), sizeof(size));
+
+  const char* src = ptr + kBodyPrefixBytes;
+  size_t src_size = body_size - kBodyPrefixBytes;
+
+  // The size is from the wire, check it before allocate.
+  if (type == CompressType::kLZ4) {
+    if (size > LZ4_MAX_INPUT_SIZE || src_size > LZ4_MAX_INPUT_SIZE) {
+      return false;
+    }
+  } else if (type == CompressType::kZSTD) {
+    // The frame always has the content size (the pledged size when compress).
+    unsigned long long content_size = ZSTD_getFrameContentSize(src, src_size);
+    if (content_size == ZSTD_CONTENTSIZE_UNKNOWN ||
+        content_size == ZSTD_CONTENTSIZE_ERROR || content_size != size) {
+      return false;
+    }
+  } else {
+    return false;
+  }
+
+  auto buf = std::make_shared<MemBuffer>(size);
+  char* target = buf->Extend(size);
+
+  std::unique_ptr<char[]> shuffled;
+  char* dst = target;
+  if (shuffle > 1) {
+    shuffled.reset(new char[size]);
+    dst = shuffled.get();
+  }
+
+  if (type == CompressType::kLZ4) {
+    if (LZ4_decompress_safe(src, dst, (int)src_size, (int)size) != (int)size) {
+      return false;
+    }
+  } else {
+    size_t n = ZSTD_decompressDCtx(ThreadZSTDDCtx(), dst, size, src, src_size);
+    if (ZSTD_isError(n) || n != size) {
+      return false;
+    }
+  }
+
+  if (shuffle > 1) {
+    UnShuffle(dst, size, shuffle, target);
+  }
+
+  *raw = std::move(buf);
+
+  return true;
+}
+
+}  // namespace kraken
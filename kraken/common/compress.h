@@ -1,91 +1,150 @@
 #pragma once
 
-#include <snappy.h>
-
 #include <cinttypes>
+#include <memory>
+#include <vector>
 
+#include "common/compress_policy.h"
 #include "common/deserialize.h"
 #include "common/error_code.h"
 #include "common/exception.h"
+#include "common/iovec_buffer.h"
+#include "common/iovec_reader.h"
 #include "common/mem_buffer.h"
 #include "common/mem_reader.h"
 #include "common/serialize.h"
-#include "common/snappy.h"
+#include "common/size_writer.h"
+#include "common/zmq_buffer.h"
 
 namespace kraken {
 
 struct Compress {
+  // The LZ4/ZSTD body: [shuffle:uint8][raw length:uint64][codec data]. The
+  // snappy body is the snappy data only, same as the old version.
+  constexpr static size_t kBodyPrefixBytes = sizeof(uint8_t) + sizeof(uint64_t);
+
+  static bool Support(CompressType type);
+
+  // Put the i-th byte of every width bytes element together, the tail bytes
+  // not fill an element are copied directly.
+  static void Shuffle(const std::vector<IOVec>& src, uint8_t width, char* dst);
+
+  static void UnShuffle(const char* src, size_t size, uint8_t width,
+                        char* dst);
+
+  // Append the compressed body into buf.
+  static bool CompressBody(const CompressPolicy& policy,
+                           const std::vector<IOVec>& body, MemBuffer* buf);
+
+  static bool UnCompressBody(CompressType type, const std::vector<IOVec>& body,
+                             std::shared_ptr<MemBuffer>* raw);
+
+  // If holder is set it own the body, the big dense Tensors in v will alias
+  // the body and keep holder alive.
   template <typename Type>
-  static bool NoUnCompressDeser(const char* body, size_t body_len, Type* v) {
-    MemReader reader(body, body_len);
+  static bool NoUnCompressDeser(const std::vector<IOVec>& body, Type* v,
+                                const std::shared_ptr<void>& holder = nullptr) {
+    IOVecReader reader(body, holder);
     Deserialize deserialize(&reader);
 
     return deserialize >> (*v);
   }
 
+  // The body is compressed by type, the big dense Tensors in v alias the
+  // uncompressed buffer.
   template <typename Type>
-  static bool SnappyUnCompressDeser(const char* body, size_t body_len,
-                                    Type* v) {
-    SnappySource source(body, body_len);
-    SnappySink sink;
+  static bool UnCompressDeser(CompressType type, const std::vector<IOVec>& body,
+                              Type* v,
+                              const std::shared_ptr<void>& holder = nullptr) {
+    if (type == CompressType::kNo) {
+      return NoUnCompressDeser(body, v, holder);
+    }
 
-    if (snappy::Uncompress(&source, &sink) == false) {
+    std::shared_ptr<MemBuffer> raw;
+    if (UnCompressBody(type, body, &raw) == false) {
       return false;
     }
 
-    MemReader reader(sink.ptr(), sink.offset());
+    MemReader reader(raw->ptr(), raw->offset(), raw);
     Deserialize deserialize(&reader);
 
     return deserialize >> (*v);
   }
 
-  template <typename ReplyType>
-  static bool NoCompressSeria(const ReplyHeader& reply_header,
-                              const ReplyType& reply, ZMQBuffer* z_buf) {
-    MemBuffer buffer;
-    Serialize serialize(&buffer);
+  // Serialize the header and v into buf. Count the size firstly so the inline
+  // bytes are allocated once, the big dense Tensors in v are referenced not
+  // copied, so they must not be modified until buf is sent.
+  template <typename HeaderType, typename Type>
+  static bool NoCompressSeria(const HeaderType& header, const Type& v,
+                              IOVecBuffer* buf) {
+    SizeWriter sizer(IOVecBuffer::kMinRefBytes);
+    {
+      Serialize serialize(&sizer);
+      if ((serialize << header) == false || (serialize << v) == false) {
+        return false;
+      }
+    }
 
-    ARGUMENT_CHECK(serialize << reply_header, "Serialize reply header error!");
-    if ((serialize << reply) == false) {
-      return false;
+    IOVecBuffer buffer(sizer.copy_size());
+    {
+      Serialize serialize(&buffer);
+      ARGUMENT_CHECK(serialize << header, "Serialize header error!");
+
+      if ((serialize << v) == false) {
+        return false;
+      }
     }
 
-    // Transfer to ZMQBuffer.
-    buffer.TransferForZMQ(z_buf);
+    *buf = std::move(buffer);
 
     return true;
   }
 
-  template <typename ReplyType>
-  static int32_t SnappyCompressSeria(const ReplyHeader& reply_header,
-                                     const ReplyType& reply, ZMQBuffer* z_buf) {
-    SnappySink sink;
+  // Serialize the header and v into buf, the body is compressed by policy.
+  template <typename HeaderType, typename Type>
+  static bool CompressSeria(HeaderType header, const Type& v,
+                            const CompressPolicy& policy, IOVecBuffer* buf) {
+    header.compress_type = CompressType::kNo;
 
-    // step1 serialize header.
-    {
-      Serialize serialize(&sink);
-      ARGUMENT_CHECK(serialize << reply_header,
-                     "Serialize reply header error!");
+    if (NoCompressSeria(header, v, buf) == false) {
+      return false;
     }
 
-    // step2 serialize body to tmp buffer.
-    MemBuffer body_buf;
-    {
-      Serialize serialize(&body_buf);
-      if ((serialize << reply) == false) {
-        return false;
-      }
+    return CompressBuffer(header, policy, buf);
+  }
+
+  // Compress the body of buf which is serialized uncompressed with header.
+  // Keep buf unchanged if the body is smaller than policy.min_bytes, the
+  // compressed one is not smaller or the compress fail (e.g. the body is too
+  // big for LZ4), the peer can always read the uncompressed one.
+  template <typename HeaderType>
+  static bool CompressBuffer(HeaderType header, const CompressPolicy& policy,
+                             IOVecBuffer* buf) {
+    if (policy.type == CompressType::kNo ||
+        buf->size() < sizeof(header) + policy.min_bytes) {
+      return true;
     }
 
-    // Step3 compress body data to sink.
+    header.compress_type = policy.type;
+
+    MemBuffer compressed;
     {
-      SnappySource source(body_buf.ptr(), body_buf.offset());
-      if (snappy::Compress(&source, &sink) <= 0) {
-        return false;
-      }
+      Serialize serialize(&compressed);
+      ARGUMENT_CHECK(serialize << header, "Serialize header error!");
     }
 
-    sink.TransferForZMQ(z_buf);
+    bool ok = CompressBody(policy, buf->IOVecs(sizeof(header)), &compressed);
+    if (ok == false || compressed.offset() >= buf->size()) {
+      return true;
+    }
+
+    ZMQBuffer z_buf;
+    compressed.TransferForZMQ(&z_buf);
+
+    IOVecBuffer compressed_buf;
+    compressed_buf.Append(&z_buf);
+
+    *buf = std::move(compressed_buf);
 
     return true;
   }
@@ -0,0 +1,46 @@
+#include "common/compress_policy.h"
+
+namespace kraken {
+
+CompressPolicy::CompressPolicy(CompressType type, size_t min_bytes,
+                               uint8_t shuffle, int32_t level)
+    : type(type), min_bytes(min_bytes), shuffle(shuffle), level(level) {
+}
+
+CompressPolicies::CompressPolicies() {
+}
+
+CompressPolicies::CompressPolicies(CompressType type) : default_(type) {
+}
+
+CompressPolicies::CompressPolicies(const CompressPolicy& default_policy)
+    : default_(default_policy) {
+}
+
+void CompressPolicies::SetDefault(const CompressPolicy& policy) {
+  default_ = policy;
+}
+
+void CompressPolicies::Set(uint32_t rpc_type, const CompressPolicy& policy) {
+  policies_[rpc_type] = policy;
+}
+
+const CompressPolicy& CompressPolicies::Get(uint32_t rpc_type) const {
+  auto it = policies_.find(rpc_type);
+  if (it == policies_.end()) {
+    return default_;
+  }
+
+  return it->second;
+}
+
+const CompressPolicy* CompressPolicies::Find(uint32_t rpc_type) const {
+  auto it = policies_.find(rpc_type);
+  if (it == policies_.end()) {
+    return nullptr;
+  }
+
+  return &(it->second);
+}
+
+}  // namespace kraken
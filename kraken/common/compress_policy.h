@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cinttypes>
+#include <cstdlib>
+#include <unordered_map>
+
+#include "rpc/protocol.h"
+
+namespace kraken {
+
+/**
+ * \brief How to compress a message body.
+ */
+struct CompressPolicy {
+  CompressType type;
+
+  // The body smaller than it is sent uncompressed, compress a small message is
+  // not worth.
+  size_t min_bytes;
+
+  // Byte shuffle the body by element width before compress (4 for float32), 0
+  // or 1 means not shuffle. The float's exponent bytes are very similar so
+  // group them together make the codec find more matches. Snappy ignores it.
+  uint8_t shuffle;
+
+  // The codec level, 0 means the default. LZ4: acceleration, ZSTD: level.
+  int32_t level;
+
+  CompressPolicy(CompressType type = CompressType::kNo, size_t min_bytes = 0,
+                 uint8_t shuffle = 0, int32_t level = 0);
+};
+
+/**
+ * \brief The CompressPolicy of every RPC type, not thread-safe, set them
+ * before use.
+ */
+class CompressPolicies {
+private:
+  CompressPolicy default_;
+
+  std::unordered_map<uint32_t /*RPC type*/, CompressPolicy> policies_;
+
+public:
+  CompressPolicies();
+
+  CompressPolicies(CompressType type);
+
+  CompressPolicies(const CompressPolicy& default_policy);
+
+public:
+  void SetDefault(const CompressPolicy& policy);
+
+  void Set(uint32_t rpc_type, const CompressPolicy& policy);
+
+  // Return the default one if the rpc_type is not set.
+  const CompressPolicy& Get(uint32_t rpc_type) const;
+
+  // Return nullptr if the rpc_type is not set.
+  const CompressPolicy* Find(uint32_t rpc_type) const;
+};
+
+}  // namespace kraken
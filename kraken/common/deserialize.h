@@ -21,6 +21,10 @@ namespace kraken {
 
 class Deserialize {
 private:
+  // A dense Tensor smaller than it is copied, copy a small one is cheaper than
+  // hold the whole message.
+  constexpr static size_t kBorrowMinBytes = 4096;
+
   IReader* reader_;
 
 public:
@@ -32,6 +36,26 @@ public:
     return reader_->Read(target, size);
   }
 
+  bool IsEnd() {
+    return reader_->IsEnd();
+  }
+
+  // Return a Storage alias the reader's memory without copy, nullptr if can
+  // not.
+  std::shared_ptr<Storage> Borrow(size_t size, size_t align) {
+    if (size < kBorrowMinBytes) {
+      return nullptr;
+    }
+
+    std::shared_ptr<void> holder;
+    const char* ptr = reader_->Borrow(size, align, &holder);
+    if (ptr == nullptr) {
+      return nullptr;
+    }
+
+    return Storage::From((void*)ptr, size, std::move(holder));
+  }
+
   template <typename T>
   bool operator>>(T& v) {
     return false;
@@ -234,12 +258,16 @@ inline bool Deserialize::operator>>(Tensor& v) {
       return false;
     }
 
-    // Read storage.
+    // Alias the reader's memory if it can be borrowed, else read storage.
     size_t nbytes = shape.Size() * etype.ByteWidth();
-    auto storage = Storage::Create(nbytes);
+    auto storage = Borrow(nbytes, etype.ByteWidth());
 
-    if (Read(storage->ptr(), nbytes) == false) {
-      return false;
+    if (storage == nullptr) {
+      storage = Storage::Create(nbytes);
+
+      if (Read(storage->ptr(), nbytes) == false) {
+        return false;
+      }
     }
 
     auto impl = TensorImpl::Dense(shape, storage, 0, etype);
@@ -466,8 +494,39 @@ inline bool Deserialize::operator>>(
 
 template <>
 inline bool Deserialize::operator>>(ModelMetaData& v) {
-  return ((*this) >> v.name) && ((*this) >> v.optim_type) &&
-         ((*this) >> v.optim_conf) && ((*this) >> v.table_mdatas);
+  if (((*this) >> v.name) == false || ((*this) >> v.optim_type) == false ||
+      ((*this) >> v.optim_conf) == false ||
+      ((*this) >> v.table_mdatas) == false) {
+    return false;
+  }
+
+  // The table_conf is appended at the end, the old one does not have it.
+  if (IsEnd()) {
+    return true;
+  }
+
+  uint64_t size;
+  if (((*this) >> size) == false) {
+    return false;
+  }
+
+  for (uint64_t i = 0; i < size; ++i) {
+    uint64_t table_id;
+    std::unordered_map<std::string, std::string> table_conf;
+
+    if (((*this) >> table_id) == false || ((*this) >> table_conf) == false) {
+      return false;
+    }
+
+    auto it = v.table_mdatas.find(table_id);
+    if (it == v.table_mdatas.end()) {
+      return false;
+    }
+
+    it->second.table_conf = std::move(table_conf);
+  }
+
+  return true;
 }
 
 template <>
@@ -549,8 +608,7 @@ inline bool Deserialize::operator>>(
 }
 
 template <>
-inline bool Deserialize::operator>>(
-    std::unordered_map<uint64_t, std::vector<Tensor>>& v) {
+inline bool Deserialize::operator>>(std::unordered_map<uint64_t, Tensor>& v) {
   v.clear();
 
   uint64_t size;
@@ -561,7 +619,7 @@ inline bool Deserialize::operator>>(
   v.reserve(size);
   for (uint64_t i = 0; i < size; ++i) {
     uint64_t key;
-    std::vector<Tensor> value;
+    Tensor value;
 
     if (((*this) >> key) == false || ((*this) >> value) == false) {
       return false;
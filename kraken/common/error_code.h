@@ -31,6 +31,8 @@ struct ErrorCode {
   static constexpr int32_t kRouterVersionError = 22;
   static constexpr int32_t kModelAlreadyInitializedError = 23;
   static constexpr int32_t kLoadModelError = 24;
+  static constexpr int32_t kTooManyRequestsError = 25;
+  static constexpr int32_t kConnecterStoppedError = 26;
 
   static const char* Msg(int32_t code) {
     switch (code) {
@@ -86,6 +88,10 @@ struct ErrorCode {
         return "Model already initialized error";
       case ErrorCode::kLoadModelError:
         return "Load model error";
+      case ErrorCode::kTooManyRequestsError:
+        return "Too many pending requests";
+      case ErrorCode::kConnecterStoppedError:
+        return "Connecter has been stopped";
       default:
         return "Unrecognized error";
     }
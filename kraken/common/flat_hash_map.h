@@ -0,0 +1,336 @@
+#pragma once
+
+#include <cassert>
+#include <cinttypes>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <utility>
+
+namespace kraken {
+
+// A open-addressing hash map use Robin Hood hashing with backward shift
+// deletion. All key/value store in one contiguous array, so a lookup only touch
+// a few cache line instead of chasing pointers.
+// ref: https://programming.guide/robin-hood-hashing.html
+template <typename Key, typename Value, typename KeyHash = std::hash<Key>>
+class FlatHashMap {
+private:
+  constexpr static size_t kMinCapacity = 16;
+
+  // Max probe distance store in uint8_t, 0 means the bucket is empty.
+  constexpr static uint8_t kMaxDistance = 255;
+
+  struct Bucket {
+    Key key;
+    Value value;
+  };
+
+public:
+  // The Iterator will be invalid when modify the FlatHashMap.
+  struct SeekIterator {
+  private:
+    friend class FlatHashMap;
+
+    const FlatHashMap* map_;
+    size_t index_;
+
+  private:
+    SeekIterator(const FlatHashMap* map, size_t index)
+        : map_(map), index_(index) {
+    }
+
+  public:
+    bool Valid() const {
+      return index_ < map_->capacity_;
+    }
+
+    const Key& key() const {
+      assert(Valid());
+      return map_->buckets_[index_].key;
+    }
+
+    const Value& value() const {
+      assert(Valid());
+      return map_->buckets_[index_].value;
+    }
+
+    Value& value() {
+      assert(Valid());
+      return map_->buckets_[index_].value;
+    }
+
+    void Next() {
+      assert(Valid());
+
+      index_++;
+      while (index_ < map_->capacity_ && map_->dists_[index_] == 0) {
+        index_++;
+      }
+    }
+  };
+
+private:
+  KeyHash hash_;
+
+  // Power of 2.
+  size_t capacity_;
+  size_t size_;
+
+  // 0 means empty, other means (probe distance + 1).
+  uint8_t* dists_;
+  Bucket* buckets_;
+
+public:
+  FlatHashMap()
+      : hash_(), capacity_(0), size_(0), dists_(nullptr), buckets_(nullptr) {
+  }
+
+  ~FlatHashMap() {
+    Clear();
+
+    free(dists_);
+    free(buckets_);
+  }
+
+  FlatHashMap(const FlatHashMap&) = delete;
+  FlatHashMap(const FlatHashMap&&) = delete;
+  FlatHashMap& operator=(const FlatHashMap&) = delete;
+  FlatHashMap& operator=(const FlatHashMap&&) = delete;
+
+private:
+  // Fibonacci hashing, the sparse id is usually hit slot by id % N, so we need
+  // mix the bits again or all keys in one slot will share the low bits.
+  inline size_t BucketIndex(const Key& key) const {
+    uint64_t h = (uint64_t)hash_(key) * 11400714819323198485ull;
+
+    return (size_t)(h >> 32) & (capacity_ - 1);
+  }
+
+  inline size_t NextIndex(size_t i) const {
+    return (i + 1) & (capacity_ - 1);
+  }
+
+  // Load factor is 0.875.
+  inline bool NeedGrow() const {
+    return capacity_ == 0 || (size_ + 1) * 8 > capacity_ * 7;
+  }
+
+  void Rehash(size_t new_capacity) {
+    uint8_t* old_dists = dists_;
+    Bucket* old_buckets = buckets_;
+    size_t old_capacity = capacity_;
+
+    capacity_ = new_capacity;
+    size_ = 0;
+    dists_ = (uint8_t*)calloc(capacity_, sizeof(uint8_t));
+    buckets_ = (Bucket*)malloc(capacity_ * sizeof(Bucket));
+
+    for (size_t i = 0; i < old_capacity; ++i) {
+      if (old_dists[i] != 0) {
+        Emplace(std::move(old_buckets[i].key), std::move(old_buckets[i].value));
+        old_buckets[i].~Bucket();
+      }
+    }
+
+    free(old_dists);
+    free(old_buckets);
+  }
+
+  // Return the index of the key, capacity_ means not found.
+  size_t FindIndex(const Key& key) const {
+    if (size_ == 0) {
+      return capacity_;
+    }
+
+    size_t i = BucketIndex(key);
+    uint8_t dist = 1;
+
+    // Robin Hood: a bucket whose distance is less than ours means the key can
+    // not be further.
+    while (dists_[i] >= dist) {
+      if (dists_[i] == dist && buckets_[i].key == key) {
+        return i;
+      }
+
+      i = NextIndex(i);
+      dist++;
+    }
+
+    return capacity_;
+  }
+
+  // Insert a key that make sure not exist.
+  void Emplace(Key&& key, Value&& value) {
+    size_t i = BucketIndex(key);
+    uint8_t dist = 1;
+
+    while (true) {
+      if (dists_[i] == 0) {
+        new (buckets_ + i) Bucket{std::move(key), std::move(value)};
+        dists_[i] = dist;
+        size_++;
+
+        return;
+      }
+
+      if (dists_[i] < dist) {
+        // Take from the rich, swap and continue insert the poorer one.
+        std::swap(key, buckets_[i].key);
+        std::swap(value, buckets_[i].value);
+        std::swap(dist, dists_[i]);
+      }
+
+      i = NextIndex(i);
+      dist++;
+
+      if (dist == kMaxDistance) {
+        // Too long probe chain, grow and insert the left one again.
+        Rehash(capacity_ * 2);
+        Emplace(std::move(key), std::move(value));
+
+        return;
+      }
+    }
+  }
+
+  // Erase the bucket at i and shift the backward bucket forward.
+  void EraseIndex(size_t i) {
+    buckets_[i].~Bucket();
+    dists_[i] = 0;
+    size_--;
+
+    size_t next = NextIndex(i);
+    while (dists_[next] > 1) {
+      new (buckets_ + i) Bucket(std::move(buckets_[next]));
+      dists_[i] = dists_[next] - 1;
+
+      buckets_[next].~Bucket();
+      dists_[next] = 0;
+
+      i = next;
+      next = NextIndex(next);
+    }
+  }
+
+public:
+  size_t Size() const {
+    return size_;
+  }
+
+  size_t Capacity() const {
+    return capacity_;
+  }
+
+  void Clear() {
+    for (size_t i = 0; i < capacity_; ++i) {
+      if (dists_[i] != 0) {
+        buckets_[i].~Bucket();
+        dists_[i] = 0;
+      }
+    }
+
+    size_ = 0;
+  }
+
+  void Reserve(size_t count) {
+    size_t new_capacity = capacity_ == 0 ? kMinCapacity : capacity_;
+    while (count * 8 > new_capacity * 7) {
+      new_capacity *= 2;
+    }
+
+    if (new_capacity > capacity_) {
+      Rehash(new_capacity);
+    }
+  }
+
+  bool Insert(const Key& key, const Value& value) {
+    if (FindIndex(key) != capacity_) {
+      return false;
+    }
+
+    if (NeedGrow()) {
+      Rehash(capacity_ == 0 ? kMinCapacity : capacity_ * 2);
+    }
+
+    Emplace(Key(key), Value(value));
+
+    return true;
+  }
+
+  bool Insert(const Key& key, Value&& value) {
+    if (FindIndex(key) != capacity_) {
+      return false;
+    }
+
+    if (NeedGrow()) {
+      Rehash(capacity_ == 0 ? kMinCapacity : capacity_ * 2);
+    }
+
+    Emplace(Key(key), std::move(value));
+
+    return true;
+  }
+
+  bool Contains(const Key& key) const {
+    return FindIndex(key) != capacity_;
+  }
+
+  SeekIterator Begin() const {
+    SeekIterator it(this, 0);
+
+    while (it.index_ < capacity_ && dists_[it.index_] == 0) {
+      it.index_++;
+    }
+
+    return it;
+  }
+
+  SeekIterator Find(const Key& key) const {
+    return SeekIterator(this, FindIndex(key));
+  }
+
+  bool Remove(const Key& key) {
+    size_t i = FindIndex(key);
+    if (i == capacity_) {
+      return false;
+    }
+
+    EraseIndex(i);
+
+    return true;
+  }
+
+  // Remove all key/value that func return true. Return removed count.
+  // Every key/value is visited exactly once, so func can update the value.
+  size_t RemoveIf(const std::function<bool(const Key&, const Value&)>& func) {
+    if (size_ == 0) {
+      return 0;
+    }
+
+    // Start after an empty bucket (the load factor is less than 1), no probe
+    // chain cross it, so the erase only shift the not visited buckets back.
+    size_t start = 0;
+    while (dists_[start] != 0) {
+      start++;
+    }
+
+    size_t count = 0;
+    size_t i = NextIndex(start);
+
+    for (size_t step = 1; step < capacity_;) {
+      if (dists_[i] != 0 && func(buckets_[i].key, buckets_[i].value)) {
+        // The backward bucket will be shift to i, check it again.
+        EraseIndex(i);
+        count++;
+      } else {
+        i = NextIndex(i);
+        step++;
+      }
+    }
+
+    return count;
+  }
+};
+
+}  // namespace kraken
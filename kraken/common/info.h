@@ -59,6 +59,12 @@ enum class InitializerType : uint8_t {
   kXavierNormal = 4,
 };
 
+// SparseTable storage type.
+enum class StorageType : uint8_t {
+  kSkipList = 0,
+  kHashMap = 1,
+};
+
 // State type.
 enum class StateType : uint32_t {
   kSteps = 0,
@@ -116,6 +122,10 @@ struct TableMetaData {
   int64_t dimension;
   InitializerType init_type;
   std::unordered_map<std::string, std::string> init_conf;
+
+  // SparseTable config, like: storage_type. It is serialized at the end of
+  // ModelMetaData, so ModelMetaData must be the last field of a message.
+  std::unordered_map<std::string, std::string> table_conf;
 };
 
 struct ModelMetaData {
@@ -0,0 +1,141 @@
+#include "common/iovec_buffer.h"
+
+namespace kraken {
+
+IOVecBuffer::IOVecBuffer()
+    : inline_(std::make_shared<MemBuffer>()), inline_begin_(0), size_(0) {
+}
+
+IOVecBuffer::IOVecBuffer(size_t expect)
+    : inline_(std::make_shared<MemBuffer>(expect)), inline_begin_(0), size_(0) {
+}
+
+void IOVecBuffer::Seal() {
+  if (inline_->offset() > inline_begin_) {
+    Piece piece;
+    piece.ptr = nullptr;
+    piece.offset = inline_begin_;
+    piece.size = inline_->offset() - inline_begin_;
+
+    pieces_.emplace_back(std::move(piece));
+
+    inline_begin_ = inline_->offset();
+  }
+}
+
+size_t IOVecBuffer::size() const {
+  return size_;
+}
+
+bool IOVecBuffer::Write(const char* ptr, size_t size) {
+  if (inline_->Write(ptr, size) == false) {
+    return false;
+  }
+
+  size_ += size;
+
+  return true;
+}
+
+bool IOVecBuffer::WriteRef(const char* ptr, size_t size,
+                           const std::shared_ptr<void>& holder) {
+  if (size < kMinRefBytes || holder == nullptr) {
+    return Write(ptr, size);
+  }
+
+  Seal();
+
+  Piece piece;
+  piece.ptr = ptr;
+  piece.offset = 0;
+  piece.size = size;
+  piece.holder = holder;
+
+  pieces_.emplace_back(std::move(piece));
+
+  size_ += size;
+
+  return true;
+}
+
+void IOVecBuffer::Append(ZMQBuffer* z_buf) {
+  void* ptr = nullptr;
+  size_t capacity = 0;
+  size_t offset = 0;
+  void (*zmq_free)(void*, void*) = nullptr;
+
+  z_buf->Transfer(&ptr, &capacity, &offset, &zmq_free);
+
+  if (ptr == nullptr) {
+    return;
+  }
+
+  Seal();
+
+  Piece piece;
+  piece.ptr = (const char*)ptr;
+  piece.offset = 0;
+  piece.size = offset;
+  piece.holder =
+      std::shared_ptr<void>(ptr, [zmq_free](void* p) { zmq_free(p, nullptr); });
+
+  pieces_.emplace_back(std::move(piece));
+
+  size_ += offset;
+}
+
+std::vector<IOVecBuffer::Segment> IOVecBuffer::Segments() {
+  Seal();
+
+  std::vector<Segment> segments;
+  segments.reserve(pieces_.size());
+
+  for (const auto& piece : pieces_) {
+    if (piece.size == 0) {
+      continue;
+    }
+
+    Segment segment;
+    segment.size = piece.size;
+
+    if (piece.ptr == nullptr) {
+      segment.ptr = inline_->ptr() + piece.offset;
+      segment.holder = inline_;
+    } else {
+      segment.ptr = piece.ptr;
+      segment.holder = piece.holder;
+    }
+
+    segments.emplace_back(std::move(segment));
+  }
+
+  return segments;
+}
+
+std::vector<IOVec> IOVecBuffer::IOVecs(size_t offset) {
+  Seal();
+
+  std::vector<IOVec> iovs;
+  iovs.reserve(pieces_.size());
+
+  for (const auto& piece : pieces_) {
+    if (offset >= piece.size) {
+      offset -= piece.size;
+      continue;
+    }
+
+    IOVec iov;
+    iov.ptr = (piece.ptr == nullptr ? inline_->ptr() + piece.offset
+                                    : piece.ptr) +
+              offset;
+    iov.size = piece.size - offset;
+
+    iovs.emplace_back(iov);
+
+    offset = 0;
+  }
+
+  return iovs;
+}
+
+}  // namespace kraken
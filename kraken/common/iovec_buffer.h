@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include "common/iwriter.h"
+#include "common/mem_buffer.h"
+#include "common/zmq_buffer.h"
+
+namespace kraken {
+
+struct IOVec {
+  const char* ptr;
+  size_t size;
+};
+
+/**
+ * \brief A scatter-gather buffer not thread-safe.
+ *
+ * The small writes are copied into one inline MemBuffer, the big referenced
+ * writes (like a dense Tensor's storage) are not copied but become a seperate
+ * segment and the buffer keep it's holder. It is sent as ZMQ multipart message,
+ * one frame per segment.
+ */
+class IOVecBuffer : public IWriter {
+public:
+  // A referenced write smaller than it is copied, a small frame is not worth.
+  constexpr static size_t kMinRefBytes = 4096;
+
+  struct Segment {
+    const char* ptr;
+    size_t size;
+
+    // Keep the memory alive.
+    std::shared_ptr<void> holder;
+  };
+
+private:
+  struct Piece {
+    // nullptr means the bytes is in inline buffer start at offset, the inline
+    // buffer maybe reallocated so not store the pointer.
+    const char* ptr;
+    size_t offset;
+    size_t size;
+
+    std::shared_ptr<void> holder;
+  };
+
+  std::shared_ptr<MemBuffer> inline_;
+
+  // The inline bytes after it not belong to any piece.
+  size_t inline_begin_;
+
+  std::vector<Piece> pieces_;
+
+  size_t size_;
+
+public:
+  IOVecBuffer();
+
+  // expect is the inline bytes.
+  explicit IOVecBuffer(size_t expect);
+
+  IOVecBuffer(IOVecBuffer&&) = default;
+  IOVecBuffer& operator=(IOVecBuffer&&) = default;
+
+  IOVecBuffer(const IOVecBuffer&) = delete;
+  IOVecBuffer& operator=(const IOVecBuffer&) = delete;
+
+private:
+  // Put the left inline bytes into a piece.
+  void Seal();
+
+public:
+  // All bytes.
+  size_t size() const;
+
+  bool Write(const char* ptr, size_t size) override;
+
+  bool WriteRef(const char* ptr, size_t size,
+                const std::shared_ptr<void>& holder) override;
+
+  // Take the z_buf's memory as a segment.
+  void Append(ZMQBuffer* z_buf);
+
+  // The non-empty segments, the inline segments' holder is the inline buffer.
+  std::vector<Segment> Segments();
+
+  // Same with Segments but skip the first offset bytes.
+  std::vector<IOVec> IOVecs(size_t offset = 0);
+};
+
+}  // namespace kraken
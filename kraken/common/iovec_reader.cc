@@ -0,0 +1,81 @@
+#include "common/iovec_reader.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace kraken {
+
+IOVecReader::IOVecReader(std::vector<IOVec> iovs)
+    : IOVecReader(std::move(iovs), nullptr) {
+}
+
+IOVecReader::IOVecReader(std::vector<IOVec> iovs, std::shared_ptr<void> holder)
+    : iovs_(std::move(iovs)),
+      idx_(0),
+      offset_(0),
+      remain_(0),
+      holder_(std::move(holder)) {
+  for (const auto& iov : iovs_) {
+    remain_ += iov.size;
+  }
+}
+
+void IOVecReader::Forward() {
+  while (idx_ < iovs_.size() && offset_ >= iovs_[idx_].size) {
+    idx_++;
+    offset_ = 0;
+  }
+}
+
+bool IOVecReader::Read(void* target, size_t size) {
+  if (size > remain_) {
+    return false;
+  }
+
+  char* ptr = (char*)target;
+
+  while (size > 0) {
+    Forward();
+
+    size_t n = std::min(size, iovs_[idx_].size - offset_);
+    memcpy(ptr, iovs_[idx_].ptr + offset_, n);
+
+    ptr += n;
+    size -= n;
+    offset_ += n;
+    remain_ -= n;
+  }
+
+  return true;
+}
+
+bool IOVecReader::IsEnd() {
+  return remain_ == 0;
+}
+
+const char* IOVecReader::Borrow(size_t size, size_t align,
+                                std::shared_ptr<void>* holder) {
+  if (holder_ == nullptr || size > remain_) {
+    return nullptr;
+  }
+
+  Forward();
+
+  if (idx_ >= iovs_.size() || offset_ + size > iovs_[idx_].size) {
+    return nullptr;
+  }
+
+  const char* ptr = iovs_[idx_].ptr + offset_;
+  if (align > 1 && ((uintptr_t)ptr) % align != 0) {
+    return nullptr;
+  }
+
+  offset_ += size;
+  remain_ -= size;
+  *holder = holder_;
+
+  return ptr;
+}
+
+}  // namespace kraken
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include "common/iovec_buffer.h"
+#include "common/ireader.h"
+
+namespace kraken {
+
+/**
+ * \brief Read the bytes scattered in many segments, like a ZMQ multipart
+ * message.
+ */
+class IOVecReader : public IReader {
+private:
+  std::vector<IOVec> iovs_;
+
+  // The current segment and the offset in it.
+  size_t idx_;
+  size_t offset_;
+
+  // The left bytes.
+  size_t remain_;
+
+  // The owner of the memory, the memory can be borrowed only if it is set.
+  std::shared_ptr<void> holder_;
+
+public:
+  explicit IOVecReader(std::vector<IOVec> iovs);
+
+  IOVecReader(std::vector<IOVec> iovs, std::shared_ptr<void> holder);
+
+private:
+  // Skip the segments be read out.
+  void Forward();
+
+public:
+  bool Read(void* target, size_t size) override;
+
+  bool IsEnd() override;
+
+  // Only borrow the bytes in one segment.
+  const char* Borrow(size_t size, size_t align,
+                     std::shared_ptr<void>* holder) override;
+};
+
+}  // namespace kraken
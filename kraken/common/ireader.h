@@ -1,12 +1,24 @@
 #pragma once
 
 #include <cstddef>
+#include <memory>
 
 namespace kraken {
 
 class IReader {
 public:
   virtual bool Read(void* target, size_t size) = 0;
+
+  // Whether all bytes have been read.
+  virtual bool IsEnd() = 0;
+
+  // Return the pointer of the next size bytes without copy and set holder to
+  // keep the memory alive. Return nullptr (and not move) if the memory can not
+  // be borrowed or the pointer is not aligned by align.
+  virtual const char* Borrow(size_t size, size_t align,
+                             std::shared_ptr<void>* holder) {
+    return nullptr;
+  }
 };
 
 }  // namespace kraken
@@ -1,12 +1,20 @@
 #pragma once
 
 #include <cstddef>
+#include <memory>
 
 namespace kraken {
 
 class IWriter {
 public:
   virtual bool Write(const char* ptr, size_t size) = 0;
+
+  // Write the bytes that owned by holder, a scatter-gather writer can reference
+  // them not copy and keep holder alive. Default is copy.
+  virtual bool WriteRef(const char* ptr, size_t size,
+                        const std::shared_ptr<void>& holder) {
+    return Write(ptr, size);
+  }
 };
 
 }  // namespace kraken
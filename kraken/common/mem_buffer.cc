@@ -71,7 +71,7 @@ size_t MemBuffer::offset() const {
   return offset_;
 }
 
-bool MemBuffer::Write(const char* bytes, size_t size) {
+void MemBuffer::Reserve(size_t size) {
   if (ptr_ == nullptr || offset_ + size > capacity_) {
     // increase the buffer.
     size_t new_capacity = Growth(offset_ + size);
@@ -90,6 +90,10 @@ bool MemBuffer::Write(const char* bytes, size_t size) {
     ptr_ = new_ptr;
     capacity_ = new_capacity;
   }
+}
+
+bool MemBuffer::Write(const char* bytes, size_t size) {
+  Reserve(size);
 
   std::memcpy(ptr_ + offset_, bytes, size);
   offset_ += size;
@@ -97,6 +101,15 @@ bool MemBuffer::Write(const char* bytes, size_t size) {
   return true;
 }
 
+char* MemBuffer::Extend(size_t size) {
+  Reserve(size);
+
+  char* ptr = ptr_ + offset_;
+  offset_ += size;
+
+  return ptr;
+}
+
 void MemBuffer::TransferForZMQ(ZMQBuffer* z_buf) {
   z_buf->Reset(ptr_, capacity_, offset_, MemBuffer::ZMQFree);
 
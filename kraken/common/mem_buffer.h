@@ -36,6 +36,9 @@ private:
   size_t Growth(size_t new_size) const;
 
 public:
+  // Make sure the buffer can hold size more bytes.
+  void Reserve(size_t size);
+
   char* ptr() const;
 
   size_t capacity() const;
@@ -44,6 +47,10 @@ public:
 
   bool Write(const char* bytes, size_t size) override;
 
+  // Increase the offset by size and return the pointer of the new space, the
+  // caller fill it directly. The pointer is invalid after next Write/Extend.
+  char* Extend(size_t size);
+
   void TransferForZMQ(ZMQBuffer* z_buf);
 
 public:
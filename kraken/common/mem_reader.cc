@@ -1,5 +1,6 @@
 #include "common/mem_reader.h"
 
+#include <cstdint>
 #include <cstring>
 
 namespace kraken {
@@ -8,6 +9,11 @@ MemReader::MemReader(const char* ptr, size_t length)
     : ptr_(ptr), length_(length), offset_(0) {
 }
 
+MemReader::MemReader(const char* ptr, size_t length,
+                     std::shared_ptr<void> holder)
+    : ptr_(ptr), length_(length), offset_(0), holder_(std::move(holder)) {
+}
+
 bool MemReader::Read(void* target, size_t size) {
   if (ptr_ == nullptr || offset_ + size > length_) {
     return false;
@@ -19,4 +25,25 @@ bool MemReader::Read(void* target, size_t size) {
   return true;
 }
 
+bool MemReader::IsEnd() {
+  return ptr_ == nullptr || offset_ >= length_;
+}
+
+const char* MemReader::Borrow(size_t size, size_t align,
+                              std::shared_ptr<void>* holder) {
+  if (holder_ == nullptr || ptr_ == nullptr || offset_ + size > length_) {
+    return nullptr;
+  }
+
+  const char* ptr = ptr_ + offset_;
+  if (align > 1 && ((uintptr_t)ptr) % align != 0) {
+    return nullptr;
+  }
+
+  offset_ += size;
+  *holder = holder_;
+
+  return ptr;
+}
+
 }  // namespace kraken
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdlib>
+#include <memory>
 
 #include "common/ireader.h"
 
@@ -12,10 +13,20 @@ private:
   size_t length_;
   size_t offset_;
 
+  // The owner of the memory, the memory can be borrowed only if it is set.
+  std::shared_ptr<void> holder_;
+
 public:
   MemReader(const char* ptr, size_t length);
 
+  MemReader(const char* ptr, size_t length, std::shared_ptr<void> holder);
+
   bool Read(void* target, size_t size) override;
+
+  bool IsEnd() override;
+
+  const char* Borrow(size_t size, size_t align,
+                     std::shared_ptr<void>* holder) override;
 };
 
 }  // namespace kraken
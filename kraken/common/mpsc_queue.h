@@ -0,0 +1,120 @@
+#pragma once
+
+#include <atomic>
+#include <cinttypes>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+
+namespace kraken {
+
+/**
+ * \brief A bounded lock-free queue, many producers and one consumer.
+ *
+ * It is a ring of cells, every cell has a sequence number tell whether it can
+ * be written or read at the position. A producer claim a position by CAS the
+ * tail, the consumer is the only one move the head so it needs no CAS.
+ * ref: https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+ */
+template <typename T>
+class MPSCQueue {
+private:
+  struct Cell {
+    std::atomic<size_t> seq;
+    T val;
+  };
+
+  // Avoid the head and tail in one cache line.
+  constexpr static size_t kCacheLineSize = 64;
+
+  std::unique_ptr<Cell[]> cells_;
+  size_t mask_;
+
+  alignas(kCacheLineSize) std::atomic<size_t> tail_;
+
+  alignas(kCacheLineSize) size_t head_;
+
+public:
+  // The capacity is round up to power of 2.
+  explicit MPSCQueue(size_t capacity) : tail_(0), head_(0) {
+    size_t size = 2;
+    while (size < capacity) {
+      size <<= 1;
+    }
+
+    cells_.reset(new Cell[size]);
+    mask_ = size - 1;
+
+    for (size_t i = 0; i < size; ++i) {
+      cells_[i].seq.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  MPSCQueue(const MPSCQueue&) = delete;
+  MPSCQueue(MPSCQueue&&) = delete;
+
+  MPSCQueue& operator=(const MPSCQueue&) = delete;
+  MPSCQueue& operator=(MPSCQueue&&) = delete;
+
+  ~MPSCQueue() = default;
+
+public:
+  size_t capacity() const {
+    return mask_ + 1;
+  }
+
+  // Return false if the queue is full, v is not moved.
+  bool TryPush(T&& v) {
+    size_t pos = tail_.load(std::memory_order_relaxed);
+
+    for (;;) {
+      Cell& cell = cells_[pos & mask_];
+      size_t seq = cell.seq.load(std::memory_order_acquire);
+      intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+
+      if (diff == 0) {
+        if (tail_.compare_exchange_weak(pos, pos + 1,
+                                        std::memory_order_relaxed)) {
+          cell.val = std::move(v);
+          cell.seq.store(pos + 1, std::memory_order_release);
+
+          return true;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = tail_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // Wait until the consumer make room.
+  void Push(T&& v) {
+    while (TryPush(std::move(v)) == false) {
+      std::this_thread::yield();
+    }
+  }
+
+  // Only the consumer thread can call it. Return false if the queue is empty
+  // or the next cell is claimed but not written yet.
+  // A consumer that sleep on a "notified" flag must clear it by an RMW
+  // (exchange) before TryPop, a plain store is not ordered with the acquire
+  // load here and the producer's notify can be missed.
+  bool TryPop(T* v) {
+    Cell& cell = cells_[head_ & mask_];
+    size_t seq = cell.seq.load(std::memory_order_acquire);
+
+    if ((intptr_t)seq - (intptr_t)(head_ + 1) < 0) {
+      return false;
+    }
+
+    *v = std::move(cell.val);
+    cell.seq.store(head_ + mask_ + 1, std::memory_order_release);
+
+    head_++;
+
+    return true;
+  }
+};
+
+}  // namespace kraken
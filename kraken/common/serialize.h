@@ -33,6 +33,12 @@ public:
     return buf_->Write((const char*)ptr, size);
   }
 
+  // The memory is owned by holder, maybe referenced not copied.
+  bool WriteRef(const void* ptr, size_t size,
+                const std::shared_ptr<void>& holder) {
+    return buf_->WriteRef((const char*)ptr, size, holder);
+  }
+
   template <typename T>
   bool operator<<(const T& v) {
     return false;
@@ -172,8 +178,8 @@ inline bool Serialize::operator<<(const Tensor& v) {
       return false;
     }
 
-    // Storage.
-    return Write(v.Ptr(), v.NumBytes());
+    // Storage, the impl keep it alive if it is referenced.
+    return WriteRef(v.Ptr(), v.NumBytes(), v.impl());
   } else if (v.layout() == Layout::kCoo) {
     auto coo_impl = std::dynamic_pointer_cast<CooTensorImpl>(v.impl());
 
@@ -343,8 +349,25 @@ inline bool Serialize::operator<<(
 
 template <>
 inline bool Serialize::operator<<(const ModelMetaData& v) {
-  return ((*this) << v.name) && ((*this) << v.optim_type) &&
-         ((*this) << v.optim_conf) && ((*this) << v.table_mdatas);
+  if (((*this) << v.name) == false || ((*this) << v.optim_type) == false ||
+      ((*this) << v.optim_conf) == false ||
+      ((*this) << v.table_mdatas) == false) {
+    return false;
+  }
+
+  // The table_conf is appended at the end, so the old reader can ignore it.
+  uint64_t size = v.table_mdatas.size();
+  if (((*this) << size) == false) {
+    return false;
+  }
+
+  for (const auto& [key, val] : v.table_mdatas) {
+    if (((*this) << key) == false || ((*this) << val.table_conf) == false) {
+      return false;
+    }
+  }
+
+  return true;
 }
 
 template <>
@@ -413,7 +436,7 @@ inline bool Serialize::operator<<(
 
 template <>
 inline bool Serialize::operator<<(
-    const std::unordered_map<uint64_t, std::vector<Tensor>>& v) {
+    const std::unordered_map<uint64_t, Tensor>& v) {
   uint64_t size = v.size();
   if (((*this) << size) == false) {
     return false;
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+
+#include "common/iwriter.h"
+
+namespace kraken {
+
+/**
+ * \brief A writer only count the bytes.
+ *
+ * Serialize into it firstly to know how many bytes the real writer need, so the
+ * real one can be allocated once.
+ */
+class SizeWriter : public IWriter {
+private:
+  // A referenced write not smaller than it will be referenced by a
+  // scatter-gather writer.
+  size_t min_ref_bytes_;
+
+  // All bytes.
+  size_t size_;
+
+  // The bytes will be copied.
+  size_t copy_size_;
+
+public:
+  explicit SizeWriter(size_t min_ref_bytes = SIZE_MAX)
+      : min_ref_bytes_(min_ref_bytes), size_(0), copy_size_(0) {
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+  size_t copy_size() const {
+    return copy_size_;
+  }
+
+  bool Write(const char* ptr, size_t size) override {
+    size_ += size;
+    copy_size_ += size;
+
+    return true;
+  }
+
+  bool WriteRef(const char* ptr, size_t size,
+                const std::shared_ptr<void>& holder) override {
+    size_ += size;
+
+    if (size < min_ref_bytes_ || holder == nullptr) {
+      copy_size_ += size;
+    }
+
+    return true;
+  }
+};
+
+}  // namespace kraken
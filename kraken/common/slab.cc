@@ -0,0 +1,80 @@
+#include "common/slab.h"
+
+#include <algorithm>
+
+namespace kraken {
+
+Slab::Slab(size_t stride)
+    : stride_(std::max(stride, sizeof(char*))),
+      chunk_rows_(std::max<size_t>(1, kChunkBytes / stride_)),
+      last_chunk_offset_(0),
+      free_list_(nullptr),
+      size_(0) {
+}
+
+Slab::Slab(Slab&& other)
+    : stride_(other.stride_),
+      chunk_rows_(other.chunk_rows_),
+      chunks_(std::move(other.chunks_)),
+      last_chunk_offset_(other.last_chunk_offset_),
+      free_list_(other.free_list_),
+      size_(other.size_) {
+  other.chunks_.clear();
+  other.last_chunk_offset_ = 0;
+  other.free_list_ = nullptr;
+  other.size_ = 0;
+}
+
+Slab::~Slab() {
+  Clear();
+}
+
+size_t Slab::stride() const {
+  return stride_;
+}
+
+size_t Slab::size() const {
+  return size_;
+}
+
+size_t Slab::capacity() const {
+  return chunks_.size() * chunk_rows_ * stride_;
+}
+
+char* Slab::Allocate() {
+  size_++;
+
+  if (free_list_ != nullptr) {
+    char* row = free_list_;
+    free_list_ = *((char**)row);
+
+    return row;
+  }
+
+  if (chunks_.empty() || last_chunk_offset_ >= chunk_rows_) {
+    chunks_.emplace_back((char*)malloc(chunk_rows_ * stride_));
+    last_chunk_offset_ = 0;
+  }
+
+  return chunks_.back() + (last_chunk_offset_++) * stride_;
+}
+
+void Slab::Free(char* row) {
+  *((char**)row) = free_list_;
+  free_list_ = row;
+
+  size_--;
+}
+
+void Slab::Clear() {
+  for (auto chunk : chunks_) {
+    free(chunk);
+  }
+
+  chunks_.clear();
+  last_chunk_offset_ = 0;
+  free_list_ = nullptr;
+  size_ = 0;
+}
+
+}  // namespace kraken
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdlib>
+#include <vector>
+
+namespace kraken {
+
+/**
+ * \brief A fixed-stride row allocator not thread-safe.
+ *
+ * Slab malloc memory by big chunk and cut it into rows, the freed row will be
+ * reused. The row's address will not change until it be freed.
+ */
+class Slab {
+private:
+  // Every chunk about 1MB.
+  constexpr static size_t kChunkBytes = 1 << 20;
+
+  size_t stride_;
+  size_t chunk_rows_;
+
+  std::vector<char*> chunks_;
+
+  // How many row has been cut from the last chunk.
+  size_t last_chunk_offset_;
+
+  // The freed rows, the first 8 bytes of a freed row store the next one.
+  char* free_list_;
+
+  size_t size_;
+
+public:
+  explicit Slab(size_t stride);
+
+  Slab(Slab&&);
+
+  Slab(const Slab&) = delete;
+  Slab& operator=(const Slab&) = delete;
+  Slab& operator=(Slab&&) = delete;
+
+  ~Slab();
+
+public:
+  size_t stride() const;
+
+  // Allocated row count.
+  size_t size() const;
+
+  // The memory hold by this slab.
+  size_t capacity() const;
+
+  char* Allocate();
+
+  void Free(char* row);
+
+  // Free all rows and release the memory.
+  void Clear();
+};
+
+}  // namespace kraken
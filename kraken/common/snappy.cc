@@ -7,31 +7,70 @@
 namespace kraken {
 
 SnappySource::SnappySource(const char* ptr, size_t length)
-    : ::snappy::Source(), ptr_(ptr), offset_(0), length_(length) {
+    : SnappySource(std::vector<IOVec>{{ptr, length}}) {
+}
+
+SnappySource::SnappySource(std::vector<IOVec> iovs)
+    : ::snappy::Source(),
+      iovs_(std::move(iovs)),
+      idx_(0),
+      offset_(0),
+      available_(0) {
+  for (const auto& iov : iovs_) {
+    available_ += iov.size;
+  }
 }
 
 SnappySource::~SnappySource() {
-  ptr_ = nullptr;
+  idx_ = 0;
   offset_ = 0;
-  length_ = 0;
+  available_ = 0;
 }
 
 size_t SnappySource::Available() const {
-  return (length_ - offset_);
+  return available_;
 }
 
 const char* SnappySource::Peek(size_t* len) {
-  *len = (length_ - offset_);
-  return ptr_ + offset_;
+  // Skip the empty segments.
+  while (idx_ < iovs_.size() && offset_ >= iovs_[idx_].size) {
+    idx_++;
+    offset_ = 0;
+  }
+
+  if (idx_ >= iovs_.size()) {
+    *len = 0;
+    return nullptr;
+  }
+
+  *len = iovs_[idx_].size - offset_;
+  return iovs_[idx_].ptr + offset_;
 }
 
 void SnappySource::Skip(size_t n) {
-  offset_ += n;
+  available_ -= n;
+
+  while (n > 0) {
+    size_t left = iovs_[idx_].size - offset_;
+
+    if (n < left) {
+      offset_ += n;
+      break;
+    }
+
+    n -= left;
+    idx_++;
+    offset_ = 0;
+  }
 }
 
 SnappySink::SnappySink() : ptr_(nullptr), capacity_(0), offset_(0) {
 }
 
+SnappySink::SnappySink(size_t expect)
+    : ptr_((char*)SnappySink::Malloc(expect)), capacity_(expect), offset_(0) {
+}
+
 SnappySink::~SnappySink() {
   if (ptr_ != nullptr) {
     SnappySink::Free(ptr_);
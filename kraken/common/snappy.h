@@ -1,5 +1,8 @@
 #pragma once
 
+#include <vector>
+
+#include "common/iovec_buffer.h"
 #include "common/iwriter.h"
 #include "common/zmq_buffer.h"
 #include "snappy-sinksource.h"
@@ -8,13 +11,19 @@ namespace kraken {
 
 class SnappySource : public snappy::Source {
 private:
-  const char* ptr_;
+  // The source maybe scattered in many segments.
+  std::vector<IOVec> iovs_;
+
+  size_t idx_;
   size_t offset_;
-  size_t length_;
+
+  size_t available_;
 
 public:
   SnappySource(const char* ptr, size_t length);
 
+  explicit SnappySource(std::vector<IOVec> iovs);
+
   ~SnappySource() override;
 
 public:
@@ -34,6 +43,9 @@ private:
 public:
   SnappySink();
 
+  // Preallocate expect bytes, like snappy::MaxCompressedLength.
+  explicit SnappySink(size_t expect);
+
   ~SnappySink() override;
 
 private:
@@ -0,0 +1,208 @@
+#include "common/thread_pool.h"
+
+#include <algorithm>
+
+namespace kraken {
+
+namespace {
+
+// The pool and index of current worker thread.
+thread_local ThreadPool* current_pool = nullptr;
+thread_local size_t current_index = 0;
+
+}  // namespace
+
+ThreadPool::ThreadPool(size_t thread_nums)
+    : next_que_(0), pending_(0), stop_(false) {
+  task_ques_.reserve(thread_nums);
+  for (size_t i = 0; i < thread_nums; ++i) {
+    task_ques_.emplace_back(new TaskQueue());
+  }
+
+  for (size_t i = 0; i < thread_nums; ++i) {
+    std::thread t(&ThreadPool::Run, this, i);
+
+    workers_.emplace_back(std::move(t));
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  Stop();
+}
+
+bool ThreadPool::TryPop(size_t index, TASK* task) {
+  TaskQueue& q = *task_ques_[index];
+
+  std::unique_lock<std::mutex> lock(q.mu);
+  if (q.que.empty()) {
+    return false;
+  }
+
+  // LIFO for own queue, the task is hot in cache.
+  *task = std::move(q.que.back());
+  q.que.pop_back();
+
+  return true;
+}
+
+bool ThreadPool::TrySteal(size_t index, TASK* task) {
+  for (size_t i = 1; i < task_ques_.size(); ++i) {
+    TaskQueue& q = *task_ques_[(index + i) % task_ques_.size()];
+
+    std::unique_lock<std::mutex> lock(q.mu, std::try_to_lock);
+    if (lock.owns_lock() == false || q.que.empty()) {
+      continue;
+    }
+
+    // Steal from the front.
+    *task = std::move(q.que.front());
+    q.que.pop_front();
+
+    return true;
+  }
+
+  return false;
+}
+
+void ThreadPool::Run(size_t index) {
+  current_pool = this;
+  current_index = index;
+
+  while (true) {
+    TASK task;
+
+    if (TryPop(index, &task) || TrySteal(index, &task)) {
+      pending_.fetch_sub(1);
+
+      task();
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(mu_);
+    if (stop_ && pending_.load() == 0) {
+      break;
+    }
+
+    cond_.wait(lock, [this]() -> bool {
+      return this->stop_ || this->pending_.load() > 0;
+    });
+  }
+}
+
+size_t ThreadPool::thread_nums() const {
+  return workers_.size();
+}
+
+void ThreadPool::Stop() {
+  {
+    std::unique_lock<std::mutex> lock(mu_);
+    stop_ = true;
+  }
+
+  cond_.notify_all();
+
+  for (auto& t : workers_) {
+    if (t.joinable()) {
+      t.join();
+    }
+  }
+}
+
+void ThreadPool::Enque(TASK&& task) {
+  size_t index;
+  if (current_pool == this) {
+    index = current_index;
+  } else {
+    index = next_que_.fetch_add(1) % task_ques_.size();
+  }
+
+  {
+    TaskQueue& q = *task_ques_[index];
+
+    std::unique_lock<std::mutex> lock(q.mu);
+    q.que.emplace_back(std::move(task));
+  }
+
+  pending_.fetch_add(1);
+
+  // Lock to make sure the worker not miss the notify.
+  { std::unique_lock<std::mutex> lock(mu_); }
+
+  cond_.notify_one();
+}
+
+void ThreadPool::ParallelFor(int64_t n,
+                             const std::function<void(int64_t)>& func) {
+  if (n <= 0) {
+    return;
+  }
+
+  if (n == 1 || workers_.empty()) {
+    for (int64_t i = 0; i < n; ++i) {
+      func(i);
+    }
+
+    return;
+  }
+
+  struct State {
+    int64_t n;
+    const std::function<void(int64_t)>* func;
+
+    std::atomic_int64_t next;
+    std::atomic_int64_t finished;
+
+    std::mutex mu;
+    std::condition_variable cond;
+  };
+
+  // The helper task maybe run after ParallelFor return, so use shared_ptr. At
+  // that time all index has been taken so it will not touch func.
+  auto state = std::make_shared<State>();
+  state->n = n;
+  state->func = &func;
+  state->next = 0;
+  state->finished = 0;
+
+  auto work = [](State* s) {
+    int64_t count = 0;
+
+    while (true) {
+      int64_t i = s->next.fetch_add(1);
+      if (i >= s->n) {
+        break;
+      }
+
+      (*s->func)(i);
+      count++;
+    }
+
+    if (count > 0 && s->finished.fetch_add(count) + count == s->n) {
+      { std::unique_lock<std::mutex> lock(s->mu); }
+
+      s->cond.notify_all();
+    }
+  };
+
+  int64_t helper_nums = std::min<int64_t>(n - 1, workers_.size());
+  for (int64_t i = 0; i < helper_nums; ++i) {
+    Enque([state, work]() { work(state.get()); });
+  }
+
+  // The caller thread work too.
+  work(state.get());
+
+  std::unique_lock<std::mutex> lock(state->mu);
+  state->cond.wait(lock, [&state, n]() -> bool {
+    return state->finished.load() == n;
+  });
+}
+
+ThreadPool* ThreadPool::Shared() {
+  static ThreadPool pool(
+      std::max<size_t>(1, std::thread::hardware_concurrency()));
+
+  return &pool;
+}
+
+}  // namespace kraken
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace kraken {
+
+/**
+ * \brief A work-stealing thread pool.
+ *
+ * Every worker has it's own task queue, a idle worker will steal task from
+ * others. The task enqueued by a worker is put to it's own queue, others are
+ * put round-robin.
+ */
+class ThreadPool {
+private:
+  using TASK = std::function<void()>;
+
+  constexpr static size_t kCacheLineSize = 64;
+
+  struct alignas(kCacheLineSize) TaskQueue {
+    std::mutex mu;
+    std::deque<TASK> que;
+  };
+
+  std::vector<std::unique_ptr<TaskQueue>> task_ques_;
+
+  std::vector<std::thread> workers_;
+
+  // For round-robin.
+  std::atomic_uint64_t next_que_;
+
+  // The task count in all queues.
+  std::atomic_int64_t pending_;
+
+  // Let the idle worker sleep.
+  std::mutex mu_;
+  std::condition_variable cond_;
+  bool stop_;
+
+public:
+  explicit ThreadPool(size_t thread_nums);
+
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+private:
+  bool TryPop(size_t index, TASK* task);
+
+  bool TrySteal(size_t index, TASK* task);
+
+  void Run(size_t index);
+
+public:
+  size_t thread_nums() const;
+
+  void Stop();
+
+  void Enque(TASK&& task);
+
+  // Call func(i) for i in [0, n) and wait all finish. The caller thread will
+  // run func too, so it's safe to call in a worker of this pool.
+  void ParallelFor(int64_t n, const std::function<void(int64_t)>& func);
+
+public:
+  // A process-wide pool, thread count is the core count.
+  static ThreadPool* Shared();
+};
+
+}  // namespace kraken
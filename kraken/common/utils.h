@@ -71,6 +71,38 @@ inline bool ParseConf<float>(
   return true;
 }
 
+template <>
+inline bool ParseConf<int64_t>(
+    const std::unordered_map<std::string, std::string>& conf,
+    const std::string& key, int64_t* v) {
+  auto it = conf.find(key);
+  if (it == conf.end()) {
+    return false;
+  }
+
+  try {
+    *v = std::stoll(it->second);
+  } catch (...) {
+    return false;
+  }
+
+  return true;
+}
+
+template <>
+inline bool ParseConf<std::string>(
+    const std::unordered_map<std::string, std::string>& conf,
+    const std::string& key, std::string* v) {
+  auto it = conf.find(key);
+  if (it == conf.end()) {
+    return false;
+  }
+
+  *v = it->second;
+
+  return true;
+}
+
 template <>
 inline bool ParseConf<bool>(
     const std::unordered_map<std::string, std::string>& conf,
@@ -0,0 +1,99 @@
+#include "common/zmq_message.h"
+
+#include <memory>
+
+#include "common/exception.h"
+
+namespace kraken {
+
+ZMQMessage::ZMQMessage() {
+}
+
+ZMQMessage::~ZMQMessage() {
+  // Not throw in destructor.
+  for (auto& frame : frames_) {
+    zmq_msg_close(&frame);
+  }
+}
+
+void ZMQMessage::FreeHolder(void* /*data*/, void* hint) {
+  delete (std::shared_ptr<void>*)hint;
+}
+
+void ZMQMessage::Recv(void* socket) {
+  int64_t more = 0;
+  size_t more_len = sizeof(more);
+
+  do {
+    frames_.emplace_back();
+    ZMQ_CALL(zmq_msg_init(&frames_.back()));
+    ZMQ_CALL(zmq_msg_recv(&frames_.back(), socket, 0));
+
+    ZMQ_CALL(zmq_getsockopt(socket, ZMQ_RCVMORE, &more, &more_len));
+  } while (more);
+}
+
+size_t ZMQMessage::FrameCount() const {
+  return frames_.size();
+}
+
+const char* ZMQMessage::data(size_t i) {
+  return (const char*)zmq_msg_data(&frames_[i]);
+}
+
+size_t ZMQMessage::size(size_t i) {
+  return zmq_msg_size(&frames_[i]);
+}
+
+std::vector<IOVec> ZMQMessage::Body(size_t offset) {
+  std::vector<IOVec> iovs;
+  iovs.reserve(frames_.size());
+
+  for (size_t i = 0; i < frames_.size(); ++i) {
+    size_t size = this->size(i);
+
+    if (offset >= size) {
+      offset -= size;
+      continue;
+    }
+
+    IOVec iov;
+    iov.ptr = data(i) + offset;
+    iov.size = size - offset;
+
+    iovs.emplace_back(iov);
+
+    offset = 0;
+  }
+
+  return iovs;
+}
+
+void ZMQMessage::Send(void* socket, IOVecBuffer* buf, int flags) {
+  auto segments = buf->Segments();
+
+  if (segments.empty()) {
+    zmq_msg_t msg;
+    ZMQ_CALL(zmq_msg_init(&msg));
+    ZMQ_CALL(zmq_msg_send(&msg, socket, flags));
+
+    return;
+  }
+
+  for (size_t i = 0; i < segments.size(); ++i) {
+    // The frame keep a reference of the holder until ZMQ free it.
+    auto hint = new std::shared_ptr<void>(std::move(segments[i].holder));
+
+    zmq_msg_t msg;
+    ZMQ_CALL(zmq_msg_init_data(&msg, (void*)segments[i].ptr, segments[i].size,
+                               ZMQMessage::FreeHolder, hint));
+
+    // http://api.zeromq.org/4-1:zmq-msg-send
+    // Not need to close the msg after a successful zmq_msg_send.
+    ZMQ_CALL(zmq_msg_send(&msg, socket,
+                          i + 1 < segments.size() ? (ZMQ_SNDMORE | flags)
+                                                  : flags));
+  }
+}
+
+}  // namespace kraken
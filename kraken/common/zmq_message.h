@@ -0,0 +1,53 @@
+#pragma once
+
+#include <zmq.h>
+
+#include <cstdlib>
+#include <deque>
+#include <vector>
+
+#include "common/iovec_buffer.h"
+
+namespace kraken {
+
+/**
+ * \brief Own a received ZMQ message, maybe multipart.
+ *
+ * Hold it by a shared_ptr, so the Tensors deserialized from the message can
+ * alias the message's memory and keep it alive.
+ */
+class ZMQMessage {
+private:
+  // zmq_msg_t can not be moved, so not use vector.
+  std::deque<zmq_msg_t> frames_;
+
+public:
+  ZMQMessage();
+
+  ZMQMessage(const ZMQMessage&) = delete;
+  ZMQMessage& operator=(const ZMQMessage&) = delete;
+
+  ~ZMQMessage();
+
+private:
+  static void FreeHolder(void* data, void* hint);
+
+public:
+  // Receive all frames of a message.
+  void Recv(void* socket);
+
+  size_t FrameCount() const;
+
+  const char* data(size_t i = 0);
+
+  size_t size(size_t i = 0);
+
+  // The bytes of all frames but skip the first offset bytes.
+  std::vector<IOVec> Body(size_t offset);
+
+  // Send buf's segments as a multipart message without copy, the last frame
+  // is sent with flags.
+  static void Send(void* socket, IOVecBuffer* buf, int flags = 0);
+};
+
+}  // namespace kraken
@@ -0,0 +1,248 @@
+#include <gflags/gflags.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "common/compress.h"
+#include "common/compress_policy.h"
+#include "common/iovec_buffer.h"
+#include "common/log.h"
+#include "common/mem_buffer.h"
+#include "common/serialize.h"
+#include "common/utils.h"
+#include "protocol/pull_sparse_table_prot.h"
+#include "protocol/push_dense_table_prot.h"
+#include "protocol/push_sparse_table_prot.h"
+#include "ps/initializer/initializer.h"
+#include "ps/optim/optim.h"
+#include "ps/sparse_table.h"
+
+// Measure the ratio and throughput of every codec on the embedding payloads,
+// the rows are trained some rounds before so they are not the initial values.
+// like: ./compress_benchmark --dimension=32 --batch_size=4096
+DEFINE_uint32(batch_size, 1024, "Sparse id count per message.");
+DEFINE_uint64(id_range, 100000, "The sparse id is in [0, id_range).");
+DEFINE_int64(dimension, 16, "The SparseTable dimension.");
+DEFINE_uint32(train_rounds, 100, "The push rounds before measure.");
+DEFINE_uint32(rounds, 200, "Compress/uncompress rounds of every case.");
+DEFINE_int32(level, 0, "The codec level, 0 means the default.");
+
+namespace {
+
+using namespace kraken;
+
+struct Payload {
+  std::string name;
+
+  // The payload is in buf from offset.
+  IOVecBuffer buf;
+  size_t offset;
+};
+
+std::vector<uint64_t> RandomIds() {
+  std::vector<uint64_t> sparse_ids;
+  sparse_ids.reserve(FLAGS_batch_size);
+
+  for (uint32_t i = 0; i < FLAGS_batch_size; ++i) {
+    sparse_ids.emplace_back(
+        utils::ThreadLocalRandom<uint64_t>(0, FLAGS_id_range));
+  }
+
+  return sparse_ids;
+}
+
+std::vector<Tensor> RandomGrads() {
+  std::vector<Tensor> grads;
+  grads.reserve(FLAGS_batch_size);
+
+  for (uint32_t i = 0; i < FLAGS_batch_size; ++i) {
+    grads.emplace_back(
+        Tensor::Dense({FLAGS_dimension}, ElementType::From<float>())
+            .Normal(0, 0.01));
+  }
+
+  return grads;
+}
+
+Payload MemPayload(const std::string& name, MemBuffer* mem) {
+  ZMQBuffer z_buf;
+  mem->TransferForZMQ(&z_buf);
+
+  Payload payload;
+  payload.name = name;
+  payload.buf.Append(&z_buf);
+  payload.offset = 0;
+
+  return payload;
+}
+
+template <typename Type>
+Payload SeriaPayload(const std::string& name, const Type& v) {
+  RequestHeader header;
+  header.timestamp = 0;
+  header.type = 0;
+  header.compress_type = CompressType::kNo;
+
+  Payload payload;
+  payload.name = name;
+  payload.offset = sizeof(header);
+
+  ARGUMENT_CHECK(Compress::NoCompressSeria(header, v, &payload.buf),
+                 "Serialize payload error!");
+
+  return payload;
+}
+
+const char* CodecName(CompressType type) {
+  switch (type) {
+    case CompressType::kSnappy:
+      return "snappy";
+    case CompressType::kLZ4:
+      return "lz4";
+    case CompressType::kZSTD:
+      return "zstd";
+    default:
+      return "no";
+  }
+}
+
+void Measure(Payload* payload, const CompressPolicy& policy) {
+  std::vector<IOVec> body = payload->buf.IOVecs(payload->offset);
+
+  size_t raw_size = 0;
+  for (const auto& iov : body) {
+    raw_size += iov.size;
+  }
+
+  double compress_cost = 0;
+  double uncompress_cost = 0;
+  size_t compressed_size = 0;
+
+  for (uint32_t r = 0; r < FLAGS_rounds; ++r) {
+    MemBuffer compressed;
+
+    auto start = std::chrono::steady_clock::now();
+    ARGUMENT_CHECK(Compress::CompressBody(policy, body, &compressed),
+                   "Compress error!");
+    auto middle = std::chrono::steady_clock::now();
+
+    std::shared_ptr<MemBuffer> raw;
+    ARGUMENT_CHECK(Compress::UnCompressBody(
+                       policy.type, {{compressed.ptr(), compressed.offset()}},
+                       &raw),
+                   "UnCompress error!");
+    auto end = std::chrono::steady_clock::now();
+
+    ARGUMENT_CHECK(raw->offset() == raw_size, "UnCompress size error!");
+
+    compress_cost += std::chrono::duration<double>(middle - start).count();
+    uncompress_cost += std::chrono::duration<double>(end - middle).count();
+    compressed_size = compressed.offset();
+  }
+
+  double mb = (double)raw_size * FLAGS_rounds / (1024.0 * 1024.0);
+
+  LOG_INFO("payload:[" << payload->name << "], codec:["
+                       << CodecName(policy.type) << "], shuffle:["
+                       << (int32_t)policy.shuffle << "], bytes:[" << raw_size
+                       << "], ratio:[" << (double)raw_size / compressed_size
+                       << "], compress MB/s:[" << mb / compress_cost
+                       << "], uncompress MB/s:[" << mb / uncompress_cost
+                       << "]");
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  gflags::SetUsageMessage("Usage: [Options]");
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  std::unique_ptr<Optim> optim = Optim::Create(OptimType::kAdagrad, {});
+  std::unique_ptr<Initializer> initializer =
+      Initializer::Create(InitializerType::kNormal, {});
+
+  SparseTable table(0, "benchmark", FLAGS_dimension, ElementType::From<float>(),
+                    std::move(initializer), {}, optim.get());
+
+  // Create all rows at first, then train them some rounds.
+  {
+    std::vector<uint64_t> sparse_ids;
+    for (uint64_t i = 0; i < FLAGS_id_range; ++i) {
+      sparse_ids.emplace_back(i);
+    }
+
+    std::vector<Tensor> vals;
+    table.Pull(sparse_ids, &vals);
+  }
+
+  for (uint32_t r = 0; r < FLAGS_train_rounds; ++r) {
+    ARGUMENT_CHECK(table.Push(optim.get(), RandomIds(), RandomGrads(), 0.01) ==
+                       ErrorCode::kSuccess,
+                   "Push error!");
+  }
+
+  std::vector<Payload> payloads;
+
+  {
+    MemBuffer mem;
+    ARGUMENT_CHECK(table.Pull(RandomIds(), &mem) == ErrorCode::kSuccess,
+                   "Pull error!");
+
+    payloads.emplace_back(MemPayload("pull_sparse", &mem));
+  }
+
+  {
+    MemBuffer mem;
+    ARGUMENT_CHECK(table.PullMatrix(RandomIds(), &mem) == ErrorCode::kSuccess,
+                   "PullMatrix error!");
+
+    payloads.emplace_back(MemPayload("pull_matrix", &mem));
+  }
+
+  {
+    PushSparseTableRequest req;
+    req.router_version = 0;
+    req.table_id = 0;
+    req.sparse_ids = RandomIds();
+    req.grads = RandomGrads();
+    req.lr = 0.01;
+
+    payloads.emplace_back(SeriaPayload("push_sparse", req));
+  }
+
+  {
+    PushDenseTableRequest req;
+    req.router_version = 0;
+    req.table_id = 0;
+    req.grad = Tensor::Dense({(int64_t)FLAGS_batch_size, FLAGS_dimension},
+                             ElementType::From<float>())
+                   .Normal(0, 0.01);
+    req.lr = 0.01;
+
+    payloads.emplace_back(SeriaPayload("push_dense", req));
+  }
+
+  {
+    PullSparseTableRequest req;
+    req.router_version = 0;
+    req.table_id = 0;
+    req.sparse_ids = RandomIds();
+
+    payloads.emplace_back(SeriaPayload("sparse_ids", req));
+  }
+
+  std::vector<CompressType> types = {CompressType::kSnappy, CompressType::kLZ4,
+                                     CompressType::kZSTD};
+
+  for (auto& payload : payloads) {
+    for (auto type : types) {
+      for (uint8_t shuffle : {0, 4, 8}) {
+        Measure(&payload, CompressPolicy(type, 0, shuffle, FLAGS_level));
+      }
+    }
+  }
+
+  return 0;
+}
@@ -8,6 +8,7 @@ DEFINE_string(addr, "", "Local addr include port.");
 DEFINE_string(s_addr, "", "Scheduler addr include port.");
 DEFINE_string(saved_dir, "", "Model save dir.");
 DEFINE_uint32(max_save_count, 3, "Max saved model count.");
+DEFINE_bool(direct_station, false, "Station send replies without inproc proxy.");
 
 int main(int argc, char* argv[]) {
   gflags::SetUsageMessage("Usage: [Options]");
@@ -15,7 +16,7 @@ int main(int argc, char* argv[]) {
 
   kraken::PsServer ps_server(FLAGS_port, FLAGS_thread_nums, FLAGS_addr,
                              FLAGS_s_addr, FLAGS_saved_dir,
-                             FLAGS_max_save_count);
+                             FLAGS_max_save_count, FLAGS_direct_station);
   ps_server.Start();
 
   return 0;
@@ -0,0 +1,150 @@
+#include <gflags/gflags.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "common/log.h"
+#include "common/utils.h"
+#include "protocol/pull_sparse_table_prot.h"
+#include "protocol/rpc_func_type.h"
+#include "ps/initializer/initializer.h"
+#include "ps/optim/optim.h"
+#include "ps/sparse_table.h"
+#include "ps/storage/row_cache.h"
+#include "rpc/pool_connecter.h"
+#include "rpc/station.h"
+
+// Measure the SparseTable pull QPS through Station, run it with different
+// thread_nums to see how the pull scale with the Station thread count.
+// like: ./pull_benchmark --thread_nums=8 --client_nums=16 --socket_nums=4
+DEFINE_uint32(port, 50010, "The benchmark Station port, default is:50010.");
+DEFINE_uint32(thread_nums, 4, "The Station thread_nums, default is:4.");
+DEFINE_uint32(client_nums, 8, "The client thread count, default is:8.");
+DEFINE_uint32(socket_nums, 1, "The sockets/IO threads of the connecter.");
+DEFINE_uint32(batch_size, 1024, "Sparse id count per request.");
+DEFINE_uint64(id_range, 100000, "The sparse id is in [0, id_range).");
+DEFINE_int64(dimension, 16, "The SparseTable dimension.");
+DEFINE_string(storage_type, "hash_map", "The SparseTable storage type.");
+DEFINE_int64(cache_size, 0, "The SparseTable hot row cache size, 0 disable.");
+DEFINE_bool(raw_pull, true, "Serialize the vals into the reply directly.");
+DEFINE_uint32(seconds, 10, "The benchmark duration in seconds.");
+
+int main(int argc, char* argv[]) {
+  using namespace kraken;
+
+  gflags::SetUsageMessage("Usage: [Options]");
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  std::unique_ptr<Optim> optim = Optim::Create(OptimType::kAdagrad, {});
+  std::unique_ptr<Initializer> initializer =
+      Initializer::Create(InitializerType::kNormal, {});
+
+  SparseTable table(0, "benchmark", FLAGS_dimension, ElementType::From<float>(),
+                    std::move(initializer),
+                    {{"storage_type", FLAGS_storage_type},
+                     {"cache_size", std::to_string(FLAGS_cache_size)}},
+                    optim.get());
+
+  // Create all rows at first, so the benchmark only measure the read path.
+  {
+    std::vector<uint64_t> sparse_ids;
+    for (uint64_t i = 0; i < FLAGS_id_range; ++i) {
+      sparse_ids.emplace_back(i);
+    }
+
+    std::vector<Tensor> vals;
+    table.Pull(sparse_ids, &vals);
+  }
+
+  Station station(FLAGS_port, FLAGS_thread_nums);
+  if (FLAGS_raw_pull) {
+    station.RegisterRawFunc<PullSparseTableRequest>(
+        RPCFuncType::kPullSparseTableType,
+        [&table](const PullSparseTableRequest& req, MemBuffer* buf) -> int32_t {
+          return table.Pull(req.sparse_ids, buf);
+        });
+  } else {
+    station.RegisterFunc<PullSparseTableRequest, PullSparseTableResponse>(
+        RPCFuncType::kPullSparseTableType,
+        [&table](const PullSparseTableRequest& req,
+                 PullSparseTableResponse* rsp) -> int32_t {
+          return table.Pull(req.sparse_ids, &rsp->vals);
+        });
+  }
+
+  station.Start();
+
+  std::atomic_bool stop(false);
+  std::atomic_uint64_t req_count(0);
+  std::atomic_uint64_t error_count(0);
+
+  std::string addr = "127.0.0.1:" + std::to_string(FLAGS_port);
+
+  // All clients share one connecter like the training threads in a worker.
+  PoolConnecter connecter(addr, CompressType::kNo, FLAGS_socket_nums);
+  connecter.Start();
+
+  std::vector<std::thread> clients;
+  for (uint32_t c = 0; c < FLAGS_client_nums; ++c) {
+    clients.emplace_back([&]() {
+      PullSparseTableRequest req;
+      req.router_version = 0;
+      req.table_id = 0;
+      req.sparse_ids.resize(FLAGS_batch_size);
+
+      while (stop.load() == false) {
+        for (auto& id : req.sparse_ids) {
+          id = utils::ThreadLocalRandom<uint64_t>(0, FLAGS_id_range);
+        }
+
+        PullSparseTableResponse rsp;
+        int32_t error_code =
+            connecter.Call(RPCFuncType::kPullSparseTableType, req, &rsp);
+
+        if (error_code == ErrorCode::kSuccess) {
+          req_count.fetch_add(1);
+        } else {
+          error_count.fetch_add(1);
+        }
+      }
+    });
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  std::this_thread::sleep_for(std::chrono::seconds(FLAGS_seconds));
+  stop.store(true);
+
+  for (auto& t : clients) {
+    t.join();
+  }
+
+  connecter.Stop();
+
+  double cost =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+          .count();
+
+  LOG_INFO("Station thread_nums:["
+           << FLAGS_thread_nums << "], client_nums:[" << FLAGS_client_nums
+           << "], socket_nums:[" << FLAGS_socket_nums
+           << "], batch_size:[" << FLAGS_batch_size << "], raw_pull:["
+           << FLAGS_raw_pull << "], QPS:["
+           << req_count.load() / cost << "], sparse ids/s:["
+           << req_count.load() * FLAGS_batch_size / cost << "], errors:["
+           << error_count.load() << "]");
+
+  RowCache* cache = table.mutable_vals()->cache();
+  if (cache != nullptr) {
+    double hit = cache->hit_count();
+    double total = hit + cache->miss_count();
+
+    LOG_INFO("Cache capacity:[" << cache->capacity() << "], hit rate:["
+                                << (total > 0 ? hit / total : 0) << "]");
+  }
+
+  // Station can not be stopped gracefully, exit directly.
+  std::exit(0);
+}
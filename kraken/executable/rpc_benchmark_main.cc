@@ -0,0 +1,146 @@
+#include <gflags/gflags.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "common/log.h"
+#include "common/thread_barrier.h"
+#include "protocol/heartbeat_prot.h"
+#include "protocol/rpc_func_type.h"
+#include "rpc/combine_connecter.h"
+#include "rpc/indep_connecter.h"
+#include "rpc/station.h"
+
+// Measure the small RPC QPS, every client thread send window_size Heartbeat
+// by CallAsync then wait all replies. It mostly measure the per message cost
+// of the connecter and the Station.
+// like: ./rpc_benchmark --client_nums=8 --window_size=64 --direct=true
+DEFINE_uint32(port, 50020, "The benchmark Station port, default is:50020.");
+DEFINE_uint32(thread_nums, 4, "The Station thread_nums, default is:4.");
+DEFINE_uint32(client_nums, 8, "The client thread count, default is:8.");
+DEFINE_uint32(window_size, 64, "The in-flight calls of every client.");
+DEFINE_bool(combine, false, "Use CombineConnecter instead of IndepConnecter.");
+DEFINE_bool(direct, false, "Station send replies without inproc proxy.");
+DEFINE_uint64(max_in_flight, 0, "IndepConnecter in-flight window, 0 no limit.");
+DEFINE_uint64(max_pending, 0, "IndepConnecter max pending, 0 no limit.");
+DEFINE_bool(fail_fast, false, "Fail the call instead of block if too many.");
+DEFINE_uint32(seconds, 10, "The benchmark duration in seconds.");
+
+int main(int argc, char* argv[]) {
+  using namespace kraken;
+
+  gflags::SetUsageMessage("Usage: [Options]");
+  gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+  Station station(FLAGS_port, FLAGS_thread_nums, FLAGS_direct);
+  station.RegisterFunc<HeartbeatRequest, HeartbeatResponse>(
+      RPCFuncType::kHeartbeatType,
+      [](const HeartbeatRequest& req, HeartbeatResponse* rsp) -> int32_t {
+        rsp->status = 0;
+        return ErrorCode::kSuccess;
+      });
+
+  station.Start();
+
+  std::string addr = "127.0.0.1:" + std::to_string(FLAGS_port);
+
+  std::unique_ptr<IndepConnecter> indep;
+  std::unique_ptr<CombineConnecter> combine;
+
+  if (FLAGS_combine) {
+    combine.reset(new CombineConnecter(CompressType::kNo));
+    combine->Start();
+    combine->AddConnect(0, addr);
+  } else {
+    FlowControl flow_control(
+        FLAGS_max_in_flight, FLAGS_max_pending,
+        FLAGS_fail_fast ? FlowControlMode::kFailFast : FlowControlMode::kBlock);
+
+    indep.reset(new IndepConnecter(addr, CompressType::kNo, flow_control));
+    indep->Start();
+  }
+
+  std::atomic_bool stop(false);
+  std::atomic_uint64_t req_count(0);
+  std::atomic_uint64_t error_count(0);
+
+  std::vector<std::thread> clients;
+  for (uint32_t c = 0; c < FLAGS_client_nums; ++c) {
+    clients.emplace_back([&]() {
+      HeartbeatRequest req;
+
+      while (stop.load() == false) {
+        ThreadBarrier barrier(FLAGS_window_size);
+
+        auto callback = [&](int32_t error_code, HeartbeatResponse& rsp) {
+          if (error_code == ErrorCode::kSuccess) {
+            req_count.fetch_add(1);
+          } else {
+            error_count.fetch_add(1);
+          }
+
+          barrier.Release();
+        };
+
+        for (uint32_t i = 0; i < FLAGS_window_size; ++i) {
+          if (FLAGS_combine) {
+            combine->CallAsync<HeartbeatRequest, HeartbeatResponse>(
+                RPCFuncType::kHeartbeatType, 0, req, callback);
+          } else {
+            indep->CallAsync<HeartbeatRequest, HeartbeatResponse>(
+                RPCFuncType::kHeartbeatType, req, callback);
+          }
+        }
+
+        barrier.Wait();
+      }
+    });
+  }
+
+  // Sample the IndepConnecter queue depth.
+  size_t max_pending = 0;
+  size_t max_in_flight = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  auto end = start + std::chrono::seconds(FLAGS_seconds);
+  while (std::chrono::steady_clock::now() < end) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    if (indep != nullptr) {
+      max_pending = std::max(max_pending, indep->pending());
+      max_in_flight = std::max(max_in_flight, indep->in_flight());
+    }
+  }
+
+  stop.store(true);
+
+  for (auto& t : clients) {
+    t.join();
+  }
+
+  double cost =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+          .count();
+
+  if (FLAGS_combine) {
+    combine->Stop();
+  } else {
+    indep->Stop();
+  }
+
+  LOG_INFO("Station thread_nums:["
+           << FLAGS_thread_nums << "], client_nums:[" << FLAGS_client_nums
+           << "], window_size:[" << FLAGS_window_size << "], combine:["
+           << FLAGS_combine << "], direct:[" << FLAGS_direct << "], QPS:["
+           << req_count.load() / cost
+           << "], errors:[" << error_count.load() << "], max pending:["
+           << max_pending << "], max in_flight:[" << max_in_flight << "]");
+
+  // Station can not be stopped gracefully, exit directly.
+  std::exit(0);
+}
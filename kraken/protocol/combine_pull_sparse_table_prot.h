@@ -28,8 +28,9 @@ inline bool Deserialize::operator>>(CombinePullSparseTableRequest& v) {
 }
 
 struct CombinePullSparseTableResponse {
-  // <TableId, Vals> map.
-  std::unordered_map<uint64_t, std::vector<Tensor>> table_vals;
+  // <TableId, Vals> map, the vals of a table is a [n, dimension] matrix that
+  // the row i is the val of table_sparse_ids[TableId][i].
+  std::unordered_map<uint64_t, Tensor> table_vals;
 };
 
 template <>
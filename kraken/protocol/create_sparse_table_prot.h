@@ -14,20 +14,22 @@ struct CreateSparseTableRequest {
 
   InitializerType init_type;
   std::unordered_map<std::string, std::string> init_conf;
+
+  std::unordered_map<std::string, std::string> table_conf;
 };
 
 template <>
 inline bool Serialize::operator<<(const CreateSparseTableRequest& v) {
   return (*this) << v.table_id && (*this) << v.name && (*this) << v.dimension &&
          (*this) << v.element_type && (*this) << v.init_type &&
-         (*this) << v.init_conf;
+         (*this) << v.init_conf && (*this) << v.table_conf;
 }
 
 template <>
 inline bool Deserialize::operator>>(CreateSparseTableRequest& v) {
   return (*this) >> v.table_id && (*this) >> v.name && (*this) >> v.dimension &&
          (*this) >> v.element_type && (*this) >> v.init_type &&
-         (*this) >> v.init_conf;
+         (*this) >> v.init_conf && (*this) >> v.table_conf;
 }
 
 struct CreateSparseTableResponse {};
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cinttypes>
+#include <vector>
+
+#include "common/deserialize.h"
+#include "common/serialize.h"
+#include "t/tensor.h"
+
+namespace kraken {
+
+struct PullSparseMatrixRequest {
+  uint64_t router_version;
+
+  uint64_t table_id;
+  std::vector<uint64_t> sparse_ids;
+};
+
+template <>
+inline bool Serialize::operator<<(const PullSparseMatrixRequest& v) {
+  return (*this) << v.router_version && (*this) << v.table_id &&
+         (*this) << v.sparse_ids;
+}
+
+template <>
+inline bool Deserialize::operator>>(PullSparseMatrixRequest& v) {
+  return (*this) >> v.router_version && (*this) >> v.table_id &&
+         (*this) >> v.sparse_ids;
+}
+
+struct PullSparseMatrixResponse {
+  // The ReplyHeader is 13 bytes and the matrix header is 26 bytes, pad it to
+  // make the matrix data 8 bytes aligned in the message, so the receiver can
+  // alias it without copy.
+  constexpr static size_t kPadding = 1;
+
+  // [sparse_ids.size(), dimension], the row i is the val of sparse_ids[i].
+  Tensor vals;
+};
+
+template <>
+inline bool Serialize::operator<<(const PullSparseMatrixResponse& v) {
+  uint8_t padding[PullSparseMatrixResponse::kPadding] = {0};
+
+  return Write(padding, sizeof(padding)) && (*this) << v.vals;
+}
+
+template <>
+inline bool Deserialize::operator>>(PullSparseMatrixResponse& v) {
+  uint8_t padding[PullSparseMatrixResponse::kPadding];
+
+  return Read(padding, sizeof(padding)) && (*this) >> v.vals;
+}
+
+}  // namespace kraken
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cinttypes>
+#include <vector>
+
+#include "common/deserialize.h"
+#include "common/serialize.h"
+#include "t/tensor.h"
+
+namespace kraken {
+
+struct PushSparseMatrixRequest {
+  uint64_t router_version;
+  uint64_t table_id;
+
+  std::vector<uint64_t> sparse_ids;
+
+  // [sparse_ids.size(), dimension], the row i is the grad of sparse_ids[i].
+  Tensor grads;
+
+  float lr;
+};
+
+template <>
+inline bool Serialize::operator<<(const PushSparseMatrixRequest& v) {
+  return (*this) << v.router_version && (*this) << v.table_id &&
+         (*this) << v.sparse_ids && (*this) << v.grads && (*this) << v.lr;
+}
+
+template <>
+inline bool Deserialize::operator>>(PushSparseMatrixRequest& v) {
+  return (*this) >> v.router_version && (*this) >> v.table_id &&
+         (*this) >> v.sparse_ids && (*this) >> v.grads && (*this) >> v.lr;
+}
+
+struct PushSparseMatrixResponse {
+  /*empty*/
+};
+
+template <>
+inline bool Serialize::operator<<(const PushSparseMatrixResponse& v) {
+  return true;
+}
+
+template <>
+inline bool Deserialize::operator>>(PushSparseMatrixResponse& v) {
+  return true;
+}
+
+}  // namespace kraken
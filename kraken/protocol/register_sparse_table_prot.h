@@ -18,20 +18,22 @@ struct RegisterSparseTableRequest {
 
   InitializerType init_type;
   std::unordered_map<std::string, std::string> init_conf;
+
+  std::unordered_map<std::string, std::string> table_conf;
 };
 
 template <>
 inline bool Serialize::operator<<(const RegisterSparseTableRequest& v) {
   return (*this) << v.name && (*this) << v.dimension &&
          (*this) << v.element_type && (*this) << v.init_type &&
-         (*this) << v.init_conf;
+         (*this) << v.init_conf && (*this) << v.table_conf;
 }
 
 template <>
 inline bool Deserialize::operator>>(RegisterSparseTableRequest& v) {
   return (*this) >> v.name && (*this) >> v.dimension &&
          (*this) >> v.element_type && (*this) >> v.init_type &&
-         (*this) >> v.init_conf;
+         (*this) >> v.init_conf && (*this) >> v.table_conf;
 }
 
 struct RegisterSparseTableResponse {
@@ -36,6 +36,8 @@ struct RPCFuncType {
   static constexpr uint32_t kNotifySaveModelType = 28;
   static constexpr uint32_t kNotifyLoadModelType = 29;
   static constexpr uint32_t kIsAllPsWorkingType = 30;
+  static constexpr uint32_t kPullSparseMatrixType = 31;
+  static constexpr uint32_t kPushSparseMatrixType = 32;
 };
 
 }  // namespace kraken
@@ -17,6 +17,8 @@ struct TransferSparseMetaDataRequest {
 
   InitializerType init_type;
   std::unordered_map<std::string, std::string> init_conf;
+
+  std::unordered_map<std::string, std::string> table_conf;
 };
 
 template <>
@@ -24,7 +26,7 @@ inline bool Serialize::operator<<(const TransferSparseMetaDataRequest& v) {
   return (*this) << v.from_node_id && (*this) << v.table_id &&
          (*this) << v.name && (*this) << v.dimension &&
          (*this) << v.element_type && (*this) << v.init_type &&
-         (*this) << v.init_conf;
+         (*this) << v.init_conf && (*this) << v.table_conf;
 }
 
 template <>
@@ -32,7 +34,7 @@ inline bool Deserialize::operator>>(TransferSparseMetaDataRequest& v) {
   return (*this) >> v.from_node_id && (*this) >> v.table_id &&
          (*this) >> v.name && (*this) >> v.dimension &&
          (*this) >> v.element_type && (*this) >> v.init_type &&
-         (*this) >> v.init_conf;
+         (*this) >> v.init_conf && (*this) >> v.table_conf;
 }
 
 struct TransferSparseMetaDataResponse {};
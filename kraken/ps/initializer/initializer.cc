@@ -8,22 +8,48 @@
 
 namespace kraken {
 
-Initializer::Initializer(InitializerType type) : type_(type) {
+Initializer::Initializer(InitializerType type, int64_t seed)
+    : type_(type), seed_(seed) {
+}
+
+uint64_t Initializer::RowKey(uint64_t table_id) const {
+  return utils::Hash((uint64_t)seed_, table_id);
 }
 
 InitializerType Initializer::type() const {
   return type_;
 }
 
+int64_t Initializer::seed() const {
+  return seed_;
+}
+
 std::unordered_map<std::string, std::string> Initializer::conf() const {
   return {};
 }
 
+void Initializer::InitializeRows(uint64_t table_id,
+                                 const std::vector<uint64_t>& sparse_ids,
+                                 int64_t dimension, ElementType element_type,
+                                 const std::vector<char*>& rows) const {
+  size_t vec_bytes = dimension * element_type.ByteWidth();
+
+  for (auto row : rows) {
+    Tensor val = Tensor::Dense(Shape({dimension}),
+                               Storage::From(row, vec_bytes), 0, element_type);
+
+    Initialize(&val);
+  }
+}
+
 std::unique_ptr<Initializer> Initializer::Create(
     InitializerType init_type,
     const std::unordered_map<std::string, std::string>& init_conf) {
   std::unique_ptr<Initializer> initializer;
 
+  int64_t seed = 0;
+  utils::ParseConf<int64_t>(init_conf, "seed", &seed);
+
   if (init_type == InitializerType::kConstant) {
     float value = 0;
     utils::ParseConf<float>(init_conf, "value", &value);
@@ -36,7 +62,7 @@ std::unique_ptr<Initializer> Initializer::Create(
     utils::ParseConf<float>(init_conf, "mean", &mean);
     utils::ParseConf<float>(init_conf, "stddev", &stddev);
 
-    initializer.reset(new NormalInitializer(mean, stddev));
+    initializer.reset(new NormalInitializer(mean, stddev, seed));
   } else if (init_type == InitializerType::kUniform) {
     float lower = 0.0;
     float upper = 1.0;
@@ -44,17 +70,17 @@ std::unique_ptr<Initializer> Initializer::Create(
     utils::ParseConf<float>(init_conf, "lower", &lower);
     utils::ParseConf<float>(init_conf, "upper", &upper);
 
-    initializer.reset(new UniformInitializer(lower, upper));
+    initializer.reset(new UniformInitializer(lower, upper, seed));
   } else if (init_type == InitializerType::kXavierNormal) {
     float gain = 1.0;
     utils::ParseConf<float>(init_conf, "gain", &gain);
 
-    initializer.reset(new XavierNormalInitializer(gain));
+    initializer.reset(new XavierNormalInitializer(gain, seed));
   } else if (init_type == InitializerType::kXavierUniform) {
     float gain = 1.0;
     utils::ParseConf<float>(init_conf, "gain", &gain);
 
-    initializer.reset(new XavierUniformInitializer(gain));
+    initializer.reset(new XavierUniformInitializer(gain, seed));
   }
 
   return initializer;
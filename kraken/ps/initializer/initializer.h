@@ -3,6 +3,7 @@
 #include <cinttypes>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "common/info.h"
 #include "common/utils.h"
@@ -14,18 +15,48 @@ class Initializer {
 protected:
   InitializerType type_;
 
+  // The random initializers seed a sparse row by (seed_, table id, sparse id),
+  // set by init_conf "seed".
+  int64_t seed_;
+
 protected:
-  Initializer(InitializerType type);
+  Initializer(InitializerType type, int64_t seed = 0);
+
+  // The RNG key of a table's rows.
+  uint64_t RowKey(uint64_t table_id) const;
+
+  template <typename T>
+  static std::vector<T*> CastRows(const std::vector<char*>& rows) {
+    std::vector<T*> t_rows;
+    t_rows.reserve(rows.size());
+
+    for (auto row : rows) {
+      t_rows.emplace_back((T*)row);
+    }
+
+    return t_rows;
+  }
 
 public:
   virtual ~Initializer() = default;
 
   InitializerType type() const;
 
+  int64_t seed() const;
+
   virtual std::unordered_map<std::string, std::string> conf() const;
 
   virtual void Initialize(Tensor* val) const = 0;
 
+  // Initialize the new rows at once, rows[i] is the [dimension] val of
+  // sparse_ids[i] in element_type. The random ones only depend on the seed,
+  // table_id and the sparse id, so a row is initialized the same on any node.
+  // Default call Initialize on every row.
+  virtual void InitializeRows(uint64_t table_id,
+                              const std::vector<uint64_t>& sparse_ids,
+                              int64_t dimension, ElementType element_type,
+                              const std::vector<char*>& rows) const;
+
 public:
   static std::unique_ptr<Initializer> Create(
       InitializerType init_type,
@@ -1,19 +1,41 @@
 #include "ps/initializer/normal_initializer.h"
 
 #include "common/log.h"
+#include "t/philox.h"
 
 namespace kraken {
 
-NormalInitializer::NormalInitializer(float mean, float stddev)
-    : Initializer(InitializerType::kNormal), mean_(mean), stddev_(stddev) {
+NormalInitializer::NormalInitializer(float mean, float stddev, int64_t seed)
+    : Initializer(InitializerType::kNormal, seed),
+      mean_(mean),
+      stddev_(stddev) {
 }
 
 std::unordered_map<std::string, std::string> NormalInitializer::conf() const {
-  return {{"mean", std::to_string(mean_)}, {"stddev", std::to_string(stddev_)}};
+  return {{"mean", std::to_string(mean_)},
+          {"stddev", std::to_string(stddev_)},
+          {"seed", std::to_string(seed_)}};
 }
 
 void NormalInitializer::Initialize(Tensor* val) const {
   val->Normal(mean_, stddev_);
 }
 
+void NormalInitializer::InitializeRows(uint64_t table_id,
+                                       const std::vector<uint64_t>& sparse_ids,
+                                       int64_t dimension,
+                                       ElementType element_type,
+                                       const std::vector<char*>& rows) const {
+  if (element_type.Is<float>()) {
+    philox::NormalRows<float>(RowKey(table_id), sparse_ids, dimension, mean_,
+                              stddev_, CastRows<float>(rows));
+  } else if (element_type.Is<double>()) {
+    philox::NormalRows<double>(RowKey(table_id), sparse_ids, dimension, mean_,
+                               stddev_, CastRows<double>(rows));
+  } else {
+    Initializer::InitializeRows(table_id, sparse_ids, dimension, element_type,
+                                rows);
+  }
+}
+
 }  // namespace kraken
@@ -3,6 +3,7 @@
 #include <cinttypes>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "common/utils.h"
 #include "ps/initializer/initializer.h"
@@ -16,11 +17,16 @@ private:
   float stddev_;
 
 public:
-  NormalInitializer(float mean, float stddev);
+  NormalInitializer(float mean, float stddev, int64_t seed);
 
   std::unordered_map<std::string, std::string> conf() const override;
 
   void Initialize(Tensor* val) const override;
+
+  void InitializeRows(uint64_t table_id,
+                      const std::vector<uint64_t>& sparse_ids,
+                      int64_t dimension, ElementType element_type,
+                      const std::vector<char*>& rows) const override;
 };
 
 }  // namespace kraken
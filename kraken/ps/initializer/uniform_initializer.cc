@@ -1,19 +1,41 @@
 #include "ps/initializer/uniform_initializer.h"
 
 #include "common/log.h"
+#include "t/philox.h"
 
 namespace kraken {
 
-UniformInitializer::UniformInitializer(float lower, float upper)
-    : Initializer(InitializerType::kUniform), lower_(lower), upper_(upper) {
+UniformInitializer::UniformInitializer(float lower, float upper, int64_t seed)
+    : Initializer(InitializerType::kUniform, seed),
+      lower_(lower),
+      upper_(upper) {
 }
 
 std::unordered_map<std::string, std::string> UniformInitializer::conf() const {
-  return {{"lower", std::to_string(lower_)}, {"upper", std::to_string(upper_)}};
+  return {{"lower", std::to_string(lower_)},
+          {"upper", std::to_string(upper_)},
+          {"seed", std::to_string(seed_)}};
 }
 
 void UniformInitializer::Initialize(Tensor* val) const {
   val->Uniform(lower_, upper_);
 }
 
+void UniformInitializer::InitializeRows(uint64_t table_id,
+                                        const std::vector<uint64_t>& sparse_ids,
+                                        int64_t dimension,
+                                        ElementType element_type,
+                                        const std::vector<char*>& rows) const {
+  if (element_type.Is<float>()) {
+    philox::UniformRows<float>(RowKey(table_id), sparse_ids, dimension, lower_,
+                               upper_, CastRows<float>(rows));
+  } else if (element_type.Is<double>()) {
+    philox::UniformRows<double>(RowKey(table_id), sparse_ids, dimension,
+                                lower_, upper_, CastRows<double>(rows));
+  } else {
+    Initializer::InitializeRows(table_id, sparse_ids, dimension, element_type,
+                                rows);
+  }
+}
+
 }  // namespace kraken
@@ -1,20 +1,43 @@
 #include "ps/initializer/xavier_normal_initializer.h"
 
+#include <cmath>
+
 #include "common/log.h"
+#include "t/philox.h"
 
 namespace kraken {
 
-XavierNormalInitializer::XavierNormalInitializer(float gain)
-    : Initializer(InitializerType::kXavierNormal), gain_(gain) {
+XavierNormalInitializer::XavierNormalInitializer(float gain, int64_t seed)
+    : Initializer(InitializerType::kXavierNormal, seed), gain_(gain) {
 }
 
 std::unordered_map<std::string, std::string> XavierNormalInitializer::conf()
     const {
-  return {{"gain", std::to_string(gain_)}};
+  return {{"gain", std::to_string(gain_)}, {"seed", std::to_string(seed_)}};
 }
 
 void XavierNormalInitializer::Initialize(Tensor* val) const {
   val->XavierNormal(gain_);
 }
 
+void XavierNormalInitializer::InitializeRows(
+    uint64_t table_id, const std::vector<uint64_t>& sparse_ids,
+    int64_t dimension, ElementType element_type,
+    const std::vector<char*>& rows) const {
+  // Same with XavierNormal of a [dimension] Tensor: fan_in is 1 and fan_out is
+  // dimension.
+  float std = gain_ * std::sqrt(2.0 / float(1 + dimension));
+
+  if (element_type.Is<float>()) {
+    philox::NormalRows<float>(RowKey(table_id), sparse_ids, dimension, 0, std,
+                              CastRows<float>(rows));
+  } else if (element_type.Is<double>()) {
+    philox::NormalRows<double>(RowKey(table_id), sparse_ids, dimension, 0, std,
+                               CastRows<double>(rows));
+  } else {
+    Initializer::InitializeRows(table_id, sparse_ids, dimension, element_type,
+                                rows);
+  }
+}
+
 }  // namespace kraken
@@ -1,20 +1,43 @@
 #include "ps/initializer/xavier_uniform_initializer.h"
 
+#include <cmath>
+
 #include "common/log.h"
+#include "t/philox.h"
 
 namespace kraken {
 
-XavierUniformInitializer::XavierUniformInitializer(float gain)
-    : Initializer(InitializerType::kXavierUniform), gain_(gain) {
+XavierUniformInitializer::XavierUniformInitializer(float gain, int64_t seed)
+    : Initializer(InitializerType::kXavierUniform, seed), gain_(gain) {
 }
 
 std::unordered_map<std::string, std::string> XavierUniformInitializer::conf()
     const {
-  return {{"gain", std::to_string(gain_)}};
+  return {{"gain", std::to_string(gain_)}, {"seed", std::to_string(seed_)}};
 }
 
 void XavierUniformInitializer::Initialize(Tensor* val) const {
   val->XavierUniform(gain_);
 }
 
+void XavierUniformInitializer::InitializeRows(
+    uint64_t table_id, const std::vector<uint64_t>& sparse_ids,
+    int64_t dimension, ElementType element_type,
+    const std::vector<char*>& rows) const {
+  // Same with XavierUniform of a [dimension] Tensor.
+  float std = gain_ * std::sqrt(2.0 / float(1 + dimension));
+  float a = std::sqrt(3.0) * std;
+
+  if (element_type.Is<float>()) {
+    philox::UniformRows<float>(RowKey(table_id), sparse_ids, dimension, -a, a,
+                               CastRows<float>(rows));
+  } else if (element_type.Is<double>()) {
+    philox::UniformRows<double>(RowKey(table_id), sparse_ids, dimension, -a,
+                                a, CastRows<double>(rows));
+  } else {
+    Initializer::InitializeRows(table_id, sparse_ids, dimension, element_type,
+                                rows);
+  }
+}
+
 }  // namespace kraken
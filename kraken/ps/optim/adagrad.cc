@@ -4,10 +4,45 @@
 
 #include "common/error_code.h"
 #include "common/log.h"
+#include "ps/optim/kernel.h"
 #include "ps/table.h"
 
 namespace kraken {
 
+namespace {
+
+template <typename T>
+void AdagradRows(const kernel::AdagradParam& p, const RowLayout& layout,
+                 const std::vector<char*>& rows,
+                 const std::vector<Tensor>& grads) {
+  size_t n = rows.size();
+
+  std::vector<T*> vals(n);
+  std::vector<T*> state_sums(n);
+  std::vector<const T*> gs(n);
+
+  for (size_t i = 0; i < n; ++i) {
+    vals[i] = (T*)layout.Val(rows[i]);
+    state_sums[i] = (T*)layout.State(rows[i], 0);
+    gs[i] = grads[i].Data<T>();
+  }
+
+  kernel::Adagrad<T>(p, layout.dimension(), n, vals.data(), state_sums.data(),
+                     gs.data());
+}
+
+template <typename T>
+void AdagradValue(const kernel::AdagradParam& p, const Tensor& grad,
+                  Value* value) {
+  T* val = value->val.Data<T>();
+  T* state_sum = value->states[StateType::kStateSum].Data<T>();
+  const T* g = grad.Data<T>();
+
+  kernel::Adagrad<T>(p, value->val.Size(), 1, &val, &state_sum, &g);
+}
+
+}  // namespace
+
 Adagrad::Adagrad(bool has_weight_decay, float weight_decay, float eps)
     : Optim(OptimType::kAdagrad),
       has_weight_decay_(has_weight_decay),
@@ -15,6 +50,10 @@ Adagrad::Adagrad(bool has_weight_decay, float weight_decay, float eps)
       eps_(eps) {
 }
 
+std::vector<StateType> Adagrad::StateTypes() const {
+  return {StateType::kStateSum};
+}
+
 int32_t Adagrad::Update(const Tensor& grad, float lr, Value* value) const {
   // Grad maybe Coo tensor.
   Tensor grad_t = grad;
@@ -35,6 +74,17 @@ int32_t Adagrad::Update(const Tensor& grad, float lr, Value* value) const {
     value->states.emplace(StateType::kStateSum, grad_t.Like().Zero());
   }
 
+  ElementType etype = grad_t.element_type();
+  if (etype.Is<float>() || etype.Is<double>()) {
+    if (etype.Is<float>()) {
+      AdagradValue<float>(KernelParam(lr), grad_t, value);
+    } else {
+      AdagradValue<double>(KernelParam(lr), grad_t, value);
+    }
+
+    return ErrorCode::kSuccess;
+  }
+
   if (has_weight_decay_) {
     grad_t += weight_decay_ * (value->val);
   }
@@ -47,4 +97,45 @@ int32_t Adagrad::Update(const Tensor& grad, float lr, Value* value) const {
   return ErrorCode::kSuccess;
 }
 
+int32_t Adagrad::UpdateBatch(const RowLayout& layout,
+                             const std::vector<char*>& rows,
+                             const std::vector<const Tensor*>& grads,
+                             float lr) const {
+  ElementType etype = layout.element_type();
+  if (etype.Is<float>() == false && etype.Is<double>() == false) {
+    return Optim::UpdateBatch(layout, rows, grads, lr);
+  }
+
+  std::vector<char*> valid_rows;
+  std::vector<Tensor> dense_grads;
+
+  int32_t error_code =
+      RowGrads(layout, rows, grads, &valid_rows, &dense_grads);
+  if (error_code != ErrorCode::kSuccess) {
+    return error_code;
+  }
+
+  if (etype.Is<float>()) {
+    AdagradRows<float>(KernelParam(lr), layout, valid_rows, dense_grads);
+  } else {
+    AdagradRows<double>(KernelParam(lr), layout, valid_rows, dense_grads);
+  }
+
+  for (auto row : valid_rows) {
+    *(layout.Steps(row)) += 1;
+  }
+
+  return ErrorCode::kSuccess;
+}
+
+kernel::AdagradParam Adagrad::KernelParam(float lr) const {
+  kernel::AdagradParam p;
+  p.lr = lr;
+  p.has_weight_decay = has_weight_decay_;
+  p.weight_decay = weight_decay_;
+  p.eps = eps_;
+
+  return p;
+}
+
 }  // namespace kraken
@@ -1,14 +1,89 @@
 #include "ps/optim/adam.h"
 
+#include <algorithm>
 #include <cmath>
+#include <numeric>
 #include <sstream>
 
 #include "common/error_code.h"
 #include "common/log.h"
+#include "ps/optim/kernel.h"
 #include "ps/table.h"
 
 namespace kraken {
 
+namespace {
+
+template <typename T>
+void AdamRows(kernel::AdamParam p, float beta1, float beta2,
+              const RowLayout& layout, const std::vector<char*>& rows,
+              const std::vector<Tensor>& grads) {
+  // Sort the rows by steps, the rows with same steps share the bias
+  // correction and be updated in one call.
+  std::vector<size_t> idxs(rows.size());
+  std::iota(idxs.begin(), idxs.end(), 0);
+  std::sort(idxs.begin(), idxs.end(), [&layout, &rows](size_t a, size_t b) {
+    return layout.Steps((const char*)rows[a]) <
+           layout.Steps((const char*)rows[b]);
+  });
+
+  size_t n = idxs.size();
+
+  std::vector<T*> vals(n);
+  std::vector<T*> ms(n);
+  std::vector<T*> vs(n);
+  std::vector<T*> v_maxs(n, nullptr);
+  std::vector<const T*> gs(n);
+
+  for (size_t i = 0; i < n; ++i) {
+    char* row = rows[idxs[i]];
+
+    vals[i] = (T*)layout.Val(row);
+    ms[i] = (T*)layout.State(row, 0);
+    vs[i] = (T*)layout.State(row, 1);
+    if (p.amsgrad) {
+      v_maxs[i] = (T*)layout.State(row, 2);
+    }
+
+    gs[i] = grads[idxs[i]].Data<T>();
+  }
+
+  for (size_t start = 0; start < n;) {
+    int64_t steps = layout.Steps((const char*)rows[idxs[start]]);
+
+    size_t end = start + 1;
+    while (end < n && layout.Steps((const char*)rows[idxs[end]]) == steps) {
+      end++;
+    }
+
+    p.bias_correction1 = 1.0 - std::pow(beta1, float(steps + 1));
+    p.bias_correction2 = 1.0 - std::pow(beta2, float(steps + 1));
+
+    kernel::Adam<T>(p, layout.dimension(), end - start, vals.data() + start,
+                    ms.data() + start, vs.data() + start,
+                    v_maxs.data() + start, gs.data() + start);
+
+    start = end;
+  }
+}
+
+template <typename T>
+void AdamValue(const kernel::AdamParam& p, const Tensor& grad, Value* value) {
+  T* val = value->val.Data<T>();
+  T* m = value->states[StateType::kFirstMoment].Data<T>();
+  T* v = value->states[StateType::kSecondMoment].Data<T>();
+  T* v_max = nullptr;
+  if (p.amsgrad) {
+    v_max = value->states[StateType::kSecondMomentMax].Data<T>();
+  }
+
+  const T* g = grad.Data<T>();
+
+  kernel::Adam<T>(p, value->val.Size(), 1, &val, &m, &v, &v_max, &g);
+}
+
+}  // namespace
+
 Adam::Adam(bool has_weight_decay, float weight_decay, float beta1, float beta2,
            float eps, bool amsgrad)
     : Optim(OptimType::kAdam),
@@ -20,6 +95,16 @@ Adam::Adam(bool has_weight_decay, float weight_decay, float beta1, float beta2,
       amsgrad_(amsgrad) {
 }
 
+std::vector<StateType> Adam::StateTypes() const {
+  std::vector<StateType> state_types = {StateType::kFirstMoment,
+                                        StateType::kSecondMoment};
+  if (amsgrad_) {
+    state_types.emplace_back(StateType::kSecondMomentMax);
+  }
+
+  return state_types;
+}
+
 int32_t Adam::Update(const Tensor& grad, float lr, Value* value) const {
   // Grad maybe Coo tensor.
   Tensor grad_t = grad;
@@ -36,6 +121,29 @@ int32_t Adam::Update(const Tensor& grad, float lr, Value* value) const {
     return ErrorCode::kGradientUnCompatibleError;
   }
 
+  ElementType etype = grad_t.element_type();
+  if (etype.Is<float>() || etype.Is<double>()) {
+    for (auto state_type : StateTypes()) {
+      if (value->states.find(state_type) == value->states.end()) {
+        value->states.emplace(state_type, grad_t.Like().Zero());
+      }
+    }
+
+    int64_t steps = ++(value->states_i[StateType::kSteps]);
+
+    kernel::AdamParam p = KernelParam(lr);
+    p.bias_correction1 = 1.0 - std::pow(beta1_, float(steps));
+    p.bias_correction2 = 1.0 - std::pow(beta2_, float(steps));
+
+    if (etype.Is<float>()) {
+      AdamValue<float>(p, grad_t, value);
+    } else {
+      AdamValue<double>(p, grad_t, value);
+    }
+
+    return ErrorCode::kSuccess;
+  }
+
   // First moment and second moment.
   if (value->states.find(StateType::kFirstMoment) == value->states.end()) {
     value->states.emplace(StateType::kFirstMoment, grad_t.Like().Zero());
@@ -80,4 +188,52 @@ int32_t Adam::Update(const Tensor& grad, float lr, Value* value) const {
   return ErrorCode::kSuccess;
 }
 
+int32_t Adam::UpdateBatch(const RowLayout& layout,
+                          const std::vector<char*>& rows,
+                          const std::vector<const Tensor*>& grads,
+                          float lr) const {
+  ElementType etype = layout.element_type();
+  if (etype.Is<float>() == false && etype.Is<double>() == false) {
+    return Optim::UpdateBatch(layout, rows, grads, lr);
+  }
+
+  std::vector<char*> valid_rows;
+  std::vector<Tensor> dense_grads;
+
+  int32_t error_code =
+      RowGrads(layout, rows, grads, &valid_rows, &dense_grads);
+  if (error_code != ErrorCode::kSuccess) {
+    return error_code;
+  }
+
+  if (etype.Is<float>()) {
+    AdamRows<float>(KernelParam(lr), beta1_, beta2_, layout, valid_rows,
+                    dense_grads);
+  } else {
+    AdamRows<double>(KernelParam(lr), beta1_, beta2_, layout, valid_rows,
+                     dense_grads);
+  }
+
+  for (auto row : valid_rows) {
+    *(layout.Steps(row)) += 1;
+  }
+
+  return ErrorCode::kSuccess;
+}
+
+kernel::AdamParam Adam::KernelParam(float lr) const {
+  kernel::AdamParam p;
+  p.lr = lr;
+  p.has_weight_decay = has_weight_decay_;
+  p.weight_decay = weight_decay_;
+  p.beta1 = beta1_;
+  p.beta2 = beta2_;
+  p.eps = eps_;
+  p.amsgrad = amsgrad_;
+  p.bias_correction1 = 1.0;
+  p.bias_correction2 = 1.0;
+
+  return p;
+}
+
 }  // namespace kraken
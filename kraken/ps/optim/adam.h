@@ -3,6 +3,7 @@
 #include <string>
 #include <unordered_map>
 
+#include "ps/optim/kernel.h"
 #include "ps/optim/optim.h"
 #include "t/tensor.h"
 
@@ -26,7 +27,17 @@ public:
   Adam(bool has_weight_decay, float weight_decay, float beta1, float beta2,
        float eps, bool amsgrad);
 
+  std::vector<StateType> StateTypes() const override;
+
   int32_t Update(const Tensor& grad, float lr, Value* value) const override;
+
+  int32_t UpdateBatch(const RowLayout& layout, const std::vector<char*>& rows,
+                      const std::vector<const Tensor*>& grads,
+                      float lr) const override;
+
+private:
+  // The bias correction is set by the caller.
+  kernel::AdamParam KernelParam(float lr) const;
 };
 
 }  // namespace kraken
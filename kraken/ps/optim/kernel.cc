@@ -0,0 +1,490 @@
+#include "ps/optim/kernel.h"
+
+#include <atomic>
+#include <cmath>
+#include <type_traits>
+
+// The AVX2/AVX-512 code is compiled by the target attribute, not the global
+// -mavx2, and only run if the cpu support it.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define KRAKEN_X86_SIMD
+#include <immintrin.h>
+#endif
+
+namespace kraken {
+namespace kernel {
+
+namespace {
+
+// A tiny vector wrapper, so the kernel only write once for scalar/AVX2/AVX-512.
+template <typename T>
+struct ScalarVec {
+  constexpr static int64_t kWidth = 1;
+
+  T v;
+
+  static inline ScalarVec Set(T x) {
+    return {x};
+  }
+
+  static inline ScalarVec Load(const T* p) {
+    return {*p};
+  }
+
+  inline void Store(T* p) const {
+    *p = v;
+  }
+};
+
+template <typename T>
+inline ScalarVec<T> operator+(ScalarVec<T> a, ScalarVec<T> b) {
+  return {a.v + b.v};
+}
+
+template <typename T>
+inline ScalarVec<T> operator-(ScalarVec<T> a, ScalarVec<T> b) {
+  return {a.v - b.v};
+}
+
+template <typename T>
+inline ScalarVec<T> operator*(ScalarVec<T> a, ScalarVec<T> b) {
+  return {a.v * b.v};
+}
+
+template <typename T>
+inline ScalarVec<T> operator/(ScalarVec<T> a, ScalarVec<T> b) {
+  return {a.v / b.v};
+}
+
+template <typename T>
+inline ScalarVec<T> Sqrt(ScalarVec<T> a) {
+  return {std::sqrt(a.v)};
+}
+
+template <typename T>
+inline ScalarVec<T> Max(ScalarVec<T> a, ScalarVec<T> b) {
+  return {a.v > b.v ? a.v : b.v};
+}
+
+// Pass the vector type to the row, the vector itself is not passed by value
+// out of the target functions.
+template <typename V>
+struct VecTag {
+  using Vec = V;
+};
+
+#ifdef KRAKEN_X86_SIMD
+#pragma GCC push_options
+#pragma GCC target("avx2")
+
+struct Avx2Float {
+  constexpr static int64_t kWidth = 8;
+
+  __m256 v;
+
+  static inline Avx2Float Set(float x) {
+    return {_mm256_set1_ps(x)};
+  }
+
+  // The row is not 32 bytes aligned.
+  static inline Avx2Float Load(const float* p) {
+    return {_mm256_loadu_ps(p)};
+  }
+
+  inline void Store(float* p) const {
+    _mm256_storeu_ps(p, v);
+  }
+};
+
+inline Avx2Float operator+(Avx2Float a, Avx2Float b) {
+  return {_mm256_add_ps(a.v, b.v)};
+}
+
+inline Avx2Float operator-(Avx2Float a, Avx2Float b) {
+  return {_mm256_sub_ps(a.v, b.v)};
+}
+
+inline Avx2Float operator*(Avx2Float a, Avx2Float b) {
+  return {_mm256_mul_ps(a.v, b.v)};
+}
+
+inline Avx2Float operator/(Avx2Float a, Avx2Float b) {
+  return {_mm256_div_ps(a.v, b.v)};
+}
+
+inline Avx2Float Sqrt(Avx2Float a) {
+  return {_mm256_sqrt_ps(a.v)};
+}
+
+inline Avx2Float Max(Avx2Float a, Avx2Float b) {
+  return {_mm256_max_ps(a.v, b.v)};
+}
+
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+
+struct Avx512Float {
+  constexpr static int64_t kWidth = 16;
+
+  __m512 v;
+
+  static inline Avx512Float Set(float x) {
+    return {_mm512_set1_ps(x)};
+  }
+
+  static inline Avx512Float Load(const float* p) {
+    return {_mm512_loadu_ps(p)};
+  }
+
+  inline void Store(float* p) const {
+    _mm512_storeu_ps(p, v);
+  }
+};
+
+inline Avx512Float operator+(Avx512Float a, Avx512Float b) {
+  return {_mm512_add_ps(a.v, b.v)};
+}
+
+inline Avx512Float operator-(Avx512Float a, Avx512Float b) {
+  return {_mm512_sub_ps(a.v, b.v)};
+}
+
+inline Avx512Float operator*(Avx512Float a, Avx512Float b) {
+  return {_mm512_mul_ps(a.v, b.v)};
+}
+
+inline Avx512Float operator/(Avx512Float a, Avx512Float b) {
+  return {_mm512_div_ps(a.v, b.v)};
+}
+
+inline Avx512Float Sqrt(Avx512Float a) {
+  return {_mm512_sqrt_ps(a.v)};
+}
+
+inline Avx512Float Max(Avx512Float a, Avx512Float b) {
+  return {_mm512_max_ps(a.v, b.v)};
+}
+
+#pragma GCC pop_options
+
+// flatten inline the row (and the vector ops) here, so they are compiled with
+// the target.
+template <typename Row>
+__attribute__((target("avx2"), flatten)) void RunRowsAvx2(int64_t dimension,
+                                                          int64_t n,
+                                                          Row& row) {
+  for (int64_t r = 0; r < n; ++r) {
+    int64_t i = row(VecTag<Avx2Float>(), r, 0, dimension);
+    row(VecTag<ScalarVec<float>>(), r, i, dimension);
+  }
+}
+
+template <typename Row>
+__attribute__((target("avx512f"), flatten)) void RunRowsAvx512(
+    int64_t dimension, int64_t n, Row& row) {
+  for (int64_t r = 0; r < n; ++r) {
+    int64_t i = row(VecTag<Avx512Float>(), r, 0, dimension);
+    i = row(VecTag<Avx2Float>(), r, i, dimension);
+    row(VecTag<ScalarVec<float>>(), r, i, dimension);
+  }
+}
+#endif
+
+std::atomic<Simd>& SimdRef() {
+  static std::atomic<Simd> simd(SupportedSimd());
+
+  return simd;
+}
+
+// Call row for every row with the widest vector first, the left elements use
+// scalar. row(VecTag<V>, r, start, end) return the index it stopped at.
+template <typename T, typename Row>
+inline void RunRows(int64_t dimension, int64_t n, Row&& row) {
+#ifdef KRAKEN_X86_SIMD
+  if constexpr (std::is_same<T, float>::value) {
+    Simd simd = SimdRef().load(std::memory_order_relaxed);
+
+    if (simd == Simd::kAvx512) {
+      RunRowsAvx512(dimension, n, row);
+      return;
+    }
+
+    if (simd == Simd::kAvx2) {
+      RunRowsAvx2(dimension, n, row);
+      return;
+    }
+  }
+#endif
+
+  for (int64_t r = 0; r < n; ++r) {
+    row(VecTag<ScalarVec<T>>(), r, 0, dimension);
+  }
+}
+
+}  // namespace
+
+Simd SupportedSimd() {
+#ifdef KRAKEN_X86_SIMD
+  if (__builtin_cpu_supports("avx512f")) {
+    return Simd::kAvx512;
+  }
+
+  if (__builtin_cpu_supports("avx2")) {
+    return Simd::kAvx2;
+  }
+#endif
+
+  return Simd::kScalar;
+}
+
+Simd CurrentSimd() {
+  return SimdRef().load(std::memory_order_relaxed);
+}
+
+void SetSimd(Simd simd) {
+  if (simd > SupportedSimd()) {
+    simd = SupportedSimd();
+  }
+
+  SimdRef().store(simd, std::memory_order_relaxed);
+}
+
+template <typename T>
+void SGD(const SGDParam& p, int64_t dimension, int64_t n, T* const* vals,
+         T* const* momentum_buffers, const T* const* grads) {
+  T weight_decay = p.weight_decay;
+  T momentum = p.momentum;
+  T one_minus_dampening = (float)(1.0 - p.dampening);
+  T lr = p.lr;
+
+  RunRows<T>(dimension, n, [&](auto tag, int64_t r, int64_t i, int64_t end) {
+    using V = typename decltype(tag)::Vec;
+
+    T* val = vals[r];
+    T* buf = p.has_momentum ? momentum_buffers[r] : nullptr;
+    const T* grad = grads[r];
+
+    V weight_decay_v = V::Set(weight_decay);
+    V momentum_v = V::Set(momentum);
+    V one_minus_dampening_v = V::Set(one_minus_dampening);
+    V lr_v = V::Set(lr);
+
+    for (; i + V::kWidth <= end; i += V::kWidth) {
+      V w = V::Load(val + i);
+      V g = V::Load(grad + i);
+
+      if (p.has_weight_decay) {
+        g = g + weight_decay_v * w;
+      }
+
+      if (p.has_momentum) {
+        V b;
+        if (p.first) {
+          b = g;
+        } else {
+          b = momentum_v * V::Load(buf + i) + one_minus_dampening_v * g;
+        }
+
+        b.Store(buf + i);
+
+        if (p.nesterov) {
+          g = g + momentum_v * b;
+        } else {
+          g = b;
+        }
+      }
+
+      (w - g * lr_v).Store(val + i);
+    }
+
+    return i;
+  });
+}
+
+template <typename T>
+void Adagrad(const AdagradParam& p, int64_t dimension, int64_t n,
+             T* const* vals, T* const* state_sums, const T* const* grads) {
+  T weight_decay = p.weight_decay;
+  T eps = p.eps;
+  T lr = p.lr;
+
+  RunRows<T>(dimension, n, [&](auto tag, int64_t r, int64_t i, int64_t end) {
+    using V = typename decltype(tag)::Vec;
+
+    T* val = vals[r];
+    T* sum = state_sums[r];
+    const T* grad = grads[r];
+
+    V weight_decay_v = V::Set(weight_decay);
+    V eps_v = V::Set(eps);
+    V lr_v = V::Set(lr);
+
+    for (; i + V::kWidth <= end; i += V::kWidth) {
+      V w = V::Load(val + i);
+      V g = V::Load(grad + i);
+
+      if (p.has_weight_decay) {
+        g = g + weight_decay_v * w;
+      }
+
+      V s = V::Load(sum + i) + g * g;
+      s.Store(sum + i);
+
+      (w - lr_v * (g / (Sqrt(s) + eps_v))).Store(val + i);
+    }
+
+    return i;
+  });
+}
+
+template <typename T>
+void RMSprop(const RMSpropParam& p, int64_t dimension, int64_t n,
+             T* const* vals, T* const* square_averages, T* const* g_aves,
+             T* const* momentum_buffers, const T* const* grads) {
+  T weight_decay = p.weight_decay;
+  T momentum = p.momentum;
+  T alpha = p.alpha;
+  T one_minus_alpha = (float)(1.0 - p.alpha);
+  T eps = p.eps;
+  T lr = p.lr;
+
+  RunRows<T>(dimension, n, [&](auto tag, int64_t r, int64_t i, int64_t end) {
+    using V = typename decltype(tag)::Vec;
+
+    T* val = vals[r];
+    T* square_average = square_averages[r];
+    T* g_ave = p.centered ? g_aves[r] : nullptr;
+    T* buf = p.has_momentum ? momentum_buffers[r] : nullptr;
+    const T* grad = grads[r];
+
+    V weight_decay_v = V::Set(weight_decay);
+    V momentum_v = V::Set(momentum);
+    V alpha_v = V::Set(alpha);
+    V one_minus_alpha_v = V::Set(one_minus_alpha);
+    V eps_v = V::Set(eps);
+    V lr_v = V::Set(lr);
+
+    for (; i + V::kWidth <= end; i += V::kWidth) {
+      V w = V::Load(val + i);
+      V g = V::Load(grad + i);
+
+      if (p.has_weight_decay) {
+        g = g + weight_decay_v * w;
+      }
+
+      V v = alpha_v * V::Load(square_average + i) +
+            one_minus_alpha_v * (g * g);
+      v.Store(square_average + i);
+
+      if (p.centered) {
+        V ga = V::Load(g_ave + i) * alpha_v + one_minus_alpha_v * g;
+        ga.Store(g_ave + i);
+
+        v = v - ga * ga;
+      }
+
+      if (p.has_momentum) {
+        V b = V::Load(buf + i) * momentum_v + g / (Sqrt(v) + eps_v);
+        b.Store(buf + i);
+
+        (w - lr_v * b).Store(val + i);
+      } else {
+        (w - lr_v * g / (Sqrt(v) + eps_v)).Store(val + i);
+      }
+    }
+
+    return i;
+  });
+}
+
+template <typename T>
+void Adam(const AdamParam& p, int64_t dimension, int64_t n, T* const* vals,
+          T* const* first_moments, T* const* second_moments,
+          T* const* second_moment_maxs, const T* const* grads) {
+  T weight_decay = p.weight_decay;
+  T beta1 = p.beta1;
+  T one_minus_beta1 = (float)(1.0 - p.beta1);
+  T beta2 = p.beta2;
+  T one_minus_beta2 = (float)(1.0 - p.beta2);
+  T bias_correction1 = p.bias_correction1;
+  T bias_correction2 = p.bias_correction2;
+  T eps = p.eps;
+  T lr = p.lr;
+
+  RunRows<T>(dimension, n, [&](auto tag, int64_t r, int64_t i, int64_t end) {
+    using V = typename decltype(tag)::Vec;
+
+    T* val = vals[r];
+    T* m = first_moments[r];
+    T* v = second_moments[r];
+    T* v_max = p.amsgrad ? second_moment_maxs[r] : nullptr;
+    const T* grad = grads[r];
+
+    V weight_decay_v = V::Set(weight_decay);
+    V beta1_v = V::Set(beta1);
+    V one_minus_beta1_v = V::Set(one_minus_beta1);
+    V beta2_v = V::Set(beta2);
+    V one_minus_beta2_v = V::Set(one_minus_beta2);
+    V bias_correction1_v = V::Set(bias_correction1);
+    V bias_correction2_v = V::Set(bias_correction2);
+    V eps_v = V::Set(eps);
+    V lr_v = V::Set(lr);
+
+    for (; i + V::kWidth <= end; i += V::kWidth) {
+      V w = V::Load(val + i);
+      V g = V::Load(grad + i);
+
+      if (p.has_weight_decay) {
+        g = g + weight_decay_v * w;
+      }
+
+      V mi = beta1_v * V::Load(m + i) + one_minus_beta1_v * g;
+      V vi = beta2_v * V::Load(v + i) + one_minus_beta2_v * (g * g);
+
+      mi.Store(m + i);
+      vi.Store(v + i);
+
+      V mt = mi / bias_correction1_v;
+      V vt = vi / bias_correction2_v;
+
+      if (p.amsgrad) {
+        vt = Max(V::Load(v_max + i), vt);
+        vt.Store(v_max + i);
+      }
+
+      (w - lr_v * mt / (Sqrt(vt) + eps_v)).Store(val + i);
+    }
+
+    return i;
+  });
+}
+
+template void SGD<float>(const SGDParam&, int64_t, int64_t, float* const*,
+                         float* const*, const float* const*);
+template void SGD<double>(const SGDParam&, int64_t, int64_t, double* const*,
+                          double* const*, const double* const*);
+
+template void Adagrad<float>(const AdagradParam&, int64_t, int64_t,
+                             float* const*, float* const*, const float* const*);
+template void Adagrad<double>(const AdagradParam&, int64_t, int64_t,
+                              double* const*, double* const*,
+                              const double* const*);
+
+template void RMSprop<float>(const RMSpropParam&, int64_t, int64_t,
+                             float* const*, float* const*, float* const*,
+                             float* const*, const float* const*);
+template void RMSprop<double>(const RMSpropParam&, int64_t, int64_t,
+                              double* const*, double* const*, double* const*,
+                              double* const*, const double* const*);
+
+template void Adam<float>(const AdamParam&, int64_t, int64_t, float* const*,
+                          float* const*, float* const*, float* const*,
+                          const float* const*);
+template void Adam<double>(const AdamParam&, int64_t, int64_t, double* const*,
+                           double* const*, double* const*, double* const*,
+                           const double* const*);
+
+}  // namespace kernel
+}  // namespace kraken
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cinttypes>
+
+namespace kraken {
+namespace kernel {
+
+// Fused optimizer kernels, update n rows in place in one pass without any
+// allocation. Every row is a vector of dimension, the state pointers that the
+// optim not need can be nullptr.
+// Support float/double, float use the widest simd (AVX-512/AVX2) the cpu
+// support, it's checked at runtime so the binary not need build with -mavx2.
+// The math and the order of operations is same as the Tensor version in
+// ps/optim/*.cc, but the compiler may fuse the multiply-add in the AVX-512 path
+// so the result can differ in the last bits.
+
+enum class Simd : uint8_t {
+  kScalar = 0,
+  kAvx2 = 1,
+  kAvx512 = 2,
+};
+
+// The widest simd the cpu support, kScalar if not x86.
+Simd SupportedSimd();
+
+// The simd used by the kernels, default is SupportedSimd().
+Simd CurrentSimd();
+
+// Limit the kernels use the simd not wider than it, for test and benchmark.
+void SetSimd(Simd simd);
+
+struct SGDParam {
+  float lr;
+
+  bool has_weight_decay;
+  float weight_decay;
+
+  bool has_momentum;
+  float momentum;
+  float dampening;
+  bool nesterov;
+
+  // The rows have not been updated, the momentum buffer will be set to grad.
+  bool first;
+};
+
+struct AdagradParam {
+  float lr;
+
+  bool has_weight_decay;
+  float weight_decay;
+
+  float eps;
+};
+
+struct RMSpropParam {
+  float lr;
+
+  bool has_weight_decay;
+  float weight_decay;
+
+  bool has_momentum;
+  float momentum;
+
+  float alpha;
+  float eps;
+
+  bool centered;
+};
+
+struct AdamParam {
+  float lr;
+
+  bool has_weight_decay;
+  float weight_decay;
+
+  float beta1;
+  float beta2;
+  float eps;
+
+  bool amsgrad;
+
+  // 1 - beta^steps, all rows must have same steps.
+  float bias_correction1;
+  float bias_correction2;
+};
+
+template <typename T>
+void SGD(const SGDParam& p, int64_t dimension, int64_t n, T* const* vals,
+         T* const* momentum_buffers, const T* const* grads);
+
+template <typename T>
+void Adagrad(const AdagradParam& p, int64_t dimension, int64_t n,
+             T* const* vals, T* const* state_sums, const T* const* grads);
+
+template <typename T>
+void RMSprop(const RMSpropParam& p, int64_t dimension, int64_t n,
+             T* const* vals, T* const* square_averages, T* const* g_aves,
+             T* const* momentum_buffers, const T* const* grads);
+
+template <typename T>
+void Adam(const AdamParam& p, int64_t dimension, int64_t n, T* const* vals,
+          T* const* first_moments, T* const* second_moments,
+          T* const* second_moment_maxs, const T* const* grads);
+
+}  // namespace kernel
+}  // namespace kraken
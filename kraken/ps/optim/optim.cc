@@ -1,5 +1,6 @@
 #include "ps/optim/optim.h"
 
+#include "common/error_code.h"
 #include "common/utils.h"
 #include "ps/optim/adagrad.h"
 #include "ps/optim/adam.h"
@@ -11,10 +12,79 @@ namespace kraken {
 Optim::Optim(OptimType optim_type) : optim_type_(optim_type) {
 }
 
+int32_t Optim::RowGrads(const RowLayout& layout,
+                        const std::vector<char*>& rows,
+                        const std::vector<const Tensor*>& grads,
+                        std::vector<char*>* valid_rows,
+                        std::vector<Tensor>* dense_grads) const {
+  valid_rows->clear();
+  valid_rows->reserve(rows.size());
+
+  dense_grads->clear();
+  dense_grads->reserve(rows.size());
+
+  for (size_t i = 0; i < rows.size(); ++i) {
+    Tensor grad_t = *(grads[i]);
+    if (grad_t.IsCoo()) {
+      if (grad_t.indices().IsEmpty()) {
+        continue;
+      }
+
+      grad_t = grad_t.ToDense();
+    }
+
+    if (grad_t.Size() != layout.dimension() ||
+        grad_t.element_type() != layout.element_type()) {
+      return ErrorCode::kGradientUnCompatibleError;
+    }
+
+    valid_rows->emplace_back(rows[i]);
+    dense_grads->emplace_back(std::move(grad_t));
+  }
+
+  return ErrorCode::kSuccess;
+}
+
 OptimType Optim::optim_type() const {
   return optim_type_;
 }
 
+int32_t Optim::Update(const RowLayout& layout, char* row, const Tensor& grad,
+                      float lr) const {
+  std::vector<char*> rows = {row};
+  std::vector<const Tensor*> grads = {&grad};
+
+  return UpdateBatch(layout, rows, grads, lr);
+}
+
+int32_t Optim::UpdateBatch(const RowLayout& layout,
+                           const std::vector<char*>& rows,
+                           const std::vector<const Tensor*>& grads,
+                           float lr) const {
+  for (size_t i = 0; i < rows.size(); ++i) {
+    // Empty Coo grad, nothing to update.
+    if (grads[i]->IsCoo() && grads[i]->indices().IsEmpty()) {
+      continue;
+    }
+
+    int64_t steps = *(layout.Steps(rows[i]));
+
+    // The Value share memory with the row.
+    Value value;
+    layout.View(rows[i], &value);
+
+    int32_t error_code = Update(*(grads[i]), lr, &value);
+    if (error_code != ErrorCode::kSuccess) {
+      return error_code;
+    }
+
+    layout.Store(value, rows[i]);
+    *(layout.Steps(rows[i])) = steps + 1;
+  }
+
+  return ErrorCode::kSuccess;
+}
+
 std::unique_ptr<Optim> Optim::Create(
     OptimType optim_type,
     const std::unordered_map<std::string, std::string>& optim_conf) {
@@ -3,8 +3,10 @@
 #include <cinttypes>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "common/info.h"
+#include "ps/storage/row_layout.h"
 #include "t/tensor.h"
 
 namespace kraken {
@@ -16,13 +18,37 @@ protected:
 protected:
   Optim(OptimType optim_type);
 
+  // Convert the grads to Dense and check them with the rows. The rows with an
+  // empty Coo grad are skipped, the left rows are put into valid_rows.
+  int32_t RowGrads(const RowLayout& layout, const std::vector<char*>& rows,
+                   const std::vector<const Tensor*>& grads,
+                   std::vector<char*>* valid_rows,
+                   std::vector<Tensor>* dense_grads) const;
+
 public:
   virtual ~Optim() = default;
 
   OptimType optim_type() const;
 
+  // The states this optim need keep for every row, SparseTable use it to
+  // decide the row's layout.
+  virtual std::vector<StateType> StateTypes() const = 0;
+
   virtual int32_t Update(const Tensor& grad, float lr, Value* value) const = 0;
 
+  // Update a SparseTable row in place, same as UpdateBatch with one row.
+  int32_t Update(const RowLayout& layout, char* row, const Tensor& grad,
+                 float lr) const;
+
+  // Update a batch of SparseTable rows in place, the row's states is ordered
+  // by StateTypes and the rows must be different. The default one view every
+  // row as a Value and call Update, the sub class override it by the fused
+  // kernels.
+  virtual int32_t UpdateBatch(const RowLayout& layout,
+                              const std::vector<char*>& rows,
+                              const std::vector<const Tensor*>& grads,
+                              float lr) const;
+
 public:
   static std::unique_ptr<Optim> Create(
       OptimType optim_type,
@@ -4,10 +4,71 @@
 
 #include "common/error_code.h"
 #include "common/log.h"
+#include "ps/optim/kernel.h"
 #include "ps/table.h"
 
 namespace kraken {
 
+namespace {
+
+template <typename T>
+void RMSpropRows(const kernel::RMSpropParam& p, const RowLayout& layout,
+                 const std::vector<char*>& rows,
+                 const std::vector<Tensor>& grads) {
+  size_t n = rows.size();
+
+  std::vector<T*> vals(n);
+  std::vector<T*> square_averages(n);
+  std::vector<T*> g_aves(n, nullptr);
+  std::vector<T*> bufs(n, nullptr);
+  std::vector<const T*> gs(n);
+
+  for (size_t i = 0; i < n; ++i) {
+    // The states order: square_average, [g_ave], [momentum_buffer].
+    size_t idx = 0;
+
+    vals[i] = (T*)layout.Val(rows[i]);
+    square_averages[i] = (T*)layout.State(rows[i], idx++);
+    if (p.centered) {
+      g_aves[i] = (T*)layout.State(rows[i], idx++);
+    }
+
+    if (p.has_momentum) {
+      bufs[i] = (T*)layout.State(rows[i], idx++);
+    }
+
+    gs[i] = grads[i].Data<T>();
+  }
+
+  kernel::RMSprop<T>(p, layout.dimension(), n, vals.data(),
+                     square_averages.data(), g_aves.data(), bufs.data(),
+                     gs.data());
+}
+
+template <typename T>
+void RMSpropValue(const kernel::RMSpropParam& p, const Tensor& grad,
+                  Value* value) {
+  T* val = value->val.Data<T>();
+  T* square_average = value->states[StateType::kSquareAverage].Data<T>();
+  T* g_ave = nullptr;
+  T* buf = nullptr;
+
+  if (p.centered) {
+    g_ave = value->states[StateType::kGAve].Data<T>();
+  }
+
+  if (p.has_momentum) {
+    buf = value->states[StateType::kMomentumBuffer].Data<T>();
+  }
+
+  const T* g = grad.Data<T>();
+
+  kernel::RMSprop<T>(p, value->val.Size(), 1, &val, &square_average, &g_ave,
+                     &buf, &g);
+}
+
+}  // namespace
+
 RMSprop::RMSprop(bool has_weight_decay, float weight_decay, bool has_momentum,
                  float momentum, float alpha, float eps, bool centered)
     : Optim(OptimType::kRMSprop),
@@ -20,6 +81,19 @@ RMSprop::RMSprop(bool has_weight_decay, float weight_decay, bool has_momentum,
       centered_(centered) {
 }
 
+std::vector<StateType> RMSprop::StateTypes() const {
+  std::vector<StateType> state_types = {StateType::kSquareAverage};
+  if (centered_) {
+    state_types.emplace_back(StateType::kGAve);
+  }
+
+  if (has_momentum_) {
+    state_types.emplace_back(StateType::kMomentumBuffer);
+  }
+
+  return state_types;
+}
+
 int32_t RMSprop::Update(const Tensor& grad, float lr, Value* value) const {
   // Grad maybe Coo tensor.
   Tensor grad_t = grad;
@@ -36,6 +110,23 @@ int32_t RMSprop::Update(const Tensor& grad, float lr, Value* value) const {
     return ErrorCode::kGradientUnCompatibleError;
   }
 
+  ElementType etype = grad_t.element_type();
+  if (etype.Is<float>() || etype.Is<double>()) {
+    for (auto state_type : StateTypes()) {
+      if (value->states.find(state_type) == value->states.end()) {
+        value->states.emplace(state_type, grad_t.Like().Zero());
+      }
+    }
+
+    if (etype.Is<float>()) {
+      RMSpropValue<float>(KernelParam(lr), grad_t, value);
+    } else {
+      RMSpropValue<double>(KernelParam(lr), grad_t, value);
+    }
+
+    return ErrorCode::kSuccess;
+  }
+
   if (has_weight_decay_) {
     grad_t += weight_decay_ * value->val;
   }
@@ -77,4 +168,49 @@ int32_t RMSprop::Update(const Tensor& grad, float lr, Value* value) const {
   return ErrorCode::kSuccess;
 }
 
+int32_t RMSprop::UpdateBatch(const RowLayout& layout,
+                             const std::vector<char*>& rows,
+                             const std::vector<const Tensor*>& grads,
+                             float lr) const {
+  ElementType etype = layout.element_type();
+  if (etype.Is<float>() == false && etype.Is<double>() == false) {
+    return Optim::UpdateBatch(layout, rows, grads, lr);
+  }
+
+  std::vector<char*> valid_rows;
+  std::vector<Tensor> dense_grads;
+
+  int32_t error_code =
+      RowGrads(layout, rows, grads, &valid_rows, &dense_grads);
+  if (error_code != ErrorCode::kSuccess) {
+    return error_code;
+  }
+
+  if (etype.Is<float>()) {
+    RMSpropRows<float>(KernelParam(lr), layout, valid_rows, dense_grads);
+  } else {
+    RMSpropRows<double>(KernelParam(lr), layout, valid_rows, dense_grads);
+  }
+
+  for (auto row : valid_rows) {
+    *(layout.Steps(row)) += 1;
+  }
+
+  return ErrorCode::kSuccess;
+}
+
+kernel::RMSpropParam RMSprop::KernelParam(float lr) const {
+  kernel::RMSpropParam p;
+  p.lr = lr;
+  p.has_weight_decay = has_weight_decay_;
+  p.weight_decay = weight_decay_;
+  p.has_momentum = has_momentum_;
+  p.momentum = momentum_;
+  p.alpha = alpha_;
+  p.eps = eps_;
+  p.centered = centered_;
+
+  return p;
+}
+
 }  // namespace kraken
@@ -1,15 +1,81 @@
 #include "ps/optim/sgd.h"
 
+#include <algorithm>
 #include <iostream>
+#include <numeric>
 #include <sstream>
 #include <string>
 
 #include "common/error_code.h"
 #include "common/log.h"
+#include "ps/optim/kernel.h"
 #include "ps/table.h"
 
 namespace kraken {
 
+namespace {
+
+template <typename T>
+void SGDRows(kernel::SGDParam p, const RowLayout& layout,
+             const std::vector<char*>& rows,
+             const std::vector<Tensor>& grads) {
+  // The rows that never be updated should set the momentum buffer to grad, so
+  // put them in front and update them in a separate call.
+  std::vector<size_t> idxs(rows.size());
+  std::iota(idxs.begin(), idxs.end(), 0);
+
+  auto mid = std::stable_partition(
+      idxs.begin(), idxs.end(), [&layout, &rows](size_t i) {
+        return layout.Steps((const char*)rows[i]) == 0;
+      });
+
+  size_t n = idxs.size();
+  size_t first_count = mid - idxs.begin();
+
+  std::vector<T*> vals(n);
+  std::vector<T*> bufs(n, nullptr);
+  std::vector<const T*> gs(n);
+
+  for (size_t i = 0; i < n; ++i) {
+    char* row = rows[idxs[i]];
+
+    vals[i] = (T*)layout.Val(row);
+    if (p.has_momentum) {
+      bufs[i] = (T*)layout.State(row, 0);
+    }
+
+    gs[i] = grads[idxs[i]].Data<T>();
+  }
+
+  if (first_count > 0) {
+    p.first = true;
+    kernel::SGD<T>(p, layout.dimension(), first_count, vals.data(),
+                   bufs.data(), gs.data());
+  }
+
+  if (first_count < n) {
+    p.first = false;
+    kernel::SGD<T>(p, layout.dimension(), n - first_count,
+                   vals.data() + first_count, bufs.data() + first_count,
+                   gs.data() + first_count);
+  }
+}
+
+template <typename T>
+void SGDValue(const kernel::SGDParam& p, const Tensor& grad, Value* value) {
+  T* val = value->val.Data<T>();
+  T* buf = nullptr;
+  if (p.has_momentum) {
+    buf = value->states[StateType::kMomentumBuffer].Data<T>();
+  }
+
+  const T* g = grad.Data<T>();
+
+  kernel::SGD<T>(p, value->val.Size(), 1, &val, &buf, &g);
+}
+
+}  // namespace
+
 SGD::SGD(bool has_weight_decay, float weight_decay, bool has_momentum,
          float momentum, bool has_dampening, float dampening, bool nesterov)
     : Optim(OptimType::kSGD),
@@ -22,6 +88,14 @@ SGD::SGD(bool has_weight_decay, float weight_decay, bool has_momentum,
       nesterov_(nesterov) {
 }
 
+std::vector<StateType> SGD::StateTypes() const {
+  if (has_momentum_) {
+    return {StateType::kMomentumBuffer};
+  }
+
+  return {};
+}
+
 int32_t SGD::Update(const Tensor& grad, float lr, Value* value) const {
   // Grad maybe Coo tensor.
   Tensor grad_t = grad;
@@ -38,6 +112,25 @@ int32_t SGD::Update(const Tensor& grad, float lr, Value* value) const {
     return ErrorCode::kGradientUnCompatibleError;
   }
 
+  ElementType etype = grad_t.element_type();
+  if (etype.Is<float>() || etype.Is<double>()) {
+    kernel::SGDParam p = KernelParam(lr);
+
+    if (has_momentum_ && value->states.find(StateType::kMomentumBuffer) ==
+                             value->states.end()) {
+      value->states.emplace(StateType::kMomentumBuffer, grad_t.Like());
+      p.first = true;
+    }
+
+    if (etype.Is<float>()) {
+      SGDValue<float>(p, grad_t, value);
+    } else {
+      SGDValue<double>(p, grad_t, value);
+    }
+
+    return ErrorCode::kSuccess;
+  }
+
   if (has_weight_decay_) {
     grad_t += weight_decay_ * (value->val);
   }
@@ -62,4 +155,49 @@ int32_t SGD::Update(const Tensor& grad, float lr, Value* value) const {
   return ErrorCode::kSuccess;
 }
 
+int32_t SGD::UpdateBatch(const RowLayout& layout,
+                         const std::vector<char*>& rows,
+                         const std::vector<const Tensor*>& grads,
+                         float lr) const {
+  ElementType etype = layout.element_type();
+  if (etype.Is<float>() == false && etype.Is<double>() == false) {
+    return Optim::UpdateBatch(layout, rows, grads, lr);
+  }
+
+  std::vector<char*> valid_rows;
+  std::vector<Tensor> dense_grads;
+
+  int32_t error_code =
+      RowGrads(layout, rows, grads, &valid_rows, &dense_grads);
+  if (error_code != ErrorCode::kSuccess) {
+    return error_code;
+  }
+
+  if (etype.Is<float>()) {
+    SGDRows<float>(KernelParam(lr), layout, valid_rows, dense_grads);
+  } else {
+    SGDRows<double>(KernelParam(lr), layout, valid_rows, dense_grads);
+  }
+
+  for (auto row : valid_rows) {
+    *(layout.Steps(row)) += 1;
+  }
+
+  return ErrorCode::kSuccess;
+}
+
+kernel::SGDParam SGD::KernelParam(float lr) const {
+  kernel::SGDParam p;
+  p.lr = lr;
+  p.has_weight_decay = has_weight_decay_;
+  p.weight_decay = weight_decay_;
+  p.has_momentum = has_momentum_;
+  p.momentum = momentum_;
+  p.dampening = dampening_;
+  p.nesterov = nesterov_;
+  p.first = false;
+
+  return p;
+}
+
 }  // namespace kraken
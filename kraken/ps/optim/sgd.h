@@ -2,6 +2,7 @@
 
 #include <string>
 
+#include "ps/optim/kernel.h"
 #include "ps/optim/optim.h"
 #include "t/tensor.h"
 
@@ -25,7 +26,16 @@ public:
   SGD(bool has_weight_decay, float weight_decay, bool has_momentum,
       float momentum, bool has_dampening, float dampening, bool nesterov);
 
+  std::vector<StateType> StateTypes() const override;
+
   int32_t Update(const Tensor& grad, float lr, Value* value) const override;
+
+  int32_t UpdateBatch(const RowLayout& layout, const std::vector<char*>& rows,
+                      const std::vector<const Tensor*>& grads,
+                      float lr) const override;
+
+private:
+  kernel::SGDParam KernelParam(float lr) const;
 };
 
 }  // namespace kraken
@@ -85,7 +85,8 @@ int32_t Proxy::TryCombineFetchDenseTable(const std::vector<uint64_t>& table_ids,
 int32_t Proxy::TryFetchSparseMetaData(
     uint64_t table_id, std::string* name, int64_t* dimension,
     ElementType* element_type, InitializerType* init_type,
-    std::unordered_map<std::string, std::string>* init_conf) {
+    std::unordered_map<std::string, std::string>* init_conf,
+    std::unordered_map<std::string, std::string>* table_conf) {
   uint64_t node_id = router_.Hit(utils::Hash(table_id));
 
   TryFetchSparseMetaDataRequest req;
@@ -103,6 +104,7 @@ int32_t Proxy::TryFetchSparseMetaData(
   *element_type = reply.element_type;
   *init_type = reply.init_type;
   *init_conf = reply.init_conf;
+  *table_conf = reply.table_conf;
 
   return ErrorCode::kSuccess;
 }
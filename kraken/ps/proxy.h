@@ -37,7 +37,8 @@ public:
   int32_t TryFetchSparseMetaData(
       uint64_t table_id, std::string* name, int64_t* dimension,
       ElementType* element_type, InitializerType* init_type,
-      std::unordered_map<std::string, std::string>* init_conf);
+      std::unordered_map<std::string, std::string>* init_conf,
+      std::unordered_map<std::string, std::string>* table_conf);
 
   int32_t TryFetchSparseValues(uint64_t table_id,
                                const std::vector<uint64_t>& sparse_ids,
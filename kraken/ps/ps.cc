@@ -1,5 +1,7 @@
 #include "ps/ps.h"
 
+#include <algorithm>
+#include <chrono>
 #include <thread>
 
 #include "common/error_code.h"
@@ -23,7 +25,19 @@ Ps::Ps(const std::string& addr, const std::string& s_addr,
       checkpoint_exec_(saved_dir, max_save_count),
       status_(NodeStatus::kInit),
       node_id_(0),
-      model_init_(false) {
+      model_init_(false),
+      sweeper_stop_(false) {
+  sweeper_ = std::thread(&Ps::SweepLoop, this);
+}
+
+Ps::~Ps() {
+  {
+    std::unique_lock<std::mutex> lock(sweeper_mu_);
+    sweeper_stop_ = true;
+  }
+
+  sweeper_cond_.notify_all();
+  sweeper_.join();
 }
 
 void Ps::CleanDenseTables() {
@@ -95,17 +109,12 @@ void Ps::CleanSparseTables() {
     size_t remove_c = 0;
 
     for (size_t slot = 0; slot < parallel_vals->slot_count(); ++slot) {
-      auto h = parallel_vals->UniqueSkipListHandler(slot);
-
-      auto sit = h.skip_list.Begin();
-      while (sit.Valid()) {
-        if (router.Hit(utils::Hash(it.key(), sit.key())) != node_id) {
-          sit = h.skip_list.Remove(sit);
-          remove_c++;
-        } else {
-          sit.Next();
-        }
-      }
+      auto h = parallel_vals->UniqueSlotHandler(slot);
+
+      remove_c += parallel_vals->RemoveIf(
+          slot, [&router, node_id, table_id](uint64_t sparse_id, const char*) {
+            return router.Hit(utils::Hash(table_id, sparse_id)) != node_id;
+          });
     }
 
     LOG_INFO("Clean SparseValues from SparseTable:[" << table_id << "], count:["
@@ -122,6 +131,42 @@ void Ps::CleanTables() {
   CleanSparseTables();
 }
 
+void Ps::SweepSparseTables() {
+  uint64_t table_id = 0;
+
+  while (true) {
+    std::shared_lock<std::shared_mutex> ll(model_mu_);
+
+    auto it = tables_.FindGreaterOrEqual(table_id);
+    if (it.Valid() == false) {
+      break;
+    }
+
+    if (it.value()->type() == TableType::kSparse) {
+      ((SparseTable*)it.value().get())->Sweep();
+    }
+
+    table_id = it.key() + 1;
+  }
+}
+
+void Ps::SweepLoop() {
+  std::unique_lock<std::mutex> lock(sweeper_mu_);
+
+  while (true) {
+    sweeper_cond_.wait_for(lock, std::chrono::milliseconds(kSweepIntervalMs),
+                           [this]() { return sweeper_stop_; });
+
+    if (sweeper_stop_) {
+      break;
+    }
+
+    lock.unlock();
+    SweepSparseTables();
+    lock.lock();
+  }
+}
+
 void Ps::TransferDenseTableTo(const Transfer& transfer, uint64_t target_id) {
   Router router;
   uint64_t node_id;
@@ -195,6 +240,7 @@ void Ps::TransferSparseMetaDataTo(const Transfer& transfer,
   ElementType element_type;
   InitializerType init_type;
   std::unordered_map<std::string, std::string> init_conf;
+  std::unordered_map<std::string, std::string> table_conf;
 
   while (true) {
     {
@@ -219,14 +265,15 @@ void Ps::TransferSparseMetaDataTo(const Transfer& transfer,
       element_type = table->element_type();
       init_type = table->initializer()->type();
       init_conf = table->initializer()->conf();
+      table_conf = table->table_conf();
 
       // Jump to next SparseTable.
       table_id_offset = it.key() + 1;
     }
 
     RPC_CALL(transfer.TransferSparseMetaData(node_id, table_id, name, dimension,
-                                             element_type, init_type,
-                                             init_conf));
+                                             element_type, init_type, init_conf,
+                                             table_conf));
 
     LOG_INFO("Transfer SparseTable:[" << table_id << "] MetaData to node:["
                                       << target_id << "]");
@@ -246,21 +293,25 @@ void Ps::TransferSparseValuesTo(const Transfer& transfer, uint64_t target_id) {
 
   uint64_t table_id_offset = 0;
   size_t slot_id_offset = 0;
-  uint64_t sparse_id_offset = 0;
 
   const size_t step = 1024;
 
   uint64_t table_id = 0;
 
+  // The sparse ids of current slot that belong to target node.
+  std::vector<uint64_t> slot_sparse_ids;
+
   std::vector<uint64_t> sparse_ids;
   sparse_ids.reserve(step);
 
+  std::vector<uint64_t> exist_sparse_ids;
+  exist_sparse_ids.reserve(step);
+
   std::vector<Value> sparse_vals;
   sparse_vals.reserve(step);
 
   while (true) {
-    sparse_ids.clear();
-    sparse_vals.clear();
+    slot_sparse_ids.clear();
 
     {
       std::shared_lock<std::shared_mutex> _(model_mu_);
@@ -274,7 +325,6 @@ void Ps::TransferSparseValuesTo(const Transfer& transfer, uint64_t target_id) {
         // Jump to next SparseTable.
         table_id_offset = it.key() + 1;
         slot_id_offset = 0;
-        sparse_id_offset = 0;
 
         continue;
       }
@@ -283,7 +333,6 @@ void Ps::TransferSparseValuesTo(const Transfer& transfer, uint64_t target_id) {
       if (table_id_offset != it.key()) {
         table_id_offset = it.key();
         slot_id_offset = 0;
-        sparse_id_offset = 0;
       }
 
       SparseTable* table = (SparseTable*)it.value().get();
@@ -293,7 +342,6 @@ void Ps::TransferSparseValuesTo(const Transfer& transfer, uint64_t target_id) {
       if (slot_id_offset >= parallel_vals->slot_count()) {
         table_id_offset = it.key() + 1;
         slot_id_offset = 0;
-        sparse_id_offset = 0;
 
         continue;
       }
@@ -301,33 +349,55 @@ void Ps::TransferSparseValuesTo(const Transfer& transfer, uint64_t target_id) {
       // Store the real table id.
       table_id = it.key();
 
-      auto h = parallel_vals->SharedSkipListHandler(slot_id_offset);
-      auto sit = h.skip_list.FindGreaterOrEqual(sparse_id_offset);
-
-      while (sparse_ids.size() < step && sit.Valid()) {
-        if (router.Hit(utils::Hash(it.key(), sit.key())) == target_id) {
-          sparse_ids.emplace_back(sit.key());
-          sparse_vals.emplace_back(sit.value());
+      // Not every storage is ordered (like HashMapStorage) and it maybe
+      // rehashed when we release the lock, so snapshot the sparse ids of the
+      // slot at first.
+      auto h = parallel_vals->SharedSlotHandler(slot_id_offset);
+      auto func = [&router, &slot_sparse_ids, table_id, target_id](
+                      uint64_t sparse_id, const char*) {
+        if (router.Hit(utils::Hash(table_id, sparse_id)) == target_id) {
+          slot_sparse_ids.emplace_back(sparse_id);
         }
 
-        sit.Next();
-      }
+        return true;
+      };
 
-      if (sit.Valid() == false) {
-        slot_id_offset++;
-        sparse_id_offset = 0;
-      } else {
-        sparse_id_offset = sit.key();
-      }
+      // The spilled rows also need to be transferred.
+      parallel_vals->ForEach(slot_id_offset, func);
+      parallel_vals->ForEachCold(slot_id_offset, func);
+
+      slot_id_offset++;
     }
 
-    if (sparse_ids.empty() == false) {
-      RPC_CALL(transfer.TransferSparseValues(node_id, table_id, sparse_ids,
-                                             sparse_vals));
+    for (size_t i = 0; i < slot_sparse_ids.size(); i += step) {
+      size_t end = std::min(i + step, slot_sparse_ids.size());
+
+      sparse_ids.assign(slot_sparse_ids.begin() + i,
+                        slot_sparse_ids.begin() + end);
+      exist_sparse_ids.clear();
+      sparse_vals.clear();
+
+      {
+        std::shared_lock<std::shared_mutex> _(model_mu_);
+
+        auto it = tables_.Find(table_id);
+        if (it.Valid() == false) {
+          break;
+        }
+
+        SparseTable* table = (SparseTable*)it.value().get();
+        table->mutable_vals()->Fetch(sparse_ids, &exist_sparse_ids,
+                                     &sparse_vals);
+      }
+
+      if (exist_sparse_ids.empty() == false) {
+        RPC_CALL(transfer.TransferSparseValues(node_id, table_id,
+                                               exist_sparse_ids, sparse_vals));
 
-      LOG_INFO("Transfer SparseValues of SparseTable:["
-               << table_id << "] to node:[" << target_id << "], count:["
-               << sparse_ids.size() << "]");
+        LOG_INFO("Transfer SparseValues of SparseTable:["
+                 << table_id << "] to node:[" << target_id << "], count:["
+                 << exist_sparse_ids.size() << "]");
+      }
     }
   }
 }
@@ -484,6 +554,48 @@ int32_t Ps::Heartbeat(uint32_t* status) {
   return ErrorCode::kSuccess;
 }
 
+bool Ps::NeedFetch(uint64_t table_id) {
+  std::shared_lock<std::shared_mutex> l(mu_);
+
+  if (!(status_ & NodeStatus::kProxy)) {
+    return false;
+  }
+
+  std::shared_lock<std::shared_mutex> ll(model_mu_);
+
+  return tables_.Find(table_id).Valid() == false;
+}
+
+bool Ps::NeedFetch(uint64_t table_id, const std::vector<uint64_t>& sparse_ids) {
+  std::shared_lock<std::shared_mutex> l(mu_);
+
+  if (!(status_ & NodeStatus::kProxy)) {
+    return false;
+  }
+
+  std::shared_lock<std::shared_mutex> ll(model_mu_);
+
+  auto it = tables_.Find(table_id);
+  if (it.Valid() == false) {
+    return true;
+  }
+
+  // Not a SparseTable, the request fail directly.
+  if (it.value()->type() != TableType::kSparse) {
+    return false;
+  }
+
+  SparseTable* table = (SparseTable*)it.value().get();
+
+  for (auto sparse_id : sparse_ids) {
+    if (table->mutable_vals()->Contains(sparse_id) == false) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
 int32_t Ps::NotifySaveModel(const ModelMetaData& model_mdata) {
   std::unique_lock<std::shared_mutex> _(mu_);
 
@@ -648,7 +760,9 @@ int32_t Ps::CreateDenseTable(uint64_t table_id, std::string name,
     return ErrorCode::kSuccess;
   }
 
-  std::unique_ptr<DenseTable> table(new DenseTable(table_id, name, val));
+  // The val maybe alias the request message, clone to own it.
+  std::unique_ptr<DenseTable> table(
+      new DenseTable(table_id, name, val.Clone()));
 
   tables_.Insert(table_id, std::move(table));
 
@@ -662,7 +776,8 @@ int32_t Ps::CreateDenseTable(uint64_t table_id, std::string name,
 int32_t Ps::CreateSparseTable(
     uint64_t table_id, std::string name, int64_t dimension,
     ElementType element_type, InitializerType init_type,
-    const std::unordered_map<std::string, std::string>& init_conf) {
+    const std::unordered_map<std::string, std::string>& init_conf,
+    const std::unordered_map<std::string, std::string>& table_conf) {
   std::shared_lock<std::shared_mutex> l(mu_);
   if (!(status_ & NodeStatus::kWork)) {
     return ErrorCode::kNodeStatusError;
@@ -670,6 +785,11 @@ int32_t Ps::CreateSparseTable(
 
   std::unique_lock<std::shared_mutex> ll(model_mu_);
 
+  // The SparseTable's row layout depend on the Optim.
+  if (model_init_ == false) {
+    return ErrorCode::kModelNotInitializedError;
+  }
+
   if (dimension <= 0) {
     return ErrorCode::kSparseDimensionError;
   }
@@ -688,14 +808,16 @@ int32_t Ps::CreateSparseTable(
   }
 
   std::unique_ptr<SparseTable> table(new SparseTable(
-      table_id, name, dimension, element_type, std::move(initializer)));
+      table_id, name, dimension, element_type, std::move(initializer),
+      table_conf, optim_.get(), node_id_));
 
   tables_.Insert(table_id, std::move(table));
 
   LOG_INFO("Create SparseTable:["
            << name << "], id:[" << table_id << "], dimension:[" << dimension
            << "], ElementType:[" << element_type.Name() << "], init_type:["
-           << init_type << "], init_conf:[" << init_conf << "]");
+           << init_type << "], init_conf:[" << init_conf << "], table_conf:["
+           << table_conf << "]");
 
   return ErrorCode::kSuccess;
 }
@@ -751,7 +873,9 @@ int32_t Ps::TransferDenseTable(uint64_t from_node_id, uint64_t table_id,
     return ErrorCode::kSuccess;
   }
 
-  std::unique_ptr<DenseTable> table(new DenseTable(table_id, name, value));
+  // The value maybe alias the request message, clone to own it.
+  std::unique_ptr<DenseTable> table(
+      new DenseTable(table_id, name, value.Clone()));
   tables_.Insert(table_id, std::move(table));
 
   LOG_INFO("Get Transfered DenseTable:[" << table_id << "] from node:["
@@ -763,7 +887,8 @@ int32_t Ps::TransferDenseTable(uint64_t from_node_id, uint64_t table_id,
 int32_t Ps::TransferSparseMetaData(
     uint64_t from_node_id, uint64_t table_id, std::string name,
     int64_t dimension, ElementType element_type, InitializerType init_type,
-    const std::unordered_map<std::string, std::string>& init_conf) {
+    const std::unordered_map<std::string, std::string>& init_conf,
+    const std::unordered_map<std::string, std::string>& table_conf) {
   std::shared_lock<std::shared_mutex> l(mu_);
   if (status_ != (NodeStatus::kWork | NodeStatus::kProxy)) {
     return ErrorCode::kNodeStatusError;
@@ -776,6 +901,10 @@ int32_t Ps::TransferSparseMetaData(
     return ErrorCode::kSuccess;
   }
 
+  if (model_init_ == false) {
+    return ErrorCode::kModelNotInitializedError;
+  }
+
   if (dimension <= 0) {
     return ErrorCode::kSparseDimensionError;
   }
@@ -787,7 +916,8 @@ int32_t Ps::TransferSparseMetaData(
   }
 
   std::unique_ptr<SparseTable> table(new SparseTable(
-      table_id, name, dimension, element_type, std::move(initializer)));
+      table_id, name, dimension, element_type, std::move(initializer),
+      table_conf, optim_.get(), node_id_));
 
   tables_.Insert(table_id, std::move(table));
 
@@ -876,7 +1006,8 @@ int32_t Ps::TryCombineFetchDenseTable(const std::vector<uint64_t>& table_ids,
 int32_t Ps::TryFetchSparseMetaData(
     uint64_t table_id, std::string* name, int64_t* dimension,
     ElementType* element_type, InitializerType* init_type,
-    std::unordered_map<std::string, std::string>* init_conf) {
+    std::unordered_map<std::string, std::string>* init_conf,
+    std::unordered_map<std::string, std::string>* table_conf) {
   std::shared_lock<std::shared_mutex> ll(model_mu_);
 
   auto it = tables_.Find(table_id);
@@ -891,6 +1022,7 @@ int32_t Ps::TryFetchSparseMetaData(
   *element_type = table->element_type();
   *init_type = table->initializer()->type();
   *init_conf = table->initializer()->conf();
+  *table_conf = table->table_conf();
 
   return ErrorCode::kSuccess;
 }
@@ -907,33 +1039,7 @@ int32_t Ps::TryFetchSparseValues(uint64_t table_id,
   }
 
   SparseTable* table = (SparseTable*)it.value().get();
-
-  exist_sparse_ids->reserve(sparse_ids.size());
-  values->reserve(sparse_ids.size());
-
-  auto* parallel_vals = table->mutable_vals();
-
-  std::unordered_map<size_t, std::vector<size_t>> slot_idx_map;
-  slot_idx_map.reserve(parallel_vals->slot_count());
-
-  for (size_t i = 0; i < sparse_ids.size(); ++i) {
-    slot_idx_map[parallel_vals->HitSlot(sparse_ids[i])].emplace_back(
-        sparse_ids[i]);
-  }
-
-  for (auto& [slot, v] : slot_idx_map) {
-    // Lock the slot.
-    auto h = parallel_vals->SharedSkipListHandler(slot);
-
-    for (auto sparse_id : v) {
-      auto it = h.skip_list.Find(sparse_id);
-
-      if (it.Valid()) {
-        exist_sparse_ids->emplace_back(sparse_id);
-        values->emplace_back(it.value().Clone());
-      }
-    }
-  }
+  table->mutable_vals()->Fetch(sparse_ids, exist_sparse_ids, values);
 
   return ErrorCode::kSuccess;
 }
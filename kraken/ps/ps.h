@@ -1,9 +1,12 @@
 #pragma once
 
 #include <atomic>
+#include <condition_variable>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <shared_mutex>
+#include <thread>
 
 #include "checkpoint/checkpoint_exec.h"
 #include "common/async_task_queue.h"
@@ -26,6 +29,10 @@ private:
     kProxyFinishTransfer = 0,
   };
 
+  // The sweeper wake up interval, every SparseTable is swept by its own
+  // evict_interval_ms.
+  constexpr static int64_t kSweepIntervalMs = 1000;
+
   AsyncTaskQueue task_que_;
 
   // Current node address.
@@ -54,11 +61,17 @@ private:
   std::unique_ptr<Optim> optim_;
   SkipList<uint64_t, std::unique_ptr<Table>> tables_;
 
+  // One sweeper evict the rows of all SparseTables.
+  bool sweeper_stop_;
+  std::mutex sweeper_mu_;
+  std::condition_variable sweeper_cond_;
+  std::thread sweeper_;
+
 public:
   Ps(const std::string& addr, const std::string& s_addr,
      const std::string& saved_dir, size_t max_save_count);
 
-  ~Ps() = default;
+  ~Ps();
 
 private:
   inline const char* NodeStatusStr(uint32_t status) const {
@@ -86,6 +99,12 @@ private:
 
   void CleanTables();
 
+  // Sweep every SparseTable, lock one table at a time.
+  void SweepSparseTables();
+
+  // Run SweepSparseTables every kSweepIntervalMs until stopped.
+  void SweepLoop();
+
   // Transfer data to new node.
   void TransferDenseTableTo(const Transfer& transfer, uint64_t target_id);
 
@@ -106,6 +125,11 @@ private:
   void TryFetchSparseValuesFromProxy(uint64_t table_id,
                                      const std::vector<uint64_t>& sparse_ids);
 
+  // Find the SparseTable (fetch from proxy if need) then call pull.
+  int32_t PullSparseTableImpl(uint64_t router_version, uint64_t table_id,
+                              const std::vector<uint64_t>& sparse_ids,
+                              const std::function<int32_t(Table*)>& pull);
+
 public:
   // Start Ps server.
   void Start();
@@ -113,6 +137,13 @@ public:
   // Call by scheduler.
   int32_t Heartbeat(uint32_t* status);
 
+  // Whether a request of the table maybe wait a fetch from the proxied nodes:
+  // this node is proxying and the table is not here.
+  bool NeedFetch(uint64_t table_id);
+
+  // Same as above, or some of the sparse_ids are not here.
+  bool NeedFetch(uint64_t table_id, const std::vector<uint64_t>& sparse_ids);
+
   // Call by scheduler.
   int32_t NotifySaveModel(const ModelMetaData& model_mdata);
 
@@ -137,7 +168,8 @@ public:
   int32_t CreateSparseTable(
       uint64_t table_id, std::string name, int64_t dimension,
       ElementType element_type, InitializerType init_type,
-      const std::unordered_map<std::string, std::string>& init_conf);
+      const std::unordered_map<std::string, std::string>& init_conf,
+      const std::unordered_map<std::string, std::string>& table_conf);
 
   // Call by other Ps node.
   // Notify this PS other Ps has finish transfer data.
@@ -153,7 +185,8 @@ public:
   int32_t TransferSparseMetaData(
       uint64_t from_node_id, uint64_t table_id, std::string name,
       int64_t dimension, ElementType element_type, InitializerType init_type,
-      const std::unordered_map<std::string, std::string>& init_conf);
+      const std::unordered_map<std::string, std::string>& init_conf,
+      const std::unordered_map<std::string, std::string>& table_conf);
 
   // Call by other Ps node.
   // Another node transfer SparseTable Embedding to this node.
@@ -176,7 +209,8 @@ public:
   int32_t TryFetchSparseMetaData(
       uint64_t table_id, std::string* name, int64_t* dimension,
       ElementType* element_type, InitializerType* init_type,
-      std::unordered_map<std::string, std::string>* init_conf);
+      std::unordered_map<std::string, std::string>* init_conf,
+      std::unordered_map<std::string, std::string>* table_conf);
 
   // Call by other Ps node.
   int32_t TryFetchSparseValues(uint64_t table_id,
@@ -206,17 +240,38 @@ public:
                           std::vector<Tensor>* vals);
 
   // Call by Worker.
+  // Serialize the vals into buf directly without building the Tensors.
+  int32_t PullSparseTable(uint64_t router_version, uint64_t table_id,
+                          const std::vector<uint64_t>& sparse_ids,
+                          MemBuffer* buf);
+
+  // Call by Worker.
+  // Serialize the vals into buf directly as one [sparse_ids.size(), dimension]
+  // matrix.
+  int32_t PullSparseMatrix(uint64_t router_version, uint64_t table_id,
+                           const std::vector<uint64_t>& sparse_ids,
+                           MemBuffer* buf);
+
+  // Call by Worker.
+  // Lock once for all tables and pull them in parallel, every table's vals are
+  // a [sparse_ids.size(), dimension] matrix.
   int32_t CombinePullSparseTable(
       uint64_t router_version,
       const std::unordered_map<uint64_t, std::vector<uint64_t>>&
           table_sparse_ids,
-      std::unordered_map<uint64_t, std::vector<Tensor>>* table_vals);
+      std::unordered_map<uint64_t, Tensor>* table_vals);
 
   // Call by Worker.
   int32_t PushSparseTable(uint64_t router_version, uint64_t table_id,
                           const std::vector<uint64_t>& sparse_ids,
                           const std::vector<Tensor>& grads, float lr);
 
+  // Call by Worker.
+  // The grads is a [sparse_ids.size(), dimension] matrix.
+  int32_t PushSparseMatrix(uint64_t router_version, uint64_t table_id,
+                           const std::vector<uint64_t>& sparse_ids,
+                           const Tensor& grads, float lr);
+
   // Call by Worker.
   int32_t CombinePushSparseTable(
       uint64_t router_version,
@@ -1,6 +1,7 @@
 #include <thread>
 
 #include "common/log.h"
+#include "common/thread_pool.h"
 #include "ps/dense_table.h"
 #include "ps/ps.h"
 #include "ps/sparse_table.h"
@@ -62,9 +63,11 @@ void Ps::TryFetchSparseMetaDataFromProxy(uint64_t table_id) {
   ElementType element_type;
   InitializerType init_type;
   std::unordered_map<std::string, std::string> init_conf;
+  std::unordered_map<std::string, std::string> table_conf;
 
-  auto error_code = proxy_->TryFetchSparseMetaData(
-      table_id, &name, &dimension, &element_type, &init_type, &init_conf);
+  auto error_code =
+      proxy_->TryFetchSparseMetaData(table_id, &name, &dimension, &element_type,
+                                     &init_type, &init_conf, &table_conf);
 
   if (error_code == ErrorCode::kSuccess) {
     std::unique_lock<std::shared_mutex> ll(model_mu_);
@@ -73,6 +76,11 @@ void Ps::TryFetchSparseMetaDataFromProxy(uint64_t table_id) {
       return;
     }
 
+    if (model_init_ == false) {
+      LOG_ERROR("TryFetchSparseTableFromProxy before Model initialized.");
+      return;
+    }
+
     if (dimension <= 0) {
       LOG_ERROR(
           "TryFetchSparseTableFromProxy get wrong dimension:" << dimension);
@@ -88,7 +96,8 @@ void Ps::TryFetchSparseMetaDataFromProxy(uint64_t table_id) {
     }
 
     std::unique_ptr<SparseTable> table(new SparseTable(
-        table_id, name, dimension, element_type, std::move(initializer)));
+        table_id, name, dimension, element_type, std::move(initializer),
+        table_conf, optim_.get(), node_id_));
 
     tables_.Insert(table_id, std::move(table));
   } else {
@@ -299,9 +308,9 @@ int32_t Ps::PushDenseTable(uint64_t router_version, uint64_t table_id,
   }
 }
 
-int32_t Ps::PullSparseTable(uint64_t router_version, uint64_t table_id,
-                            const std::vector<uint64_t>& sparse_ids,
-                            std::vector<Tensor>* vals) {
+int32_t Ps::PullSparseTableImpl(uint64_t router_version, uint64_t table_id,
+                                const std::vector<uint64_t>& sparse_ids,
+                                const std::function<int32_t(Table*)>& pull) {
   std::shared_lock<std::shared_mutex> l(mu_);
 
   if (!(status_ & NodeStatus::kWork)) {
@@ -354,7 +363,7 @@ int32_t Ps::PullSparseTable(uint64_t router_version, uint64_t table_id,
     }
 
     // Try to pull again.
-    return it.value()->Pull(sparse_ids, vals);
+    return pull(it.value().get());
   } else {
     std::shared_lock<std::shared_mutex> ll(model_mu_);
 
@@ -363,24 +372,134 @@ int32_t Ps::PullSparseTable(uint64_t router_version, uint64_t table_id,
       return ErrorCode::kTableNotExistError;
     }
 
-    return it.value()->Pull(sparse_ids, vals);
+    return pull(it.value().get());
   }
 }
 
+int32_t Ps::PullSparseTable(uint64_t router_version, uint64_t table_id,
+                            const std::vector<uint64_t>& sparse_ids,
+                            std::vector<Tensor>* vals) {
+  return PullSparseTableImpl(
+      router_version, table_id, sparse_ids,
+      [&sparse_ids, vals](Table* table) -> int32_t {
+        return table->Pull(sparse_ids, vals);
+      });
+}
+
+int32_t Ps::PullSparseTable(uint64_t router_version, uint64_t table_id,
+                            const std::vector<uint64_t>& sparse_ids,
+                            MemBuffer* buf) {
+  return PullSparseTableImpl(
+      router_version, table_id, sparse_ids,
+      [&sparse_ids, buf](Table* table) -> int32_t {
+        return table->Pull(sparse_ids, buf);
+      });
+}
+
+int32_t Ps::PullSparseMatrix(uint64_t router_version, uint64_t table_id,
+                             const std::vector<uint64_t>& sparse_ids,
+                             MemBuffer* buf) {
+  return PullSparseTableImpl(
+      router_version, table_id, sparse_ids,
+      [&sparse_ids, buf](Table* table) -> int32_t {
+        return table->PullMatrix(sparse_ids, buf);
+      });
+}
+
 int32_t Ps::CombinePullSparseTable(
     uint64_t router_version,
     const std::unordered_map<uint64_t, std::vector<uint64_t>>& table_sparse_ids,
-    std::unordered_map<uint64_t, std::vector<Tensor>>* table_vals) {
+    std::unordered_map<uint64_t, Tensor>* table_vals) {
+  std::shared_lock<std::shared_mutex> l(mu_);
+
+  if (!(status_ & NodeStatus::kWork)) {
+    return ErrorCode::kNodeStatusError;
+  }
+
+  if (router_version != router_.version()) {
+    return ErrorCode::kRouterVersionError;
+  }
+
+  // Hold the model locker once for all tables.
+  std::shared_lock<std::shared_mutex> ll(model_mu_);
+
+  if (status_ & NodeStatus::kProxy) {
+    std::vector<uint64_t> not_exist_table_ids;
+
+    for (const auto& [table_id, _] : table_sparse_ids) {
+      if (tables_.Find(table_id).Valid() == false) {
+        not_exist_table_ids.emplace_back(table_id);
+      }
+    }
+
+    if (not_exist_table_ids.empty() == false) {
+      ll.unlock();
+      for (auto table_id : not_exist_table_ids) {
+        TryFetchSparseMetaDataFromProxy(table_id);
+      }
+      ll.lock();
+    }
+
+    // <TableId, not exist SparseIds>.
+    std::unordered_map<uint64_t, std::vector<uint64_t>> not_exist_ids;
+
+    for (const auto& [table_id, sparse_ids] : table_sparse_ids) {
+      auto it = tables_.Find(table_id);
+      if (it.Valid() == false || it.value()->type() != TableType::kSparse) {
+        return ErrorCode::kTableNotExistError;
+      }
+
+      SparseTable* table = (SparseTable*)it.value().get();
+
+      for (auto sparse_id : sparse_ids) {
+        if (table->mutable_vals()->Contains(sparse_id) == false) {
+          not_exist_ids[table_id].emplace_back(sparse_id);
+        }
+      }
+    }
+
+    if (not_exist_ids.empty() == false) {
+      ll.unlock();
+      for (const auto& [table_id, sparse_ids] : not_exist_ids) {
+        TryFetchSparseValuesFromProxy(table_id, sparse_ids);
+      }
+      ll.lock();
+    }
+  }
+
+  // Find all tables and create the reply matrix before pulling, so the tables
+  // can be pulled in parallel.
+  std::vector<const std::vector<uint64_t>*> ids;
+  std::vector<Table*> tables;
+  std::vector<Tensor*> vals;
+
+  ids.reserve(table_sparse_ids.size());
+  tables.reserve(table_sparse_ids.size());
+  vals.reserve(table_sparse_ids.size());
+  table_vals->reserve(table_sparse_ids.size());
+
   for (const auto& [table_id, sparse_ids] : table_sparse_ids) {
-    std::vector<Tensor> vals;
+    auto it = tables_.Find(table_id);
+    if (it.Valid() == false || it.value()->type() != TableType::kSparse) {
+      return ErrorCode::kTableNotExistError;
+    }
+
+    ids.emplace_back(&sparse_ids);
+    tables.emplace_back(it.value().get());
+    vals.emplace_back(&((*table_vals)[table_id]));
+  }
+
+  std::vector<int32_t> error_codes(tables.size(), ErrorCode::kSuccess);
 
-    auto error_code =
-        PullSparseTable(router_version, table_id, sparse_ids, &vals);
+  ThreadPool::Shared()->ParallelFor(
+      (int64_t)tables.size(), [&ids, &tables, &vals, &error_codes](int64_t i) {
+        error_codes[i] = tables[i]->Pull(*ids[i], vals[i]);
+      });
+
+  for (auto error_code : error_codes) {
     if (error_code != ErrorCode::kSuccess) {
       return error_code;
     }
-
-    table_vals->emplace(table_id, std::move(vals));
   }
 
   return ErrorCode::kSuccess;
@@ -453,6 +572,25 @@ int32_t Ps::PushSparseTable(uint64_t router_version, uint64_t table_id,
   }
 }
 
+int32_t Ps::PushSparseMatrix(uint64_t router_version, uint64_t table_id,
+                             const std::vector<uint64_t>& sparse_ids,
+                             const Tensor& grads, float lr) {
+  if (grads.IsDense() == false || grads.shape().NDims() != 2 ||
+      grads.shape()[0] != (int64_t)sparse_ids.size()) {
+    return ErrorCode::kGradientUnCompatibleError;
+  }
+
+  // The rows are views of the matrix, no copy.
+  std::vector<Tensor> row_grads;
+  row_grads.reserve(sparse_ids.size());
+
+  for (size_t i = 0; i < sparse_ids.size(); ++i) {
+    row_grads.emplace_back(grads.Vector(i));
+  }
+
+  return PushSparseTable(router_version, table_id, sparse_ids, row_grads, lr);
+}
+
 int32_t Ps::CombinePushSparseTable(
     uint64_t router_version,
     const std::unordered_map<uint64_t, CombinePushSparseTableItem>& table_items,
@@ -6,9 +6,10 @@ namespace kraken {
 
 PsServer::PsServer(uint32_t port, uint32_t thread_nums, const std::string& addr,
                    const std::string& s_addr, const std::string& saved_dir,
-                   size_t max_save_count)
-    : station_(port, thread_nums),
-      ps_(addr, s_addr, saved_dir, max_save_count) {
+                   size_t max_save_count, bool direct_station)
+    : station_(port, thread_nums, direct_station),
+      ps_(addr, s_addr, saved_dir, max_save_count),
+      thread_nums_(thread_nums) {
 }
 
 int32_t PsServer::Heartbeat(const HeartbeatRequest& req,
@@ -49,7 +50,8 @@ int32_t PsServer::CreateDenseTable(const CreateDenseTableRequest& req,
 int32_t PsServer::CreateSparseTable(const CreateSparseTableRequest& req,
                                     CreateSparseTableResponse* rsp) {
   return ps_.CreateSparseTable(req.table_id, req.name, req.dimension,
-                               req.element_type, req.init_type, req.init_conf);
+                               req.element_type, req.init_type, req.init_conf,
+                               req.table_conf);
 }
 
 int32_t PsServer::TransferDenseTable(const TransferDenseTableRequest& req,
@@ -63,7 +65,8 @@ int32_t PsServer::TransferSparseMetaData(
     TransferSparseMetaDataResponse* rsp) {
   return ps_.TransferSparseMetaData(req.from_node_id, req.table_id, req.name,
                                     req.dimension, req.element_type,
-                                    req.init_type, req.init_conf);
+                                    req.init_type, req.init_conf,
+                                    req.table_conf);
 }
 
 int32_t PsServer::TransferSparseValues(const TransferSparseValuesRequest& req,
@@ -89,7 +92,8 @@ int32_t PsServer::TryFetchSparseMetaData(
     TryFetchSparseMetaDataResponse* rsp) {
   return ps_.TryFetchSparseMetaData(req.table_id, &(rsp->name),
                                     &(rsp->dimension), &(rsp->element_type),
-                                    &(rsp->init_type), &(rsp->init_conf));
+                                    &(rsp->init_type), &(rsp->init_conf),
+                                    &(rsp->table_conf));
 }
 
 int32_t PsServer::TryFetchSparseValues(const TryFetchSparseValuesRequest& req,
@@ -115,9 +119,9 @@ int32_t PsServer::PushDenseTable(const PushDenseTableRequest& req,
 }
 
 int32_t PsServer::PullSparseTable(const PullSparseTableRequest& req,
-                                  PullSparseTableResponse* rsp) {
+                                  MemBuffer* buf) {
   return ps_.PullSparseTable(req.router_version, req.table_id, req.sparse_ids,
-                             &(rsp->vals));
+                             buf);
 }
 
 int32_t PsServer::CombinePullSparseTable(
@@ -140,6 +144,85 @@ int32_t PsServer::CombinePushSparseTable(
                                     req.lr);
 }
 
+int32_t PsServer::PullSparseMatrix(const PullSparseMatrixRequest& req,
+                                   MemBuffer* buf) {
+  uint8_t padding[PullSparseMatrixResponse::kPadding] = {0};
+  buf->Write((const char*)padding, sizeof(padding));
+
+  return ps_.PullSparseMatrix(req.router_version, req.table_id, req.sparse_ids,
+                              buf);
+}
+
+int32_t PsServer::PushSparseMatrix(const PushSparseMatrixRequest& req,
+                                   PushSparseMatrixResponse* rsp) {
+  return ps_.PushSparseMatrix(req.router_version, req.table_id, req.sparse_ids,
+                              req.grads, req.lr);
+}
+
+bool PsServer::NeedFetch(const PullDenseTableRequest& req) {
+  return ps_.NeedFetch(req.table_id);
+}
+
+bool PsServer::NeedFetch(const CombinePullDenseTableRequest& req) {
+  for (auto table_id : req.table_ids) {
+    if (ps_.NeedFetch(table_id)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool PsServer::NeedFetch(const PushDenseTableRequest& req) {
+  return ps_.NeedFetch(req.table_id);
+}
+
+bool PsServer::NeedFetch(const PullSparseTableRequest& req) {
+  return ps_.NeedFetch(req.table_id, req.sparse_ids);
+}
+
+bool PsServer::NeedFetch(const CombinePullSparseTableRequest& req) {
+  for (const auto& [table_id, sparse_ids] : req.table_sparse_ids) {
+    if (ps_.NeedFetch(table_id, sparse_ids)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool PsServer::NeedFetch(const PushSparseTableRequest& req) {
+  return ps_.NeedFetch(req.table_id, req.sparse_ids);
+}
+
+bool PsServer::NeedFetch(const CombinePushSparseTableRequest& req) {
+  for (const auto& [table_id, item] : req.table_items) {
+    if (ps_.NeedFetch(table_id, item.sparse_ids)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool PsServer::NeedFetch(const PullSparseMatrixRequest& req) {
+  return ps_.NeedFetch(req.table_id, req.sparse_ids);
+}
+
+bool PsServer::NeedFetch(const PushSparseMatrixRequest& req) {
+  return ps_.NeedFetch(req.table_id, req.sparse_ids);
+}
+
+AsyncTaskQueue* PsServer::ProxyQue() {
+  std::unique_lock<std::mutex> _(proxy_mu_);
+
+  if (proxy_que_ == nullptr) {
+    proxy_que_.reset(new AsyncTaskQueue(thread_nums_));
+  }
+
+  return proxy_que_.get();
+}
+
 void PsServer::RegisterFuncs() {
   using namespace std::placeholders;
 
@@ -147,6 +230,14 @@ void PsServer::RegisterFuncs() {
   station_.RegisterFunc<TYPE##Request, TYPE##Response>( \
       RPCFuncType::k##TYPE##Type, std::bind(&PsServer::FUNC, this, _1, _2));
 
+#define REGISTER_ASYNC_FUNC(TYPE, FUNC) \
+  RegisterAsyncFunc<TYPE##Request, TYPE##Response>(RPCFuncType::k##TYPE##Type, \
+                                                   &PsServer::FUNC);
+
+#define REGISTER_ASYNC_RAW_FUNC(TYPE, FUNC) \
+  RegisterAsyncRawFunc<TYPE##Request>(RPCFuncType::k##TYPE##Type, \
+                                      &PsServer::FUNC);
+
   REGISTER_FUNC(Heartbeat, Heartbeat);
   REGISTER_FUNC(NotifySaveModel, NotifySaveModel);
   REGISTER_FUNC(NotifyLoadModel, NotifyLoadModel);
@@ -162,13 +253,26 @@ void PsServer::RegisterFuncs() {
   REGISTER_FUNC(TryCombineFetchDenseTable, TryCombineFetchDenseTable);
   REGISTER_FUNC(TryFetchSparseMetaData, TryFetchSparseMetaData);
   REGISTER_FUNC(TryFetchSparseValues, TryFetchSparseValues);
-  REGISTER_FUNC(PullDenseTable, PullDenseTable);
-  REGISTER_FUNC(CombinePullDenseTable, CombinePullDenseTable);
-  REGISTER_FUNC(PushDenseTable, PushDenseTable);
-  REGISTER_FUNC(PullSparseTable, PullSparseTable);
-  REGISTER_FUNC(CombinePullSparseTable, CombinePullSparseTable);
-  REGISTER_FUNC(PushSparseTable, PushSparseTable);
-  REGISTER_FUNC(CombinePushSparseTable, CombinePushSparseTable);
+
+  // The table funcs maybe fetch from the proxied node.
+  REGISTER_ASYNC_FUNC(PullDenseTable, PullDenseTable);
+  REGISTER_ASYNC_FUNC(CombinePullDenseTable, CombinePullDenseTable);
+  REGISTER_ASYNC_FUNC(PushDenseTable, PushDenseTable);
+  REGISTER_ASYNC_RAW_FUNC(PullSparseTable, PullSparseTable);
+  REGISTER_ASYNC_FUNC(CombinePullSparseTable, CombinePullSparseTable);
+  REGISTER_ASYNC_FUNC(PushSparseTable, PushSparseTable);
+  REGISTER_ASYNC_FUNC(CombinePushSparseTable, CombinePushSparseTable);
+  REGISTER_ASYNC_RAW_FUNC(PullSparseMatrix, PullSparseMatrix);
+  REGISTER_ASYNC_FUNC(PushSparseMatrix, PushSparseMatrix);
+
+  // The dense values are float arrays, shuffle them before compress. Others
+  // reply with the request's codec. PullSparseMatrix is not forced to LZ4, a
+  // compressed reply can not be aliased by the Worker.
+  CompressPolicy dense_policy(CompressType::kLZ4, 4096, sizeof(float));
+
+  station_.SetCompressPolicy(RPCFuncType::kPullDenseTableType, dense_policy);
+  station_.SetCompressPolicy(RPCFuncType::kCombinePullDenseTableType,
+                             dense_policy);
 }
 
 void PsServer::Start() {
@@ -183,6 +287,11 @@ void PsServer::Start() {
 
 void PsServer::Stop() {
   station_.Stop();
+
+  std::unique_lock<std::mutex> _(proxy_mu_);
+  if (proxy_que_ != nullptr) {
+    proxy_que_->Stop();
+  }
 }
 
 }  // namespace kraken
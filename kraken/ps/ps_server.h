@@ -1,5 +1,9 @@
 #pragma once
 
+#include <memory>
+#include <mutex>
+
+#include "common/async_task_queue.h"
 #include "protocol/combine_pull_dense_table_prot.h"
 #include "protocol/combine_pull_sparse_table_prot.h"
 #include "protocol/create_dense_table_prot.h"
@@ -11,8 +15,10 @@
 #include "protocol/notify_node_join_prot.h"
 #include "protocol/notify_save_model_prot.h"
 #include "protocol/pull_dense_table_prot.h"
+#include "protocol/pull_sparse_matrix_prot.h"
 #include "protocol/pull_sparse_table_prot.h"
 #include "protocol/push_dense_table_prot.h"
+#include "protocol/push_sparse_matrix_prot.h"
 #include "protocol/push_sparse_table_prot.h"
 #include "protocol/transfer_dense_table_prot.h"
 #include "protocol/transfer_sparse_meta_data_prot.h"
@@ -31,10 +37,17 @@ private:
   Station station_;
   Ps ps_;
 
+  uint32_t thread_nums_;
+
+  // Run the table funcs that wait a fetch from other node, they should not
+  // block the Station threads. Created at the first fetch.
+  std::mutex proxy_mu_;
+  std::unique_ptr<AsyncTaskQueue> proxy_que_;
+
 public:
   PsServer(uint32_t port, uint32_t thread_nums, const std::string& addr,
            const std::string& s_addr, const std::string& saved_dir,
-           size_t max_save_count);
+           size_t max_save_count, bool direct_station = false);
 
 private:
   int32_t Heartbeat(const HeartbeatRequest& req, HeartbeatResponse* rsp);
@@ -89,8 +102,8 @@ private:
   int32_t PushDenseTable(const PushDenseTableRequest& req,
                          PushDenseTableResponse* rsp);
 
-  int32_t PullSparseTable(const PullSparseTableRequest& req,
-                          PullSparseTableResponse* rsp);
+  // Serialize the PullSparseTableResponse into buf directly.
+  int32_t PullSparseTable(const PullSparseTableRequest& req, MemBuffer* buf);
 
   int32_t CombinePullSparseTable(const CombinePullSparseTableRequest& req,
                                  CombinePullSparseTableResponse* rsp);
@@ -101,6 +114,80 @@ private:
   int32_t CombinePushSparseTable(const CombinePushSparseTableRequest& req,
                                  CombinePushSparseTableResponse* rsp);
 
+  // Serialize the PullSparseMatrixResponse into buf directly.
+  int32_t PullSparseMatrix(const PullSparseMatrixRequest& req, MemBuffer* buf);
+
+  int32_t PushSparseMatrix(const PushSparseMatrixRequest& req,
+                           PushSparseMatrixResponse* rsp);
+
+  // Whether the request maybe wait a fetch from the proxied nodes.
+  bool NeedFetch(const PullDenseTableRequest& req);
+
+  bool NeedFetch(const CombinePullDenseTableRequest& req);
+
+  bool NeedFetch(const PushDenseTableRequest& req);
+
+  bool NeedFetch(const PullSparseTableRequest& req);
+
+  bool NeedFetch(const CombinePullSparseTableRequest& req);
+
+  bool NeedFetch(const PushSparseTableRequest& req);
+
+  bool NeedFetch(const CombinePushSparseTableRequest& req);
+
+  bool NeedFetch(const PullSparseMatrixRequest& req);
+
+  bool NeedFetch(const PushSparseMatrixRequest& req);
+
+  AsyncTaskQueue* ProxyQue();
+
+  // Run the func in the Station thread, or in proxy_que_ if it need a fetch.
+  template <typename ReqType, typename RspType>
+  void RegisterAsyncFunc(uint32_t type,
+                         int32_t (PsServer::*func)(const ReqType&, RspType*)) {
+    station_.RegisterAsyncFunc<ReqType>(
+        type, [this, func](const ReqType& req, Station::Completion done) {
+          auto run = [this, func](const ReqType& req,
+                                  const Station::Completion& done) {
+            RspType rsp;
+            int32_t error_code = (this->*func)(req, &rsp);
+
+            if (error_code == ErrorCode::kSuccess) {
+              done.Done(rsp);
+            } else {
+              done.Error(error_code);
+            }
+          };
+
+          if (NeedFetch(req) == false) {
+            run(req, done);
+          } else {
+            ProxyQue()->Enque([run, req, done]() { run(req, done); });
+          }
+        });
+  }
+
+  template <typename ReqType>
+  void RegisterAsyncRawFunc(uint32_t type,
+                            int32_t (PsServer::*func)(const ReqType&,
+                                                      MemBuffer*)) {
+    station_.RegisterAsyncFunc<ReqType>(
+        type, [this, func](const ReqType& req, Station::Completion done) {
+          auto run = [this, func](const ReqType& req,
+                                  const Station::Completion& done) {
+            done.DoneRaw([this, func, &req](MemBuffer* buf) -> int32_t {
+              return (this->*func)(req, buf);
+            });
+          };
+
+          if (NeedFetch(req) == false) {
+            run(req, done);
+          } else {
+            ProxyQue()->Enque([run, req, done]() { run(req, done); });
+          }
+        });
+  }
+
   void RegisterFuncs();
 
 public:
@@ -1,17 +1,147 @@
 #include "ps/sparse_table.h"
 
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstring>
+
 #include "common/exception.h"
+#include "common/log.h"
+#include "common/serialize.h"
+#include "common/thread_pool.h"
+#include "common/utils.h"
 
 namespace kraken {
 
+namespace {
+
+// Parse the table_conf "store_type", only the float table can be stored in a
+// compact type.
+ElementType ParseStoreType(
+    const std::unordered_map<std::string, std::string>& table_conf,
+    ElementType element_type) {
+  std::string store_type;
+  if (utils::ParseConf<std::string>(table_conf, "store_type", &store_type) ==
+      false) {
+    return element_type;
+  }
+
+  store_type = utils::ToLower(store_type);
+
+  if (element_type.Is<float>() == false) {
+    LOG_WARNING("The " << element_type.Name()
+                       << " SparseTable not support store_type:["
+                       << store_type << "], ignore it.");
+    return element_type;
+  }
+
+  if (store_type == "float16") {
+    return ElementType::From<half>();
+  } else if (store_type == "bfloat16") {
+    return ElementType::From<bfloat16>();
+  } else if (store_type == "int8") {
+    return ElementType::From<int8_t>();
+  } else if (store_type != "float32") {
+    LOG_WARNING("Unrecognized store_type:[" << store_type
+                                            << "], use float32.");
+  }
+
+  return element_type;
+}
+
+}  // namespace
+
 SparseTable::SparseTable(uint64_t id, const std::string& name,
                          int64_t dimension, ElementType element_type,
-                         std::unique_ptr<Initializer>&& initializer)
+                         std::unique_ptr<Initializer>&& initializer,
+                         const std::unordered_map<std::string, std::string>&
+                             table_conf,
+                         const Optim* optim, uint64_t node_id)
     : Table(TableType::kSparse, id, name),
       dimension_(dimension),
       element_type_(element_type),
       initializer_(std::move(initializer)),
-      vals_() {
+      table_conf_(table_conf),
+      pull_type_(element_type),
+      parallel_threshold_(1024),
+      merge_push_(false),
+      lazy_init_(false),
+      step_(0),
+      ttl_steps_(0),
+      lfu_min_count_(0),
+      max_rows_(0),
+      admit_count_(0),
+      allow_not_exist_(false),
+      evict_interval_ms_(10000),
+      last_sweep_(std::chrono::steady_clock::now()),
+      last_cache_log_(std::chrono::steady_clock::now()),
+      logged_hit_count_(0),
+      logged_miss_count_(0) {
+  utils::ParseConf<int64_t>(table_conf_, "parallel_threshold",
+                            &parallel_threshold_);
+  utils::ParseConf<bool>(table_conf_, "merge_push", &merge_push_);
+  utils::ParseConf<bool>(table_conf_, "lazy_init", &lazy_init_);
+  utils::ParseConf<int64_t>(table_conf_, "ttl_steps", &ttl_steps_);
+  utils::ParseConf<int64_t>(table_conf_, "lfu_min_count", &lfu_min_count_);
+  utils::ParseConf<int64_t>(table_conf_, "max_rows", &max_rows_);
+  utils::ParseConf<int64_t>(table_conf_, "admit_count", &admit_count_);
+  utils::ParseConf<int64_t>(table_conf_, "evict_interval_ms",
+                            &evict_interval_ms_);
+
+  bool evictable = ttl_steps_ > 0 || lfu_min_count_ > 0 || max_rows_ > 0;
+
+  ElementType store_type = ParseStoreType(table_conf_, element_type_);
+
+  // The row only record the access when need eviction.
+  vals_ = SparseStorage::Create(
+      table_conf_,
+      RowLayout(dimension, element_type, optim->StateTypes(), evictable,
+                store_type),
+      node_id, id_);
+
+  // The int8 val need the scale/bias, it can only be pulled as float.
+  bool pull_compact = false;
+  utils::ParseConf<bool>(table_conf_, "pull_compact", &pull_compact);
+
+  if (pull_compact && (store_type.Is<half>() || store_type.Is<bfloat16>())) {
+    pull_type_ = store_type;
+  }
+
+  if (admit_count_ > 1) {
+    int64_t admit_sketch_width = 1 << 20;
+    utils::ParseConf<int64_t>(table_conf_, "admit_sketch_width",
+                              &admit_sketch_width);
+
+    admission_.reset(new CountMinSketch((size_t)admit_sketch_width));
+  }
+
+  allow_not_exist_ = evictable || admission_ != nullptr;
+
+  {
+    MemBuffer buf;
+    Serialize serialize(&buf);
+
+    ARGUMENT_CHECK(serialize << Layout::kStride &&
+                       serialize << Shape({dimension_}) &&
+                       serialize << pull_type_,
+                   "Serialize val header error!");
+
+    val_header_.assign(buf.ptr(), buf.offset());
+  }
+
+  if (evictable && vals_->cache() != nullptr) {
+    cache_accesses_.reserve(vals_->slot_count());
+    for (size_t i = 0; i < vals_->slot_count(); ++i) {
+      cache_accesses_.emplace_back(new CacheAccess());
+    }
+  }
+
+  if (merge_push_) {
+    merge_slots_.reserve(vals_->slot_count());
+    for (size_t i = 0; i < vals_->slot_count(); ++i) {
+      merge_slots_.emplace_back(new MergeSlot());
+    }
+  }
 }
 
 int64_t SparseTable::dimension() const {
@@ -26,85 +156,992 @@ Initializer* SparseTable::initializer() const {
   return initializer_.get();
 }
 
-ParallelSkipList<uint64_t, Value>* SparseTable::mutable_vals() {
-  return &vals_;
+const std::unordered_map<std::string, std::string>& SparseTable::table_conf()
+    const {
+  return table_conf_;
+}
+
+SparseStorage* SparseTable::mutable_vals() {
+  return vals_.get();
+}
+
+int64_t SparseTable::step() const {
+  return step_.load(std::memory_order_relaxed);
+}
+
+size_t SparseTable::Sweep() {
+  LogCache();
+
+  // The sweep also decay the admission sketch.
+  if (allow_not_exist_ == false || evict_interval_ms_ <= 0) {
+    return 0;
+  }
+
+  auto now = std::chrono::steady_clock::now();
+  if (now - last_sweep_ < std::chrono::milliseconds(evict_interval_ms_)) {
+    return 0;
+  }
+
+  last_sweep_ = now;
+
+  size_t count = Evict();
+  if (count > 0) {
+    LOG_INFO("Evict SparseTable:[" << name_ << "], count:[" << count << "]");
+  }
+
+  return count;
+}
+
+void SparseTable::LogCache() {
+  RowCache* cache = vals_->cache();
+  if (cache == nullptr) {
+    return;
+  }
+
+  auto now = std::chrono::steady_clock::now();
+  if (now - last_cache_log_ < std::chrono::milliseconds(kCacheLogIntervalMs)) {
+    return;
+  }
+
+  last_cache_log_ = now;
+
+  uint64_t hit_count = cache->hit_count() - logged_hit_count_;
+  uint64_t miss_count = cache->miss_count() - logged_miss_count_;
+
+  logged_hit_count_ += hit_count;
+  logged_miss_count_ += miss_count;
+
+  if (hit_count + miss_count == 0) {
+    return;
+  }
+
+  LOG_INFO("RowCache of SparseTable:["
+           << name_ << "], hit:[" << hit_count << "], miss:[" << miss_count
+           << "], hit rate:["
+           << (double)hit_count / (double)(hit_count + miss_count) << "]");
+}
+
+void SparseTable::FoldCacheAccess(int64_t slot) {
+  const RowLayout& layout = vals_->layout();
+
+  std::unordered_map<uint64_t, std::pair<int64_t, int64_t>> accesses;
+
+  {
+    SpinLockerHandler _(cache_accesses_[slot]->locker);
+    accesses.swap(cache_accesses_[slot]->accesses);
+  }
+
+  if (accesses.empty()) {
+    return;
+  }
+
+  auto h = vals_->SharedSlotHandler(slot);
+
+  for (const auto& [sparse_id, access] : accesses) {
+    char* row = vals_->Find(slot, sparse_id);
+    if (row != nullptr) {
+      layout.SharedTouch(row, access.first, access.second);
+    }
+  }
+}
+
+size_t SparseTable::EvictSlot(int64_t slot, int64_t step) {
+  const RowLayout& layout = vals_->layout();
+
+  if (cache_accesses_.empty() == false) {
+    FoldCacheAccess(slot);
+  }
+
+  size_t slot_max_rows = 0;
+  if (max_rows_ > 0) {
+    int64_t slot_count = (int64_t)vals_->slot_count();
+    slot_max_rows =
+        (size_t)std::max<int64_t>(1, (max_rows_ + slot_count - 1) / slot_count);
+  }
+
+  // Without LFU the sweep not modify the rows except the unknown ones, so
+  // check under shared lock first, the slot is not blocked if nothing to do.
+  if (lfu_min_count_ <= 0) {
+    auto h = vals_->SharedSlotHandler(slot);
+
+    bool need = max_rows_ > 0 && vals_->Size(slot) > slot_max_rows;
+
+    if (need == false) {
+      need = !vals_->ForEach(slot, [&](uint64_t, const char* row) {
+        int64_t access_step = layout.AccessStep(row);
+
+        return access_step != RowLayout::kUnknownStep &&
+               (ttl_steps_ <= 0 || step - access_step <= ttl_steps_);
+      });
+    }
+
+    if (need == false) {
+      return 0;
+    }
+  }
+
+  auto h = vals_->UniqueSlotHandler(slot);
+
+  size_t count = vals_->SpillIf(slot, [&](uint64_t, char* row) {
+    int64_t* access_step = layout.AccessStep(row);
+    int64_t* access_count = layout.AccessCount(row);
+
+    // Not know when it be accessed (like transferred), treat it as accessed
+    // now and give it a chance.
+    if (*access_step == RowLayout::kUnknownStep) {
+      *access_step = step;
+      *access_count = std::max(*access_count, lfu_min_count_);
+
+      return false;
+    }
+
+    if (ttl_steps_ > 0 && step - *access_step > ttl_steps_) {
+      return true;
+    }
+
+    if (lfu_min_count_ > 0) {
+      if (*access_count < lfu_min_count_) {
+        return true;
+      }
+
+      // Halve the count, so the count means the recent frequency.
+      *access_count >>= 1;
+    }
+
+    return false;
+  });
+
+  size_t size = vals_->Size(slot);
+
+  if (max_rows_ > 0 && size > slot_max_rows) {
+    // Remove the least recently accessed rows.
+    std::vector<int64_t> access_steps;
+    access_steps.reserve(size);
+
+    vals_->ForEach(slot, [&](uint64_t, const char* row) {
+      access_steps.emplace_back(layout.AccessStep(row));
+      return true;
+    });
+
+    size_t remove_count = access_steps.size() - slot_max_rows;
+
+    std::nth_element(access_steps.begin(),
+                     access_steps.begin() + (remove_count - 1),
+                     access_steps.end());
+
+    // The rows before threshold must be removed, the rows at threshold are
+    // removed until enough.
+    int64_t threshold = access_steps[remove_count - 1];
+    size_t equal_count =
+        remove_count - std::count_if(access_steps.begin(), access_steps.end(),
+                                     [threshold](int64_t access_step) {
+                                       return access_step < threshold;
+                                     });
+
+    count += vals_->SpillIf(slot, [&](uint64_t, char* row) {
+      int64_t access_step = layout.AccessStep((const char*)row);
+
+      if (access_step < threshold) {
+        return true;
+      }
+
+      if (access_step == threshold && equal_count > 0) {
+        equal_count--;
+        return true;
+      }
+
+      return false;
+    });
+  }
+
+  return count;
+}
+
+void SparseTable::ForEachSlot(size_t count,
+                              const std::function<void(int64_t)>& func) {
+  int64_t slot_count = (int64_t)vals_->slot_count();
+
+  if (parallel_threshold_ > 0 && (int64_t)count >= parallel_threshold_) {
+    ThreadPool::Shared()->ParallelFor(slot_count, func);
+  } else {
+    for (int64_t slot = 0; slot < slot_count; ++slot) {
+      func(slot);
+    }
+  }
+}
+
+void SparseTable::CopyVal(const char* vec, char* out) const {
+  const RowLayout& layout = vals_->layout();
+
+  if (pull_type_ == layout.store_type()) {
+    memcpy(out, vec, layout.store_vec_bytes());
+  } else {
+    layout.ReadVec(vec, out);
+  }
+}
+
+int32_t SparseTable::UpdateRows(Optim* optim, const std::vector<char*>& rows,
+                                const std::vector<const Tensor*>& grads,
+                                float lr) {
+  const RowLayout& layout = vals_->layout();
+
+  if (layout.compact() == false) {
+    return optim->UpdateBatch(layout, rows, grads, lr);
+  }
+
+  // Run the Optim on the float rows then encode back.
+  RowLayout full = layout.Full();
+
+  std::vector<char> buf(rows.size() * full.stride());
+  std::vector<char*> full_rows(rows.size());
+
+  for (size_t k = 0; k < rows.size(); ++k) {
+    full_rows[k] = buf.data() + k * full.stride();
+    layout.Decode(rows[k], full_rows[k]);
+  }
+
+  int32_t error_code = optim->UpdateBatch(full, full_rows, grads, lr);
+
+  for (size_t k = 0; k < rows.size(); ++k) {
+    layout.Encode(full_rows[k], rows[k]);
+  }
+
+  return error_code;
+}
+
+void SparseTable::InitRows(const std::vector<uint64_t>& sparse_ids,
+                           const std::vector<char*>& rows) {
+  const RowLayout& layout = vals_->layout();
+
+  if (layout.compact() == false) {
+    std::vector<char*> vals;
+    vals.reserve(rows.size());
+
+    for (auto row : rows) {
+      vals.emplace_back(layout.Val(row));
+    }
+
+    initializer_->InitializeRows(id_, sparse_ids, dimension_, element_type_,
+                                 vals);
+    return;
+  }
+
+  // The compact row is initialized in float then encoded.
+  size_t vec_bytes = dimension_ * element_type_.ByteWidth();
+  std::vector<char> buf(rows.size() * vec_bytes);
+
+  std::vector<char*> vals(rows.size());
+  for (size_t k = 0; k < rows.size(); ++k) {
+    vals[k] = buf.data() + k * vec_bytes;
+  }
+
+  initializer_->InitializeRows(id_, sparse_ids, dimension_, element_type_,
+                               vals);
+
+  for (size_t k = 0; k < rows.size(); ++k) {
+    layout.WriteVec(vals[k], layout.Val(rows[k]));
+  }
+}
+
+void SparseTable::LazyVals(const std::vector<uint64_t>& sparse_ids,
+                           const std::vector<char*>& outs) const {
+  const RowLayout& layout = vals_->layout();
+
+  // The out maybe not aligned, so initialize in a buffer then copy.
+  size_t vec_bytes = dimension_ * element_type_.ByteWidth();
+  std::vector<char> buf(sparse_ids.size() * vec_bytes);
+
+  std::vector<char*> vals(sparse_ids.size());
+  for (size_t k = 0; k < sparse_ids.size(); ++k) {
+    vals[k] = buf.data() + k * vec_bytes;
+  }
+
+  initializer_->InitializeRows(id_, sparse_ids, dimension_, element_type_,
+                               vals);
+
+  if (layout.compact() == false) {
+    for (size_t k = 0; k < sparse_ids.size(); ++k) {
+      memcpy(outs[k], vals[k], vec_bytes);
+    }
+
+    return;
+  }
+
+  // Encode then decode, so it is same with the val after materialized.
+  std::vector<char> stored(layout.store_vec_bytes());
+
+  for (size_t k = 0; k < sparse_ids.size(); ++k) {
+    layout.WriteVec(vals[k], stored.data());
+    CopyVal(stored.data(), outs[k]);
+  }
+}
+
+char* SparseTable::PushRow(int64_t slot, uint64_t sparse_id,
+                           std::vector<uint64_t>* new_ids,
+                           std::vector<char*>* new_rows) {
+  char* row = vals_->Find(slot, sparse_id);
+  if (row != nullptr) {
+    return row;
+  }
+
+  // Spilled, fault it back.
+  row = vals_->Load(slot, sparse_id);
+  if (row != nullptr || lazy_init_ == false) {
+    return row;
+  }
+
+  // Materialize the lazy row, skip the not admitted one.
+  if (admission_ != nullptr &&
+      admission_->Estimate(sparse_id) < (uint32_t)admit_count_) {
+    return nullptr;
+  }
+
+  row = vals_->Insert(slot, sparse_id);
+  vals_->layout().ZeroStates(row);
+
+  new_ids->emplace_back(sparse_id);
+  new_rows->emplace_back(row);
+
+  return row;
+}
+
+void SparseTable::PullRows(const std::vector<uint64_t>& sparse_ids,
+                           const std::function<char*(size_t)>& val_ptr) {
+  const RowLayout& layout = vals_->layout();
+  int64_t slot_count = (int64_t)vals_->slot_count();
+  int64_t step = step_.load(std::memory_order_relaxed);
+
+  RowCache* cache = vals_->cache();
+
+  std::vector<std::vector<size_t>> slot_idxs(slot_count);
+  size_t slot_idx_count = 0;
+
+  if (cache != nullptr) {
+    // Phase 0: serve the hot rows from the cache without lock. The cache
+    // keep the stored val, convert it if pull in other type.
+    bool convert = layout.store_type() != pull_type_;
+    std::vector<char> stored(convert ? layout.store_vec_bytes() : 0);
+
+    // The hit ids of every slot, record the access for eviction.
+    std::vector<std::vector<uint64_t>> slot_hit_ids(
+        cache_accesses_.empty() ? 0 : slot_count);
+
+    for (size_t i = 0; i < sparse_ids.size(); ++i) {
+      char* val = convert ? stored.data() : val_ptr(i);
+
+      if (cache->Get(sparse_ids[i], val) == false) {
+        slot_idxs[vals_->HitSlot(sparse_ids[i])].emplace_back(i);
+        slot_idx_count++;
+        continue;
+      }
+
+      if (convert) {
+        CopyVal(val, val_ptr(i));
+      }
+
+      if (cache_accesses_.empty() == false) {
+        slot_hit_ids[vals_->HitSlot(sparse_ids[i])].emplace_back(
+            sparse_ids[i]);
+      }
+    }
+
+    cache->Record(sparse_ids.size() - slot_idx_count, slot_idx_count);
+
+    for (int64_t slot = 0; slot < (int64_t)slot_hit_ids.size(); ++slot) {
+      if (slot_hit_ids[slot].empty()) {
+        continue;
+      }
+
+      SpinLockerHandler _(cache_accesses_[slot]->locker);
+
+      for (auto sparse_id : slot_hit_ids[slot]) {
+        auto& access = cache_accesses_[slot]->accesses[sparse_id];
+        access.first = step;
+        access.second++;
+      }
+    }
+  } else {
+    for (size_t i = 0; i < sparse_ids.size(); ++i) {
+      slot_idxs[vals_->HitSlot(sparse_ids[i])].emplace_back(i);
+    }
+
+    slot_idx_count = sparse_ids.size();
+  }
+
+  if (slot_idx_count == 0) {
+    return;
+  }
+
+  // The ids not exist in this table.
+  std::vector<std::vector<size_t>> slot_miss_idxs(slot_count);
+
+  // Phase 1: read the exist rows under shared lock, so the concurrent pull of
+  // hot ids will not serialize. Every slot is independent so run parallel.
+  ForEachSlot(slot_idx_count, [&](int64_t slot) {
+    if (slot_idxs[slot].empty()) {
+      return;
+    }
+
+    // The not exist ids that computed without insert in lazy mode.
+    std::vector<uint64_t> lazy_ids;
+    std::vector<char*> lazy_vals;
+
+    {
+      auto h = vals_->SharedSlotHandler(slot);
+
+      for (auto i : slot_idxs[slot]) {
+        char* row = vals_->Find(slot, sparse_ids[i]);
+
+        if (row != nullptr) {
+          CopyVal(layout.Val(row), val_ptr(i));
+
+          if (layout.with_access()) {
+            layout.SharedTouch(row, step);
+          }
+
+          // Push can not change the row when hold the shared lock, so the
+          // cached val is newest.
+          if (cache != nullptr) {
+            cache->Put(sparse_ids[i], layout.Val(row));
+          }
+        } else if (vals_->FindCold(slot, sparse_ids[i]) != nullptr) {
+          // Spilled, fault it back in Phase 2.
+          slot_miss_idxs[slot].emplace_back(i);
+        } else if (admission_ != nullptr &&
+                   admission_->Add(sparse_ids[i]) < (uint32_t)admit_count_) {
+          // Not seen enough times, do not allocate the row.
+          memset(val_ptr(i), 0, dimension_ * pull_type_.ByteWidth());
+        } else if (lazy_init_) {
+          lazy_ids.emplace_back(sparse_ids[i]);
+          lazy_vals.emplace_back(val_ptr(i));
+        } else {
+          slot_miss_idxs[slot].emplace_back(i);
+        }
+      }
+    }
+
+    // The initializer not need the lock.
+    if (lazy_ids.empty() == false) {
+      LazyVals(lazy_ids, lazy_vals);
+    }
+  });
+
+  size_t miss_count = 0;
+  for (const auto& v : slot_miss_idxs) {
+    miss_count += v.size();
+  }
+
+  if (miss_count == 0) {
+    return;
+  }
+
+  // Phase 2: create the missing rows under unique lock. Another thread maybe
+  // insert it between the 2 phases, so find again.
+  ForEachSlot(miss_count, [&](int64_t slot) {
+    if (slot_miss_idxs[slot].empty()) {
+      return;
+    }
+
+    const std::vector<size_t>& idxs = slot_miss_idxs[slot];
+
+    std::vector<char*> rows(idxs.size());
+
+    // The new rows are initialized at once.
+    std::vector<uint64_t> new_ids;
+    std::vector<char*> new_rows;
+
+    auto h = vals_->UniqueSlotHandler(slot);
+
+    for (size_t k = 0; k < idxs.size(); ++k) {
+      uint64_t sparse_id = sparse_ids[idxs[k]];
+
+      char* row = vals_->Find(slot, sparse_id);
+
+      if (row == nullptr) {
+        // Spilled, fault it back.
+        row = vals_->Load(slot, sparse_id);
+
+        if (row == nullptr) {
+          // Not exist create a new embedding in place.
+          row = vals_->Insert(slot, sparse_id);
+          layout.ZeroStates(row);
+
+          new_ids.emplace_back(sparse_id);
+          new_rows.emplace_back(row);
+        }
+
+        if (layout.with_access()) {
+          layout.Touch(row, step);
+        }
+      }
+
+      rows[k] = row;
+    }
+
+    if (new_rows.empty() == false) {
+      InitRows(new_ids, new_rows);
+    }
+
+    for (size_t k = 0; k < idxs.size(); ++k) {
+      CopyVal(layout.Val(rows[k]), val_ptr(idxs[k]));
+    }
+  });
 }
 
 int32_t SparseTable::Pull(const std::vector<uint64_t>& sparse_ids,
                           std::vector<Tensor>* vals) {
-  // At here the id maybe not exist in this table. If not exist create a new
-  // one.
-  vals->resize(sparse_ids.size());
-
-  std::unordered_map<size_t, std::vector<size_t>> slot_idx_map;
-  slot_idx_map.reserve(vals_.slot_count());
+  vals->clear();
+  vals->reserve(sparse_ids.size());
 
   for (size_t i = 0; i < sparse_ids.size(); ++i) {
-    slot_idx_map[vals_.HitSlot(sparse_ids[i])].emplace_back(i);
+    vals->emplace_back(Tensor::Dense({dimension_}, pull_type_));
+  }
+
+  PullRows(sparse_ids, [vals](size_t i) { return (char*)(*vals)[i].Ptr(); });
+
+  return ErrorCode::kSuccess;
+}
+
+int32_t SparseTable::Pull(const std::vector<uint64_t>& sparse_ids,
+                          Tensor* val) {
+  int64_t row = (int64_t)sparse_ids.size();
+  size_t vec_bytes = dimension_ * pull_type_.ByteWidth();
+
+  *val = Tensor::Dense({row, dimension_}, pull_type_);
+  char* ptr = (char*)val->Ptr();
+
+  PullRows(sparse_ids,
+           [ptr, vec_bytes](size_t i) { return ptr + i * vec_bytes; });
+
+  return ErrorCode::kSuccess;
+}
+
+int32_t SparseTable::Pull(const std::vector<uint64_t>& sparse_ids,
+                          MemBuffer* buf) {
+  uint64_t size = sparse_ids.size();
+  size_t val_bytes =
+      val_header_.size() + dimension_ * pull_type_.ByteWidth();
+
+  buf->Write((const char*)&size, sizeof(size));
+
+  // All vals have the same size, so reserve them at once and every slot write
+  // the vals to their own position.
+  char* ptr = buf->Extend(size * val_bytes);
+  for (size_t i = 0; i < size; ++i) {
+    memcpy(ptr + i * val_bytes, val_header_.data(), val_header_.size());
+  }
+
+  ptr += val_header_.size();
+
+  PullRows(sparse_ids,
+           [ptr, val_bytes](size_t i) { return ptr + i * val_bytes; });
+
+  return ErrorCode::kSuccess;
+}
+
+int32_t SparseTable::PullMatrix(const std::vector<uint64_t>& sparse_ids,
+                                MemBuffer* buf) {
+  int64_t row = (int64_t)sparse_ids.size();
+  size_t vec_bytes = dimension_ * pull_type_.ByteWidth();
+
+  Serialize serialize(buf);
+  if ((serialize << Layout::kStride && serialize << Shape({row, dimension_}) &&
+       serialize << pull_type_) == false) {
+    return ErrorCode::kSerializeReplyError;
+  }
+
+  char* ptr = buf->Extend(row * vec_bytes);
+
+  PullRows(sparse_ids,
+           [ptr, vec_bytes](size_t i) { return ptr + i * vec_bytes; });
+
+  return ErrorCode::kSuccess;
+}
+
+int32_t SparseTable::PushSlot(Optim* optim, int64_t slot,
+                              const std::vector<uint64_t>& sparse_ids,
+                              const std::vector<Tensor>& grads,
+                              const std::vector<size_t>& idxs, float lr) {
+  const RowLayout& layout = vals_->layout();
+  int64_t step = step_.load(std::memory_order_relaxed);
+
+  // sparse id -> index of rows.
+  std::unordered_map<uint64_t, size_t> id_idx;
+  id_idx.reserve(idxs.size());
+
+  std::vector<uint64_t> row_ids;
+  std::vector<char*> rows;
+  std::vector<const Tensor*> slot_grads;
+
+  row_ids.reserve(idxs.size());
+  rows.reserve(idxs.size());
+  slot_grads.reserve(idxs.size());
+
+  // The summed grads of the repeated ids, reserve so the pointers keep valid.
+  // sum_idxs is the index of sums for every row, -1 means only one grad.
+  std::vector<Tensor> sums;
+  std::vector<int64_t> sum_idxs;
+  sums.reserve(idxs.size());
+  sum_idxs.reserve(idxs.size());
+
+  // The materialized lazy rows.
+  std::vector<uint64_t> new_ids;
+  std::vector<char*> new_rows;
+
+  // Lock the slot.
+  auto h = vals_->UniqueSlotHandler(slot);
+
+  for (auto i : idxs) {
+    char* row = PushRow(slot, sparse_ids[i], &new_ids, &new_rows);
+
+    if (row == nullptr) {
+      // Evicted or not admitted.
+      if (allow_not_exist_) {
+        continue;
+      }
+
+      return ErrorCode::kSparseIdNotExistError;
+    }
+
+    if (layout.with_access()) {
+      layout.Touch(row, step);
+    }
+
+    auto it = id_idx.find(sparse_ids[i]);
+    if (it == id_idx.end()) {
+      id_idx.emplace(sparse_ids[i], rows.size());
+
+      row_ids.emplace_back(sparse_ids[i]);
+      rows.emplace_back(row);
+      slot_grads.emplace_back(&grads[i]);
+      sum_idxs.emplace_back(-1);
+
+      continue;
+    }
+
+    // The Optim update a row once per call, so sum the grads of the repeated
+    // id.
+    size_t j = it->second;
+
+    if (sum_idxs[j] < 0) {
+      const Tensor& first = *(slot_grads[j]);
+
+      sum_idxs[j] = (int64_t)sums.size();
+      sums.emplace_back(first.IsCoo() ? first.ToDense() : first.Clone());
+
+      slot_grads[j] = &(sums.back());
+    }
+
+    sums[sum_idxs[j]] += (grads[i].IsCoo() ? grads[i].ToDense() : grads[i]);
+  }
+
+  if (new_rows.empty() == false) {
+    InitRows(new_ids, new_rows);
+  }
+
+  if (rows.empty()) {
+    return ErrorCode::kSuccess;
+  }
+
+  // Update all rows of the slot in one call.
+  int32_t error_code = UpdateRows(optim, rows, slot_grads, lr);
+
+  // Keep the cache coherent before release the lock.
+  RowCache* cache = vals_->cache();
+  if (cache != nullptr) {
+    for (size_t k = 0; k < rows.size(); ++k) {
+      cache->Update(row_ids[k], layout.Val(rows[k]));
+    }
   }
 
-  for (const auto& [slot, v] : slot_idx_map) {
-    // Lock the slot.
-    auto h = vals_.UniqueSkipListHandler(slot);
+  return error_code;
+}
+
+int32_t SparseTable::MergePushSlot(Optim* optim, int64_t slot,
+                                   PushTask* task) {
+  MergeSlot& merge_slot = *(merge_slots_[slot]);
+
+  std::unique_lock<std::mutex> lock(merge_slot.mu);
+  merge_slot.tasks.emplace_back(task);
+
+  while (task->done == false) {
+    if (merge_slot.merging) {
+      merge_slot.cond.wait(lock);
+      continue;
+    }
 
-    for (auto i : v) {
-      uint64_t sparse_id = sparse_ids[i];
+    // Take the waiting tasks that have the same lr with the first one.
+    merge_slot.merging = true;
 
-      auto it = h.skip_list.Find(sparse_id);
+    float lr = merge_slot.tasks.front()->lr;
+    std::vector<PushTask*> tasks;
+    std::vector<PushTask*> left;
 
-      if (it.Valid()) {
-        // Exist.
-        (*vals)[i] = it.value().val.Clone();
+    for (auto t : merge_slot.tasks) {
+      if (t->lr == lr) {
+        tasks.emplace_back(t);
       } else {
-        // Not exist create a new embedding.
-        Tensor t = Tensor::Dense({dimension_}, element_type_);
-        initializer_->Initialize(&t);
+        left.emplace_back(t);
+      }
+    }
 
-        // for result.
-        (*vals)[i] = t.Clone();
+    merge_slot.tasks.swap(left);
 
-        Value v;
-        v.val = t;
+    // Finish the taken tasks and reset merging on every exit. If the update
+    // throw, the taken tasks fail with kUnknowError and our task (maybe not
+    // taken) leave the queue, so the waiting threads not hang.
+    bool applied = false;
+
+    struct ScopeGuard {
+      std::function<void()> func;
+
+      ~ScopeGuard() {
+        func();
+      }
+    } guard{[&]() {
+      lock.lock();
+
+      for (auto t : tasks) {
+        if (applied == false) {
+          t->error_code = ErrorCode::kUnknowError;
+        }
+
+        t->done = true;
+      }
 
-        h.skip_list.Insert(sparse_id, v);
+      if (applied == false) {
+        merge_slot.tasks.erase(std::remove(merge_slot.tasks.begin(),
+                                           merge_slot.tasks.end(), task),
+                               merge_slot.tasks.end());
       }
+
+      // Let the waiting thread take the left tasks.
+      merge_slot.merging = false;
+      merge_slot.cond.notify_all();
+    }};
+
+    lock.unlock();
+    ApplyPushTasks(optim, slot, tasks);
+    applied = true;
+  }
+
+  return task->error_code;
+}
+
+void SparseTable::ApplyPushTasks(Optim* optim, int64_t slot,
+                                 const std::vector<PushTask*>& tasks) {
+  const RowLayout& layout = vals_->layout();
+  int64_t step = step_.load(std::memory_order_relaxed);
+
+  size_t total = 0;
+  for (auto task : tasks) {
+    total += task->idxs->size();
+  }
+
+  // sparse id -> index of rows.
+  std::unordered_map<uint64_t, size_t> id_idx;
+  id_idx.reserve(total);
+
+  std::vector<uint64_t> row_ids;
+  std::vector<char*> rows;
+  std::vector<const Tensor*> merged_grads;
+  row_ids.reserve(total);
+  rows.reserve(total);
+  merged_grads.reserve(total);
+
+  // The summed grads, reserve so the pointers keep valid. sum_idxs is the
+  // index of sums for every row, -1 means the row only has one grad.
+  std::vector<Tensor> sums;
+  std::vector<int64_t> sum_idxs;
+  sums.reserve(total);
+  sum_idxs.reserve(total);
+
+  std::vector<PushTask*> valid_tasks;
+  valid_tasks.reserve(tasks.size());
+
+  std::vector<char*> task_rows;
+
+  // The materialized lazy rows.
+  std::vector<uint64_t> new_ids;
+  std::vector<char*> new_rows;
+
+  // Lock the slot.
+  auto h = vals_->UniqueSlotHandler(slot);
+
+  for (auto task : tasks) {
+    const std::vector<uint64_t>& sparse_ids = *(task->sparse_ids);
+    const std::vector<Tensor>& grads = *(task->grads);
+    const std::vector<size_t>& idxs = *(task->idxs);
+
+    // Check the task first, a wrong task should not fail the others.
+    task->error_code = ErrorCode::kSuccess;
+    task_rows.clear();
+
+    for (auto i : idxs) {
+      char* row = PushRow(slot, sparse_ids[i], &new_ids, &new_rows);
+
+      if (row == nullptr && allow_not_exist_ == false) {
+        task->error_code = ErrorCode::kSparseIdNotExistError;
+        break;
+      }
+
+      if (grads[i].Size() != layout.dimension() ||
+          grads[i].element_type() != layout.element_type()) {
+        task->error_code = ErrorCode::kGradientUnCompatibleError;
+        break;
+      }
+
+      task_rows.emplace_back(row);
+    }
+
+    if (task->error_code != ErrorCode::kSuccess) {
+      continue;
+    }
+
+    valid_tasks.emplace_back(task);
+
+    for (size_t k = 0; k < idxs.size(); ++k) {
+      uint64_t sparse_id = sparse_ids[idxs[k]];
+      const Tensor& grad = grads[idxs[k]];
+
+      // Evicted/not admitted row or empty Coo grad, nothing to update.
+      if (task_rows[k] == nullptr ||
+          (grad.IsCoo() && grad.indices().IsEmpty())) {
+        continue;
+      }
+
+      if (layout.with_access()) {
+        layout.Touch(task_rows[k], step);
+      }
+
+      auto it = id_idx.find(sparse_id);
+      if (it == id_idx.end()) {
+        id_idx.emplace(sparse_id, rows.size());
+
+        row_ids.emplace_back(sparse_id);
+        rows.emplace_back(task_rows[k]);
+        merged_grads.emplace_back(&grad);
+        sum_idxs.emplace_back(-1);
+
+        continue;
+      }
+
+      size_t j = it->second;
+
+      // The first time merge this row, copy the grad.
+      if (sum_idxs[j] < 0) {
+        const Tensor& first = *(merged_grads[j]);
+
+        sum_idxs[j] = (int64_t)sums.size();
+        sums.emplace_back(first.IsCoo() ? first.ToDense() : first.Clone());
+
+        merged_grads[j] = &(sums.back());
+      }
+
+      sums[sum_idxs[j]] += (grad.IsCoo() ? grad.ToDense() : grad);
     }
   }
 
-  return ErrorCode::kSuccess;
+  // The rows are inserted even the task is invalid, initialize them anyway.
+  if (new_rows.empty() == false) {
+    InitRows(new_ids, new_rows);
+  }
+
+  if (rows.empty()) {
+    return;
+  }
+
+  int32_t error_code =
+      UpdateRows(optim, rows, merged_grads, valid_tasks.front()->lr);
+  if (error_code != ErrorCode::kSuccess) {
+    for (auto task : valid_tasks) {
+      task->error_code = error_code;
+    }
+  }
+
+  // Keep the cache coherent before release the lock.
+  RowCache* cache = vals_->cache();
+  if (cache != nullptr) {
+    for (size_t k = 0; k < rows.size(); ++k) {
+      cache->Update(row_ids[k], layout.Val(rows[k]));
+    }
+  }
 }
 
 int32_t SparseTable::Push(Optim* optim, const std::vector<uint64_t>& sparse_ids,
                           const std::vector<Tensor>& grads, float lr) {
   assert(sparse_ids.size() == grads.size());
 
-  std::unordered_map<size_t, std::vector<size_t>> slot_idx_map;
-  slot_idx_map.reserve(vals_.slot_count());
+  step_.fetch_add(1, std::memory_order_relaxed);
 
+  int64_t slot_count = (int64_t)vals_->slot_count();
+
+  std::vector<std::vector<size_t>> slot_idxs(slot_count);
   for (size_t i = 0; i < sparse_ids.size(); ++i) {
-    slot_idx_map[vals_.HitSlot(sparse_ids[i])].emplace_back(i);
+    slot_idxs[vals_->HitSlot(sparse_ids[i])].emplace_back(i);
   }
 
-  for (const auto& [slot, v] : slot_idx_map) {
-    // Lock the slot.
-    auto h = vals_.UniqueSkipListHandler(slot);
-
-    for (auto i : v) {
-      uint64_t sparse_id = sparse_ids[i];
+  // The slots maybe run in different thread, so record the error code of
+  // every slot.
+  std::vector<int32_t> error_codes(slot_count, ErrorCode::kSuccess);
 
-      auto it = h.skip_list.Find(sparse_id);
-      if (it.Valid() == false) {
-        return ErrorCode::kSparseIdNotExistError;
+  if (merge_push_) {
+    // The merged task wait for another thread, so run it in the caller thread.
+    // Wait in the shared ThreadPool maybe park all workers and stall the Pull.
+    for (int64_t slot = 0; slot < slot_count; ++slot) {
+      if (slot_idxs[slot].empty()) {
+        continue;
       }
 
-      int32_t error_code = optim->Update(grads[i], lr, &(it.value()));
-      if (error_code != ErrorCode::kSuccess) {
-        return error_code;
+      PushTask task;
+      task.sparse_ids = &sparse_ids;
+      task.grads = &grads;
+      task.idxs = &slot_idxs[slot];
+      task.lr = lr;
+      task.done = false;
+      task.error_code = ErrorCode::kSuccess;
+
+      error_codes[slot] = MergePushSlot(optim, slot, &task);
+    }
+  } else {
+    ForEachSlot(sparse_ids.size(), [&](int64_t slot) {
+      if (slot_idxs[slot].empty()) {
+        return;
       }
+
+      error_codes[slot] =
+          PushSlot(optim, slot, sparse_ids, grads, slot_idxs[slot], lr);
+    });
+  }
+
+  for (auto error_code : error_codes) {
+    if (error_code != ErrorCode::kSuccess) {
+      return error_code;
     }
   }
 
   return ErrorCode::kSuccess;
 }
 
+size_t SparseTable::Evict() {
+  size_t count = 0;
+
+  if (ttl_steps_ > 0 || lfu_min_count_ > 0 || max_rows_ > 0) {
+    int64_t step = step_.load(std::memory_order_relaxed);
+
+    for (size_t slot = 0; slot < vals_->slot_count(); ++slot) {
+      count += EvictSlot((int64_t)slot, step);
+
+      // The faulted back rows leave dead records in the cold file.
+      vals_->CompactCold(slot);
+    }
+  }
+
+  if (admission_ != nullptr) {
+    admission_->Decay();
+  }
+
+  return count;
+}
+
 }  // namespace kraken
@@ -1,14 +1,20 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
 #include "common/error_code.h"
-#include "common/parallel_skip_list.h"
 #include "common/spin_locker.h"
-#include "libcuckoo/libcuckoo/cuckoohash_map.hh"
 #include "ps/initializer/initializer.h"
 #include "ps/optim/optim.h"
+#include "ps/storage/count_min_sketch.h"
+#include "ps/storage/sparse_storage.h"
 #include "ps/table.h"
 #include "t/element_type.h"
 #include "t/tensor.h"
@@ -17,6 +23,42 @@ namespace kraken {
 
 class SparseTable : public Table {
 private:
+  constexpr static size_t kCacheLineSize = 64;
+
+  // A Push's part on one slot that wait to be merged.
+  struct PushTask {
+    const std::vector<uint64_t>* sparse_ids;
+    const std::vector<Tensor>* grads;
+
+    // The index of the sparse_ids/grads that belong to this slot.
+    const std::vector<size_t>* idxs;
+
+    float lr;
+
+    bool done;
+    int32_t error_code;
+  };
+
+  // The waiting PushTasks of a slot.
+  struct alignas(kCacheLineSize) MergeSlot {
+    std::mutex mu;
+    std::condition_variable cond;
+
+    // Whether a thread is applying the tasks.
+    bool merging = false;
+
+    std::vector<PushTask*> tasks;
+  };
+
+  // The access of the rows pulled from the RowCache, a cache hit not touch the
+  // row so record it here, the sweeper fold it into the rows.
+  struct alignas(kCacheLineSize) CacheAccess {
+    SpinLocker locker;
+
+    // sparse id -> (the last step, the count).
+    std::unordered_map<uint64_t, std::pair<int64_t, int64_t>> accesses;
+  };
+
   // For sparse table this must be a matrix. shape is [N, dimension].
   // We donnot assign the N, so it means the matrix's row canbe increase
   // automatically.
@@ -25,12 +67,80 @@ private:
 
   std::unique_ptr<Initializer> initializer_;
 
-  ParallelSkipList<uint64_t, Value> vals_;
+  // Table config, like: storage_type.
+  std::unordered_map<std::string, std::string> table_conf_;
+
+  std::unique_ptr<SparseStorage> vals_;
+
+  // The vals are pulled in this type: element_type_, or the float16/bfloat16
+  // store type if table_conf "pull_compact" is true. The rows are stored in
+  // table_conf "store_type": float32/float16/bfloat16/int8.
+  ElementType pull_type_;
+
+  // The serialized bytes before a val's data, all vals have the same one.
+  std::string val_header_;
+
+  // The request which sparse id count >= parallel_threshold_ will be split by
+  // slot and run in ThreadPool, the smaller one run inline.
+  int64_t parallel_threshold_;
+
+  // If true the concurrent Push on a slot will be merged: the grads of the same
+  // sparse id are summed and only one optim step is applied. The merged Push
+  // always run in the caller thread, not split by parallel_threshold_.
+  bool merge_push_;
+  std::vector<std::unique_ptr<MergeSlot>> merge_slots_;
+
+  // If true the not exist row is not inserted when pulled, the val is computed
+  // by the initializer (deterministic by the sparse id) and the row is
+  // materialized by the first Push.
+  bool lazy_init_;
+
+  // Increased by every Push, the row's access step is the step of last
+  // Pull/Push.
+  std::atomic<int64_t> step_;
+
+  // Eviction, 0 means disable. The background sweeper remove the rows that
+  // not be accessed in ttl_steps_, the rows accessed less than
+  // lfu_min_count_ times (the count is halved after every sweep), and the
+  // least recently accessed rows if the table has more than max_rows_ rows.
+  // If the storage is tiered (table_conf "cold_path") the rows are spilled to
+  // the cold file instead, and faulted back when pulled/pushed.
+  int64_t ttl_steps_;
+  int64_t lfu_min_count_;
+  int64_t max_rows_;
+
+  // A new sparse id must be seen admit_count_ times before allocate a row, the
+  // not admitted id is pulled as zero. 0/1 means disable.
+  int64_t admit_count_;
+  std::unique_ptr<CountMinSketch> admission_;
+
+  // Every slot's CacheAccess, only used if evictable and has RowCache.
+  std::vector<std::unique_ptr<CacheAccess>> cache_accesses_;
+
+  // If rows can be evicted or not admitted, Push skip the not exist sparse
+  // ids instead of fail.
+  bool allow_not_exist_;
+
+  // The Ps's sweeper call Sweep, only Evict if evict_interval_ms_ passed
+  // since last_sweep_.
+  int64_t evict_interval_ms_;
+  std::chrono::steady_clock::time_point last_sweep_;
+
+  // Sweep also log the RowCache's hit/miss count since the last log, every
+  // kCacheLogIntervalMs.
+  constexpr static int64_t kCacheLogIntervalMs = 60000;
+  std::chrono::steady_clock::time_point last_cache_log_;
+  uint64_t logged_hit_count_;
+  uint64_t logged_miss_count_;
 
 public:
+  // The optim decide which states every row need keep. node_id is the Ps
+  // node's id, use to separate the cold files of the nodes.
   SparseTable(uint64_t id, const std::string& name, int64_t dimension,
               ElementType element_type,
-              std::unique_ptr<Initializer>&& initializer);
+              std::unique_ptr<Initializer>&& initializer,
+              const std::unordered_map<std::string, std::string>& table_conf,
+              const Optim* optim, uint64_t node_id = 0);
 
 public:
   int64_t dimension() const;
@@ -39,13 +149,91 @@ public:
 
   Initializer* initializer() const;
 
-  ParallelSkipList<uint64_t, Value>* mutable_vals();
+  const std::unordered_map<std::string, std::string>& table_conf() const;
+
+  SparseStorage* mutable_vals();
 
+  int64_t step() const;
+
+private:
+  // Touch the rows by the slot's CacheAccess then clear it.
+  void FoldCacheAccess(int64_t slot);
+
+  // Evict the rows of a slot, step is the current step.
+  size_t EvictSlot(int64_t slot, int64_t step);
+
+  // Log the RowCache's hit rate if kCacheLogIntervalMs passed since the last
+  // log and the cache is used.
+  void LogCache();
+
+  // Call func(slot) for every slot, parallel if count >= parallel_threshold_.
+  void ForEachSlot(size_t count, const std::function<void(int64_t)>& func);
+
+  // Copy a stored val to out in pull_type_.
+  void CopyVal(const char* vec, char* out) const;
+
+  // Update the rows by the Optim, the compact rows are decoded to float to
+  // update then encoded back.
+  int32_t UpdateRows(Optim* optim, const std::vector<char*>& rows,
+                     const std::vector<const Tensor*>& grads, float lr);
+
+  // Initialize the new rows' val by the initializer at once.
+  void InitRows(const std::vector<uint64_t>& sparse_ids,
+                const std::vector<char*>& rows);
+
+  // Compute the not exist rows' val to outs (in pull_type_) without insert,
+  // same with the val after they are materialized.
+  void LazyVals(const std::vector<uint64_t>& sparse_ids,
+                const std::vector<char*>& outs) const;
+
+  // Find the row to push and fault back the spilled one. In lazy mode the not
+  // exist (and admitted) row is inserted and appended to new_ids/new_rows, the
+  // caller must InitRows them before update. Need the unique lock.
+  char* PushRow(int64_t slot, uint64_t sparse_id,
+                std::vector<uint64_t>* new_ids, std::vector<char*>* new_rows);
+
+  // Copy the val of sparse_ids[i] to val_ptr(i), create the row if not exist.
+  void PullRows(const std::vector<uint64_t>& sparse_ids,
+                const std::function<char*(size_t)>& val_ptr);
+
+  // Update the rows of a slot.
+  int32_t PushSlot(Optim* optim, int64_t slot,
+                   const std::vector<uint64_t>& sparse_ids,
+                   const std::vector<Tensor>& grads,
+                   const std::vector<size_t>& idxs, float lr);
+
+  // Put the task into the slot's queue, the first thread find no one merging
+  // will take the waiting tasks and apply them, the others wait to be done.
+  int32_t MergePushSlot(Optim* optim, int64_t slot, PushTask* task);
+
+  // Sum the grads of the same sparse id in tasks and update the rows once. All
+  // tasks must have the same lr.
+  void ApplyPushTasks(Optim* optim, int64_t slot,
+                      const std::vector<PushTask*>& tasks);
+
+public:
   int32_t Pull(const std::vector<uint64_t>& sparse_ids,
                std::vector<Tensor>* vals) override;
 
+  int32_t Pull(const std::vector<uint64_t>& sparse_ids,
+               Tensor* val) override;
+
+  int32_t Pull(const std::vector<uint64_t>& sparse_ids,
+               MemBuffer* buf) override;
+
+  int32_t PullMatrix(const std::vector<uint64_t>& sparse_ids,
+                     MemBuffer* buf) override;
+
   int32_t Push(Optim* optim, const std::vector<uint64_t>& sparse_ids,
                const std::vector<Tensor>& grads, float lr) override;
+
+  // Sweep all slots once by the eviction config, lock one slot at a time so
+  // the others can be pulled/pushed. Return the removed row count.
+  size_t Evict();
+
+  // Evict if evict_interval_ms_ passed since the last sweep and log the cache
+  // hit rate, called by the Ps sweeper. Return the removed row count.
+  size_t Sweep();
 };
 
 }  // namespace kraken
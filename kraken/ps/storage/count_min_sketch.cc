@@ -0,0 +1,68 @@
+#include "ps/storage/count_min_sketch.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "common/utils.h"
+
+namespace kraken {
+
+CountMinSketch::CountMinSketch(size_t width)
+    : width_(std::max<size_t>(1, width)) {
+  counters_.reset(new std::atomic<uint32_t>[kDepth * width_]());
+}
+
+size_t CountMinSketch::Index(uint64_t hash, size_t d) const {
+  // Double hashing: h1 + d * h2.
+  uint64_t h1 = hash & 0xFFFFFFFF;
+  uint64_t h2 = hash >> 32;
+
+  return d * width_ + (h1 + d * h2) % width_;
+}
+
+size_t CountMinSketch::width() const {
+  return width_;
+}
+
+uint32_t CountMinSketch::Add(uint64_t sparse_id) {
+  uint64_t hash = utils::Hash(sparse_id);
+  uint32_t estimate = std::numeric_limits<uint32_t>::max();
+
+  for (size_t d = 0; d < kDepth; ++d) {
+    std::atomic<uint32_t>& counter = counters_[Index(hash, d)];
+
+    uint32_t count = counter.load(std::memory_order_relaxed);
+
+    // Saturate instead of overflow.
+    if (count < std::numeric_limits<uint32_t>::max()) {
+      count = counter.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    estimate = std::min(estimate, count);
+  }
+
+  return estimate;
+}
+
+uint32_t CountMinSketch::Estimate(uint64_t sparse_id) const {
+  uint64_t hash = utils::Hash(sparse_id);
+  uint32_t estimate = std::numeric_limits<uint32_t>::max();
+
+  for (size_t d = 0; d < kDepth; ++d) {
+    estimate = std::min(
+        estimate, counters_[Index(hash, d)].load(std::memory_order_relaxed));
+  }
+
+  return estimate;
+}
+
+void CountMinSketch::Decay() {
+  for (size_t i = 0; i < kDepth * width_; ++i) {
+    uint32_t count = counters_[i].load(std::memory_order_relaxed);
+
+    // A concurrent Add maybe lost, it is fine for a estimate.
+    counters_[i].store(count >> 1, std::memory_order_relaxed);
+  }
+}
+
+}  // namespace kraken
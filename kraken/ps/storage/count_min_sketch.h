@@ -0,0 +1,44 @@
+#pragma once
+
+#include <atomic>
+#include <cinttypes>
+#include <memory>
+
+namespace kraken {
+
+/**
+ * \brief A Count-Min sketch to estimate how many times a sparse id be seen.
+ *
+ * It has kDepth rows and every row has width counters, a sparse id is hashed
+ * to one counter of every row and the estimate is the min of them, so it may
+ * be bigger than the real count but never smaller. The counters are atomic,
+ * Add/Estimate/Decay can be called concurrently.
+ */
+class CountMinSketch {
+private:
+  constexpr static size_t kDepth = 4;
+
+  size_t width_;
+
+  std::unique_ptr<std::atomic<uint32_t>[]> counters_;
+
+public:
+  explicit CountMinSketch(size_t width);
+
+private:
+  // The index of the sparse id's counter in row d.
+  size_t Index(uint64_t hash, size_t d) const;
+
+public:
+  size_t width() const;
+
+  // Increase the sparse id's count and return the estimate after increased.
+  uint32_t Add(uint64_t sparse_id);
+
+  uint32_t Estimate(uint64_t sparse_id) const;
+
+  // Halve all counters, so the old seen fade out.
+  void Decay();
+};
+
+}  // namespace kraken
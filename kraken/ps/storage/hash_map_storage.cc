@@ -0,0 +1,51 @@
+#include "ps/storage/hash_map_storage.h"
+
+namespace kraken {
+
+HashMapStorage::HashMapStorage(const RowLayout& layout, size_t slot_count)
+    : SparseStorage(StorageType::kHashMap, layout, slot_count),
+      hash_maps_(slot_count) {
+}
+
+bool HashMapStorage::InsertIndex(size_t slot, uint64_t sparse_id, char* row) {
+  return hash_maps_[slot].map.Insert(sparse_id, row);
+}
+
+size_t HashMapStorage::RemoveIndexIf(
+    size_t slot, const std::function<bool(uint64_t, char*)>& func) {
+  return hash_maps_[slot].map.RemoveIf(
+      [&func](const uint64_t& sparse_id, char* const& row) {
+        return func(sparse_id, row);
+      });
+}
+
+void HashMapStorage::ClearIndex(size_t slot) {
+  hash_maps_[slot].map.Clear();
+}
+
+char* HashMapStorage::Find(size_t slot, uint64_t sparse_id) {
+  auto it = hash_maps_[slot].map.Find(sparse_id);
+  if (it.Valid() == false) {
+    return nullptr;
+  }
+
+  return it.value();
+}
+
+size_t HashMapStorage::Size(size_t slot) const {
+  return hash_maps_[slot].map.Size();
+}
+
+bool HashMapStorage::ForEach(
+    size_t slot,
+    const std::function<bool(uint64_t, const char*)>& func) const {
+  for (auto it = hash_maps_[slot].map.Begin(); it.Valid(); it.Next()) {
+    if (func(it.key(), it.value()) == false) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+}  // namespace kraken
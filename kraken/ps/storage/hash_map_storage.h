@@ -0,0 +1,39 @@
+#pragma once
+
+#include "common/flat_hash_map.h"
+#include "ps/storage/sparse_storage.h"
+
+namespace kraken {
+
+// Every slot is a open-addressing FlatHashMap, O(1) Find for Pull/Push but the
+// sparse id is unordered.
+class HashMapStorage : public SparseStorage {
+private:
+  struct alignas(kCacheLineSize) PaddedIndex {
+    FlatHashMap<uint64_t, char*> map;
+  };
+
+  std::vector<PaddedIndex> hash_maps_;
+
+protected:
+  bool InsertIndex(size_t slot, uint64_t sparse_id, char* row) override;
+
+  size_t RemoveIndexIf(
+      size_t slot, const std::function<bool(uint64_t, char*)>& func) override;
+
+  void ClearIndex(size_t slot) override;
+
+public:
+  HashMapStorage(const RowLayout& layout, size_t slot_count);
+
+public:
+  char* Find(size_t slot, uint64_t sparse_id) override;
+
+  size_t Size(size_t slot) const override;
+
+  bool ForEach(size_t slot,
+               const std::function<bool(uint64_t, const char*)>& func)
+      const override;
+};
+
+}  // namespace kraken
@@ -0,0 +1,174 @@
+#include "ps/storage/quantize.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#ifdef __F16C__
+#include <immintrin.h>
+#endif
+
+namespace kraken {
+namespace quantize {
+
+namespace {
+
+inline uint32_t FloatBits(float v) {
+  uint32_t bits;
+  memcpy(&bits, &v, sizeof(bits));
+
+  return bits;
+}
+
+inline float BitsFloat(uint32_t bits) {
+  float v;
+  memcpy(&v, &bits, sizeof(v));
+
+  return v;
+}
+
+inline uint16_t FloatToHalfBits(float v) {
+  uint32_t bits = FloatBits(v);
+
+  uint16_t sign = (uint16_t)((bits >> 16) & 0x8000);
+  uint32_t abs = bits & 0x7FFFFFFF;
+
+  // NaN keep quiet, Inf keep Inf.
+  if (abs >= 0x7F800000) {
+    return sign | (abs > 0x7F800000 ? 0x7E00 : 0x7C00);
+  }
+
+  // Overflow to Inf, 65520 is the first value round to Inf.
+  if (abs >= 0x477FF000) {
+    return sign | 0x7C00;
+  }
+
+  // Subnormal or zero, add 0.5 to shift the mantissa by the hardware rounding.
+  if (abs < 0x38800000) {
+    float f = BitsFloat(abs) + 0.5f;
+    return sign | (uint16_t)(FloatBits(f) - FloatBits(0.5f));
+  }
+
+  // Normal, rebias the exponent and round to nearest even.
+  uint32_t odd = (abs >> 13) & 1;
+  abs += 0xC8000FFF + odd;
+
+  return sign | (uint16_t)(abs >> 13);
+}
+
+inline float HalfBitsToFloat(uint16_t h) {
+  uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+  uint32_t exp = (h >> 10) & 0x1F;
+  uint32_t man = h & 0x3FF;
+
+  if (exp == 0x1F) {
+    return BitsFloat(sign | 0x7F800000 | (man << 13));
+  }
+
+  if (exp == 0) {
+    // Subnormal or zero: man * 2^-24.
+    float f = std::ldexp((float)man, -24);
+    return sign ? -f : f;
+  }
+
+  return BitsFloat(sign | ((exp + 112) << 23) | (man << 13));
+}
+
+}  // namespace
+
+void FloatToHalf(const float* x, int64_t n, half* y) {
+  int64_t i = 0;
+
+#ifdef __F16C__
+  for (; i + 8 <= n; i += 8) {
+    __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(x + i),
+                                _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    _mm_storeu_si128((__m128i*)(y + i), h);
+  }
+#endif
+
+  for (; i < n; ++i) {
+    y[i].value = FloatToHalfBits(x[i]);
+  }
+}
+
+void HalfToFloat(const half* x, int64_t n, float* y) {
+  int64_t i = 0;
+
+#ifdef __F16C__
+  for (; i + 8 <= n; i += 8) {
+    __m128i h = _mm_loadu_si128((const __m128i*)(x + i));
+    _mm256_storeu_ps(y + i, _mm256_cvtph_ps(h));
+  }
+#endif
+
+  for (; i < n; ++i) {
+    y[i] = HalfBitsToFloat(x[i].value);
+  }
+}
+
+void FloatToBFloat16(const float* x, int64_t n, bfloat16* y) {
+  for (int64_t i = 0; i < n; ++i) {
+    uint32_t bits = FloatBits(x[i]);
+
+    if ((bits & 0x7FFFFFFF) > 0x7F800000) {
+      // Keep NaN quiet, the rounding maybe change it to Inf.
+      y[i].value = (uint16_t)((bits >> 16) | 0x40);
+    } else {
+      bits += 0x7FFF + ((bits >> 16) & 1);
+      y[i].value = (uint16_t)(bits >> 16);
+    }
+  }
+}
+
+void BFloat16ToFloat(const bfloat16* x, int64_t n, float* y) {
+  for (int64_t i = 0; i < n; ++i) {
+    y[i] = BitsFloat((uint32_t)x[i].value << 16);
+  }
+}
+
+void FloatToInt8(const float* x, int64_t n, int8_t* y, float* scale,
+                 float* bias) {
+  if (n <= 0) {
+    *scale = 0;
+    *bias = 0;
+    return;
+  }
+
+  float min_v = x[0];
+  float max_v = x[0];
+
+  for (int64_t i = 1; i < n; ++i) {
+    min_v = std::min(min_v, x[i]);
+    max_v = std::max(max_v, x[i]);
+  }
+
+  *bias = min_v;
+  *scale = (max_v - min_v) / 255.0f;
+
+  if (*scale <= 0) {
+    // All same, every q decode to bias.
+    *scale = 0;
+    memset(y, -128, n);
+    return;
+  }
+
+  float inv_scale = 1.0f / *scale;
+
+  for (int64_t i = 0; i < n; ++i) {
+    float q = std::nearbyint((x[i] - min_v) * inv_scale);
+    q = std::min(255.0f, std::max(0.0f, q));
+
+    y[i] = (int8_t)((int32_t)q - 128);
+  }
+}
+
+void Int8ToFloat(const int8_t* x, int64_t n, float scale, float bias,
+                 float* y) {
+  for (int64_t i = 0; i < n; ++i) {
+    y[i] = ((int32_t)x[i] + 128) * scale + bias;
+  }
+}
+
+}  // namespace quantize
+}  // namespace kraken
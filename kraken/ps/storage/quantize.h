@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cinttypes>
+
+#include "t/element_type.h"
+
+namespace kraken {
+namespace quantize {
+
+// Convert float vectors to the compact types and back, used by the compact
+// row storage. half/bfloat16 round to nearest even, half use F16C if compiled
+// with it.
+
+void FloatToHalf(const float* x, int64_t n, half* y);
+
+void HalfToFloat(const half* x, int64_t n, float* y);
+
+void FloatToBFloat16(const float* x, int64_t n, bfloat16* y);
+
+void BFloat16ToFloat(const bfloat16* x, int64_t n, float* y);
+
+// Linear quantize to int8: x = (q + 128) * scale + bias, bias is the min and
+// scale is (max - min) / 255.
+void FloatToInt8(const float* x, int64_t n, int8_t* y, float* scale,
+                 float* bias);
+
+void Int8ToFloat(const int8_t* x, int64_t n, float scale, float bias,
+                 float* y);
+
+}  // namespace quantize
+}  // namespace kraken
@@ -0,0 +1,240 @@
+#include "ps/storage/row_cache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+#include "common/utils.h"
+
+namespace kraken {
+
+RowCache::RowCache(size_t capacity, size_t vec_bytes)
+    : vec_bytes_(vec_bytes),
+      words_((vec_bytes + sizeof(uint64_t) - 1) / sizeof(uint64_t)),
+      set_count_(std::max<size_t>(1, (capacity + kWays - 1) / kWays)),
+      hit_count_(0),
+      miss_count_(0) {
+  entries_.reset(new Entry[set_count_ * kWays]());
+  data_.reset(new std::atomic<uint64_t>[set_count_ * kWays * words_]());
+  hands_.reset(new std::atomic<uint8_t>[set_count_]());
+}
+
+size_t RowCache::HitSet(uint64_t sparse_id) const {
+  return utils::Hash(sparse_id) % set_count_;
+}
+
+uint64_t RowCache::Lock(Entry& entry) {
+  uint64_t version = entry.version.load(std::memory_order_relaxed);
+
+  while (true) {
+    if ((version & 1) == 0 &&
+        entry.version.compare_exchange_weak(version, version + 1,
+                                            std::memory_order_acquire)) {
+      break;
+    }
+
+    std::this_thread::yield();
+    version = entry.version.load(std::memory_order_relaxed);
+  }
+
+  // The reader must see the odd version before the data be changed.
+  std::atomic_thread_fence(std::memory_order_release);
+
+  return version + 1;
+}
+
+void RowCache::Unlock(Entry& entry, uint64_t version) {
+  entry.version.store(version + 1, std::memory_order_release);
+}
+
+void RowCache::ReadVal(size_t idx, char* val) const {
+  std::atomic<uint64_t>* data = data_.get() + idx * words_;
+
+  for (size_t w = 0; w < words_; ++w) {
+    uint64_t word = data[w].load(std::memory_order_relaxed);
+    size_t offset = w * sizeof(uint64_t);
+
+    memcpy(val + offset, &word,
+           std::min(sizeof(uint64_t), vec_bytes_ - offset));
+  }
+}
+
+void RowCache::WriteVal(size_t idx, const char* val) {
+  std::atomic<uint64_t>* data = data_.get() + idx * words_;
+
+  for (size_t w = 0; w < words_; ++w) {
+    uint64_t word = 0;
+    size_t offset = w * sizeof(uint64_t);
+
+    memcpy(&word, val + offset,
+           std::min(sizeof(uint64_t), vec_bytes_ - offset));
+
+    data[w].store(word, std::memory_order_relaxed);
+  }
+}
+
+size_t RowCache::capacity() const {
+  return set_count_ * kWays;
+}
+
+uint64_t RowCache::hit_count() const {
+  return hit_count_.load(std::memory_order_relaxed);
+}
+
+uint64_t RowCache::miss_count() const {
+  return miss_count_.load(std::memory_order_relaxed);
+}
+
+void RowCache::Record(uint64_t hit_count, uint64_t miss_count) {
+  if (hit_count > 0) {
+    hit_count_.fetch_add(hit_count, std::memory_order_relaxed);
+  }
+
+  if (miss_count > 0) {
+    miss_count_.fetch_add(miss_count, std::memory_order_relaxed);
+  }
+}
+
+bool RowCache::Get(uint64_t sparse_id, char* val) {
+  size_t base = HitSet(sparse_id) * kWays;
+
+  for (size_t i = base; i < base + kWays; ++i) {
+    Entry& entry = entries_[i];
+
+    uint64_t version = entry.version.load(std::memory_order_acquire);
+    if ((version & 1) != 0 ||
+        entry.valid.load(std::memory_order_relaxed) == false ||
+        entry.sparse_id.load(std::memory_order_relaxed) != sparse_id) {
+      continue;
+    }
+
+    ReadVal(i, val);
+
+    // Check whether a writer changed the entry when reading.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (entry.version.load(std::memory_order_relaxed) != version) {
+      return false;
+    }
+
+    uint8_t ref = entry.ref.load(std::memory_order_relaxed);
+    if (ref < kMaxRef) {
+      entry.ref.store(ref + 1, std::memory_order_relaxed);
+    }
+
+    return true;
+  }
+
+  return false;
+}
+
+void RowCache::Put(uint64_t sparse_id, const char* val) {
+  size_t set = HitSet(sparse_id);
+  size_t base = set * kWays;
+
+  // Use a free entry first.
+  for (size_t i = base; i < base + kWays; ++i) {
+    Entry& entry = entries_[i];
+
+    if (entry.valid.load(std::memory_order_relaxed) &&
+        entry.sparse_id.load(std::memory_order_relaxed) == sparse_id) {
+      // Put by others, the caller hold the slot lock so it is same.
+      return;
+    }
+
+    if (entry.valid.load(std::memory_order_relaxed)) {
+      continue;
+    }
+
+    uint64_t version = Lock(entry);
+
+    if (entry.valid.load(std::memory_order_relaxed) == false) {
+      entry.sparse_id.store(sparse_id, std::memory_order_relaxed);
+      entry.valid.store(true, std::memory_order_relaxed);
+      entry.ref.store(0, std::memory_order_relaxed);
+      WriteVal(i, val);
+
+      Unlock(entry, version);
+      return;
+    }
+
+    Unlock(entry, version);
+  }
+
+  // CLOCK: give the entry a second chance if it has been hit.
+  size_t i = base + hands_[set].fetch_add(1, std::memory_order_relaxed) % kWays;
+  Entry& entry = entries_[i];
+
+  uint8_t ref = entry.ref.load(std::memory_order_relaxed);
+  if (ref > 0) {
+    entry.ref.store(ref - 1, std::memory_order_relaxed);
+    return;
+  }
+
+  uint64_t version = Lock(entry);
+
+  entry.sparse_id.store(sparse_id, std::memory_order_relaxed);
+  entry.valid.store(true, std::memory_order_relaxed);
+  entry.ref.store(0, std::memory_order_relaxed);
+  WriteVal(i, val);
+
+  Unlock(entry, version);
+}
+
+void RowCache::Update(uint64_t sparse_id, const char* val) {
+  size_t base = HitSet(sparse_id) * kWays;
+
+  for (size_t i = base; i < base + kWays; ++i) {
+    Entry& entry = entries_[i];
+
+    if (entry.valid.load(std::memory_order_relaxed) == false ||
+        entry.sparse_id.load(std::memory_order_relaxed) != sparse_id) {
+      continue;
+    }
+
+    uint64_t version = Lock(entry);
+
+    // Check again, it maybe replaced before locked.
+    if (entry.valid.load(std::memory_order_relaxed) &&
+        entry.sparse_id.load(std::memory_order_relaxed) == sparse_id) {
+      WriteVal(i, val);
+    }
+
+    Unlock(entry, version);
+  }
+}
+
+void RowCache::Remove(uint64_t sparse_id) {
+  RemoveIf(HitSet(sparse_id) * kWays, (HitSet(sparse_id) + 1) * kWays,
+           [sparse_id](uint64_t id) { return id == sparse_id; });
+}
+
+void RowCache::RemoveIf(const std::function<bool(uint64_t)>& func) {
+  RemoveIf(0, set_count_ * kWays, func);
+}
+
+void RowCache::RemoveIf(size_t begin, size_t end,
+                        const std::function<bool(uint64_t)>& func) {
+  for (size_t i = begin; i < end; ++i) {
+    Entry& entry = entries_[i];
+
+    if (entry.valid.load(std::memory_order_relaxed) == false ||
+        func(entry.sparse_id.load(std::memory_order_relaxed)) == false) {
+      continue;
+    }
+
+    uint64_t version = Lock(entry);
+
+    if (entry.valid.load(std::memory_order_relaxed) &&
+        func(entry.sparse_id.load(std::memory_order_relaxed))) {
+      entry.valid.store(false, std::memory_order_relaxed);
+    }
+
+    Unlock(entry, version);
+  }
+}
+
+void RowCache::Clear() {
+  RemoveIf(0, set_count_ * kWays, [](uint64_t) { return true; });
+}
+
+}  // namespace kraken
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <cinttypes>
+#include <functional>
+#include <memory>
+
+namespace kraken {
+
+/**
+ * \brief A bounded cache of the hot rows' val in front of SparseStorage.
+ *
+ * The cache is kWays set associative, a sparse id only can be cached in the
+ * set: hash(sparse_id) % set_count. Every entry is protected by a seqlock, so
+ * Get is lock-free and the writers only spin on the entry they write.
+ * The replacement is CLOCK: a hit increase the entry's ref, a miss decrease the
+ * ref of the entry the set's hand point to and only replace it when the ref is
+ * 0, so the frequent rows will not be evicted by the one-time rows.
+ *
+ * The cache not know the storage, the caller must keep it coherent: Put a row
+ * when hold the row's slot lock, and Update/Remove the row before release the
+ * slot's unique lock.
+ */
+class RowCache {
+private:
+  constexpr static size_t kWays = 4;
+  constexpr static uint8_t kMaxRef = 3;
+
+  struct Entry {
+    // Odd means a writer is writing the entry.
+    std::atomic<uint64_t> version;
+
+    std::atomic<bool> valid;
+    std::atomic<uint64_t> sparse_id;
+
+    std::atomic<uint8_t> ref;
+  };
+
+  size_t vec_bytes_;
+
+  // How many uint64_t to store a val.
+  size_t words_;
+
+  size_t set_count_;
+
+  std::unique_ptr<Entry[]> entries_;
+
+  // The val of the entries, every entry use words_ uint64_t.
+  std::unique_ptr<std::atomic<uint64_t>[]> data_;
+
+  // The CLOCK hand of every set.
+  std::unique_ptr<std::atomic<uint8_t>[]> hands_;
+
+  std::atomic<uint64_t> hit_count_;
+  std::atomic<uint64_t> miss_count_;
+
+public:
+  // capacity is the max row count.
+  RowCache(size_t capacity, size_t vec_bytes);
+
+private:
+  size_t HitSet(uint64_t sparse_id) const;
+
+  // Lock the entry for writing, return the locked version.
+  uint64_t Lock(Entry& entry);
+
+  void Unlock(Entry& entry, uint64_t version);
+
+  void ReadVal(size_t idx, char* val) const;
+
+  void WriteVal(size_t idx, const char* val);
+
+  // Remove the entries in [begin, end) that func return true.
+  void RemoveIf(size_t begin, size_t end,
+                const std::function<bool(uint64_t)>& func);
+
+public:
+  size_t capacity() const;
+
+  uint64_t hit_count() const;
+
+  uint64_t miss_count() const;
+
+  // Add the hit/miss count, the caller count a batch then add once.
+  void Record(uint64_t hit_count, uint64_t miss_count);
+
+  // Copy the cached val to val, return false if not cached.
+  bool Get(uint64_t sparse_id, char* val);
+
+  // Try to cache the row's val, maybe not be admitted.
+  void Put(uint64_t sparse_id, const char* val);
+
+  // Update the val if it is cached.
+  void Update(uint64_t sparse_id, const char* val);
+
+  void Remove(uint64_t sparse_id);
+
+  // Remove the cached sparse id that func return true.
+  void RemoveIf(const std::function<bool(uint64_t)>& func);
+
+  void Clear();
+};
+
+}  // namespace kraken
@@ -0,0 +1,251 @@
+#include "ps/storage/row_file.h"
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "common/exception.h"
+#include "common/log.h"
+
+namespace kraken {
+
+RowFile::RowFile(const std::string& path, size_t stride)
+    : path_(path),
+      stride_(stride),
+      record_bytes_(sizeof(uint64_t) + stride),
+      fd_(-1),
+      data_(nullptr),
+      capacity_(0),
+      end_(0),
+      version_(0) {
+  fd_ = open(path_.c_str(), O_RDWR | O_CREAT, 0644);
+
+  ARGUMENT_CHECK(fd_ >= 0, "Open RowFile:[" << path_ << "] error:["
+                                            << strerror(errno) << "]");
+
+  // Another RowFile (maybe in other process) is using it, do not truncate.
+  if (flock(fd_, LOCK_EX | LOCK_NB) != 0) {
+    int error_no = errno;
+
+    close(fd_);
+    fd_ = -1;
+
+    RUNTIME_ERROR("Lock RowFile:[" << path_ << "] error:["
+                                   << strerror(error_no)
+                                   << "], it maybe used by another one.");
+  }
+
+  // The left file of a crashed process is useless.
+  if (ftruncate(fd_, 0) != 0) {
+    int error_no = errno;
+
+    close(fd_);
+    fd_ = -1;
+
+    RUNTIME_ERROR("Truncate RowFile:[" << path_ << "] error:["
+                                       << strerror(error_no) << "]");
+  }
+}
+
+RowFile::~RowFile() {
+  Close();
+}
+
+bool RowFile::Grow(size_t min_capacity) {
+  size_t capacity = std::max(capacity_ * 2, kMinGrowBytes);
+  capacity = std::max(capacity, min_capacity);
+
+  if (ftruncate(fd_, (off_t)capacity) != 0) {
+    LOG_ERROR("Grow RowFile:[" << path_ << "] to:[" << capacity
+                               << "] error:[" << strerror(errno) << "]");
+    return false;
+  }
+
+  void* data = nullptr;
+
+  if (data_ == nullptr) {
+    data = mmap(nullptr, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+  } else {
+    data = mremap(data_, capacity_, capacity, MREMAP_MAYMOVE);
+  }
+
+  if (data == MAP_FAILED) {
+    LOG_ERROR("Map RowFile:[" << path_ << "] error:[" << strerror(errno)
+                              << "]");
+    return false;
+  }
+
+  data_ = (char*)data;
+  capacity_ = capacity;
+
+  return true;
+}
+
+void RowFile::Close() {
+  if (data_ != nullptr) {
+    munmap(data_, capacity_);
+    data_ = nullptr;
+  }
+
+  if (fd_ >= 0) {
+    close(fd_);
+    unlink(path_.c_str());
+
+    fd_ = -1;
+  }
+
+  capacity_ = 0;
+  end_ = 0;
+  index_.clear();
+}
+
+const std::string& RowFile::path() const {
+  return path_;
+}
+
+size_t RowFile::stride() const {
+  return stride_;
+}
+
+size_t RowFile::Size() const {
+  return index_.size();
+}
+
+size_t RowFile::DeadCount() const {
+  return end_ / record_bytes_ - index_.size();
+}
+
+uint64_t RowFile::version() const {
+  return version_;
+}
+
+const char* RowFile::Find(uint64_t sparse_id) const {
+  auto it = index_.find(sparse_id);
+  if (it == index_.end()) {
+    return nullptr;
+  }
+
+  return data_ + it->second + sizeof(uint64_t);
+}
+
+bool RowFile::Put(uint64_t sparse_id, const char* row) {
+  if (end_ + record_bytes_ > capacity_ && Grow(end_ + record_bytes_) == false) {
+    return false;
+  }
+
+  memcpy(data_ + end_, &sparse_id, sizeof(uint64_t));
+  memcpy(data_ + end_ + sizeof(uint64_t), row, stride_);
+
+  index_[sparse_id] = end_;
+  end_ += record_bytes_;
+
+  version_++;
+
+  return true;
+}
+
+bool RowFile::Remove(uint64_t sparse_id) {
+  if (index_.erase(sparse_id) == 0) {
+    return false;
+  }
+
+  version_++;
+
+  return true;
+}
+
+bool RowFile::ForEach(
+    const std::function<bool(uint64_t, const char*)>& func) const {
+  for (const auto& [sparse_id, offset] : index_) {
+    if (func(sparse_id, data_ + offset + sizeof(uint64_t)) == false) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void RowFile::Clear() {
+  if (data_ != nullptr) {
+    munmap(data_, capacity_);
+    data_ = nullptr;
+  }
+
+  // Release the disk space.
+  if (ftruncate(fd_, 0) != 0) {
+    LOG_WARNING("Truncate RowFile:[" << path_ << "] error:["
+                                     << strerror(errno) << "]");
+  }
+
+  capacity_ = 0;
+  end_ = 0;
+  index_.clear();
+
+  version_++;
+}
+
+std::unique_ptr<RowFile> RowFile::Compact(const std::string& path) const {
+  std::unique_ptr<RowFile> compacted(new RowFile(path, stride_));
+
+  if (index_.empty() == false &&
+      compacted->Grow(index_.size() * record_bytes_) == false) {
+    return nullptr;
+  }
+
+  // Copy by the file order, so the disk is read sequentially.
+  std::vector<size_t> offsets;
+  offsets.reserve(index_.size());
+
+  for (const auto& [sparse_id, offset] : index_) {
+    offsets.emplace_back(offset);
+  }
+
+  std::sort(offsets.begin(), offsets.end());
+
+  for (auto offset : offsets) {
+    uint64_t sparse_id;
+    memcpy(&sparse_id, data_ + offset, sizeof(uint64_t));
+
+    compacted->Put(sparse_id, data_ + offset + sizeof(uint64_t));
+  }
+
+  return compacted;
+}
+
+bool RowFile::Replace(RowFile* compacted) {
+  if (rename(compacted->path_.c_str(), path_.c_str()) != 0) {
+    LOG_ERROR("Rename RowFile:[" << compacted->path_ << "] to:[" << path_
+                                 << "] error:[" << strerror(errno) << "]");
+    return false;
+  }
+
+  // The old file is unlinked by rename, do not unlink the path again.
+  if (data_ != nullptr) {
+    munmap(data_, capacity_);
+  }
+
+  close(fd_);
+
+  fd_ = compacted->fd_;
+  data_ = compacted->data_;
+  capacity_ = compacted->capacity_;
+  end_ = compacted->end_;
+  index_.swap(compacted->index_);
+
+  version_++;
+
+  compacted->fd_ = -1;
+  compacted->data_ = nullptr;
+  compacted->Close();
+
+  return true;
+}
+
+}  // namespace kraken
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cinttypes>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace kraken {
+
+/**
+ * \brief An append-only memory-mapped file of fixed-stride rows, not
+ * thread-safe.
+ *
+ * Every record is: [sparse_id | row], the in-memory index map the sparse id to
+ * it's newest record. Put append a record and Remove only drop the index, so
+ * the file keep growing with dead records until Compact copy the live ones to
+ * a new file. The file grows by doubling and the mapping is remapped, so a row
+ * pointer is only valid until the next Put/Replace.
+ *
+ * The file is a spill area not a persistent one, it is truncated when open and
+ * deleted when destroyed. The file is locked (flock) when open, open a file
+ * that used by another RowFile throw error instead of truncate it.
+ */
+class RowFile {
+private:
+  // The first grow map 1MB at least.
+  constexpr static size_t kMinGrowBytes = 1 << 20;
+
+  std::string path_;
+
+  size_t stride_;
+  size_t record_bytes_;
+
+  int fd_;
+
+  char* data_;
+  size_t capacity_;
+
+  // The append offset.
+  size_t end_;
+
+  // sparse id -> the record's offset.
+  std::unordered_map<uint64_t, size_t> index_;
+
+  // Increased by every modification, Compact use it to check whether the file
+  // is changed when copying.
+  uint64_t version_;
+
+public:
+  RowFile(const std::string& path, size_t stride);
+
+  RowFile(const RowFile&) = delete;
+  RowFile& operator=(const RowFile&) = delete;
+
+  ~RowFile();
+
+private:
+  bool Grow(size_t min_capacity);
+
+  void Close();
+
+public:
+  const std::string& path() const;
+
+  size_t stride() const;
+
+  // The live row count.
+  size_t Size() const;
+
+  // The dead record count.
+  size_t DeadCount() const;
+
+  uint64_t version() const;
+
+  // Return nullptr if not exist.
+  const char* Find(uint64_t sparse_id) const;
+
+  // Append the row, the old one become dead. Return false if the file can not
+  // grow.
+  bool Put(uint64_t sparse_id, const char* row);
+
+  bool Remove(uint64_t sparse_id);
+
+  // Iterate the live rows, stop when func return false. Return false if
+  // stopped.
+  bool ForEach(
+      const std::function<bool(uint64_t, const char*)>& func) const;
+
+  void Clear();
+
+  // Copy the live rows to a new file at path, return nullptr if failed. This is
+  // not modify the file so can run with the other readers.
+  std::unique_ptr<RowFile> Compact(const std::string& path) const;
+
+  // Replace this by the compacted file, the compacted file is renamed to
+  // path().
+  bool Replace(RowFile* compacted);
+};
+
+}  // namespace kraken
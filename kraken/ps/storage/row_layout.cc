@@ -0,0 +1,265 @@
+#include "ps/storage/row_layout.h"
+
+#include <cassert>
+#include <cstring>
+
+#include "common/exception.h"
+#include "ps/storage/quantize.h"
+#include "t/storage.h"
+
+namespace kraken {
+
+RowLayout::RowLayout(int64_t dimension, ElementType element_type,
+                     const std::vector<StateType>& state_types,
+                     bool with_access, ElementType store_type)
+    : dimension_(dimension),
+      element_type_(element_type),
+      state_types_(state_types),
+      store_type_(store_type),
+      with_access_(with_access) {
+  vec_bytes_ = dimension_ * element_type_.ByteWidth();
+
+  if (store_type_.Is<UnKnown>()) {
+    store_type_ = element_type_;
+  }
+
+  ARGUMENT_CHECK(store_type_ == element_type_ ||
+                     (element_type_.Is<float>() &&
+                      (store_type_.Is<half>() || store_type_.Is<bfloat16>() ||
+                       store_type_.Is<int8_t>())),
+                 "RowLayout not support store:" << element_type_.Name()
+                                                << " as:"
+                                                << store_type_.Name());
+
+  if (store_type_.Is<int8_t>() && compact()) {
+    store_vec_bytes_ = 2 * sizeof(float) + dimension_;
+  } else {
+    store_vec_bytes_ = dimension_ * store_type_.ByteWidth();
+  }
+
+  // Steps align to 8 bytes.
+  steps_offset_ = (state_types_.size() + 1) * store_vec_bytes_;
+  steps_offset_ = (steps_offset_ + 7) / 8 * 8;
+
+  access_offset_ = steps_offset_ + sizeof(int64_t);
+
+  stride_ = access_offset_;
+  if (with_access_) {
+    stride_ += 2 * sizeof(int64_t);
+  }
+}
+
+int64_t RowLayout::dimension() const {
+  return dimension_;
+}
+
+ElementType RowLayout::element_type() const {
+  return element_type_;
+}
+
+const std::vector<StateType>& RowLayout::state_types() const {
+  return state_types_;
+}
+
+size_t RowLayout::vec_bytes() const {
+  return vec_bytes_;
+}
+
+size_t RowLayout::stride() const {
+  return stride_;
+}
+
+bool RowLayout::with_access() const {
+  return with_access_;
+}
+
+ElementType RowLayout::store_type() const {
+  return store_type_;
+}
+
+size_t RowLayout::store_vec_bytes() const {
+  return store_vec_bytes_;
+}
+
+bool RowLayout::compact() const {
+  return store_type_ != element_type_;
+}
+
+RowLayout RowLayout::Full() const {
+  return RowLayout(dimension_, element_type_, state_types_);
+}
+
+void RowLayout::ReadVec(const char* vec, char* out) const {
+  if (compact() == false) {
+    memcpy(out, vec, vec_bytes_);
+  } else if (store_type_.Is<half>()) {
+    quantize::HalfToFloat((const half*)vec, dimension_, (float*)out);
+  } else if (store_type_.Is<bfloat16>()) {
+    quantize::BFloat16ToFloat((const bfloat16*)vec, dimension_, (float*)out);
+  } else {
+    float scale;
+    float bias;
+    memcpy(&scale, vec, sizeof(float));
+    memcpy(&bias, vec + sizeof(float), sizeof(float));
+
+    quantize::Int8ToFloat((const int8_t*)(vec + 2 * sizeof(float)),
+                          dimension_, scale, bias, (float*)out);
+  }
+}
+
+void RowLayout::WriteVec(const char* in, char* vec) const {
+  if (compact() == false) {
+    memcpy(vec, in, vec_bytes_);
+  } else if (store_type_.Is<half>()) {
+    quantize::FloatToHalf((const float*)in, dimension_, (half*)vec);
+  } else if (store_type_.Is<bfloat16>()) {
+    quantize::FloatToBFloat16((const float*)in, dimension_, (bfloat16*)vec);
+  } else {
+    float scale;
+    float bias;
+
+    quantize::FloatToInt8((const float*)in, dimension_,
+                          (int8_t*)(vec + 2 * sizeof(float)), &scale, &bias);
+
+    memcpy(vec, &scale, sizeof(float));
+    memcpy(vec + sizeof(float), &bias, sizeof(float));
+  }
+}
+
+void RowLayout::Decode(const char* row, char* full_row) const {
+  // The Full() layout: vectors are contiguous, steps align to 8 bytes.
+  size_t count = state_types_.size() + 1;
+  size_t full_steps_offset = (count * vec_bytes_ + 7) / 8 * 8;
+
+  for (size_t i = 0; i < count; ++i) {
+    ReadVec(row + i * store_vec_bytes_, full_row + i * vec_bytes_);
+  }
+
+  *((int64_t*)(full_row + full_steps_offset)) = Steps(row);
+}
+
+void RowLayout::Encode(const char* full_row, char* row) const {
+  size_t count = state_types_.size() + 1;
+  size_t full_steps_offset = (count * vec_bytes_ + 7) / 8 * 8;
+
+  for (size_t i = 0; i < count; ++i) {
+    WriteVec(full_row + i * vec_bytes_, row + i * store_vec_bytes_);
+  }
+
+  *Steps(row) = *((const int64_t*)(full_row + full_steps_offset));
+}
+
+void RowLayout::ResetAccess(char* row) const {
+  *AccessStep(row) = kUnknownStep;
+  *AccessCount(row) = 0;
+}
+
+Tensor RowLayout::ValView(char* row) const {
+  assert(compact() == false);
+
+  return Tensor::Dense(Shape({dimension_}),
+                       Storage::From(Val(row), vec_bytes_), 0, element_type_);
+}
+
+Tensor RowLayout::CopyVal(const char* row) const {
+  Tensor val = Tensor::Dense({dimension_}, element_type_);
+  ReadVec(Val(row), (char*)val.Ptr());
+
+  return val;
+}
+
+void RowLayout::ZeroStates(char* row) const {
+  // A zero compact vector also decode to zero.
+  memset(State(row, 0), 0, state_types_.size() * store_vec_bytes_);
+  *Steps(row) = 0;
+}
+
+void RowLayout::View(char* row, Value* value) const {
+  assert(compact() == false);
+
+  value->val = ValView(row);
+  value->states.clear();
+  value->states_i.clear();
+
+  int64_t steps = Steps((const char*)row);
+  if (steps <= 0) {
+    return;
+  }
+
+  for (size_t i = 0; i < state_types_.size(); ++i) {
+    value->states.emplace(
+        state_types_[i],
+        Tensor::Dense(Shape({dimension_}),
+                      Storage::From(State(row, i), vec_bytes_), 0,
+                      element_type_));
+  }
+
+  value->states_i.emplace(StateType::kSteps, steps);
+}
+
+void RowLayout::Store(const Value& value, char* row) const {
+  assert(compact() == false);
+
+  // The optim maybe create a new Tensor instead of update in place.
+  if (value.val.Ptr() != Val(row)) {
+    memcpy(Val(row), value.val.Ptr(), vec_bytes_);
+  }
+
+  for (size_t i = 0; i < state_types_.size(); ++i) {
+    auto it = value.states.find(state_types_[i]);
+
+    if (it == value.states.end()) {
+      memset(State(row, i), 0, vec_bytes_);
+    } else if (it->second.Ptr() != State(row, i)) {
+      memcpy(State(row, i), it->second.Ptr(), vec_bytes_);
+    }
+  }
+}
+
+void RowLayout::ToValue(const char* row, Value* value) const {
+  value->val = CopyVal(row);
+  value->states.clear();
+  value->states_i.clear();
+
+  int64_t steps = Steps(row);
+  if (steps <= 0) {
+    return;
+  }
+
+  for (size_t i = 0; i < state_types_.size(); ++i) {
+    Tensor state = Tensor::Dense({dimension_}, element_type_);
+    ReadVec(State(row, i), (char*)state.Ptr());
+
+    value->states.emplace(state_types_[i], state);
+  }
+
+  value->states_i.emplace(StateType::kSteps, steps);
+}
+
+void RowLayout::FromValue(const Value& value, char* row) const {
+  if (compact()) {
+    WriteVec((const char*)value.val.Ptr(), Val(row));
+
+    for (size_t i = 0; i < state_types_.size(); ++i) {
+      auto it = value.states.find(state_types_[i]);
+
+      if (it == value.states.end()) {
+        memset(State(row, i), 0, store_vec_bytes_);
+      } else {
+        WriteVec((const char*)it->second.Ptr(), State(row, i));
+      }
+    }
+  } else {
+    Store(value, row);
+  }
+
+  auto it = value.states_i.find(StateType::kSteps);
+  if (it != value.states_i.end()) {
+    *Steps(row) = it->second;
+  } else {
+    // The Value not record steps, but has states means it has been updated.
+    *Steps(row) = value.states.empty() ? 0 : 1;
+  }
+}
+
+}  // namespace kraken
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <cinttypes>
+#include <vector>
+
+#include "common/info.h"
+#include "t/element_type.h"
+#include "t/tensor.h"
+
+namespace kraken {
+
+/**
+ * \brief The memory layout of a sparse row.
+ *
+ * A row is: [val | state_0 | state_1 | ... | steps | (access_step |
+ * access_count)].
+ * val and every state is a vector of dimension, the state types decided by the
+ * Optim. steps is a int64_t counter of how many times the row has been updated,
+ * the states only valid when steps > 0.
+ * The access is only kept when with_access is true, it is used by eviction:
+ * the last step the row be accessed and how many times it be accessed.
+ *
+ * If element_type is float the vectors can be stored in a compact store_type:
+ * float16/bfloat16, or int8 that a vector is [scale | bias | int8 x dimension].
+ * A compact vector can not be viewed as a Tensor, use ReadVec/WriteVec or
+ * Decode/Encode the row to a Full() row.
+ */
+class RowLayout {
+public:
+  // The access step of a row that not know when be accessed, like the row
+  // transferred from other node.
+  constexpr static int64_t kUnknownStep = -1;
+
+private:
+  int64_t dimension_;
+  ElementType element_type_;
+
+  std::vector<StateType> state_types_;
+
+  // The bytes of a vector.
+  size_t vec_bytes_;
+
+  ElementType store_type_;
+
+  // The bytes of a vector stored in the row.
+  size_t store_vec_bytes_;
+
+  size_t steps_offset_;
+
+  bool with_access_;
+  size_t access_offset_;
+
+  size_t stride_;
+
+public:
+  RowLayout(int64_t dimension, ElementType element_type,
+            const std::vector<StateType>& state_types,
+            bool with_access = false,
+            ElementType store_type = ElementType::From<UnKnown>());
+
+public:
+  int64_t dimension() const;
+
+  ElementType element_type() const;
+
+  const std::vector<StateType>& state_types() const;
+
+  size_t vec_bytes() const;
+
+  size_t stride() const;
+
+  bool with_access() const;
+
+  ElementType store_type() const;
+
+  size_t store_vec_bytes() const;
+
+  // Whether store the vectors in a type different with element_type.
+  bool compact() const;
+
+  // The not compact layout without access, use to run the Optim.
+  RowLayout Full() const;
+
+  inline char* Val(char* row) const {
+    return row;
+  }
+
+  inline const char* Val(const char* row) const {
+    return row;
+  }
+
+  inline char* State(char* row, size_t i) const {
+    return row + (i + 1) * store_vec_bytes_;
+  }
+
+  inline const char* State(const char* row, size_t i) const {
+    return row + (i + 1) * store_vec_bytes_;
+  }
+
+  inline int64_t* Steps(char* row) const {
+    return (int64_t*)(row + steps_offset_);
+  }
+
+  inline int64_t Steps(const char* row) const {
+    return *((const int64_t*)(row + steps_offset_));
+  }
+
+  // Below access functions only valid when with_access is true.
+  inline int64_t* AccessStep(char* row) const {
+    return (int64_t*)(row + access_offset_);
+  }
+
+  // The const one maybe read under the shared lock with the concurrent
+  // SharedTouch, so load atomic.
+  inline int64_t AccessStep(const char* row) const {
+    return __atomic_load_n((const int64_t*)(row + access_offset_),
+                           __ATOMIC_RELAXED);
+  }
+
+  inline int64_t* AccessCount(char* row) const {
+    return (int64_t*)(row + access_offset_ + sizeof(int64_t));
+  }
+
+  inline int64_t AccessCount(const char* row) const {
+    return __atomic_load_n(
+        (const int64_t*)(row + access_offset_ + sizeof(int64_t)),
+        __ATOMIC_RELAXED);
+  }
+
+  // Record the row is accessed at step.
+  inline void Touch(char* row, int64_t step) const {
+    *AccessStep(row) = step;
+    (*AccessCount(row))++;
+  }
+
+  // Record the row is accessed count times, the last one at step. Used under
+  // the shared lock (like Pull), the concurrent readers maybe touch the same
+  // row so update by relaxed atomic and the step never go back.
+  inline void SharedTouch(char* row, int64_t step, int64_t count = 1) const {
+    int64_t* access_step = AccessStep(row);
+    int64_t old = __atomic_load_n(access_step, __ATOMIC_RELAXED);
+
+    while (old < step &&
+           !__atomic_compare_exchange_n(access_step, &old, step, true,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+
+    __atomic_fetch_add(AccessCount(row), count, __ATOMIC_RELAXED);
+  }
+
+  // Set the access step to kUnknownStep and the count to 0.
+  void ResetAccess(char* row) const;
+
+  // Decode a stored vector (Val/State) to element_type.
+  void ReadVec(const char* vec, char* out) const;
+
+  // Encode a element_type vector to the stored vector.
+  void WriteVec(const char* in, char* vec) const;
+
+  // Decode the row to a Full() row, include states and steps.
+  void Decode(const char* row, char* full_row) const;
+
+  // Encode a Full() row to the row, include states and steps.
+  void Encode(const char* full_row, char* row) const;
+
+  // A Tensor share the memory with the row's val, not compact only.
+  Tensor ValView(char* row) const;
+
+  // Copy the row's val to a new Tensor.
+  Tensor CopyVal(const char* row) const;
+
+  // Zero the states and steps.
+  void ZeroStates(char* row) const;
+
+  // Create a Value share memory with the row, the states only be set when the
+  // row has been updated. Use to call Optim::Update, not compact only.
+  void View(char* row, Value* value) const;
+
+  // Copy the Value's val/states back to the row, not include steps.
+  void Store(const Value& value, char* row) const;
+
+  // Copy the row to a Value.
+  void ToValue(const char* row, Value* value) const;
+
+  // Copy a Value to the row, include steps.
+  void FromValue(const Value& value, char* row) const;
+};
+
+}  // namespace kraken
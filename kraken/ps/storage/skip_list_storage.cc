@@ -0,0 +1,61 @@
+#include "ps/storage/skip_list_storage.h"
+
+namespace kraken {
+
+SkipListStorage::SkipListStorage(const RowLayout& layout, size_t slot_count)
+    : SparseStorage(StorageType::kSkipList, layout, slot_count),
+      skip_lists_(slot_count) {
+}
+
+bool SkipListStorage::InsertIndex(size_t slot, uint64_t sparse_id,
+                                  char* row) {
+  return skip_lists_[slot].list.Insert(sparse_id, row);
+}
+
+size_t SkipListStorage::RemoveIndexIf(
+    size_t slot, const std::function<bool(uint64_t, char*)>& func) {
+  size_t count = 0;
+
+  auto it = skip_lists_[slot].list.Begin();
+  while (it.Valid()) {
+    if (func(it.key(), it.value())) {
+      it = skip_lists_[slot].list.Remove(it);
+      count++;
+    } else {
+      it.Next();
+    }
+  }
+
+  return count;
+}
+
+void SkipListStorage::ClearIndex(size_t slot) {
+  skip_lists_[slot].list.Clear();
+}
+
+char* SkipListStorage::Find(size_t slot, uint64_t sparse_id) {
+  auto it = skip_lists_[slot].list.Find(sparse_id);
+  if (it.Valid() == false) {
+    return nullptr;
+  }
+
+  return it.value();
+}
+
+size_t SkipListStorage::Size(size_t slot) const {
+  return skip_lists_[slot].list.Size();
+}
+
+bool SkipListStorage::ForEach(
+    size_t slot,
+    const std::function<bool(uint64_t, const char*)>& func) const {
+  for (auto it = skip_lists_[slot].list.Begin(); it.Valid(); it.Next()) {
+    if (func(it.key(), it.value()) == false) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+}  // namespace kraken
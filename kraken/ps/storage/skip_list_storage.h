@@ -0,0 +1,38 @@
+#pragma once
+
+#include "common/skip_list.h"
+#include "ps/storage/sparse_storage.h"
+
+namespace kraken {
+
+// Every slot is a SkipList, the sparse id is ordered in one slot.
+class SkipListStorage : public SparseStorage {
+private:
+  struct alignas(kCacheLineSize) PaddedIndex {
+    SkipList<uint64_t, char*> list;
+  };
+
+  std::vector<PaddedIndex> skip_lists_;
+
+protected:
+  bool InsertIndex(size_t slot, uint64_t sparse_id, char* row) override;
+
+  size_t RemoveIndexIf(
+      size_t slot, const std::function<bool(uint64_t, char*)>& func) override;
+
+  void ClearIndex(size_t slot) override;
+
+public:
+  SkipListStorage(const RowLayout& layout, size_t slot_count);
+
+public:
+  char* Find(size_t slot, uint64_t sparse_id) override;
+
+  size_t Size(size_t slot) const override;
+
+  bool ForEach(size_t slot,
+               const std::function<bool(uint64_t, const char*)>& func)
+      const override;
+};
+
+}  // namespace kraken
@@ -0,0 +1,377 @@
+#include "ps/storage/sparse_storage.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+
+#include "common/exception.h"
+#include "common/log.h"
+#include "common/utils.h"
+#include "ps/storage/hash_map_storage.h"
+#include "ps/storage/skip_list_storage.h"
+
+namespace kraken {
+
+SparseStorage::SparseStorage(StorageType type, const RowLayout& layout,
+                             size_t slot_count)
+    : type_(type), layout_(layout) {
+  slots_.reserve(slot_count);
+  for (size_t i = 0; i < slot_count; ++i) {
+    slots_.emplace_back(new Slot(layout_.stride()));
+  }
+}
+
+StorageType SparseStorage::type() const {
+  return type_;
+}
+
+const RowLayout& SparseStorage::layout() const {
+  return layout_;
+}
+
+size_t SparseStorage::slot_count() const {
+  return slots_.size();
+}
+
+RowCache* SparseStorage::cache() const {
+  return cache_.get();
+}
+
+bool SparseStorage::tiered() const {
+  return slots_[0]->cold != nullptr;
+}
+
+SparseStorage::UniqueHandler SparseStorage::UniqueSlotHandler(size_t slot) {
+  return UniqueHandler(slots_[slot]->locker);
+}
+
+SparseStorage::SharedHandler SparseStorage::SharedSlotHandler(size_t slot) {
+  return SharedHandler(slots_[slot]->locker);
+}
+
+char* SparseStorage::Insert(size_t slot, uint64_t sparse_id) {
+  // Exist in the cold file, need Load.
+  if (FindCold(slot, sparse_id) != nullptr) {
+    return nullptr;
+  }
+
+  Slab& slab = slots_[slot]->slab;
+  char* row = slab.Allocate();
+
+  if (InsertIndex(slot, sparse_id, row) == false) {
+    slab.Free(row);
+    return nullptr;
+  }
+
+  if (layout_.with_access()) {
+    layout_.ResetAccess(row);
+  }
+
+  return row;
+}
+
+size_t SparseStorage::RemoveIf(
+    size_t slot, const std::function<bool(uint64_t, char*)>& func) {
+  Slab& slab = slots_[slot]->slab;
+  RowCache* cache = cache_.get();
+
+  return RemoveIndexIf(
+      slot, [&slab, cache, &func](uint64_t sparse_id, char* row) {
+        if (func(sparse_id, row)) {
+          if (cache != nullptr) {
+            cache->Remove(sparse_id);
+          }
+
+          // The index will not touch the row after removed.
+          slab.Free(row);
+          return true;
+        }
+
+        return false;
+      });
+}
+
+void SparseStorage::Clear(size_t slot) {
+  if (cache_ != nullptr) {
+    cache_->RemoveIf([this, slot](uint64_t sparse_id) {
+      return HitSlot(sparse_id) == slot;
+    });
+  }
+
+  ClearIndex(slot);
+  slots_[slot]->slab.Clear();
+
+  if (slots_[slot]->cold != nullptr) {
+    slots_[slot]->cold->Clear();
+  }
+}
+
+size_t SparseStorage::SpillIf(
+    size_t slot, const std::function<bool(uint64_t, char*)>& func) {
+  RowFile* cold = slots_[slot]->cold.get();
+  if (cold == nullptr) {
+    return RemoveIf(slot, func);
+  }
+
+  return RemoveIf(slot, [cold, &func](uint64_t sparse_id, char* row) {
+    return func(sparse_id, row) && cold->Put(sparse_id, row);
+  });
+}
+
+const char* SparseStorage::FindCold(size_t slot, uint64_t sparse_id) const {
+  const RowFile* cold = slots_[slot]->cold.get();
+  if (cold == nullptr) {
+    return nullptr;
+  }
+
+  return cold->Find(sparse_id);
+}
+
+char* SparseStorage::Load(size_t slot, uint64_t sparse_id) {
+  RowFile* cold = slots_[slot]->cold.get();
+  if (cold == nullptr) {
+    return nullptr;
+  }
+
+  const char* cold_row = cold->Find(sparse_id);
+  if (cold_row == nullptr) {
+    return nullptr;
+  }
+
+  Slab& slab = slots_[slot]->slab;
+  char* row = slab.Allocate();
+
+  memcpy(row, cold_row, layout_.stride());
+
+  if (InsertIndex(slot, sparse_id, row) == false) {
+    // Exist in memory, the memory one is newer.
+    slab.Free(row);
+    cold->Remove(sparse_id);
+
+    return Find(slot, sparse_id);
+  }
+
+  cold->Remove(sparse_id);
+
+  if (layout_.with_access()) {
+    layout_.ResetAccess(row);
+  }
+
+  return row;
+}
+
+size_t SparseStorage::ColdSize(size_t slot) const {
+  const RowFile* cold = slots_[slot]->cold.get();
+  if (cold == nullptr) {
+    return 0;
+  }
+
+  return cold->Size();
+}
+
+bool SparseStorage::ForEachCold(
+    size_t slot,
+    const std::function<bool(uint64_t, const char*)>& func) const {
+  const RowFile* cold = slots_[slot]->cold.get();
+  if (cold == nullptr) {
+    return true;
+  }
+
+  return cold->ForEach(func);
+}
+
+bool SparseStorage::CompactCold(size_t slot) {
+  RowFile* cold = slots_[slot]->cold.get();
+  if (cold == nullptr) {
+    return false;
+  }
+
+  std::unique_ptr<RowFile> compacted;
+  uint64_t version;
+
+  {
+    std::shared_lock<std::shared_mutex> _(slots_[slot]->locker);
+
+    if (cold->DeadCount() == 0 || cold->DeadCount() < cold->Size()) {
+      return false;
+    }
+
+    version = cold->version();
+    compacted = cold->Compact(cold->path() + ".compact");
+  }
+
+  if (compacted == nullptr) {
+    return false;
+  }
+
+  std::unique_lock<std::shared_mutex> _(slots_[slot]->locker);
+
+  // Modified when copying, try next time.
+  if (cold->version() != version) {
+    return false;
+  }
+
+  return cold->Replace(compacted.get());
+}
+
+bool SparseStorage::Contains(uint64_t sparse_id) {
+  size_t slot = HitSlot(sparse_id);
+
+  std::shared_lock<std::shared_mutex> _(slots_[slot]->locker);
+  return Find(slot, sparse_id) != nullptr ||
+         FindCold(slot, sparse_id) != nullptr;
+}
+
+bool SparseStorage::Insert(uint64_t sparse_id, const Value& value) {
+  size_t slot = HitSlot(sparse_id);
+
+  std::unique_lock<std::shared_mutex> _(slots_[slot]->locker);
+
+  char* row = Insert(slot, sparse_id);
+  if (row == nullptr) {
+    return false;
+  }
+
+  layout_.FromValue(value, row);
+
+  return true;
+}
+
+void SparseStorage::Insert(const std::vector<uint64_t>& sparse_ids,
+                           const std::vector<Value>& values) {
+  assert(sparse_ids.size() == values.size());
+
+  std::unordered_map<size_t /*slot*/, std::vector<size_t>> slot_idx_map;
+  slot_idx_map.reserve(slot_count());
+
+  for (size_t i = 0; i < sparse_ids.size(); ++i) {
+    slot_idx_map[HitSlot(sparse_ids[i])].emplace_back(i);
+  }
+
+  for (const auto& [slot, v] : slot_idx_map) {
+    std::unique_lock<std::shared_mutex> _(slots_[slot]->locker);
+
+    for (auto i : v) {
+      char* row = Insert(slot, sparse_ids[i]);
+
+      if (row != nullptr) {
+        layout_.FromValue(values[i], row);
+      }
+    }
+  }
+}
+
+void SparseStorage::Fetch(const std::vector<uint64_t>& sparse_ids,
+                          std::vector<uint64_t>* exist_sparse_ids,
+                          std::vector<Value>* values) {
+  exist_sparse_ids->reserve(sparse_ids.size());
+  values->reserve(sparse_ids.size());
+
+  std::unordered_map<size_t /*slot*/, std::vector<size_t>> slot_idx_map;
+  slot_idx_map.reserve(slot_count());
+
+  for (size_t i = 0; i < sparse_ids.size(); ++i) {
+    slot_idx_map[HitSlot(sparse_ids[i])].emplace_back(i);
+  }
+
+  for (const auto& [slot, v] : slot_idx_map) {
+    std::shared_lock<std::shared_mutex> _(slots_[slot]->locker);
+
+    for (auto i : v) {
+      const char* row = Find(slot, sparse_ids[i]);
+      if (row == nullptr) {
+        row = FindCold(slot, sparse_ids[i]);
+      }
+
+      if (row != nullptr) {
+        exist_sparse_ids->emplace_back(sparse_ids[i]);
+
+        values->emplace_back();
+        layout_.ToValue(row, &(values->back()));
+      }
+    }
+  }
+}
+
+void SparseStorage::Clear() {
+  for (size_t slot = 0; slot < slot_count(); ++slot) {
+    std::unique_lock<std::shared_mutex> _(slots_[slot]->locker);
+
+    Clear(slot);
+  }
+}
+
+std::unique_ptr<SparseStorage> SparseStorage::Create(
+    const std::unordered_map<std::string, std::string>& table_conf,
+    const RowLayout& layout, uint64_t node_id, uint64_t table_id) {
+  // More slot means less lock contention, default one slot per core.
+  int64_t slot_count =
+      std::max<int64_t>(8, std::thread::hardware_concurrency());
+  utils::ParseConf<int64_t>(table_conf, "slot_count", &slot_count);
+
+  if (slot_count < 1) {
+    LOG_WARNING("Illegal slot_count:[" << slot_count << "], use 8.");
+    slot_count = 8;
+  }
+
+  std::string storage_type = "skip_list";
+  utils::ParseConf<std::string>(table_conf, "storage_type", &storage_type);
+
+  storage_type = utils::ToLower(storage_type);
+
+  std::unique_ptr<SparseStorage> storage;
+
+  if (storage_type == "skip_list") {
+    storage = std::make_unique<SkipListStorage>(layout, (size_t)slot_count);
+  } else if (storage_type == "hash_map") {
+    storage = std::make_unique<HashMapStorage>(layout, (size_t)slot_count);
+  } else {
+    LOG_WARNING("Unrecognized storage_type:[" << storage_type
+                                              << "], use skip_list.");
+
+    storage = std::make_unique<SkipListStorage>(layout, (size_t)slot_count);
+  }
+
+  // The max row count of the hot row cache, 0 means disable.
+  int64_t cache_size = 0;
+  utils::ParseConf<int64_t>(table_conf, "cache_size", &cache_size);
+
+  if (cache_size > 0) {
+    // Cache the stored val, so the compact row also cost less.
+    storage->cache_.reset(
+        new RowCache((size_t)cache_size, layout.store_vec_bytes()));
+  }
+
+  // Tiered: spill the cold rows to the local files.
+  std::string cold_path;
+  utils::ParseConf<std::string>(table_conf, "cold_path", &cold_path);
+
+  if (cold_path.empty() == false) {
+    std::filesystem::path cold_dir(cold_path);
+    cold_dir /= std::to_string(node_id);
+    cold_dir /= std::to_string(table_id);
+
+    std::error_code error_code;
+    std::filesystem::create_directories(cold_dir, error_code);
+
+    ARGUMENT_CHECK(!error_code, "Create cold dir:[" << cold_dir.string()
+                                                    << "] error:["
+                                                    << error_code.message()
+                                                    << "]");
+
+    for (size_t slot = 0; slot < storage->slot_count(); ++slot) {
+      std::filesystem::path path = cold_dir;
+      path /= "slot_" + std::to_string(slot) + ".rows";
+
+      storage->slots_[slot]->cold.reset(
+          new RowFile(path.string(), layout.stride()));
+    }
+  }
+
+  return storage;
+}
+
+}  // namespace kraken
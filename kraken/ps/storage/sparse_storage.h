@@ -0,0 +1,203 @@
+#pragma once
+
+#include <cinttypes>
+#include <functional>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/info.h"
+#include "common/slab.h"
+#include "ps/storage/row_cache.h"
+#include "ps/storage/row_file.h"
+#include "ps/storage/row_layout.h"
+
+namespace kraken {
+
+// SparseStorage store the sparse id -> row for SparseTable.
+// The storage is split into slots, every slot has it's own lock, the sparse id
+// hit slot by: sparse_id % slot_count. The slot count is config by table_conf
+// "slot_count", default is the core count.
+// The row is allocated from the slot's Slab and layout by RowLayout, the index
+// (SkipList/FlatHashMap) only store the row's pointer.
+// If table_conf "cache_size" > 0, a RowCache of the hot rows' val (in the
+// layout's store type) is created.
+// If table_conf "cold_path" is set the storage is tiered: every slot has a
+// RowFile at cold_path/<node_id>/<table_id>/slot_<i>.rows, SpillIf move the
+// cold rows from memory to it and Load fault them back.
+class SparseStorage {
+public:
+  class UniqueHandler {
+  private:
+    std::shared_mutex& mu_;
+
+  public:
+    UniqueHandler(std::shared_mutex& mu) : mu_(mu) {
+      mu_.lock();
+    }
+
+    UniqueHandler(const UniqueHandler&) = delete;
+    UniqueHandler(const UniqueHandler&&) = delete;
+    const UniqueHandler& operator=(const UniqueHandler&) = delete;
+    const UniqueHandler& operator=(const UniqueHandler&&) = delete;
+
+    ~UniqueHandler() {
+      mu_.unlock();
+    }
+  };
+
+  class SharedHandler {
+  private:
+    std::shared_mutex& mu_;
+
+  public:
+    SharedHandler(std::shared_mutex& mu) : mu_(mu) {
+      mu_.lock_shared();
+    }
+
+    SharedHandler(const SharedHandler&) = delete;
+    SharedHandler(const SharedHandler&&) = delete;
+    const SharedHandler& operator=(const SharedHandler&) = delete;
+    const SharedHandler& operator=(const SharedHandler&&) = delete;
+
+    ~SharedHandler() {
+      mu_.unlock_shared();
+    }
+  };
+
+protected:
+  // Every slot is padded to cache line, avoid false sharing between slots.
+  constexpr static size_t kCacheLineSize = 64;
+
+  struct alignas(kCacheLineSize) Slot {
+    std::shared_mutex locker;
+    Slab slab;
+
+    // The spilled rows, nullptr if not tiered.
+    std::unique_ptr<RowFile> cold;
+
+    explicit Slot(size_t stride) : slab(stride) {
+    }
+  };
+
+  StorageType type_;
+
+  RowLayout layout_;
+
+  std::vector<std::unique_ptr<Slot>> slots_;
+
+  // The hot rows' val cache, nullptr if not enabled.
+  std::unique_ptr<RowCache> cache_;
+
+  SparseStorage(StorageType type, const RowLayout& layout, size_t slot_count);
+
+  // Index the row, return false if the sparse id already exist.
+  virtual bool InsertIndex(size_t slot, uint64_t sparse_id, char* row) = 0;
+
+  // Remove the index that func return true. Return the removed count.
+  virtual size_t RemoveIndexIf(
+      size_t slot, const std::function<bool(uint64_t, char*)>& func) = 0;
+
+  virtual void ClearIndex(size_t slot) = 0;
+
+public:
+  virtual ~SparseStorage() = default;
+
+  StorageType type() const;
+
+  const RowLayout& layout() const;
+
+  size_t slot_count() const;
+
+  // Return nullptr if the cache is not enabled. RemoveIf/Clear will remove the
+  // rows from the cache, the others (Pull/Push) is maintained by SparseTable.
+  RowCache* cache() const;
+
+  bool tiered() const;
+
+  inline size_t HitSlot(uint64_t sparse_id) const {
+    return sparse_id % slots_.size();
+  }
+
+  UniqueHandler UniqueSlotHandler(size_t slot);
+
+  SharedHandler SharedSlotHandler(size_t slot);
+
+  // Below functions is not thread-safe, the caller must lock the slot before
+  // call them.
+  // Return nullptr if not exist. The row's address not change until it be
+  // removed.
+  virtual char* Find(size_t slot, uint64_t sparse_id) = 0;
+
+  virtual size_t Size(size_t slot) const = 0;
+
+  // Iterate the slot, stop when func return false. Return false if stopped.
+  virtual bool ForEach(
+      size_t slot,
+      const std::function<bool(uint64_t, const char*)>& func) const = 0;
+
+  // Allocate a uninitialized row for the sparse id, return nullptr if the
+  // sparse id already exist. The access of the row is reset if has.
+  char* Insert(size_t slot, uint64_t sparse_id);
+
+  // Remove the sparse id that func return true. Return the removed count.
+  // func is called once for every row and can modify the row that not be
+  // removed.
+  size_t RemoveIf(size_t slot,
+                  const std::function<bool(uint64_t, char*)>& func);
+
+  void Clear(size_t slot);
+
+  // Like RemoveIf but the removed rows are spilled to the slot's RowFile if
+  // tiered. The row that can not be spilled is kept in memory.
+  size_t SpillIf(size_t slot,
+                 const std::function<bool(uint64_t, char*)>& func);
+
+  // Return the spilled row, nullptr if not exist. The row is valid until the
+  // slot is modified.
+  const char* FindCold(size_t slot, uint64_t sparse_id) const;
+
+  // Move the spilled row back to memory (the access is reset), return nullptr
+  // if not exist. Need the unique lock.
+  char* Load(size_t slot, uint64_t sparse_id);
+
+  size_t ColdSize(size_t slot) const;
+
+  bool ForEachCold(
+      size_t slot,
+      const std::function<bool(uint64_t, const char*)>& func) const;
+
+  // Below functions is thread-safe.
+  // Rewrite the slot's RowFile without the dead records if they are more than
+  // the live ones. The rows are copied under shared lock and only the swap
+  // need the unique lock, give up if the file is modified between them.
+  // Return true if compacted.
+  bool CompactCold(size_t slot);
+
+  // Contains/Fetch include the spilled rows, the others only see the rows in
+  // memory.
+  bool Contains(uint64_t sparse_id);
+
+  bool Insert(uint64_t sparse_id, const Value& value);
+
+  void Insert(const std::vector<uint64_t>& sparse_ids,
+              const std::vector<Value>& values);
+
+  // Fetch the exist sparse ids's Value (cloned).
+  void Fetch(const std::vector<uint64_t>& sparse_ids,
+             std::vector<uint64_t>* exist_sparse_ids,
+             std::vector<Value>* values);
+
+  void Clear();
+
+public:
+  // The cold files are in: cold_path/node_id/table_id/, so the tables and the
+  // Ps nodes share a cold_path will not use the same file.
+  static std::unique_ptr<SparseStorage> Create(
+      const std::unordered_map<std::string, std::string>& table_conf,
+      const RowLayout& layout, uint64_t node_id, uint64_t table_id);
+};
+
+}  // namespace kraken
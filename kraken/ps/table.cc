@@ -34,6 +34,20 @@ int32_t Table::Pull(const std::vector<uint64_t>& sparse_ids,
   return ErrorCode::kInterfaceUnImplementError;
 }
 
+int32_t Table::Pull(const std::vector<uint64_t>& sparse_ids, Tensor* val) {
+  return ErrorCode::kInterfaceUnImplementError;
+}
+
+int32_t Table::Pull(const std::vector<uint64_t>& sparse_ids,
+                    MemBuffer* buf) {
+  return ErrorCode::kInterfaceUnImplementError;
+}
+
+int32_t Table::PullMatrix(const std::vector<uint64_t>& sparse_ids,
+                          MemBuffer* buf) {
+  return ErrorCode::kInterfaceUnImplementError;
+}
+
 int32_t Table::Push(Optim* optim, const std::vector<uint64_t>& sparse_ids,
                     const std::vector<Tensor>& grads, float lr) {
   return ErrorCode::kInterfaceUnImplementError;
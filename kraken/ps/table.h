@@ -3,6 +3,7 @@
 #include <string>
 
 #include "common/info.h"
+#include "common/mem_buffer.h"
 #include "ps/optim/optim.h"
 #include "t/tensor.h"
 
@@ -34,6 +35,19 @@ public:
   virtual int32_t Pull(const std::vector<uint64_t>& sparse_ids,
                        std::vector<Tensor>* vals);
 
+  // Pull the vals into one [sparse_ids.size(), dimension] matrix.
+  virtual int32_t Pull(const std::vector<uint64_t>& sparse_ids, Tensor* val);
+
+  // Serialize the vals into buf directly, the bytes are same with serializing
+  // a std::vector<Tensor>.
+  virtual int32_t Pull(const std::vector<uint64_t>& sparse_ids,
+                       MemBuffer* buf);
+
+  // Serialize the vals into buf directly, the bytes are same with serializing
+  // the [sparse_ids.size(), dimension] matrix Tensor.
+  virtual int32_t PullMatrix(const std::vector<uint64_t>& sparse_ids,
+                             MemBuffer* buf);
+
   virtual int32_t Push(Optim* optim, const std::vector<uint64_t>& sparse_ids,
                        const std::vector<Tensor>& grads, float lr);
 };
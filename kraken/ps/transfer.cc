@@ -50,7 +50,8 @@ int32_t Transfer::TransferDenseTable(uint64_t from_node_id, uint64_t table_id,
 int32_t Transfer::TransferSparseMetaData(
     uint64_t from_node_id, uint64_t table_id, std::string name,
     int64_t dimension, ElementType element_type, InitializerType init_type,
-    const std::unordered_map<std::string, std::string>& init_conf) const {
+    const std::unordered_map<std::string, std::string>& init_conf,
+    const std::unordered_map<std::string, std::string>& table_conf) const {
   uint32_t try_n = try_num_;
 
   TransferSparseMetaDataRequest req;
@@ -61,6 +62,7 @@ int32_t Transfer::TransferSparseMetaData(
   req.element_type = element_type;
   req.init_type = init_type;
   req.init_conf = init_conf;
+  req.table_conf = table_conf;
 
   TransferSparseMetaDataResponse reply;
 
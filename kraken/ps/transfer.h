@@ -30,7 +30,8 @@ public:
   int32_t TransferSparseMetaData(
       uint64_t from_node_id, uint64_t table_id, std::string name,
       int64_t dimension, ElementType element_type, InitializerType init_type,
-      const std::unordered_map<std::string, std::string>& init_conf) const;
+      const std::unordered_map<std::string, std::string>& init_conf,
+      const std::unordered_map<std::string, std::string>& table_conf) const;
 
   int32_t TransferSparseValues(uint64_t from_node_id, uint64_t table_id,
                                const std::vector<uint64_t>& sparse_ids,
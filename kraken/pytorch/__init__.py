@@ -19,6 +19,7 @@ from kraken_native import push_sparse_table
 from kraken_native import combine_push_sparse_table
 from kraken_native import try_save_model
 from kraken_native import try_load_model_blocked
+from kraken_native import connecter_stats
 
 from .embedding import Embedding
 from .combine_embedding import CombineEmbedding
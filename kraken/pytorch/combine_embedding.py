@@ -1,6 +1,6 @@
 # coding=utf-8
 
-from typing import List
+from typing import Dict, List
 import torch
 from kraken.pytorch.combine_sparse_table import CombineSparseTable
 from kraken.pytorch.initializer import Initializer
@@ -24,6 +24,12 @@ class CombineEmbeddingFunction(torch.autograd.Function):
   def backward(ctx, *grads):
     combine_sparse_table, *indices, = ctx.saved_tensors
 
+    # The val maybe pulled in the compact type, push the grad in table's dtype.
+    grads = [
+        g if g.dtype == d else g.to(d)
+        for g, d in zip(grads, combine_sparse_table.dtypes())
+    ]
+
     kraken_native.combine_push_sparse_table(combine_sparse_table.table_ids(),
                                             list(indices), list(grads))
 
@@ -36,13 +42,15 @@ class CombineEmbedding(torch.nn.Module):
                dimensions: List[int],
                dtypes: List[torch.dtype] = None,
                initializers: List[Initializer] = None,
-               names: List[str] = None):
+               names: List[str] = None,
+               table_confs: List[Dict[str, str]] = None):
     super(CombineEmbedding, self).__init__()
 
     self.combine_sparse_table = CombineSparseTable(dimensions=dimensions,
                                                    dtypes=dtypes,
                                                    initializers=initializers,
-                                                   names=names)
+                                                   names=names,
+                                                   table_confs=table_confs)
 
   def forward(self, indices: List[torch.Tensor]):
     assert len(self.combine_sparse_table.table_ids()) == len(indices)
@@ -1,6 +1,6 @@
 # coding=utf-8
 
-from typing import List
+from typing import Dict, List
 import torch
 from kraken.pytorch.combine_embedding import CombineEmbedding
 from kraken.pytorch.initializer import Initializer
@@ -15,6 +15,7 @@ class CombineJaggedEmbedding(torch.nn.Module):
                dtypes: List[torch.dtype] = None,
                initializers: List[Initializer] = None,
                names: List[str] = None,
+               table_confs: List[Dict[str, str]] = None,
                modes: List[str] = None,
                patch_values: List[float] = None):
     super(CombineJaggedEmbedding, self).__init__()
@@ -33,7 +34,8 @@ class CombineJaggedEmbedding(torch.nn.Module):
     self.combine_embedding = CombineEmbedding(dimensions=dimensions,
                                               dtypes=dtypes,
                                               initializers=initializers,
-                                              names=names)
+                                              names=names,
+                                              table_confs=table_confs)
 
     self._modes = modes
     self._patch_values = patch_values
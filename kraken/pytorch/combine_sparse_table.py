@@ -1,6 +1,6 @@
 # coding=utf-8
 
-from typing import List
+from typing import Dict, List
 import torch
 from kraken.pytorch.initializer import Initializer, NormalInitializer
 
@@ -11,7 +11,8 @@ class CombineSparseTable(torch.nn.Parameter):
               dimensions: List[int],
               dtypes: List[torch.dtype] = None,
               initializers: List[Initializer] = None,
-              names: List[str] = None):
+              names: List[str] = None,
+              table_confs: List[Dict[str, str]] = None):
     self = super(CombineSparseTable, cls).__new__(cls)
 
     if dtypes:
@@ -20,11 +21,14 @@ class CombineSparseTable(torch.nn.Parameter):
       assert len(dimensions) == len(initializers)
     if names:
       assert len(dimensions) == len(names)
+    if table_confs:
+      assert len(dimensions) == len(table_confs)
 
     self._dimensions = dimensions
     self._dtypes = dtypes
     self._initializers = initializers
     self._names = names
+    self._table_confs = table_confs
     self._table_ids = None
 
     if self._dtypes is None:
@@ -33,6 +37,9 @@ class CombineSparseTable(torch.nn.Parameter):
     if self._initializers is None:
       self._initializers = [NormalInitializer()] * len(self._dimensions)
 
+    if self._table_confs is None:
+      self._table_confs = [{}] * len(self._dimensions)
+
     return self
 
   def dimensions(self):
@@ -47,6 +54,9 @@ class CombineSparseTable(torch.nn.Parameter):
   def names(self):
     return self._names
 
+  def table_confs(self):
+    return self._table_confs
+
   def table_ids(self):
     return self._table_ids
 
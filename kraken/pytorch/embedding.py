@@ -1,5 +1,6 @@
 # coding=utf-8
 
+from typing import Dict
 import torch
 from kraken.pytorch.sparse_table import SparseTable
 from kraken.pytorch.initializer import Initializer, NormalInitializer
@@ -17,6 +18,10 @@ class EmbeddingFunction(torch.autograd.Function):
   def backward(ctx, grad):
     sparse_table, indices, = ctx.saved_tensors
 
+    # The val maybe pulled in the compact type, push the grad in table's dtype.
+    if grad.dtype != sparse_table.dtype():
+      grad = grad.to(sparse_table.dtype())
+
     kraken_native.push_sparse_table(sparse_table.table_id(), indices, grad)
 
     return None, None
@@ -28,7 +33,8 @@ class Embedding(torch.nn.Module):
                dimension: int,
                dtype: torch.dtype = torch.float32,
                initializer: Initializer = NormalInitializer(),
-               name: str = None):
+               name: str = None,
+               table_conf: Dict[str, str] = None):
     super(Embedding, self).__init__()
     '''At here we just create a SparseTabel instance.
     This instance include dimension/dtype/name.
@@ -36,7 +42,8 @@ class Embedding(torch.nn.Module):
     self.sparse_table = SparseTable(dimension=dimension,
                                     dtype=dtype,
                                     initializer=initializer,
-                                    name=name)
+                                    name=name,
+                                    table_conf=table_conf)
 
   def forward(self, indices):
     return EmbeddingFunction.apply(self.sparse_table, indices)
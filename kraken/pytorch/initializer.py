@@ -28,51 +28,63 @@ class ConstantInitializer(Initializer):
 
 class UniformInitializer(Initializer):
 
-  def __init__(self, lower: float = 0.0, upper: float = 1.0):
+  def __init__(self, lower: float = 0.0, upper: float = 1.0, seed: int = 0):
     super(UniformInitializer, self).__init__()
     self._lower = lower
     self._upper = upper
+    self._seed = seed
 
   def type(self) -> kraken_native.InitializerType:
     return kraken_native.InitializerType.kUniform
 
   def conf(self) -> Dict[str, str]:
-    return {'lower': str(self._lower), 'upper': str(self._upper)}
+    return {
+        'lower': str(self._lower),
+        'upper': str(self._upper),
+        'seed': str(self._seed)
+    }
 
 
 class NormalInitializer(Initializer):
 
-  def __init__(self, mean: float = 0.0, stddev: float = 1.0):
+  def __init__(self, mean: float = 0.0, stddev: float = 1.0, seed: int = 0):
     super(NormalInitializer, self).__init__()
     self._mean = mean
     self._stddev = stddev
+    self._seed = seed
 
   def type(self) -> kraken_native.InitializerType:
     return kraken_native.InitializerType.kNormal
 
   def conf(self) -> Dict[str, str]:
-    return {'mean': str(self._mean), 'stddev': str(self._stddev)}
+    return {
+        'mean': str(self._mean),
+        'stddev': str(self._stddev),
+        'seed': str(self._seed)
+    }
 
 
 class XavierUniformInitializer(Initializer):
 
-  def __init__(self, gain: float = 1.0):
+  def __init__(self, gain: float = 1.0, seed: int = 0):
     self._gain = gain
+    self._seed = seed
 
   def type(self) -> kraken_native.InitializerType:
     return kraken_native.InitializerType.kXavierUniform
 
   def conf(self) -> Dict[str, str]:
-    return {'gain': str(self._gain)}
+    return {'gain': str(self._gain), 'seed': str(self._seed)}
 
 
 class XavierNormalInitializer(Initializer):
 
-  def __init__(self, gain: float = 1.0):
+  def __init__(self, gain: float = 1.0, seed: int = 0):
     self._gain = gain
+    self._seed = seed
 
   def type(self) -> kraken_native.InitializerType:
     return kraken_native.InitializerType.kXavierNormal
 
   def conf(self) -> Dict[str, str]:
-    return {'gain': str(self._gain)}
+    return {'gain': str(self._gain), 'seed': str(self._seed)}
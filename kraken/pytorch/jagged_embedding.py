@@ -1,5 +1,6 @@
 # coding=utf-8
 
+from typing import Dict
 import torch
 from kraken.pytorch.embedding import Embedding
 from kraken.pytorch.initializer import Initializer, NormalInitializer
@@ -14,6 +15,7 @@ class JaggedEmbedding(torch.nn.Module):
                dtype: torch.dtype = torch.float32,
                initializer: Initializer = NormalInitializer(),
                name: str = None,
+               table_conf: Dict[str, str] = None,
                mode='sum',
                patch_value: float = 0.0):
     super(JaggedEmbedding, self).__init__()
@@ -24,7 +26,8 @@ class JaggedEmbedding(torch.nn.Module):
     self.embedding = Embedding(dimension=dimension,
                                dtype=dtype,
                                initializer=initializer,
-                               name=name)
+                               name=name,
+                               table_conf=table_conf)
 
     self._mode = mode
     self._patch_value = patch_value
@@ -51,13 +51,15 @@ class Optimizer:
         dimension = param.dimension()
         dtype = param.dtype()
         initializer = param.initializer()
+        table_conf = param.table_conf()
 
         table_id = kraken_native.register_sparse_table(
             name=real_name,
             dimension=dimension,
             dtype=dtype,
             init_type=initializer.type(),
-            init_conf=initializer.conf())
+            init_conf=initializer.conf(),
+            table_conf=table_conf)
 
         param.set_table_id(table_id)
         param.set_name(real_name)
@@ -70,7 +72,8 @@ class Optimizer:
             f'dimension:[{dimension}], ' \
             f'dtype:[{dtype}], ' \
             f'init_type:[{initializer.type()}], ' \
-            f'init_conf:[{initializer.conf()}]'
+            f'init_conf:[{initializer.conf()}], ' \
+            f'table_conf:[{table_conf}]'
         )
       elif isinstance(param, CombineSparseTable):
         real_names = []
@@ -87,13 +90,15 @@ class Optimizer:
           dimension = param.dimensions()[i]
           dtype = param.dtypes()[i]
           initializer = param.initializers()[i]
+          table_conf = param.table_confs()[i]
 
           table_id = kraken_native.register_sparse_table(
               name=real_name,
               dimension=dimension,
               dtype=dtype,
               init_type=initializer.type(),
-              init_conf=initializer.conf())
+              init_conf=initializer.conf(),
+              table_conf=table_conf)
 
           table_ids.append(table_id)
 
@@ -103,7 +108,8 @@ class Optimizer:
             f'dimension:[{dimension}], ' \
             f'dtype:[{dtype}], ' \
             f'init_type:[{initializer.type()}], ' \
-            f'init_conf:[{initializer.conf()}]'
+            f'init_conf:[{initializer.conf()}], ' \
+            f'table_conf:[{table_conf}]'
           )
 
         param.set_names(real_names)
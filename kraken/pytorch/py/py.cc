@@ -33,7 +33,9 @@ PYBIND11_MODULE(kraken_native, m) {
 
   pybind11::enum_<CompressType>(m, "CompressType")
       .value("kDefault", CompressType::kNo)
-      .value("kDCT", CompressType::kSnappy);
+      .value("kDCT", CompressType::kSnappy)
+      .value("kLZ4", CompressType::kLZ4)
+      .value("kZSTD", CompressType::kZSTD);
 
   pybind11::enum_<EmitterType>(m, "EmitterType")
       .value("kDefault", EmitterType::kDefault)
@@ -41,7 +43,9 @@ PYBIND11_MODULE(kraken_native, m) {
 
   m.def("initialize", &Initialize, pybind11::arg("s_addr"),
         pybind11::arg("emitter_type") = EmitterType::kDefault,
-        pybind11::arg("life_span") = 1000, pybind11::arg("eta") = 0.75);
+        pybind11::arg("life_span") = 1000, pybind11::arg("eta") = 0.75,
+        pybind11::arg("socket_nums") = 1, pybind11::arg("max_in_flight") = 0,
+        pybind11::arg("max_pending") = 0, pybind11::arg("fail_fast") = false);
 
   m.def("stop", &Stop);
 
@@ -57,7 +61,9 @@ PYBIND11_MODULE(kraken_native, m) {
 
   m.def("register_sparse_table", &RegisterSparseTable, pybind11::arg("name"),
         pybind11::arg("dimension"), pybind11::arg("dtype"),
-        pybind11::arg("init_type"), pybind11::arg("init_conf"));
+        pybind11::arg("init_type"), pybind11::arg("init_conf"),
+        pybind11::arg("table_conf") =
+            std::unordered_map<std::string, std::string>());
 
   m.def("pull_dense_table", &PullDenseTable, pybind11::arg("table_id"));
 
@@ -84,6 +90,8 @@ PYBIND11_MODULE(kraken_native, m) {
 
   m.def("try_load_model_blocked", &TryLoadModelBlocked);
 
+  m.def("connecter_stats", &ConnecterStats);
+
   // Jagged tensor Sum op.
   m.def("jagged_sum_forward", &jagged::SumForward, pybind11::arg("values"),
         pybind11::arg("offsets"), pybind11::arg("patch_value"));
@@ -19,9 +19,15 @@ std::once_flag flag;
 Worker worker;
 
 void Initialize(const std::string& s_addr, EmitterType emitter_type,
-                uint64_t life_span, float eta) {
-  std::call_once(flag, [&s_addr, emitter_type, life_span, eta]() {
-    worker.Initialize(s_addr, emitter_type, life_span, eta);
+                uint64_t life_span, float eta, size_t socket_nums,
+                size_t max_in_flight, size_t max_pending, bool fail_fast) {
+  FlowControl flow_control(
+      max_in_flight, max_pending,
+      fail_fast ? FlowControlMode::kFailFast : FlowControlMode::kBlock);
+
+  std::call_once(flag, [&]() {
+    worker.Initialize(s_addr, emitter_type, life_span, eta, socket_nums,
+                      flow_control);
   });
 }
 
@@ -56,12 +62,13 @@ uint64_t RegisterDenseTable(const std::string& name, torch::Tensor val) {
 uint64_t RegisterSparseTable(
     const std::string& name, int64_t dimension, pybind11::object dtype,
     InitializerType init_type,
-    const std::unordered_map<std::string, std::string>& init_conf) {
+    const std::unordered_map<std::string, std::string>& init_conf,
+    const std::unordered_map<std::string, std::string>& table_conf) {
   torch::Dtype ttype = torch::python::detail::py_object_to_dtype(dtype);
   ElementType etype = TorchDTypeToElementType(ttype);
 
   return worker.RegisterSparseTable(name, dimension, etype, init_type,
-                                    init_conf);
+                                    init_conf, table_conf);
 }
 
 torch::Tensor PullDenseTable(uint64_t table_id) {
@@ -123,18 +130,11 @@ torch::Tensor PullSparseTable(uint64_t table_id, torch::Tensor indices) {
 
   Tensor k_indices = TorchTensorToTensor(c_indices);
 
-  // The sparse embedding.
+  // The sparse embedding, it is a single allocation so hand it to torch
+  // without copy.
   Tensor k_val = worker.PullSparseTable(table_id, k_indices);
 
-  // torch::IntArrayRef sizes = ShapeToTorchSizes(k_val.shape());
-  torch::IntArrayRef sizes(k_val.shape().dims());
-  torch::Dtype dtype = ElementTypeToTorchDType(k_val.element_type());
-  torch::Tensor val = torch::zeros(sizes, dtype);
-
-  // copy memory.
-  memcpy(val.data_ptr(), k_val.Ptr(), k_val.NumBytes());
-
-  return val;
+  return TensorToTorchTensor(k_val);
 }
 
 std::vector<torch::Tensor> CombinePullSparseTable(
@@ -256,5 +256,15 @@ bool TryLoadModelBlocked(const std::string& load_dir) {
   return worker.TryLoadModelBlocked(load_dir);
 }
 
+std::unordered_map<std::string, size_t> ConnecterStats() {
+  FlowStats stats = worker.ConnecterStats();
+
+  return {{"pending", stats.pending},
+          {"in_flight", stats.in_flight},
+          {"waiting_high", stats.waiting[(size_t)RPCPriority::kHigh]},
+          {"waiting_normal", stats.waiting[(size_t)RPCPriority::kNormal]},
+          {"waiting_low", stats.waiting[(size_t)RPCPriority::kLow]}};
+}
+
 }  // namespace py
 }  // namespace kraken
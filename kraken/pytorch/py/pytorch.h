@@ -10,8 +10,11 @@
 namespace kraken {
 namespace py {
 
+// max_in_flight/max_pending is the flow control of every socket connect to
+// the Ps, 0 means no limit.
 void Initialize(const std::string& s_addr, EmitterType emitter_type,
-                uint64_t life_span, float eta);
+                uint64_t life_span, float eta, size_t socket_nums,
+                size_t max_in_flight, size_t max_pending, bool fail_fast);
 
 void Stop();
 
@@ -25,7 +28,8 @@ uint64_t RegisterDenseTable(const std::string& name, torch::Tensor val);
 uint64_t RegisterSparseTable(
     const std::string& name, int64_t dimension, pybind11::object dtype,
     InitializerType init_type,
-    const std::unordered_map<std::string, std::string>& init_conf);
+    const std::unordered_map<std::string, std::string>& init_conf,
+    const std::unordered_map<std::string, std::string>& table_conf);
 
 torch::Tensor PullDenseTable(uint64_t table_id);
 
@@ -51,5 +55,9 @@ bool TrySaveModel();
 
 bool TryLoadModelBlocked(const std::string& load_dir);
 
+// The queue depth of the connecters to the Ps nodes, like:
+// {"pending": 3, "in_flight": 64, "waiting_high": 0, ...}.
+std::unordered_map<std::string, size_t> ConnecterStats();
+
 }  // namespace py
 }  // namespace kraken
@@ -34,6 +34,8 @@ ElementType TorchDTypeToElementType(torch::Dtype dtype) {
       return ElementType::From<float>();
     case torch::kFloat64:
       return ElementType::From<double>();
+    case torch::kBFloat16:
+      return ElementType::From<bfloat16>();
     default:
       RUNTIME_ERROR("The Torch dtype does not support:" << dtype);
   }
@@ -57,6 +59,8 @@ torch::Dtype ElementTypeToTorchDType(ElementType etype) {
       return torch::kFloat32;
     case DType::kFloat64:
       return torch::kFloat64;
+    case DType::kBFloat16:
+      return torch::kBFloat16;
     default:
       RUNTIME_ERROR("The ElementType does not support:" << etype.Name());
   }
@@ -75,5 +79,16 @@ Tensor TorchTensorToTensor(const torch::Tensor& tval) {
   return Tensor::Dense(shape, storage, 0, etype);
 }
 
+torch::Tensor TensorToTorchTensor(const Tensor& val) {
+  ARGUMENT_CHECK(val.IsDense(), "TensorToTorchTensor need Tensor is dense.");
+
+  torch::Dtype dtype = ElementTypeToTorchDType(val.element_type());
+
+  // The deleter hold a reference of val's storage.
+  return torch::from_blob(
+      val.Ptr(), val.shape().dims(), [val](void*) {},
+      torch::TensorOptions().dtype(dtype));
+}
+
 }  // namespace py
 }  // namespace kraken
@@ -21,5 +21,8 @@ torch::Dtype ElementTypeToTorchDType(ElementType etype);
 // Becareful the returned tensor will share memory with torch tensor.
 Tensor TorchTensorToTensor(const torch::Tensor& tval);
 
+// The returned torch tensor share memory with val and keep it alive.
+torch::Tensor TensorToTorchTensor(const Tensor& val);
+
 }  // namespace py
 }  // namespace kraken
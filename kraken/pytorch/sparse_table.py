@@ -1,6 +1,7 @@
 # coding=utf-8
 
 import torch
+from typing import Dict
 from kraken.pytorch.initializer import Initializer, NormalInitializer
 
 
@@ -10,12 +11,21 @@ class SparseTable(torch.nn.Parameter):
               dimension: int,
               dtype: torch.dtype = torch.float32,
               initializer: Initializer = NormalInitializer(),
-              name: str = None):
+              name: str = None,
+              table_conf: Dict[str, str] = None):
     self = super(SparseTable, cls).__new__(cls)
     self._dimension = dimension
     self._dtype = dtype
     self._initializer = initializer
     self._name = name
+    # SparseTable config in Ps, like:
+    # {'storage_type': 'hash_map', 'slot_count': '64',
+    #  'parallel_threshold': '1024', 'merge_push': 'false',
+    #  'cache_size': '0', 'ttl_steps': '0', 'lfu_min_count': '0',
+    #  'max_rows': '0', 'admit_count': '0', 'evict_interval_ms': '10000',
+    #  'store_type': 'float32', 'pull_compact': 'false', 'cold_path': '',
+    #  'lazy_init': 'false'}.
+    self._table_conf = table_conf if table_conf is not None else {}
     self._table_id = None
 
     return self
@@ -32,6 +42,9 @@ class SparseTable(torch.nn.Parameter):
   def name(self):
     return self._name
 
+  def table_conf(self):
+    return self._table_conf
+
   def table_id(self):
     return self._table_id
 
@@ -9,16 +9,16 @@
 #include "common/exception.h"
 #include "common/log.h"
 #include "common/serialize.h"
-#include "common/snappy.h"
-#include "snappy.h"
 
 namespace kraken {
 
-CombineConnecter::CombineConnecter(CompressType compress_type)
-    : compress_type_(compress_type),
+CombineConnecter::CombineConnecter(CompressPolicies compress_policies)
+    : compress_policies_(std::move(compress_policies)),
       started_(false),
       stop_(false),
-      timestamp_(0) {
+      timestamp_(0),
+      task_que_(kTaskQueueCapacity),
+      notified_(false) {
 }
 
 CombineConnecter::~CombineConnecter() {
@@ -106,63 +106,31 @@ bool CombineConnecter::RemoveConnect(uint64_t id, zmq_pollitem_t** zmq_polls,
 }
 
 int32_t CombineConnecter::SendMsg(uint64_t id, uint64_t timestamp,
-                                  uint32_t rpc_type, ZMQBuffer* z_buf) {
+                                  uint32_t rpc_type, IOVecBuffer* buf) {
   if (sender_idx_.find(id) == sender_idx_.end()) {
     return ErrorCode::kSocketNotExistError;
   }
 
   void* sender = senders_[sender_idx_[id]];
 
-  void* ptr;
-  size_t capacity;
-  size_t offset;
-  void (*zmq_free)(void*, void*);
-
-  if (compress_type_ == CompressType::kNo) {
-    // No need to compress the data.
-    z_buf->Transfer(&ptr, &capacity, &offset, &zmq_free);
-  } else if (compress_type_ == CompressType::kSnappy) {
-    RequestHeader req_header;
-    req_header.timestamp = timestamp;
-    req_header.type = rpc_type;
-    req_header.compress_type = CompressType::kSnappy;
-
-    SnappySink sink;
-    // step1 serialize header.
-    {
-      Serialize serialize(&sink);
-      ARGUMENT_CHECK(serialize << req_header,
-                     "Serialize request header error!");
-    }
-
-    // Compress body.
-    {
-      SnappySource source((char*)z_buf->ptr() + sizeof(req_header),
-                          z_buf->offset() - sizeof(req_header));
-
-      ARGUMENT_CHECK(snappy::Compress(&source, &sink) > 0,
-                     "snappy::Compress error.");
-    }
-
-    sink.TransferForZMQ(&ptr, &capacity, &offset, &zmq_free);
-  }
+  RequestHeader req_header;
+  req_header.timestamp = timestamp;
+  req_header.type = rpc_type;
+  req_header.compress_type = CompressType::kNo;
 
-  // send by socket.
-  zmq_msg_t zmq_msg;
+  ARGUMENT_CHECK(Compress::CompressBuffer(
+                     req_header, compress_policies_.Get(rpc_type), buf),
+                 "Compress request error.");
 
-  // zero copy.
-  ZMQ_CALL(zmq_msg_init_data(&zmq_msg, ptr, offset, zmq_free, nullptr));
-  ZMQ_CALL(zmq_msg_send(&zmq_msg, sender, 0));
-  // ZMQ_CALL(zmq_msg_close(&zmq_msg));
+  // Zero copy, the big Tensors are sent as seperate frames.
+  ZMQMessage::Send(sender, buf);
 
   return ErrorCode::kSuccess;
 }
 
-void CombineConnecter::HandleReply(zmq_msg_t& reply) {
-  size_t reply_size = zmq_msg_size(&reply);
-  const char* reply_data = (const char*)zmq_msg_data(&reply);
-
-  MemReader reader(reply_data, reply_size);
+void CombineConnecter::HandleReply(const std::shared_ptr<ZMQMessage>& reply) {
+  // The ReplyHeader always be in the first frame.
+  MemReader reader(reply->data(), reply->size());
   Deserialize deserializer(&reader);
 
   ReplyHeader reply_header;
@@ -171,8 +139,8 @@ void CombineConnecter::HandleReply(zmq_msg_t& reply) {
 
   auto it = z_callbacks_.find(reply_header.timestamp);
   if (it != z_callbacks_.end()) {
-    it->second(reply_header, reply_data + sizeof(reply_header),
-               reply_size - sizeof(reply_header));
+    // The reply's Tensors maybe alias the msg.
+    it->second(reply_header, reply->Body(sizeof(reply_header)), reply);
 
     z_callbacks_.erase(it);
   }
@@ -207,14 +175,11 @@ void CombineConnecter::Run() {
     // We should handle the socket event firstly then handle Task.
     for (int i = 1; i < zmq_polls_size; ++i) {
       if (zmq_polls[i].revents & ZMQ_POLLIN) {
-        zmq_msg_t reply;
-
-        ZMQ_CALL(zmq_msg_init(&reply));
-        ZMQ_CALL(zmq_msg_recv(&reply, zmq_polls[i].socket, 0));
+        // The reply is closed when the last Tensor alias it is released.
+        auto reply = std::make_shared<ZMQMessage>();
+        reply->Recv(zmq_polls[i].socket);
 
         HandleReply(reply);
-
-        ZMQ_CALL(zmq_msg_close(&reply));
       }
     }
 
@@ -223,18 +188,14 @@ void CombineConnecter::Run() {
       ARGUMENT_CHECK(read(efd_, &u, sizeof(uint64_t)) == sizeof(uint64_t),
                      "read eventfd error.");
 
-      for (;;) {
-        Task task;
-        {
-          std::unique_lock<std::mutex> lock(task_que_mu_);
-          if (task_que_.empty()) {
-            break;
-          }
-
-          task = std::move(task_que_.front());
-          task_que_.pop();
-        }
+      // Clear it before drain, the task pushed after it will write efd_
+      // again so it can not be missed. Use exchange not store: the RMW read
+      // the producer's exchange(true), so the task pushed before it is
+      // visible to the drain below.
+      notified_.exchange(false);
 
+      Task task;
+      while (PopTask(&task)) {
         if (task.type == 0) {
           // Add connect.
           bool success =
@@ -253,7 +214,7 @@ void CombineConnecter::Run() {
         } else if (task.type == 2) {
           // Send message.
           int32_t error_code =
-              SendMsg(task.id, task.timestamp, task.rpc_type, &task.z_buf);
+              SendMsg(task.id, task.timestamp, task.rpc_type, &task.buf);
 
           if (task.z_callback) {
             if (error_code != ErrorCode::kSuccess) {
@@ -262,7 +223,7 @@ void CombineConnecter::Run() {
               dummy_header.error_code = error_code;
               dummy_header.compress_type = CompressType::kNo;
 
-              task.z_callback(dummy_header, nullptr, 0);
+              task.z_callback(dummy_header, {}, nullptr);
             } else {
               z_callbacks_.emplace(task.timestamp, std::move(task.z_callback));
 
@@ -301,7 +262,7 @@ void CombineConnecter::Run() {
         timeout_header.error_code = ErrorCode::kTimeoutError;
         timeout_header.timestamp = event.timestamp;
 
-        it->second(timeout_header, nullptr, 0);
+        it->second(timeout_header, {}, nullptr);
 
         z_callbacks_.erase(it);
       }
@@ -322,22 +283,40 @@ void CombineConnecter::Run() {
   zmq_context_ = nullptr;
 }
 
+bool CombineConnecter::PopTask(Task* task) {
+  if (task_que_.TryPop(task)) {
+    return true;
+  }
+
+  if (io_task_que_.empty() == false) {
+    *task = std::move(io_task_que_.front());
+    io_task_que_.pop();
+
+    return true;
+  }
+
+  return false;
+}
+
 void CombineConnecter::EnqueTask(Task&& task) {
-  {
-    std::unique_lock<std::mutex> lock(task_que_mu_);
-    task_que_.emplace(std::move(task));
+  if (std::this_thread::get_id() == worker_.get_id()) {
+    io_task_que_.emplace(std::move(task));
+  } else {
+    task_que_.Push(std::move(task));
   }
 
-  // tell worker to send message.
-  uint64_t u = 1;
-  ARGUMENT_CHECK(
-      write(efd_, &u, sizeof(uint64_t)) == sizeof(uint64_t),
-      "write eventfd errno:" << errno << ", msg:" << strerror(errno));
+  // tell worker to send message if it is not notified.
+  if (notified_.exchange(true) == false) {
+    uint64_t u = 1;
+    ARGUMENT_CHECK(
+        write(efd_, &u, sizeof(uint64_t)) == sizeof(uint64_t),
+        "write eventfd errno:" << errno << ", msg:" << strerror(errno));
+  }
 }
 
 void CombineConnecter::Start() {
-  // create eventfd.
-  efd_ = eventfd(0, EFD_SEMAPHORE);
+  // create eventfd, read it clear the counter.
+  efd_ = eventfd(0, 0);
   ARGUMENT_CHECK(efd_ != -1, "eventfd error:" << efd_);
 
   // start worker thread.
@@ -4,16 +4,17 @@
 
 #include <atomic>
 #include <functional>
-#include <mutex>
 #include <queue>
 #include <string>
 #include <thread>
 #include <unordered_map>
 
 #include "common/compress.h"
-#include "common/mem_buffer.h"
+#include "common/compress_policy.h"
+#include "common/iovec_buffer.h"
+#include "common/mpsc_queue.h"
 #include "common/thread_barrier.h"
-#include "common/zmq_buffer.h"
+#include "common/zmq_message.h"
 #include "rpc/connecter.h"
 #include "rpc/protocol.h"
 
@@ -21,6 +22,8 @@ namespace kraken {
 
 class CombineConnecter : public Connecter {
 private:
+  constexpr static size_t kTaskQueueCapacity = 4096;
+
   struct Task {
     // 0: add connect.
     // 1: remove connect.
@@ -46,8 +49,8 @@ private:
     uint32_t rpc_type;
 
     // send message.
-    // Becareful z_buf include the RequestHeader.
-    ZMQBuffer z_buf;
+    // Becareful buf include the RequestHeader.
+    IOVecBuffer buf;
 
     // Send message callback.
     ZMQ_CALLBACK z_callback;
@@ -56,15 +59,24 @@ private:
     int64_t timeout_ms;
   };
 
-  CompressType compress_type_;
+  // compress policy of every RPC type.
+  CompressPolicies compress_policies_;
 
   std::atomic_bool started_;
   std::atomic_bool stop_;
 
   std::atomic_uint64_t timestamp_;
 
-  std::mutex task_que_mu_;
-  std::queue<Task> task_que_;
+  // The IO thread is the only consumer.
+  MPSCQueue<Task> task_que_;
+
+  // The tasks enqueued by the IO thread itself (like in a callback), it can
+  // not wait the full task_que_ drained by itself. Only the IO thread use it.
+  std::queue<Task> io_task_que_;
+
+  // Set when efd_ is written and cleared by the IO thread before it drain the
+  // task_que_, so a burst of tasks only write efd_ once.
+  std::atomic_bool notified_;
   zmq_fd_t efd_;
 
   std::unordered_map<uint64_t /*timestamp*/, ZMQ_CALLBACK> z_callbacks_;
@@ -83,7 +95,7 @@ private:
   std::vector<void*> senders_;
 
 public:
-  CombineConnecter(CompressType compress_type);
+  CombineConnecter(CompressPolicies compress_policies);
 
   ~CombineConnecter();
 
@@ -95,12 +107,14 @@ private:
                      int* zmq_polls_size);
 
   int32_t SendMsg(uint64_t id, uint64_t timestamp, uint32_t rpc_type,
-                  ZMQBuffer* z_buf);
+                  IOVecBuffer* buf);
 
-  void HandleReply(zmq_msg_t& reply);
+  void HandleReply(const std::shared_ptr<ZMQMessage>& reply);
 
   void Run();
 
+  bool PopTask(Task* task);
+
   void EnqueTask(Task&& task);
 
 public:
@@ -228,19 +242,19 @@ public:
     req_header.type = rpc_type;
     req_header.compress_type = CompressType::kNo;
 
-    // Serialize the header and request.
-    MemBuffer buffer;
-    Serialize serialize(&buffer);
-
-    ARGUMENT_CHECK(serialize << req_header, "Serialize request header error!");
-    if ((serialize << req) == false) {
+    // Serialize the header and request, the big dense Tensors in req are
+    // referenced not copied, so the caller must not modify them until the
+    // callback is called.
+    IOVecBuffer buffer;
+    if (Compress::NoCompressSeria(req_header, req, &buffer) == false) {
       callback(ErrorCode::kSerializeRequestError, dummy_reply);
       return;
     }
 
     auto z_callback = [this, callback{std::move(callback)}](
-                          const ReplyHeader& header, const char* body,
-                          size_t body_len) {
+                          const ReplyHeader& header,
+                          const std::vector<IOVec>& body,
+                          const std::shared_ptr<void>& holder) {
       ReplyType reply;
 
       if (header.error_code != ErrorCode::kSuccess) {
@@ -249,18 +263,11 @@ public:
       }
 
       auto error_code = ErrorCode::kSuccess;
-      if (header.compress_type == CompressType::kNo) {
-        if (Compress::NoUnCompressDeser<ReplyType>(body, body_len, &reply) ==
-            false) {
-          error_code = ErrorCode::kDeserializeReplyError;
-        }
-      } else if (header.compress_type == CompressType::kSnappy) {
-        if (Compress::SnappyUnCompressDeser<ReplyType>(body, body_len,
-                                                       &reply) == false) {
-          error_code = ErrorCode::kDeserializeReplyError;
-        }
-      } else {
+      if (Compress::Support(header.compress_type) == false) {
         error_code = ErrorCode::kUnSupportCompressTypeError;
+      } else if (Compress::UnCompressDeser<ReplyType>(
+                     header.compress_type, body, &reply, holder) == false) {
+        error_code = ErrorCode::kDeserializeReplyError;
       }
 
       callback(error_code, reply);
@@ -274,7 +281,7 @@ public:
     task.z_callback = std::move(z_callback);
     task.timeout_ms = timeout_ms;
 
-    buffer.TransferForZMQ(&task.z_buf);
+    task.buf = std::move(buffer);
 
     EnqueTask(std::move(task));
   }
@@ -1,10 +1,14 @@
 #pragma once
 
 #include <chrono>
+#include <functional>
+#include <memory>
+#include <vector>
 
 #include "common/deserialize.h"
 #include "common/error_code.h"
 #include "common/exception.h"
+#include "common/iovec_buffer.h"
 #include "common/mem_reader.h"
 #include "common/serialize.h"
 #include "common/snappy.h"
@@ -16,8 +20,10 @@ class Connecter {
 protected:
   using CALLBACK = std::function<void(bool)>;
 
+  // The body maybe scattered in many frames, they are owned by the holder.
   using ZMQ_CALLBACK =
-      std::function<void(const ReplyHeader&, const char*, size_t)>;
+      std::function<void(const ReplyHeader&, const std::vector<IOVec>&,
+                         const std::shared_ptr<void>&)>;
 
   struct TimerEvent {
     std::chrono::time_point<std::chrono::steady_clock> when;
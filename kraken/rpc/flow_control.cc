@@ -0,0 +1,39 @@
+#include "rpc/flow_control.h"
+
+namespace kraken {
+
+FlowControl::FlowControl()
+    : max_in_flight_(0), max_pending_(0), mode_(FlowControlMode::kBlock) {
+}
+
+FlowControl::FlowControl(size_t max_in_flight, size_t max_pending,
+                         FlowControlMode mode)
+    : max_in_flight_(max_in_flight), max_pending_(max_pending), mode_(mode) {
+}
+
+size_t FlowControl::max_in_flight() const {
+  return max_in_flight_;
+}
+
+size_t FlowControl::max_pending() const {
+  return max_pending_;
+}
+
+FlowControlMode FlowControl::mode() const {
+  return mode_;
+}
+
+void FlowControl::SetPriority(uint32_t rpc_type, RPCPriority priority) {
+  priorities_[rpc_type] = priority;
+}
+
+RPCPriority FlowControl::Priority(uint32_t rpc_type) const {
+  auto it = priorities_.find(rpc_type);
+  if (it == priorities_.end()) {
+    return RPCPriority::kNormal;
+  }
+
+  return it->second;
+}
+
+}  // namespace kraken
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cinttypes>
+#include <cstdlib>
+#include <unordered_map>
+
+namespace kraken {
+
+enum class FlowControlMode : uint8_t {
+  // Block the caller until the pending requests less than max_pending.
+  kBlock = 0,
+  // Callback kTooManyRequestsError immediately.
+  kFailFast = 1,
+};
+
+// The higher priority requests are sent first when wait the credits.
+enum class RPCPriority : uint8_t {
+  // Not wait the credits and not limited by max_pending, for the small
+  // control RPCs like heartbeat.
+  kHigh = 0,
+  kNormal = 1,
+  kLow = 2,
+};
+
+/**
+ * \brief The in-flight window of a connecter, not thread-safe, set it before
+ * use.
+ *
+ * A request take a credit when it is sent and return it when the reply is
+ * received or timeout. The requests wait the credits in the connecter are
+ * pending, too many pending requests block the caller or fail fast.
+ */
+class FlowControl {
+public:
+  constexpr static size_t kPriorityNums = 3;
+
+private:
+  // The max sent but not replied requests, 0 means no limit.
+  size_t max_in_flight_;
+
+  // The max pending requests, 0 means no limit.
+  size_t max_pending_;
+
+  FlowControlMode mode_;
+
+  std::unordered_map<uint32_t /*RPC type*/, RPCPriority> priorities_;
+
+public:
+  // No limit.
+  FlowControl();
+
+  FlowControl(size_t max_in_flight, size_t max_pending,
+              FlowControlMode mode = FlowControlMode::kBlock);
+
+public:
+  size_t max_in_flight() const;
+
+  size_t max_pending() const;
+
+  FlowControlMode mode() const;
+
+  void SetPriority(uint32_t rpc_type, RPCPriority priority);
+
+  // Return kNormal if the rpc_type is not set.
+  RPCPriority Priority(uint32_t rpc_type) const;
+};
+
+// The queue depth of the connecters, sum of them if many.
+struct FlowStats {
+  // The requests enqueued but not sent.
+  size_t pending = 0;
+
+  // The requests sent but not replied.
+  size_t in_flight = 0;
+
+  // The pending requests wait the credits in the IO thread, by priority.
+  size_t waiting[FlowControl::kPriorityNums] = {};
+
+  FlowStats& operator+=(const FlowStats& other) {
+    pending += other.pending;
+    in_flight += other.in_flight;
+
+    for (size_t p = 0; p < FlowControl::kPriorityNums; ++p) {
+      waiting[p] += other.waiting[p];
+    }
+
+    return *this;
+  }
+};
+
+}  // namespace kraken
@@ -1,9 +1,24 @@
 #include "rpc/group_connecters.h"
 
+#include "common/exception.h"
+
 namespace kraken {
 
-GroupConnecters::GroupConnecters(CompressType compress_type)
-    : compress_type_(compress_type) {
+GroupConnecters::GroupConnecters(CompressPolicies compress_policies,
+                                 size_t socket_nums)
+    : compress_policies_(std::move(compress_policies)),
+      socket_nums_(socket_nums) {
+  ARGUMENT_CHECK(socket_nums_ > 0, "socket_nums must be positive.");
+}
+
+void GroupConnecters::SetSocketNums(size_t socket_nums) {
+  ARGUMENT_CHECK(socket_nums > 0, "socket_nums must be positive.");
+
+  socket_nums_ = socket_nums;
+}
+
+void GroupConnecters::SetFlowControl(const FlowControl& flow_control) {
+  flow_control_ = flow_control;
 }
 
 void GroupConnecters::Add(uint64_t node_id, const std::string& addr) {
@@ -17,8 +32,8 @@ void GroupConnecters::Add(uint64_t node_id, const std::string& addr) {
     connecters_.erase(it);
   }
 
-  std::unique_ptr<IndepConnecter> conn(
-      new IndepConnecter(addr, compress_type_));
+  std::unique_ptr<PoolConnecter> conn(
+      new PoolConnecter(addr, compress_policies_, socket_nums_, flow_control_));
   conn->Start();
 
   connecters_.emplace(node_id, std::move(conn));
@@ -42,4 +57,13 @@ void GroupConnecters::RemoveAll() {
   connecters_.clear();
 }
 
+FlowStats GroupConnecters::Stats() const {
+  FlowStats stats;
+  for (const auto& [_, conn] : connecters_) {
+    stats += conn->Stats();
+  }
+
+  return stats;
+}
+
 }  // namespace kraken
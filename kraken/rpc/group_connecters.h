@@ -5,29 +5,47 @@
 #include <string>
 #include <unordered_map>
 
-#include "rpc/indep_connecter.h"
+#include "common/compress_policy.h"
+#include "rpc/flow_control.h"
+#include "rpc/pool_connecter.h"
 
 namespace kraken {
 
 class GroupConnecters {
 private:
-  CompressType compress_type_;
+  // The compress policies of every connecter.
+  CompressPolicies compress_policies_;
 
-  std::unordered_map<uint64_t /*Ps node id*/, std::unique_ptr<IndepConnecter>>
+  // The sockets/IO threads count connect to one Ps node.
+  size_t socket_nums_;
+
+  // The in-flight window of every socket.
+  FlowControl flow_control_;
+
+  std::unordered_map<uint64_t /*Ps node id*/, std::unique_ptr<PoolConnecter>>
       connecters_;
 
 public:
-  GroupConnecters(CompressType compress_type);
+  GroupConnecters(CompressPolicies compress_policies, size_t socket_nums = 1);
 
   ~GroupConnecters() = default;
 
 public:
+  // Only affect the Ps nodes added after.
+  void SetSocketNums(size_t socket_nums);
+
+  // Only affect the Ps nodes added after.
+  void SetFlowControl(const FlowControl& flow_control);
+
   void Add(uint64_t node_id, const std::string& addr);
 
   void Remove(uint64_t node_id);
 
   void RemoveAll();
 
+  // The queue depth of all Ps nodes.
+  FlowStats Stats() const;
+
   // The caller must make sure the node_id is Added.
   template <typename ReqType, typename ReplyType>
   int32_t Call(uint64_t node_id, uint32_t rpc_type, const ReqType& req,
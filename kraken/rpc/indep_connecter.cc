@@ -4,28 +4,39 @@
 #include <sys/eventfd.h>
 #include <unistd.h>
 
+#include <algorithm>
+
 #include "common/exception.h"
 #include "common/log.h"
 
 namespace kraken {
 
 IndepConnecter::IndepConnecter(const std::string& addr,
-                               CompressType compress_type)
+                               CompressPolicies compress_policies,
+                               FlowControl flow_control)
     : addr_(addr),
-      compress_type_(compress_type),
+      compress_policies_(std::move(compress_policies)),
+      flow_control_(std::move(flow_control)),
       started_(false),
       stop_(false),
-      timestamp_(0) {
+      timestamp_(0),
+      task_que_(kTaskQueueCapacity),
+      notified_(false),
+      pending_(0),
+      in_flight_(0),
+      entering_(0),
+      blocked_(0) {
+  for (auto& waiting : waiting_) {
+    waiting.store(0);
+  }
 }
 
 IndepConnecter::~IndepConnecter() {
 }
 
-void IndepConnecter::HandleReply(zmq_msg_t& reply) {
-  size_t reply_size = zmq_msg_size(&reply);
-  const char* reply_data = (const char*)zmq_msg_data(&reply);
-
-  MemReader reader(reply_data, reply_size);
+void IndepConnecter::HandleReply(const std::shared_ptr<ZMQMessage>& reply) {
+  // The ReplyHeader always be in the first frame.
+  MemReader reader(reply->data(), reply->size());
   Deserialize deserializer(&reader);
 
   ReplyHeader reply_header;
@@ -35,10 +46,11 @@ void IndepConnecter::HandleReply(zmq_msg_t& reply) {
   // find callback by timestamp.
   auto it = z_callbacks_.find(reply_header.timestamp);
   if (it != z_callbacks_.end()) {
-    it->second(reply_header, reply_data + sizeof(reply_header),
-               reply_size - sizeof(reply_header));
+    // The reply's Tensors maybe alias the msg.
+    it->second(reply_header, reply->Body(sizeof(reply_header)), reply);
 
     z_callbacks_.erase(it);
+    in_flight_.fetch_sub(1);
   }
 }
 
@@ -82,14 +94,11 @@ void IndepConnecter::Run() {
 
     // zmq socket get message.
     if (items[0].revents & ZMQ_POLLIN) {
-      zmq_msg_t reply;
-
-      ZMQ_CALL(zmq_msg_init(&reply));
-      ZMQ_CALL(zmq_msg_recv(&reply, zmq_socket_, 0));
+      // The reply is closed when the last Tensor alias it is released.
+      auto reply = std::make_shared<ZMQMessage>();
+      reply->Recv(zmq_socket_);
 
       HandleReply(reply);
-
-      ZMQ_CALL(zmq_msg_close(&reply));
     }
 
     // Send message.
@@ -97,115 +106,67 @@ void IndepConnecter::Run() {
       ARGUMENT_CHECK(read(efd_, &u, sizeof(uint64_t)) == sizeof(uint64_t),
                      "read eventfd error.");
 
-      for (;;) {
-        Task task;
-        {
-          std::unique_lock<std::mutex> lock(task_que_mu_);
-          if (task_que_.empty()) {
-            break;
-          }
-
-          task = std::move(task_que_.front());
-          task_que_.pop();
-        }
-
-        void* ptr;
-        size_t capacity;
-        size_t offset;
-        void (*zmq_free)(void*, void*);
-
-        if (compress_type_ == CompressType::kNo) {
-          // No need to compress the data.
-          task.z_buf.Transfer(&ptr, &capacity, &offset, &zmq_free);
-        } else if (compress_type_ == CompressType::kSnappy) {
-          // Compress the data, becareful the raw data already include the
-          // RequestHeader but we only compress the body.
-          RequestHeader req_header;
-          req_header.timestamp = task.timestamp;
-          req_header.type = task.rpc_type;
-          req_header.compress_type = CompressType::kSnappy;
-
-          SnappySink sink;
-          // step1 serialize header.
-          {
-            Serialize serialize(&sink);
-            ARGUMENT_CHECK(serialize << req_header,
-                           "Serialize request header error!");
-          }
-
-          // Compress body.
-          {
-            SnappySource source((char*)task.z_buf.ptr() + sizeof(req_header),
-                                task.z_buf.offset() - sizeof(req_header));
-
-            ARGUMENT_CHECK(snappy::Compress(&source, &sink) > 0,
-                           "snappy::Compress error.");
-          }
-
-          sink.TransferForZMQ(&ptr, &capacity, &offset, &zmq_free);
-        } else {
-          RUNTIME_ERROR("Unsupport CompressType:" << (int32_t)compress_type_);
-        }
-
-        // send by socket.
-        zmq_msg_t zmq_msg;
-
-        // zero copy.
-        ZMQ_CALL(zmq_msg_init_data(&zmq_msg, ptr, offset, zmq_free, nullptr));
-        ZMQ_CALL(zmq_msg_send(&zmq_msg, zmq_socket_, 0));
-        // ref: http://api.zeromq.org/4-1:zmq-msg-send
-        // A successful invocation of zmq_msg_send() does not indicate that the
-        // message has been transmitted to the network, only that it has been
-        // queued on the socket and ØMQ has assumed responsibility for the
-        // message. You do not need to call zmq_msg_close() after a successful
-        // zmq_msg_send().
-        // ZMQ_CALL(zmq_msg_close(&zmq_msg));
-
-        // put callback into map.
-        if (task.z_callback) {
-          z_callbacks_.emplace(task.timestamp, std::move(task.z_callback));
-
-          if (task.timeout_ms > 0) {
-            // Set a timeout event.
-            TimerEvent event;
-            event.timestamp = task.timestamp;
-            event.when = std::chrono::steady_clock::now() +
-                         std::chrono::milliseconds(task.timeout_ms);
-
-            timers_.push(event);
-          }
-        }
+      // Clear it before drain, the task pushed after it will write efd_
+      // again so it can not be missed. Use exchange not store: the RMW read
+      // the producer's exchange(true), so the task pushed before it is
+      // visible to the drain below.
+      notified_.exchange(false);
+
+      Task task;
+      while (PopTask(&task)) {
+        WaitTask(std::move(task));
       }
     }
 
-    // Handle timeout event.
-    wait_timeout = -1;
-    while (timers_.empty() == false) {
-      auto now = std::chrono::steady_clock::now();
-      if (now < timers_.top().when) {
-        wait_timeout = std::chrono::duration_cast<std::chrono::milliseconds>(
-                           timers_.top().when - now)
-                           .count();
-        break;
-      }
+    // Handle timeout event, the task maybe in flight or still waiting.
+    size_t expired = 0;
 
+    auto now = std::chrono::steady_clock::now();
+    while (timers_.empty() == false && timers_.top().when <= now) {
       TimerEvent event = timers_.top();
       timers_.pop();
 
+      ReplyHeader timeout_header;
+      timeout_header.compress_type = CompressType::kNo;
+      timeout_header.error_code = ErrorCode::kTimeoutError;
+      timeout_header.timestamp = event.timestamp;
+
       auto it = z_callbacks_.find(event.timestamp);
       if (it != z_callbacks_.end()) {
-        ReplyHeader timeout_header;
-        timeout_header.compress_type = CompressType::kNo;
-        timeout_header.error_code = ErrorCode::kTimeoutError;
-        timeout_header.timestamp = event.timestamp;
-
-        it->second(timeout_header, nullptr, 0);
+        it->second(timeout_header, {}, nullptr);
 
         z_callbacks_.erase(it);
+        in_flight_.fetch_sub(1);
+        continue;
+      }
+
+      // The task is skipped when it reach the front of wait_ques_.
+      auto w_it = wait_callbacks_.find(event.timestamp);
+      if (w_it != wait_callbacks_.end()) {
+        w_it->second.first(timeout_header, {}, nullptr);
+        waiting_[w_it->second.second].fetch_sub(1);
+
+        wait_callbacks_.erase(w_it);
+        expired++;
       }
     }
+
+    ReleasePending(expired);
+
+    // The replies and timeouts return the credits.
+    SendWaiting();
+
+    wait_timeout = -1;
+    if (timers_.empty() == false) {
+      wait_timeout = std::chrono::duration_cast<std::chrono::milliseconds>(
+                         timers_.top().when - std::chrono::steady_clock::now())
+                         .count();
+      wait_timeout = std::max<long>(wait_timeout, 0);
+    }
   }
 
+  FailAll();
+
   ZMQ_CALL(zmq_close(zmq_socket_));
   zmq_socket_ = nullptr;
 
@@ -214,26 +175,283 @@ void IndepConnecter::Run() {
   zmq_context_ = nullptr;
 }
 
+bool IndepConnecter::PopTask(Task* task) {
+  if (task_que_.TryPop(task)) {
+    return true;
+  }
+
+  if (io_task_que_.empty() == false) {
+    *task = std::move(io_task_que_.front());
+    io_task_que_.pop();
+
+    return true;
+  }
+
+  return false;
+}
+
+int32_t IndepConnecter::Admit(uint32_t rpc_type) {
+  // The IO thread will not drain the task.
+  if (stop_.load()) {
+    return ErrorCode::kConnecterStoppedError;
+  }
+
+  size_t max_pending = flow_control_.max_pending();
+
+  if (max_pending == 0 ||
+      flow_control_.Priority(rpc_type) == RPCPriority::kHigh) {
+    pending_.fetch_add(1);
+    return ErrorCode::kSuccess;
+  }
+
+  for (;;) {
+    if (stop_.load()) {
+      return ErrorCode::kConnecterStoppedError;
+    }
+
+    if (pending_.fetch_add(1) < max_pending) {
+      return ErrorCode::kSuccess;
+    }
+
+    pending_.fetch_sub(1);
+
+    if (flow_control_.mode() == FlowControlMode::kFailFast) {
+      return ErrorCode::kTooManyRequestsError;
+    }
+
+    // The IO thread can not wait itself.
+    if (std::this_thread::get_id() == worker_.get_id()) {
+      pending_.fetch_add(1);
+      return ErrorCode::kSuccess;
+    }
+
+    // Wait the IO thread send some tasks.
+    std::unique_lock<std::mutex> lock(credit_mu_);
+    blocked_.fetch_add(1);
+
+    credit_cond_.wait(lock, [this, max_pending]() {
+      return pending_.load() < max_pending || stop_.load();
+    });
+
+    blocked_.fetch_sub(1);
+  }
+}
+
 void IndepConnecter::EnqueTask(Task&& task) {
-  {
-    std::unique_lock<std::mutex> lock(task_que_mu_);
-    task_que_.emplace(std::move(task));
+  task.deadline = std::chrono::steady_clock::now() +
+                  std::chrono::milliseconds(task.timeout_ms);
+
+  // Both entering_ and stop_ are seq_cst, so either Admit see stop_ or
+  // FailAll see this caller and wait it push the task.
+  entering_.fetch_add(1);
+
+  int32_t error_code = Admit(task.rpc_type);
+  if (error_code != ErrorCode::kSuccess) {
+    entering_.fetch_sub(1);
+
+    FailTask(&task, error_code);
+    return;
   }
 
-  // tell worker to send message.
-  uint64_t u = 1;
+  if (std::this_thread::get_id() == worker_.get_id()) {
+    io_task_que_.emplace(std::move(task));
+  } else {
+    task_que_.Push(std::move(task));
+  }
+
+  // tell worker to send message if it is not notified.
+  if (notified_.exchange(true) == false) {
+    uint64_t u = 1;
+    ARGUMENT_CHECK(
+        write(efd_, &u, sizeof(uint64_t)) == sizeof(uint64_t),
+        "write eventfd errno:" << errno << ", msg:" << strerror(errno));
+  }
+
+  entering_.fetch_sub(1);
+}
+
+void IndepConnecter::FailTask(Task* task, int32_t error_code) {
+  ReplyHeader header;
+  header.timestamp = task->timestamp;
+  header.error_code = error_code;
+  header.compress_type = CompressType::kNo;
+
+  task->z_callback(header, {}, nullptr);
+}
+
+void IndepConnecter::FailAll() {
+  ReplyHeader header;
+  header.error_code = ErrorCode::kConnecterStoppedError;
+  header.compress_type = CompressType::kNo;
+
+  // The tasks enqueued before stop_ is seen. The callers passed the stop_
+  // check maybe not pushed yet (or blocked on a full task_que_), drain until
+  // they all leave, the later callers see stop_ and fail by themselves.
+  Task task;
+  for (;;) {
+    bool entering = entering_.load() > 0;
+
+    while (PopTask(&task)) {
+      FailTask(&task, ErrorCode::kConnecterStoppedError);
+    }
+
+    if (entering == false) {
+      break;
+    }
+
+    std::this_thread::yield();
+  }
+
+  for (auto& [timestamp, waiting] : wait_callbacks_) {
+    header.timestamp = timestamp;
+    waiting.first(header, {}, nullptr);
+  }
+
+  for (auto& [timestamp, z_callback] : z_callbacks_) {
+    header.timestamp = timestamp;
+    z_callback(header, {}, nullptr);
+  }
+
+  for (auto& que : wait_ques_) {
+    que = std::queue<Task>();
+  }
+
+  wait_callbacks_.clear();
+  z_callbacks_.clear();
+
+  pending_.store(0);
+  in_flight_.store(0);
+
+  for (auto& waiting : waiting_) {
+    waiting.store(0);
+  }
+}
+
+void IndepConnecter::SendTask(Task* task) {
+  // Compress the body by the RPC type's policy, becareful the raw data
+  // already include the RequestHeader but we only compress the body.
+  RequestHeader req_header;
+  req_header.timestamp = task->timestamp;
+  req_header.type = task->rpc_type;
+  req_header.compress_type = CompressType::kNo;
+
   ARGUMENT_CHECK(
-      write(efd_, &u, sizeof(uint64_t)) == sizeof(uint64_t),
-      "write eventfd errno:" << errno << ", msg:" << strerror(errno));
+      Compress::CompressBuffer(
+          req_header, compress_policies_.Get(task->rpc_type), &task->buf),
+      "Compress request error.");
+
+  // Zero copy, the big Tensors are sent as seperate frames.
+  // ref: http://api.zeromq.org/4-1:zmq-msg-send
+  // A successful invocation of zmq_msg_send() does not indicate that the
+  // message has been transmitted to the network, only that it has been
+  // queued on the socket and ØMQ has assumed responsibility for the
+  // message. You do not need to call zmq_msg_close() after a successful
+  // zmq_msg_send().
+  ZMQMessage::Send(zmq_socket_, &task->buf);
+
+  // put callback into map, the timer is started by WaitTask.
+  if (task->z_callback) {
+    z_callbacks_.emplace(task->timestamp, std::move(task->z_callback));
+    in_flight_.fetch_add(1);
+  }
+}
+
+void IndepConnecter::WaitTask(Task&& task) {
+  if (task.timeout_ms > 0) {
+    // Set a timeout event.
+    TimerEvent event;
+    event.timestamp = task.timestamp;
+    event.when = task.deadline;
+
+    timers_.push(event);
+  }
+
+  size_t priority = (size_t)flow_control_.Priority(task.rpc_type);
+
+  wait_callbacks_.emplace(task.timestamp,
+                          std::make_pair(std::move(task.z_callback), priority));
+  waiting_[priority].fetch_add(1);
+
+  wait_ques_[priority].emplace(std::move(task));
+}
+
+void IndepConnecter::SendWaiting() {
+  size_t max_in_flight = flow_control_.max_in_flight();
+  size_t sent = 0;
+
+  for (size_t p = 0; p < FlowControl::kPriorityNums; ++p) {
+    bool high = (p == (size_t)RPCPriority::kHigh);
+
+    while (wait_ques_[p].empty() == false) {
+      Task& task = wait_ques_[p].front();
+
+      // Timeout before sent, its pending place is already returned.
+      auto it = wait_callbacks_.find(task.timestamp);
+      if (it == wait_callbacks_.end()) {
+        wait_ques_[p].pop();
+        continue;
+      }
+
+      if (high == false && max_in_flight > 0 &&
+          z_callbacks_.size() >= max_in_flight) {
+        break;
+      }
+
+      task.z_callback = std::move(it->second.first);
+      wait_callbacks_.erase(it);
+
+      SendTask(&task);
+      wait_ques_[p].pop();
+
+      sent++;
+      waiting_[p].fetch_sub(1);
+    }
+  }
+
+  ReleasePending(sent);
+}
+
+void IndepConnecter::ReleasePending(size_t count) {
+  if (count == 0) {
+    return;
+  }
+
+  pending_.fetch_sub(count);
+
+  // Wake up the blocked callers.
+  if (blocked_.load() > 0) {
+    std::unique_lock<std::mutex> lock(credit_mu_);
+    credit_cond_.notify_all();
+  }
 }
 
 const std::string& IndepConnecter::addr() const {
   return addr_;
 }
 
+size_t IndepConnecter::pending() const {
+  return pending_.load();
+}
+
+size_t IndepConnecter::in_flight() const {
+  return in_flight_.load();
+}
+
+FlowStats IndepConnecter::Stats() const {
+  FlowStats stats;
+  stats.pending = pending_.load();
+  stats.in_flight = in_flight_.load();
+
+  for (size_t p = 0; p < FlowControl::kPriorityNums; ++p) {
+    stats.waiting[p] = waiting_[p].load();
+  }
+
+  return stats;
+}
+
 void IndepConnecter::Start() {
-  // create eventfd.
-  efd_ = eventfd(0, EFD_SEMAPHORE);
+  // create eventfd, read it clear the counter.
+  efd_ = eventfd(0, 0);
   ARGUMENT_CHECK(efd_ != -1, "eventfd error:" << efd_);
 
   // start worker thread.
@@ -246,6 +464,12 @@ void IndepConnecter::Start() {
 void IndepConnecter::Stop() {
   stop_.store(true);
 
+  // Wake up the blocked callers.
+  {
+    std::unique_lock<std::mutex> lock(credit_mu_);
+    credit_cond_.notify_all();
+  }
+
   // tell thread to stop.
   uint64_t u = 1;
   ARGUMENT_CHECK(
@@ -3,6 +3,8 @@
 #include <zmq.h>
 
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <functional>
 #include <mutex>
 #include <queue>
@@ -11,45 +13,89 @@
 #include <unordered_map>
 
 #include "common/compress.h"
-#include "common/mem_buffer.h"
+#include "common/compress_policy.h"
+#include "common/iovec_buffer.h"
+#include "common/mpsc_queue.h"
 #include "common/thread_barrier.h"
-#include "common/zmq_buffer.h"
+#include "common/zmq_message.h"
 #include "rpc/connecter.h"
+#include "rpc/flow_control.h"
 #include "rpc/protocol.h"
 
 namespace kraken {
 
 class IndepConnecter : public Connecter {
 private:
+  constexpr static size_t kTaskQueueCapacity = 4096;
+
   struct Task {
     uint64_t timestamp;
 
     uint32_t rpc_type;
 
-    // Becareful z_buf include the RequestHeader.
-    ZMQBuffer z_buf;
+    // Becareful buf include the RequestHeader.
+    IOVecBuffer buf;
 
     ZMQ_CALLBACK z_callback;
 
     // Timeout milliseconds.
     int64_t timeout_ms;
+
+    // The timer start at enqueue, the waiting time is counted.
+    std::chrono::time_point<std::chrono::steady_clock> deadline;
   };
 
   // target address.
   std::string addr_;
 
-  // compress algorithm
-  CompressType compress_type_;
+  // compress policy of every RPC type.
+  CompressPolicies compress_policies_;
+
+  FlowControl flow_control_;
 
   std::atomic_bool started_;
   std::atomic_bool stop_;
 
   std::atomic_uint64_t timestamp_;
 
-  std::mutex task_que_mu_;
-  std::queue<Task> task_que_;
+  // The IO thread is the only consumer.
+  MPSCQueue<Task> task_que_;
+
+  // The tasks enqueued by the IO thread itself (like in a callback), it can
+  // not wait the full task_que_ drained by itself. Only the IO thread use it.
+  std::queue<Task> io_task_que_;
+
+  // Set when efd_ is written and cleared by the IO thread before it drain the
+  // task_que_, so a burst of tasks only write efd_ once.
+  std::atomic_bool notified_;
   zmq_fd_t efd_;
 
+  // The tasks wait the credits by priority. Only the IO thread use it.
+  std::queue<Task> wait_ques_[FlowControl::kPriorityNums];
+
+  // The callbacks and priorities of the tasks in wait_ques_, removed if the
+  // task timeout before sent. Only the IO thread use it.
+  std::unordered_map<uint64_t /*timestamp*/, std::pair<ZMQ_CALLBACK, size_t>>
+      wait_callbacks_;
+
+  // The live tasks in wait_ques_ by priority, for FlowStats.
+  std::atomic_size_t waiting_[FlowControl::kPriorityNums];
+
+  // The tasks enqueued but not sent.
+  std::atomic_size_t pending_;
+
+  // The requests sent but not replied, same as z_callbacks_.size().
+  std::atomic_size_t in_flight_;
+
+  // The callers in EnqueTask, FailAll wait them leave so a task admitted
+  // before stop_ is not stranded in task_que_.
+  std::atomic_size_t entering_;
+
+  // The callers blocked by max_pending.
+  std::mutex credit_mu_;
+  std::condition_variable credit_cond_;
+  std::atomic_size_t blocked_;
+
   std::unordered_map<uint64_t /*timestamp*/, ZMQ_CALLBACK> z_callbacks_;
 
   std::priority_queue<TimerEvent, std::vector<TimerEvent>, TimerEventGrater>
@@ -61,20 +107,51 @@ private:
   void* zmq_socket_;
 
 public:
-  IndepConnecter(const std::string& addr, CompressType compress_type);
+  IndepConnecter(const std::string& addr, CompressPolicies compress_policies,
+                 FlowControl flow_control = FlowControl());
 
   ~IndepConnecter();
 
 private:
-  void HandleReply(zmq_msg_t& reply);
+  void HandleReply(const std::shared_ptr<ZMQMessage>& reply);
 
   void Run();
 
+  bool PopTask(Task* task);
+
+  // Take a pending place, return kTooManyRequestsError if fail fast or
+  // kConnecterStoppedError if stopped.
+  int32_t Admit(uint32_t rpc_type);
+
+  // Fail the task's callback with error_code.
+  void FailTask(Task* task, int32_t error_code);
+
+  // Called by the IO thread at exit, fail the tasks not replied.
+  void FailAll();
+
   void EnqueTask(Task&& task);
 
+  void SendTask(Task* task);
+
+  // Move the task into wait_ques_ and start its timer.
+  void WaitTask(Task&& task);
+
+  // Send the waiting tasks by priority until the credits are used up.
+  void SendWaiting();
+
+  // Return count pending places and wake up the blocked callers.
+  void ReleasePending(size_t count);
+
 public:
   const std::string& addr() const;
 
+  // The queue depth.
+  size_t pending() const;
+
+  size_t in_flight() const;
+
+  FlowStats Stats() const;
+
   void Start();
 
   void Stop();
@@ -114,19 +191,19 @@ public:
     req_header.type = rpc_type;
     req_header.compress_type = CompressType::kNo;
 
-    // Serialize the header and request.
-    MemBuffer buffer;
-    Serialize serialize(&buffer);
-
-    ARGUMENT_CHECK(serialize << req_header, "Serialize request header error!");
-    if ((serialize << req) == false) {
+    // Serialize the header and request, the big dense Tensors in req are
+    // referenced not copied, so the caller must not modify them until the
+    // callback is called.
+    IOVecBuffer buffer;
+    if (Compress::NoCompressSeria(req_header, req, &buffer) == false) {
       callback(ErrorCode::kSerializeRequestError, dummy_reply);
       return;
     }
 
     auto z_callback = [this, callback{std::move(callback)}](
-                          const ReplyHeader& header, const char* body,
-                          size_t body_len) {
+                          const ReplyHeader& header,
+                          const std::vector<IOVec>& body,
+                          const std::shared_ptr<void>& holder) {
       ReplyType reply;
 
       if (header.error_code != ErrorCode::kSuccess) {
@@ -135,18 +212,11 @@ public:
       }
 
       auto error_code = ErrorCode::kSuccess;
-      if (header.compress_type == CompressType::kNo) {
-        if (Compress::NoUnCompressDeser<ReplyType>(body, body_len, &reply) ==
-            false) {
-          error_code = ErrorCode::kDeserializeReplyError;
-        }
-      } else if (header.compress_type == CompressType::kSnappy) {
-        if (Compress::SnappyUnCompressDeser<ReplyType>(body, body_len,
-                                                       &reply) == false) {
-          error_code = ErrorCode::kDeserializeReplyError;
-        }
-      } else {
+      if (Compress::Support(header.compress_type) == false) {
         error_code = ErrorCode::kUnSupportCompressTypeError;
+      } else if (Compress::UnCompressDeser<ReplyType>(
+                     header.compress_type, body, &reply, holder) == false) {
+        error_code = ErrorCode::kDeserializeReplyError;
       }
 
       callback(error_code, reply);
@@ -158,7 +228,7 @@ public:
     task.z_callback = std::move(z_callback);
     task.timeout_ms = timeout_ms;
 
-    buffer.TransferForZMQ(&task.z_buf);
+    task.buf = std::move(buffer);
 
     EnqueTask(std::move(task));
   }
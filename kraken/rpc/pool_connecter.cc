@@ -0,0 +1,82 @@
+#include "rpc/pool_connecter.h"
+
+#include "common/exception.h"
+
+namespace kraken {
+
+PoolConnecter::PoolConnecter(const std::string& addr,
+                             const CompressPolicies& compress_policies,
+                             size_t socket_nums,
+                             const FlowControl& flow_control)
+    : addr_(addr), next_(0) {
+  ARGUMENT_CHECK(socket_nums > 0, "socket_nums must be positive.");
+
+  connecters_.reserve(socket_nums);
+  for (size_t i = 0; i < socket_nums; ++i) {
+    connecters_.emplace_back(
+        new IndepConnecter(addr, compress_policies, flow_control));
+  }
+}
+
+IndepConnecter* PoolConnecter::Pick() {
+  if (connecters_.size() == 1) {
+    return connecters_[0].get();
+  }
+
+  uint64_t idx = next_.fetch_add(1, std::memory_order_relaxed);
+
+  return connecters_[idx % connecters_.size()].get();
+}
+
+IndepConnecter* PoolConnecter::Pick(uint64_t key) const {
+  return connecters_[key % connecters_.size()].get();
+}
+
+const std::string& PoolConnecter::addr() const {
+  return addr_;
+}
+
+size_t PoolConnecter::socket_nums() const {
+  return connecters_.size();
+}
+
+size_t PoolConnecter::pending() const {
+  size_t pending = 0;
+  for (const auto& conn : connecters_) {
+    pending += conn->pending();
+  }
+
+  return pending;
+}
+
+size_t PoolConnecter::in_flight() const {
+  size_t in_flight = 0;
+  for (const auto& conn : connecters_) {
+    in_flight += conn->in_flight();
+  }
+
+  return in_flight;
+}
+
+FlowStats PoolConnecter::Stats() const {
+  FlowStats stats;
+  for (const auto& conn : connecters_) {
+    stats += conn->Stats();
+  }
+
+  return stats;
+}
+
+void PoolConnecter::Start() {
+  for (auto& conn : connecters_) {
+    conn->Start();
+  }
+}
+
+void PoolConnecter::Stop() {
+  for (auto& conn : connecters_) {
+    conn->Stop();
+  }
+}
+
+}  // namespace kraken
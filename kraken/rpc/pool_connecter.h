@@ -0,0 +1,93 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/compress_policy.h"
+#include "rpc/flow_control.h"
+#include "rpc/indep_connecter.h"
+
+namespace kraken {
+
+/**
+ * \brief Many IndepConnecters to one server, every one has it's own socket
+ * and IO thread.
+ *
+ * One IndepConnecter's IO thread send/receive all messages so it can not
+ * saturate a fast link. The calls are spread to the connecters by round-robin
+ * or by a key like the table id.
+ */
+class PoolConnecter {
+private:
+  std::string addr_;
+
+  std::vector<std::unique_ptr<IndepConnecter>> connecters_;
+
+  // The round-robin counter.
+  std::atomic_uint64_t next_;
+
+public:
+  // Every connecter has it's own flow_control window.
+  PoolConnecter(const std::string& addr,
+                const CompressPolicies& compress_policies, size_t socket_nums,
+                const FlowControl& flow_control = FlowControl());
+
+  ~PoolConnecter() = default;
+
+private:
+  IndepConnecter* Pick();
+
+  IndepConnecter* Pick(uint64_t key) const;
+
+public:
+  const std::string& addr() const;
+
+  size_t socket_nums() const;
+
+  // The queue depth of all connecters.
+  size_t pending() const;
+
+  size_t in_flight() const;
+
+  FlowStats Stats() const;
+
+  void Start();
+
+  void Stop();
+
+  template <typename ReqType, typename ReplyType>
+  int32_t Call(uint32_t rpc_type, const ReqType& req, ReplyType* reply,
+               int64_t timeout_ms = 5000) {
+    return Pick()->Call<ReqType, ReplyType>(rpc_type, req, reply, timeout_ms);
+  }
+
+  template <typename ReqType, typename ReplyType>
+  void CallAsync(uint32_t rpc_type, const ReqType& req,
+                 std::function<void(int32_t, ReplyType&)>&& callback,
+                 int64_t timeout_ms = 5000) {
+    Pick()->CallAsync<ReqType, ReplyType>(rpc_type, req, std::move(callback),
+                                          timeout_ms);
+  }
+
+  // The calls with the same key always use the same connecter, so they are
+  // sent in order.
+  template <typename ReqType, typename ReplyType>
+  int32_t CallByKey(uint64_t key, uint32_t rpc_type, const ReqType& req,
+                    ReplyType* reply, int64_t timeout_ms = 5000) {
+    return Pick(key)->Call<ReqType, ReplyType>(rpc_type, req, reply,
+                                               timeout_ms);
+  }
+
+  template <typename ReqType, typename ReplyType>
+  void CallAsyncByKey(uint64_t key, uint32_t rpc_type, const ReqType& req,
+                      std::function<void(int32_t, ReplyType&)>&& callback,
+                      int64_t timeout_ms = 5000) {
+    Pick(key)->CallAsync<ReqType, ReplyType>(rpc_type, req,
+                                             std::move(callback), timeout_ms);
+  }
+};
+
+}  // namespace kraken
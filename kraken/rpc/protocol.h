@@ -7,6 +7,8 @@ namespace kraken {
 enum class CompressType : uint8_t {
   kNo = 0,
   kSnappy = 1,
+  kLZ4 = 2,
+  kZSTD = 3,
 };
 
 #pragma pack(1)
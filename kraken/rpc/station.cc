@@ -11,11 +11,64 @@
 
 namespace kraken {
 
-Station::Station(uint32_t port, uint32_t thread_nums)
-    : port_(port), thread_nums_(thread_nums), started_(false), stop_(false) {
+Station::Completion::Completion(Station* station,
+                                std::shared_ptr<AsyncContext> ctx)
+    : station_(station), ctx_(std::move(ctx)), gate_(station->gate_) {
+}
+
+void Station::Completion::Finish(
+    const std::function<int32_t(IOVecBuffer*)>& seria) const {
+  ARGUMENT_CHECK(ctx_->done.exchange(true) == false,
+                 "The async func is completed twice.");
+
+  // Hold it until the reply is enqueued, the listen thread close the gate
+  // before release efd_.
+  std::shared_lock<std::shared_mutex> lock(gate_->mu);
+  if (gate_->closed) {
+    LOG_WARNING("Station has stopped, drop the reply of timestamp:["
+                << ctx_->req_header.timestamp << "]");
+    return;
+  }
+
+  Reply reply;
+  reply.identity = ctx_->identity;
+
+  int32_t error_code = seria(&reply.buf);
+  if (error_code != ErrorCode::kSuccess) {
+    reply.buf = IOVecBuffer();
+    HandleError(ctx_->req_header.timestamp, error_code, &reply.buf);
+  }
+
+  station_->EnqueReply(std::move(reply));
+}
+
+void Station::Completion::DoneRaw(
+    const std::function<int32_t(MemBuffer*)>& write) const {
+  Finish([this, &write](IOVecBuffer* buf) -> int32_t {
+    return station_->SeriaRawReply(ctx_->req_header, write, buf);
+  });
+}
+
+void Station::Completion::Error(int32_t error_code) const {
+  Finish([error_code](IOVecBuffer*) -> int32_t { return error_code; });
+}
+
+Station::Station(uint32_t port, uint32_t thread_nums, bool direct)
+    : port_(port),
+      thread_nums_(thread_nums),
+      direct_(direct),
+      reply_que_(kReplyQueueCapacity),
+      notified_(false),
+      efd_(-1),
+      started_(false),
+      stop_(false),
+      gate_(std::make_shared<ReplyGate>()) {
 }
 
 Station::~Station() {
+  // The Completions hold the raw pointer, make them drop the replies.
+  std::unique_lock<std::shared_mutex> lock(gate_->mu);
+  gate_->closed = true;
 }
 
 void Station::ZMQReceiveAndSend(void* from, void* to) {
@@ -36,49 +89,56 @@ void Station::ZMQReceiveAndSend(void* from, void* to) {
 }
 
 void Station::HandleError(uint64_t timestamp, int32_t error_code,
-                          zmq_msg_t& identity, void* socket) {
+                          IOVecBuffer* reply) {
   ReplyHeader reply_header;
   reply_header.timestamp = timestamp;
   reply_header.error_code = error_code;
   reply_header.compress_type = CompressType::kNo;
 
-  MemBuffer buf;
-  Serialize serializer(&buf);
+  // Drop the partial reply.
+  *reply = IOVecBuffer();
+  Serialize serializer(reply);
 
   ARGUMENT_CHECK(serializer << reply_header, "serialize reply header error!");
+}
+
+int32_t Station::SeriaRawReply(
+    const RequestHeader& req_header,
+    const std::function<int32_t(MemBuffer*)>& write, IOVecBuffer* buf) const {
+  ReplyHeader reply_header;
+  reply_header.timestamp = req_header.timestamp;
+  reply_header.error_code = ErrorCode::kSuccess;
+  reply_header.compress_type = CompressType::kNo;
 
-  // init replyid
-  zmq_msg_t replyid;
-  ZMQ_CALL(zmq_msg_init(&replyid));
-  ZMQ_CALL(zmq_msg_copy(&replyid, &identity));
+  // The body is appended after the header, no copy when send.
+  MemBuffer buffer;
+  Serialize serialize(&buffer);
 
-  ZMQBuffer z_buf;
-  buf.TransferForZMQ(&z_buf);
+  ARGUMENT_CHECK(serialize << reply_header, "Serialize reply header error!");
 
-  void* ptr = nullptr;
-  size_t capacity = 0;
-  size_t offset = 0;
-  void (*zmq_free)(void*, void*) = nullptr;
+  int32_t error_code = write(&buffer);
+  if (error_code != ErrorCode::kSuccess) {
+    return error_code;
+  }
 
-  z_buf.Transfer(&ptr, &capacity, &offset, &zmq_free);
+  ZMQBuffer z_buf;
+  buffer.TransferForZMQ(&z_buf);
 
-  // init reply
-  zmq_msg_t reply;
-  ZMQ_CALL(zmq_msg_init_data(&reply, ptr, offset, zmq_free, nullptr));
+  buf->Append(&z_buf);
 
-  ZMQ_CALL(zmq_msg_send(&replyid, socket, ZMQ_SNDMORE));
-  ZMQ_CALL(zmq_msg_send(&reply, socket, 0));
+  if (Compress::CompressBuffer(reply_header, ReplyCompressPolicy(req_header),
+                               buf) == false) {
+    return ErrorCode::kSerializeReplyError;
+  }
 
-  // http://api.zeromq.org/4-1:zmq-msg-send
-  // ZMQ_CALL(zmq_msg_close(&replyid));
-  // ZMQ_CALL(zmq_msg_close(&reply));
+  return ErrorCode::kSuccess;
 }
 
-void Station::HandleMsg(zmq_msg_t& identity, zmq_msg_t& msg, void* socket) {
-  size_t req_size = zmq_msg_size(&msg);
-  const char* req_data = (const char*)zmq_msg_data(&msg);
-
-  MemReader reader(req_data, req_size);
+bool Station::HandleMsg(const std::string& identity,
+                        const std::shared_ptr<ZMQMessage>& msg,
+                        IOVecBuffer* reply) {
+  // The RequestHeader always be in the first frame.
+  MemReader reader(msg->data(), msg->size());
   Deserialize header_d(&reader);
 
   RequestHeader req_header;
@@ -86,42 +146,86 @@ void Station::HandleMsg(zmq_msg_t& identity, zmq_msg_t& msg, void* socket) {
 
   // Only read not need mutex.
   auto it = funcs_.find(req_header.type);
-  if (it == funcs_.end()) {
-    HandleError(req_header.timestamp, ErrorCode::kUnRegisterFuncError, identity,
-                socket);
-    return;
-  }
+  if (it != funcs_.end()) {
+    // The request's Tensors maybe alias the msg.
+    int32_t ecode =
+        it->second(req_header, msg->Body(sizeof(req_header)), msg, reply);
 
-  ZMQBuffer z_buf;
-  int32_t ecode = it->second(req_header, req_data + sizeof(req_header),
-                             req_size - sizeof(req_header), &z_buf);
+    if (ecode != ErrorCode::kSuccess) {
+      HandleError(req_header.timestamp, ecode, reply);
+    }
 
-  if (ecode != ErrorCode::kSuccess) {
-    HandleError(req_header.timestamp, ecode, identity, socket);
-    return;
+    return true;
   }
 
-  void* ptr = nullptr;
-  size_t capacity = 0;
-  size_t offset = 0;
-  void (*zmq_free)(void*, void*) = nullptr;
-
-  z_buf.Transfer(&ptr, &capacity, &offset, &zmq_free);
+  auto a_it = async_funcs_.find(req_header.type);
+  if (a_it == async_funcs_.end()) {
+    HandleError(req_header.timestamp, ErrorCode::kUnRegisterFuncError, reply);
+    return true;
+  }
 
-  // send reply.
-  zmq_msg_t replyid;
-  ZMQ_CALL(zmq_msg_init(&replyid));
-  ZMQ_CALL(zmq_msg_copy(&replyid, &identity));
+  auto ctx = std::make_shared<AsyncContext>();
+  ctx->identity = identity;
+  ctx->req_header = req_header;
+  ctx->done.store(false);
 
-  zmq_msg_t reply;
-  ZMQ_CALL(zmq_msg_init_data(&reply, ptr, offset, zmq_free, nullptr));
+  a_it->second(req_header, msg->Body(sizeof(req_header)), msg,
+               Completion(this, ctx));
 
-  ZMQ_CALL(zmq_msg_send(&replyid, socket, ZMQ_SNDMORE));
-  ZMQ_CALL(zmq_msg_send(&reply, socket, 0));
+  return false;
+}
 
+void Station::SendReply(void* socket, const void* identity, size_t size,
+                        IOVecBuffer* reply) {
+  // The big Tensors of the reply are sent as seperate frames without copy.
   // http://api.zeromq.org/4-1:zmq-msg-send
-  // ZMQ_CALL(zmq_msg_close(&replyid));
-  // ZMQ_CALL(zmq_msg_close(&reply));
+  ZMQ_CALL(zmq_send(socket, identity, size, ZMQ_SNDMORE));
+  ZMQMessage::Send(socket, reply);
+}
+
+void Station::EnqueReply(Reply&& reply) {
+  reply_que_.Push(std::move(reply));
+
+  // Only the first reply after the listen thread drained write efd_.
+  if (notified_.exchange(true) == false) {
+    uint64_t u = 1;
+    ARGUMENT_CHECK(
+        write(efd_, &u, sizeof(uint64_t)) == sizeof(uint64_t),
+        "write eventfd errno:" << errno << ", msg:" << strerror(errno));
+  }
+}
+
+void Station::CloseReplies() {
+  // The async funcs maybe blocked on a full reply_que_, drain it so they can
+  // release the gate.
+  Reply reply;
+  while (gate_->mu.try_lock() == false) {
+    while (reply_que_.TryPop(&reply)) {
+    }
+
+    std::this_thread::yield();
+  }
+
+  gate_->closed = true;
+  gate_->mu.unlock();
+}
+
+void Station::SendReplies(void* socket) {
+  uint64_t u;
+  ARGUMENT_CHECK(read(efd_, &u, sizeof(uint64_t)) == sizeof(uint64_t),
+                 "read eventfd error.");
+
+  // Clear it before drain, the reply enqueued after it will write efd_
+  // again so it can not be missed. Use exchange not store: the RMW read the
+  // producer's exchange(true), so the reply enqueued before it is visible to
+  // the drain below.
+  notified_.exchange(false);
+
+  Reply reply;
+  while (reply_que_.TryPop(&reply)) {
+    SendReply(socket, reply.identity.data(), reply.identity.size(),
+              &reply.buf);
+  }
 }
 
 void Station::Run(void* zmp_context) {
@@ -132,95 +236,211 @@ void Station::Run(void* zmp_context) {
   ZMQ_CALL(zmq_connect(receiver, "inproc://workers"));
 
   while (stop_.load() == false) {
-    // For Router and DEALER model the worker will recieve 2 message one is
-    // identity another is real msg.
+    // For Router and DEALER model the worker will recieve the identity then
+    // the real msg, the msg maybe multipart.
     zmq_msg_t identity;
-    zmq_msg_t msg;
-
     ZMQ_CALL(zmq_msg_init(&identity));
-    ZMQ_CALL(zmq_msg_init(&msg));
+
+    // The msg is closed when the last Tensor alias it is released.
+    auto msg = std::make_shared<ZMQMessage>();
 
     ZMQ_CALL(zmq_msg_recv(&identity, receiver, 0));
-    ZMQ_CALL(zmq_msg_recv(&msg, receiver, 0));
+    msg->Recv(receiver);
 
-    HandleMsg(identity, msg, receiver);
+    std::string id((const char*)zmq_msg_data(&identity),
+                   zmq_msg_size(&identity));
+
+    IOVecBuffer reply;
+    if (HandleMsg(id, msg, &reply)) {
+      SendReply(receiver, id.data(), id.size(), &reply);
+    }
 
     ZMQ_CALL(zmq_msg_close(&identity));
-    ZMQ_CALL(zmq_msg_close(&msg));
   }
 
   ZMQ_CALL(zmq_close(receiver));
 }
 
-void Station::Start() {
-  auto callback = [this]() {
-    void* zmq_context = zmq_ctx_new();
-    ARGUMENT_CHECK(zmq_context != nullptr, "zmq_ctx_new return nullptr, error:"
-                                               << zmq_strerror(zmq_errno()));
-
-    void* frontend = zmq_socket(zmq_context, ZMQ_ROUTER);
-    ARGUMENT_CHECK(frontend != nullptr, "zmq_socket return nullptr, error:"
-                                            << zmq_strerror(zmq_errno()));
-
-    // Bind to tcp.
-    std::string addr = "tcp://*:" + std::to_string(port_);
-    ZMQ_CALL(zmq_bind(frontend, addr.c_str()));
-
-    // create socket for worker. inner process socket.
-    void* backend = zmq_socket(zmq_context, ZMQ_DEALER);
-    ARGUMENT_CHECK(backend != nullptr, "zmq_socket return nullptr, error:"
-                                           << zmq_strerror(zmq_errno()));
-
-    ZMQ_CALL(zmq_bind(backend, "inproc://workers"));
-
-    // Start thread pool.
-    for (uint32_t i = 0; i < thread_nums_; ++i) {
-      std::thread t(&Station::Run, this, zmq_context);
-      workers_.emplace_back(std::move(t));
+void Station::RunProxy() {
+  void* zmq_context = zmq_ctx_new();
+  ARGUMENT_CHECK(zmq_context != nullptr, "zmq_ctx_new return nullptr, error:"
+                                             << zmq_strerror(zmq_errno()));
+
+  void* frontend = zmq_socket(zmq_context, ZMQ_ROUTER);
+  ARGUMENT_CHECK(frontend != nullptr, "zmq_socket return nullptr, error:"
+                                          << zmq_strerror(zmq_errno()));
+
+  // Bind to tcp.
+  std::string addr = "tcp://*:" + std::to_string(port_);
+  ZMQ_CALL(zmq_bind(frontend, addr.c_str()));
+
+  // create socket for worker. inner process socket.
+  void* backend = zmq_socket(zmq_context, ZMQ_DEALER);
+  ARGUMENT_CHECK(backend != nullptr, "zmq_socket return nullptr, error:"
+                                         << zmq_strerror(zmq_errno()));
+
+  ZMQ_CALL(zmq_bind(backend, "inproc://workers"));
+
+  // The async funcs tell the listen thread there are replies to send, read it
+  // clear the counter.
+  efd_ = eventfd(0, 0);
+  ARGUMENT_CHECK(efd_ != -1, "eventfd error:" << efd_);
+
+  // Start thread pool.
+  for (uint32_t i = 0; i < thread_nums_; ++i) {
+    std::thread t(&Station::Run, this, zmq_context);
+    workers_.emplace_back(std::move(t));
+  }
+
+  zmq_pollitem_t items[] = {{frontend, 0, ZMQ_POLLIN, 0},
+                            {backend, 0, ZMQ_POLLIN, 0},
+                            {nullptr, efd_, ZMQ_POLLIN, 0}};
+
+  started_.store(true);
+  LOG_INFO("Station start at port:[" << port_ << "]");
+
+  while (stop_.load() == false) {
+    zmq_poll(items, 3, -1);
+
+    if (items[0].revents & ZMQ_POLLIN) {
+      // frontend to backend.
+      // http://api.zeromq.org/4-0:zmq-msg-recv
+      // http://thisthread.blogspot.com/2012/02/zeromq-31-multithreading-reviewed.html
+      ZMQReceiveAndSend(frontend, backend);
     }
 
-    zmq_pollitem_t items[] = {{frontend, 0, ZMQ_POLLIN, 0},
-                              {backend, 0, ZMQ_POLLIN, 0}};
+    if (items[1].revents & ZMQ_POLLIN) {
+      // backend to frontend.
+      ZMQReceiveAndSend(backend, frontend);
+    }
+
+    if (items[2].revents & ZMQ_POLLIN) {
+      // The async replies.
+      SendReplies(frontend);
+    }
+  }
+
+  // Wait worker thread finish.
+  for (auto& t : workers_) {
+    if (t.joinable()) {
+      t.join();
+    }
+  }
+
+  CloseReplies();
+
+  close(efd_);
+  efd_ = -1;
 
-    started_.store(true);
-    LOG_INFO("Station start at port:[" << port_ << "]");
+  // close socket and destroy context.
+  ZMQ_CALL(zmq_close(backend));
+  backend = nullptr;
 
-    while (stop_.load() == false) {
-      zmq_poll(items, 2, -1);
+  ZMQ_CALL(zmq_close(frontend));
+  frontend = nullptr;
 
-      if (items[0].revents & ZMQ_POLLIN) {
-        // frontend to backend.
-        // http://api.zeromq.org/4-0:zmq-msg-recv
-        // http://thisthread.blogspot.com/2012/02/zeromq-31-multithreading-reviewed.html
-        ZMQReceiveAndSend(frontend, backend);
-      }
+  ZMQ_CALL(zmq_term(zmq_context));
+  zmq_context = nullptr;
+}
+
+void Station::RunDirect() {
+  void* zmq_context = zmq_ctx_new();
+  ARGUMENT_CHECK(zmq_context != nullptr, "zmq_ctx_new return nullptr, error:"
+                                             << zmq_strerror(zmq_errno()));
 
-      if (items[1].revents & ZMQ_POLLIN) {
-        // backend to frontend.
-        ZMQReceiveAndSend(backend, frontend);
-      }
+  void* frontend = zmq_socket(zmq_context, ZMQ_ROUTER);
+  ARGUMENT_CHECK(frontend != nullptr, "zmq_socket return nullptr, error:"
+                                          << zmq_strerror(zmq_errno()));
+
+  // Bind to tcp.
+  std::string addr = "tcp://*:" + std::to_string(port_);
+  ZMQ_CALL(zmq_bind(frontend, addr.c_str()));
+
+  // The handlers and async funcs tell the listen thread there are replies to
+  // send, read it clear the counter.
+  efd_ = eventfd(0, 0);
+  ARGUMENT_CHECK(efd_ != -1, "eventfd error:" << efd_);
+
+  handlers_.reset(new ThreadPool(thread_nums_));
+
+  zmq_pollitem_t items[2];
+
+  // 0 to receive the requests.
+  items[0].socket = frontend;
+  items[0].fd = 0;
+  items[0].events = ZMQ_POLLIN;
+  items[0].revents = 0;
+
+  // 1 to check the replies.
+  items[1].socket = nullptr;
+  items[1].fd = efd_;
+  items[1].events = ZMQ_POLLIN;
+  items[1].revents = 0;
+
+  started_.store(true);
+  LOG_INFO("Station start at port:[" << port_ << "] in direct mode.");
+
+  while (stop_.load() == false) {
+    zmq_poll(items, 2, -1);
+
+    if (items[0].revents & ZMQ_POLLIN) {
+      zmq_msg_t identity;
+      ZMQ_CALL(zmq_msg_init(&identity));
+      ZMQ_CALL(zmq_msg_recv(&identity, frontend, 0));
+
+      std::string id((const char*)zmq_msg_data(&identity),
+                     zmq_msg_size(&identity));
+
+      ZMQ_CALL(zmq_msg_close(&identity));
+
+      // The msg is closed when the last Tensor alias it is released.
+      auto msg = std::make_shared<ZMQMessage>();
+      msg->Recv(frontend);
+
+      handlers_->Enque([this, id, msg]() {
+        Reply reply;
+        reply.identity = id;
+
+        if (HandleMsg(id, msg, &reply.buf)) {
+          EnqueReply(std::move(reply));
+        }
+      });
     }
 
-    // Wait worker thread finish.
-    for (auto& t : workers_) {
-      if (t.joinable()) {
-        t.join();
-      }
+    if (items[1].revents & ZMQ_POLLIN) {
+      SendReplies(frontend);
     }
+  }
+
+  handlers_->Stop();
+
+  CloseReplies();
 
-    // close socket and destroy context.
-    ZMQ_CALL(zmq_close(backend));
-    backend = nullptr;
+  close(efd_);
+  efd_ = -1;
 
-    ZMQ_CALL(zmq_close(frontend));
-    frontend = nullptr;
+  ZMQ_CALL(zmq_close(frontend));
+  frontend = nullptr;
 
-    ZMQ_CALL(zmq_term(zmq_context));
-    zmq_context = nullptr;
-  };
+  ZMQ_CALL(zmq_term(zmq_context));
+  zmq_context = nullptr;
+}
+
+void Station::SetCompressPolicy(uint32_t type, const CompressPolicy& policy) {
+  ARGUMENT_CHECK(!started_.load(),
+                 "The server has been started, must call SetCompressPolicy "
+                 "before start.");
+
+  compress_policies_.Set(type, policy);
+}
 
+void Station::Start() {
   // use separate thread to listen the connection.
-  listen_t_ = std::thread(std::move(callback));
+  if (direct_) {
+    listen_t_ = std::thread(&Station::RunDirect, this);
+  } else {
+    listen_t_ = std::thread(&Station::RunProxy, this);
+  }
 
   // Wait start finish.
   while (started_.load() == false) {
@@ -1,64 +1,230 @@
 #pragma once
 
-#include <snappy.h>
 #include <zmq.h>
 
 #include <atomic>
 #include <cinttypes>
 #include <functional>
+#include <memory>
 #include <queue>
+#include <shared_mutex>
+#include <string>
 #include <thread>
 #include <unordered_map>
+#include <vector>
 
 #include "common/compress.h"
+#include "common/compress_policy.h"
 #include "common/deserialize.h"
 #include "common/error_code.h"
 #include "common/exception.h"
+#include "common/iovec_buffer.h"
 #include "common/mem_buffer.h"
 #include "common/mem_reader.h"
+#include "common/mpsc_queue.h"
 #include "common/serialize.h"
-#include "common/snappy.h"
 #include "common/thread_barrier.h"
+#include "common/thread_pool.h"
 #include "common/zmq_buffer.h"
+#include "common/zmq_message.h"
 #include "rpc/protocol.h"
 
 namespace kraken {
 
 class Station {
 private:
-  using FUNC = std::function<int32_t(const RequestHeader&, const char*, size_t,
-                                     ZMQBuffer*)>;
+  constexpr static size_t kReplyQueueCapacity = 4096;
+
+  // The body maybe scattered in many frames, they are owned by the holder.
+  using FUNC = std::function<int32_t(const RequestHeader&,
+                                     const std::vector<IOVec>&,
+                                     const std::shared_ptr<void>&,
+                                     IOVecBuffer*)>;
+
+  // A reply wait to be sent by the listen thread.
+  struct Reply {
+    std::string identity;
+    IOVecBuffer buf;
+  };
+
+  // Where to reply an async func.
+  struct AsyncContext {
+    std::string identity;
+    RequestHeader req_header;
+
+    std::atomic_bool done;
+  };
+
+  // Shared by the Station and its Completions, the Completions drop the
+  // replies once the listen thread is stopped.
+  struct ReplyGate {
+    std::shared_mutex mu;
+    bool closed = false;
+  };
+
+public:
+  /**
+   * \brief The completion token of an async func.
+   *
+   * It can be copied and completed in any thread later, but must be completed
+   * only once by one of Done/DoneRaw/Error. The reply is sent by the listen
+   * thread so the Station thread is not blocked by the func. The reply is
+   * dropped if the listen thread has stopped.
+   */
+  class Completion {
+  private:
+    Station* station_;
+    std::shared_ptr<AsyncContext> ctx_;
+    std::shared_ptr<ReplyGate> gate_;
+
+  public:
+    Completion(Station* station, std::shared_ptr<AsyncContext> ctx);
+
+  private:
+    // Serialize the reply by seria (an error reply if it fails) and send it.
+    void Finish(const std::function<int32_t(IOVecBuffer*)>& seria) const;
+
+  public:
+    template <typename ReplyType>
+    void Done(const ReplyType& reply) const {
+      Finish([this, &reply](IOVecBuffer* buf) -> int32_t {
+        return station_->SeriaReply(ctx_->req_header, reply, buf);
+      });
+    }
+
+    // Same with the RegisterRawFunc, write serialize the reply body.
+    void DoneRaw(const std::function<int32_t(MemBuffer*)>& write) const;
+
+    void Error(int32_t error_code) const;
+  };
+
+private:
+  using ASYNC_FUNC = std::function<void(
+      const RequestHeader&, const std::vector<IOVec>&,
+      const std::shared_ptr<void>&, const Completion&)>;
 
   uint32_t port_;
 
   uint32_t thread_nums_;
   std::vector<std::thread> workers_;
 
+  // In proxy mode the listen thread forward every message between the ROUTER
+  // and an inproc DEALER, the workers receive and reply by the DEALER.
+  // In direct mode the listen thread own the only socket, it dispatch the
+  // requests to handlers_ and send the replies by itself, so a message not
+  // cross the inproc queue.
+  bool direct_;
+
+  // Direct mode only.
+  std::unique_ptr<ThreadPool> handlers_;
+
+  // Written by handlers_ and the async funcs, the listen thread is the only
+  // consumer.
+  MPSCQueue<Reply> reply_que_;
+  std::atomic_bool notified_;
+  int efd_;
+
   // A seperate thread to listen connect.
   std::thread listen_t_;
 
   std::atomic_bool started_;
   std::atomic_bool stop_;
 
+  std::shared_ptr<ReplyGate> gate_;
+
   // register funcs.
   std::unordered_map<uint32_t, FUNC> funcs_;
+  std::unordered_map<uint32_t, ASYNC_FUNC> async_funcs_;
+
+  // The reply's compress policy, follow the request if not set.
+  CompressPolicies compress_policies_;
 
 public:
-  Station(uint32_t port, uint32_t thread_nums);
+  Station(uint32_t port, uint32_t thread_nums, bool direct = false);
 
   ~Station();
 
 private:
   void ZMQReceiveAndSend(void* from, void* to);
 
-  void HandleError(uint64_t timestamp, int32_t error_code, zmq_msg_t& identity,
-                   void* socket);
+  static void HandleError(uint64_t timestamp, int32_t error_code,
+                          IOVecBuffer* reply);
+
+  // Call the registered func and serialize the reply (or the error) into it.
+  // Return false if it is an async func, the reply is sent by the Completion.
+  bool HandleMsg(const std::string& identity,
+                 const std::shared_ptr<ZMQMessage>& msg, IOVecBuffer* reply);
+
+  static void SendReply(void* socket, const void* identity, size_t size,
+                        IOVecBuffer* reply);
+
+  void EnqueReply(Reply&& reply);
+
+  // Called by the listen thread before release efd_, the later replies are
+  // dropped.
+  void CloseReplies();
 
-  void HandleMsg(zmq_msg_t& identity, zmq_msg_t& msg, void* socket);
+  // Send the replies in reply_que_ by the listen thread.
+  void SendReplies(void* socket);
 
   void Run(void* zmp_context);
 
+  void RunProxy();
+
+  void RunDirect();
+
+  template <typename RequestType>
+  static int32_t DeserRequest(const RequestHeader& req_header,
+                              const std::vector<IOVec>& body,
+                              const std::shared_ptr<void>& holder,
+                              RequestType* req) {
+    if (Compress::Support(req_header.compress_type) == false) {
+      return ErrorCode::kUnSupportCompressTypeError;
+    }
+
+    if (Compress::UnCompressDeser<RequestType>(req_header.compress_type, body,
+                                               req, holder) == false) {
+      return ErrorCode::kDeserializeRequestError;
+    }
+
+    return ErrorCode::kSuccess;
+  }
+
+  CompressPolicy ReplyCompressPolicy(const RequestHeader& req_header) const {
+    const CompressPolicy* policy = compress_policies_.Find(req_header.type);
+    if (policy == nullptr) {
+      return CompressPolicy(req_header.compress_type);
+    }
+
+    return *policy;
+  }
+
+  template <typename ReplyType>
+  int32_t SeriaReply(const RequestHeader& req_header, const ReplyType& reply,
+                     IOVecBuffer* buf) const {
+    ReplyHeader reply_header;
+    reply_header.timestamp = req_header.timestamp;
+    reply_header.error_code = ErrorCode::kSuccess;
+    reply_header.compress_type = CompressType::kNo;
+
+    if (Compress::CompressSeria(reply_header, reply,
+                                ReplyCompressPolicy(req_header),
+                                buf) == false) {
+      return ErrorCode::kSerializeReplyError;
+    }
+
+    return ErrorCode::kSuccess;
+  }
+
+  // The body is written by write after the header.
+  int32_t SeriaRawReply(const RequestHeader& req_header,
+                        const std::function<int32_t(MemBuffer*)>& write,
+                        IOVecBuffer* buf) const;
+
 public:
+  // Compress the reply of the RPC type by policy, must call before start.
+  void SetCompressPolicy(uint32_t type, const CompressPolicy& policy);
+
   template <typename RequestType, typename ReplyType>
   void RegisterFunc(
       uint32_t type,
@@ -69,55 +235,95 @@ public:
                    "before start.");
 
     auto func = [this, callback{std::move(callback)}](
-                    const RequestHeader& req_header, const char* body,
-                    size_t body_len, ZMQBuffer* z_buf) -> int32_t {
+                    const RequestHeader& req_header,
+                    const std::vector<IOVec>& body,
+                    const std::shared_ptr<void>& holder,
+                    IOVecBuffer* buf) -> int32_t {
       RequestType req;
       ReplyType reply;
 
-      if (req_header.compress_type == CompressType::kNo) {
-        if (Compress::NoUnCompressDeser<RequestType>(body, body_len, &req) ==
-            false) {
-          return ErrorCode::kDeserializeRequestError;
-        }
-      } else if (req_header.compress_type == CompressType::kSnappy) {
-        if (Compress::SnappyUnCompressDeser<RequestType>(body, body_len,
-                                                         &req) == false) {
-          return ErrorCode::kDeserializeRequestError;
-        }
-      } else {
-        return ErrorCode::kUnSupportCompressTypeError;
+      int32_t error_code = DeserRequest(req_header, body, holder, &req);
+      if (error_code != ErrorCode::kSuccess) {
+        return error_code;
       }
 
-      int32_t error_code = callback(req, &reply);
+      error_code = callback(req, &reply);
       if (error_code != ErrorCode::kSuccess) {
         return error_code;
       }
 
-      ReplyHeader reply_header;
-      reply_header.timestamp = req_header.timestamp;
-      reply_header.error_code = ErrorCode::kSuccess;
-      reply_header.compress_type = req_header.compress_type;
-
-      if (reply_header.compress_type == CompressType::kNo) {
-        if (Compress::NoCompressSeria<ReplyType>(reply_header, reply, z_buf) ==
-            false) {
-          return ErrorCode::kSerializeReplyError;
-        }
-      } else if (reply_header.compress_type == CompressType::kSnappy) {
-        if (Compress::SnappyCompressSeria<ReplyType>(reply_header, reply,
-                                                     z_buf) == false) {
-          return ErrorCode::kSerializeReplyError;
-        }
-      } else {
-        return ErrorCode::kUnSupportCompressTypeError;
+      return SeriaReply(req_header, reply, buf);
+    };
+
+    funcs_.emplace(type, std::move(func));
+  }
+
+  // The callback serialize the reply body into the MemBuffer by itself, so a
+  // big reply can be written from the source directly without building the
+  // ReplyType. The body must be same with the serialized ReplyType.
+  template <typename RequestType>
+  void RegisterRawFunc(
+      uint32_t type,
+      std::function<int32_t(const RequestType&, MemBuffer*)>&& callback) {
+    // check whether the server has been started.
+    ARGUMENT_CHECK(!started_.load(),
+                   "The server has been started, must call register_func "
+                   "before start.");
+
+    auto func = [this, callback{std::move(callback)}](
+                    const RequestHeader& req_header,
+                    const std::vector<IOVec>& body,
+                    const std::shared_ptr<void>& holder,
+                    IOVecBuffer* buf) -> int32_t {
+      RequestType req;
+
+      int32_t error_code = DeserRequest(req_header, body, holder, &req);
+      if (error_code != ErrorCode::kSuccess) {
+        return error_code;
       }
 
-      return ErrorCode::kSuccess;
+      return SeriaRawReply(
+          req_header,
+          [&callback, &req](MemBuffer* buffer) -> int32_t {
+            return callback(req, buffer);
+          },
+          buf);
     };
 
     funcs_.emplace(type, std::move(func));
   }
 
+  // The func reply by the Completion later, so a slow func (like wait another
+  // node) not block the Station thread. Becareful the req is only valid in the
+  // call, copy it if use it after return (the Tensors are not copied).
+  template <typename RequestType>
+  void RegisterAsyncFunc(
+      uint32_t type,
+      std::function<void(const RequestType&, Completion)>&& callback) {
+    // check whether the server has been started.
+    ARGUMENT_CHECK(!started_.load(),
+                   "The server has been started, must call register_func "
+                   "before start.");
+
+    auto func = [callback{std::move(callback)}](
+                    const RequestHeader& req_header,
+                    const std::vector<IOVec>& body,
+                    const std::shared_ptr<void>& holder,
+                    const Completion& done) {
+      RequestType req;
+
+      int32_t error_code = DeserRequest(req_header, body, holder, &req);
+      if (error_code != ErrorCode::kSuccess) {
+        done.Error(error_code);
+        return;
+      }
+
+      callback(req, done);
+    };
+
+    async_funcs_.emplace(type, std::move(func));
+  }
+
   void Start();
 
   void Wait();
@@ -14,7 +14,7 @@ void SyncStation::HandleError(uint64_t timestamp, int32_t error_code,
   reply_header.error_code = error_code;
   reply_header.compress_type = CompressType::kNo;
 
-  MemBuffer buf;
+  IOVecBuffer buf;
   Serialize serializer(&buf);
 
   ARGUMENT_CHECK(serializer << reply_header, "serialize reply header error!");
@@ -24,32 +24,14 @@ void SyncStation::HandleError(uint64_t timestamp, int32_t error_code,
   ZMQ_CALL(zmq_msg_init(&replyid));
   ZMQ_CALL(zmq_msg_copy(&replyid, &identity));
 
-  ZMQBuffer z_buf;
-  buf.TransferForZMQ(&z_buf);
-
-  void* ptr = nullptr;
-  size_t capacity = 0;
-  size_t offset = 0;
-  void (*zmq_free)(void*, void*) = nullptr;
-
-  z_buf.Transfer(&ptr, &capacity, &offset, &zmq_free);
-
-  // init reply
-  zmq_msg_t reply;
-  ZMQ_CALL(zmq_msg_init_data(&reply, ptr, offset, zmq_free, nullptr));
-
   ZMQ_CALL(zmq_msg_send(&replyid, socket, ZMQ_SNDMORE));
-  ZMQ_CALL(zmq_msg_send(&reply, socket, 0));
-
-  // ZMQ_CALL(zmq_msg_close(&replyid));
-  // ZMQ_CALL(zmq_msg_close(&reply));
+  ZMQMessage::Send(socket, &buf);
 }
 
-void SyncStation::HandleMsg(zmq_msg_t& identity, zmq_msg_t& msg, void* socket) {
-  size_t req_size = zmq_msg_size(&msg);
-  const char* req_data = (const char*)zmq_msg_data(&msg);
-
-  MemReader reader(req_data, req_size);
+void SyncStation::HandleMsg(zmq_msg_t& identity, ZMQMessage& msg,
+                            void* socket) {
+  // The RequestHeader always be in the first frame.
+  MemReader reader(msg.data(), msg.size());
   Deserialize header_d(&reader);
 
   RequestHeader req_header;
@@ -63,36 +45,22 @@ void SyncStation::HandleMsg(zmq_msg_t& identity, zmq_msg_t& msg, void* socket) {
     return;
   }
 
-  ZMQBuffer z_buf;
-  int32_t ecode = it->second(req_header, req_data + sizeof(req_header),
-                             req_size - sizeof(req_header), &z_buf);
+  IOVecBuffer reply;
+  int32_t ecode = it->second(req_header, msg.Body(sizeof(req_header)), &reply);
 
   if (ecode != ErrorCode::kSuccess) {
     HandleError(req_header.timestamp, ecode, identity, socket);
     return;
   }
 
-  void* ptr = nullptr;
-  size_t capacity = 0;
-  size_t offset = 0;
-  void (*zmq_free)(void*, void*) = nullptr;
-
-  z_buf.Transfer(&ptr, &capacity, &offset, &zmq_free);
-
   // send reply.
   zmq_msg_t replyid;
   ZMQ_CALL(zmq_msg_init(&replyid));
   ZMQ_CALL(zmq_msg_copy(&replyid, &identity));
 
-  zmq_msg_t reply;
-  ZMQ_CALL(zmq_msg_init_data(&reply, ptr, offset, zmq_free, nullptr));
-
-  ZMQ_CALL(zmq_msg_send(&replyid, socket, ZMQ_SNDMORE));
-  ZMQ_CALL(zmq_msg_send(&reply, socket, 0));
-
   // http://api.zeromq.org/4-1:zmq-msg-send
-  // ZMQ_CALL(zmq_msg_close(&replyid));
-  // ZMQ_CALL(zmq_msg_close(&reply));
+  ZMQ_CALL(zmq_msg_send(&replyid, socket, ZMQ_SNDMORE));
+  ZMQMessage::Send(socket, &reply);
 }
 
 void SyncStation::Run() {
@@ -111,18 +79,17 @@ void SyncStation::Run() {
 
   while (true) {
     zmq_msg_t identity;
-    zmq_msg_t msg;
-
     ZMQ_CALL(zmq_msg_init(&identity));
-    ZMQ_CALL(zmq_msg_init(&msg));
+
+    // The msg maybe multipart.
+    ZMQMessage msg;
 
     ZMQ_CALL(zmq_msg_recv(&identity, zmq_scoket_, 0));
-    ZMQ_CALL(zmq_msg_recv(&msg, zmq_scoket_, 0));
+    msg.Recv(zmq_scoket_);
 
     HandleMsg(identity, msg, zmq_scoket_);
 
     ZMQ_CALL(zmq_msg_close(&identity));
-    ZMQ_CALL(zmq_msg_close(&msg));
   }
 
   // Never be called.
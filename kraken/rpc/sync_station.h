@@ -1,6 +1,5 @@
 #pragma once
 
-#include <snappy.h>
 #include <zmq.h>
 
 #include <atomic>
@@ -9,11 +8,13 @@
 #include <queue>
 #include <thread>
 #include <unordered_map>
+#include <vector>
 
 #include "common/compress.h"
 #include "common/error_code.h"
+#include "common/iovec_buffer.h"
 #include "common/thread_barrier.h"
-#include "common/zmq_buffer.h"
+#include "common/zmq_message.h"
 #include "rpc/protocol.h"
 
 namespace kraken {
@@ -21,8 +22,9 @@ namespace kraken {
 // Like Station but it's sync.
 class SyncStation {
 private:
-  using FUNC = std::function<int32_t(const RequestHeader&, const char*, size_t,
-                                     ZMQBuffer*)>;
+  // The body maybe scattered in many frames.
+  using FUNC = std::function<int32_t(const RequestHeader&,
+                                     const std::vector<IOVec>&, IOVecBuffer*)>;
 
   uint32_t port_;
 
@@ -44,7 +46,7 @@ private:
   void HandleError(uint64_t timestamp, int32_t error_code, zmq_msg_t& identity,
                    void* socket);
 
-  void HandleMsg(zmq_msg_t& identity, zmq_msg_t& msg, void* socket);
+  void HandleMsg(zmq_msg_t& identity, ZMQMessage& msg, void* socket);
 
 public:
   // Cannot call this function after start.
@@ -53,25 +55,21 @@ public:
       uint32_t type,
       std::function<int32_t(const RequestType&, ReplyType*)>&& callback) {
     auto func = [this, callback{std::move(callback)}](
-                    const RequestHeader& req_header, const char* body,
-                    size_t body_len, ZMQBuffer* z_buf) -> int32_t {
+                    const RequestHeader& req_header,
+                    const std::vector<IOVec>& body,
+                    IOVecBuffer* buf) -> int32_t {
       RequestType req;
       ReplyType reply;
 
-      if (req_header.compress_type == CompressType::kNo) {
-        if (Compress::NoUnCompressDeser<RequestType>(body, body_len, &req) ==
-            false) {
-          return ErrorCode::kDeserializeRequestError;
-        }
-      } else if (req_header.compress_type == CompressType::kSnappy) {
-        if (Compress::SnappyUnCompressDeser<RequestType>(body, body_len,
-                                                         &req) == false) {
-          return ErrorCode::kDeserializeRequestError;
-        }
-      } else {
+      if (Compress::Support(req_header.compress_type) == false) {
         return ErrorCode::kUnSupportCompressTypeError;
       }
 
+      if (Compress::UnCompressDeser<RequestType>(req_header.compress_type,
+                                                 body, &req) == false) {
+        return ErrorCode::kDeserializeRequestError;
+      }
+
       int32_t error_code = callback(req, &reply);
       if (error_code != ErrorCode::kSuccess) {
         return error_code;
@@ -80,20 +78,13 @@ public:
       ReplyHeader reply_header;
       reply_header.timestamp = req_header.timestamp;
       reply_header.error_code = ErrorCode::kSuccess;
-      reply_header.compress_type = req_header.compress_type;
-
-      if (reply_header.compress_type == CompressType::kNo) {
-        if (Compress::NoCompressSeria<ReplyType>(reply_header, reply, z_buf) ==
-            false) {
-          return ErrorCode::kSerializeReplyError;
-        }
-      } else if (reply_header.compress_type == CompressType::kSnappy) {
-        if (Compress::SnappyCompressSeria<ReplyType>(reply_header, reply,
-                                                     z_buf) == false) {
-          return ErrorCode::kSerializeReplyError;
-        }
-      } else {
-        return ErrorCode::kUnSupportCompressTypeError;
+      reply_header.compress_type = CompressType::kNo;
+
+      // Reply with the request's codec.
+      if (Compress::CompressSeria(reply_header, reply,
+                                  CompressPolicy(req_header.compress_type),
+                                  buf) == false) {
+        return ErrorCode::kSerializeReplyError;
       }
 
       return ErrorCode::kSuccess;
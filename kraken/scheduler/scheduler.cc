@@ -252,6 +252,7 @@ int32_t Scheduler::RegisterSparseTable(
     std::string name, int64_t dimension, ElementType element_type,
     InitializerType init_type,
     const std::unordered_map<std::string, std::string>& init_conf,
+    const std::unordered_map<std::string, std::string>& table_conf,
     uint64_t* table_id) {
   if (model_init_ == false) {
     return ErrorCode::kModelNotInitializedError;
@@ -292,6 +293,7 @@ int32_t Scheduler::RegisterSparseTable(
     req.element_type = element_type;
     req.init_type = init_type;
     req.init_conf = init_conf;
+    req.table_conf = table_conf;
 
     std::vector<CreateSparseTableResponse> replies;
 
@@ -307,6 +309,7 @@ int32_t Scheduler::RegisterSparseTable(
   table_mdata.element_type = element_type;
   table_mdata.init_type = init_type;
   table_mdata.init_conf = init_conf;
+  table_mdata.table_conf = table_conf;
 
   model_mdata_.table_mdatas.emplace(real_id, std::move(table_mdata));
 
@@ -315,7 +318,8 @@ int32_t Scheduler::RegisterSparseTable(
   LOG_INFO("Register SparseTable:["
            << name << "], id:[" << real_id << "], dimension:[" << dimension
            << "], ElementType:[" << element_type.Name() << "], init_type:["
-           << init_type << "], init_conf:[" << init_conf << "], in all Ps.");
+           << init_type << "], init_conf:[" << init_conf << "], table_conf:["
+           << table_conf << "], in all Ps.");
 
   return ErrorCode::kSuccess;
 }
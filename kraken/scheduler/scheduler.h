@@ -59,6 +59,7 @@ public:
       std::string name, int64_t dimension, ElementType element_type,
       InitializerType init_type,
       const std::unordered_map<std::string, std::string>& init_conf,
+      const std::unordered_map<std::string, std::string>& table_conf,
       uint64_t* table_id);
 
   // Call by Worker.
@@ -34,7 +34,8 @@ int32_t SchedulerServer::RegisterSparseTable(
     const RegisterSparseTableRequest& req, RegisterSparseTableResponse* rsp) {
   return scheduler_.RegisterSparseTable(req.name, req.dimension,
                                         req.element_type, req.init_type,
-                                        req.init_conf, &(rsp->table_id));
+                                        req.init_conf, req.table_conf,
+                                        &(rsp->table_id));
 }
 
 int32_t SchedulerServer::TrySaveModel(const TrySaveModelRequest& req,
@@ -20,6 +20,16 @@ struct half {
 static_assert(2 == sizeof(half));
 #pragma pack()
 
+/**
+ * \brief Use uint16_t represent a bfloat16, the high 16 bits of a float.
+ */
+#pragma pack(1)
+struct bfloat16 {
+  uint16_t value;
+};
+static_assert(2 == sizeof(bfloat16));
+#pragma pack()
+
 enum class DType : uint8_t {
   kUnKnown = 0,
   kBool = 1,  // This is a uint8 type.
@@ -34,6 +44,7 @@ enum class DType : uint8_t {
   kFloat16 = 10,
   kFloat32 = 11,
   kFloat64 = 12,
+  kBFloat16 = 13,
 };
 
 struct ElementType {
@@ -67,6 +78,8 @@ struct ElementType {
         return "Float32";
       case DType::kFloat64:
         return "Float64";
+      case DType::kBFloat16:
+        return "BFloat16";
       default:
         return "UnKnown";
     }
@@ -100,6 +113,8 @@ struct ElementType {
         return sizeof(float);
       case DType::kFloat64:
         return sizeof(double);
+      case DType::kBFloat16:
+        return sizeof(bfloat16);
       default:
         return 0;
     }
@@ -192,6 +207,11 @@ inline bool ElementType::Is<double>() const {
   return dtype == DType::kFloat64;
 }
 
+template <>
+inline bool ElementType::Is<bfloat16>() const {
+  return dtype == DType::kBFloat16;
+}
+
 #undef DEF_FROM_FUNC
 #define DEF_FROM_FUNC(Type, T) \
   template <> \
@@ -215,6 +235,7 @@ DEF_FROM_FUNC(kInt64, int64_t);
 DEF_FROM_FUNC(kFloat16, half);
 DEF_FROM_FUNC(kFloat32, float);
 DEF_FROM_FUNC(kFloat64, double);
+DEF_FROM_FUNC(kBFloat16, bfloat16);
 
 #undef DEF_FROM_FUNC
 
@@ -446,6 +446,10 @@ void ConcatVector(const std::vector<std::shared_ptr<TensorImpl>>& xs,
     ConcatVectorImpl<float>(xs, y.Data<float>(), row, col);
   } else if (y.element_type().Is<double>()) {
     ConcatVectorImpl<double>(xs, y.Data<double>(), row, col);
+  } else if (y.element_type().Is<half>()) {
+    ConcatVectorImpl<half>(xs, y.Data<half>(), row, col);
+  } else if (y.element_type().Is<bfloat16>()) {
+    ConcatVectorImpl<bfloat16>(xs, y.Data<bfloat16>(), row, col);
   } else {
     RUNTIME_ERROR(
         "ConcatVector not support ElementType:" << y.element_type().Name());
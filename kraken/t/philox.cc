@@ -0,0 +1,173 @@
+#include "t/philox.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace kraken {
+namespace philox {
+
+namespace {
+
+constexpr uint32_t kM0 = 0xD2511F53;
+constexpr uint32_t kM1 = 0xCD9E8D57;
+constexpr uint32_t kW0 = 0x9E3779B9;
+constexpr uint32_t kW1 = 0xBB67AE85;
+
+constexpr int kRounds = 10;
+
+// The counters are processed kLanes at once, the inner loops are independent
+// so the compiler can vectorize them.
+constexpr size_t kLanes = 8;
+
+inline void Rounds(uint64_t key, uint32_t (&c)[4][kLanes]) {
+  uint32_t k0 = (uint32_t)key;
+  uint32_t k1 = (uint32_t)(key >> 32);
+
+  for (int r = 0; r < kRounds; ++r) {
+    for (size_t l = 0; l < kLanes; ++l) {
+      uint64_t p0 = (uint64_t)kM0 * c[0][l];
+      uint64_t p1 = (uint64_t)kM1 * c[2][l];
+
+      uint32_t c0 = (uint32_t)(p1 >> 32) ^ c[1][l] ^ k0;
+      uint32_t c2 = (uint32_t)(p0 >> 32) ^ c[3][l] ^ k1;
+
+      c[0][l] = c0;
+      c[1][l] = (uint32_t)p1;
+      c[2][l] = c2;
+      c[3][l] = (uint32_t)p0;
+    }
+
+    k0 += kW0;
+    k1 += kW1;
+  }
+}
+
+// [0, 1) with 24 bits.
+template <typename T>
+inline T ToUnit(uint32_t x) {
+  return T(x >> 8) * T(1.0 / 16777216.0);
+}
+
+// (0, 1] with 24 bits, for the log of Box-Muller.
+template <typename T>
+inline T ToPositiveUnit(uint32_t x) {
+  return T((x >> 8) + 1) * T(1.0 / 16777216.0);
+}
+
+}  // namespace
+
+void Generate(uint64_t key, uint64_t id, uint64_t block, uint32_t* out) {
+  uint32_t c[4][kLanes] = {};
+
+  c[0][0] = (uint32_t)block;
+  c[1][0] = (uint32_t)(block >> 32);
+  c[2][0] = (uint32_t)id;
+  c[3][0] = (uint32_t)(id >> 32);
+
+  Rounds(key, c);
+
+  for (size_t k = 0; k < 4; ++k) {
+    out[k] = c[k][0];
+  }
+}
+
+void GenerateRows(uint64_t key, const std::vector<uint64_t>& ids,
+                  size_t blocks, uint32_t* out) {
+  size_t total = ids.size() * blocks;
+
+  uint32_t c[4][kLanes];
+
+  for (size_t begin = 0; begin < total; begin += kLanes) {
+    size_t count = std::min(kLanes, total - begin);
+
+    // The lanes after count repeat the last one.
+    for (size_t l = 0; l < kLanes; ++l) {
+      size_t j = begin + std::min(l, count - 1);
+      uint64_t block = j % blocks;
+      uint64_t id = ids[j / blocks];
+
+      c[0][l] = (uint32_t)block;
+      c[1][l] = (uint32_t)(block >> 32);
+      c[2][l] = (uint32_t)id;
+      c[3][l] = (uint32_t)(id >> 32);
+    }
+
+    Rounds(key, c);
+
+    for (size_t l = 0; l < count; ++l) {
+      for (size_t k = 0; k < 4; ++k) {
+        out[(begin + l) * 4 + k] = c[k][l];
+      }
+    }
+  }
+}
+
+template <typename T>
+void UniformRows(uint64_t key, const std::vector<uint64_t>& ids,
+                 int64_t dimension, T lower, T upper,
+                 const std::vector<T*>& rows) {
+  size_t blocks = (size_t)(dimension + 3) / 4;
+  std::vector<uint32_t> words(ids.size() * blocks * 4);
+
+  GenerateRows(key, ids, blocks, words.data());
+
+  T range = upper - lower;
+
+  for (size_t i = 0; i < ids.size(); ++i) {
+    const uint32_t* w = words.data() + i * blocks * 4;
+    T* row = rows[i];
+
+    for (int64_t j = 0; j < dimension; ++j) {
+      row[j] = lower + range * ToUnit<T>(w[j]);
+    }
+  }
+}
+
+template <typename T>
+void NormalRows(uint64_t key, const std::vector<uint64_t>& ids,
+                int64_t dimension, T mean, T stddev,
+                const std::vector<T*>& rows) {
+  constexpr T kTwoPi = T(6.283185307179586);
+
+  size_t blocks = (size_t)(dimension + 3) / 4;
+  std::vector<uint32_t> words(ids.size() * blocks * 4);
+
+  GenerateRows(key, ids, blocks, words.data());
+
+  for (size_t i = 0; i < ids.size(); ++i) {
+    const uint32_t* w = words.data() + i * blocks * 4;
+    T* row = rows[i];
+
+    // Every 2 words give 2 normals, the words of a row is a multiple of 4 so
+    // the odd dimension also has a pair.
+    for (int64_t j = 0; j < dimension; j += 2) {
+      T r = stddev * std::sqrt(T(-2) * std::log(ToPositiveUnit<T>(w[j])));
+      T theta = kTwoPi * ToUnit<T>(w[j + 1]);
+
+      row[j] = mean + r * std::cos(theta);
+
+      if (j + 1 < dimension) {
+        row[j + 1] = mean + r * std::sin(theta);
+      }
+    }
+  }
+}
+
+template void UniformRows<float>(uint64_t, const std::vector<uint64_t>&,
+                                 int64_t, float, float,
+                                 const std::vector<float*>&);
+
+template void UniformRows<double>(uint64_t, const std::vector<uint64_t>&,
+                                  int64_t, double, double,
+                                  const std::vector<double*>&);
+
+template void NormalRows<float>(uint64_t, const std::vector<uint64_t>&,
+                                int64_t, float, float,
+                                const std::vector<float*>&);
+
+template void NormalRows<double>(uint64_t, const std::vector<uint64_t>&,
+                                 int64_t, double, double,
+                                 const std::vector<double*>&);
+
+}  // namespace philox
+}  // namespace kraken
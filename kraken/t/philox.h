@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cinttypes>
+#include <vector>
+
+namespace kraken {
+namespace philox {
+
+// Philox4x32-10 counter-based RNG (Salmon et al., "Parallel Random Numbers: As
+// Easy as 1, 2, 3"). The random words are a pure function of (key, counter),
+// so a row's random only depend on it's own id, not on the generation order.
+// The counter of a row's block is: (block, block >> 32, id, id >> 32), every
+// block give 4 uint32.
+
+// Generate the 4 words of one block.
+void Generate(uint64_t key, uint64_t id, uint64_t block, uint32_t* out);
+
+// Generate blocks for every id, out[(i * blocks + b) * 4 + k] is the k-th word
+// of ids[i]'s block b. The counters are processed in lanes so the rounds are
+// vectorized.
+void GenerateRows(uint64_t key, const std::vector<uint64_t>& ids,
+                  size_t blocks, uint32_t* out);
+
+// Fill rows[i] ([dimension]) by the uniform in [lower, upper) of ids[i].
+template <typename T>
+void UniformRows(uint64_t key, const std::vector<uint64_t>& ids,
+                 int64_t dimension, T lower, T upper,
+                 const std::vector<T*>& rows);
+
+// Fill rows[i] ([dimension]) by the normal (Box-Muller) of ids[i].
+template <typename T>
+void NormalRows(uint64_t key, const std::vector<uint64_t>& ids,
+                int64_t dimension, T mean, T stddev,
+                const std::vector<T*>& rows);
+
+}  // namespace philox
+}  // namespace kraken
@@ -6,6 +6,15 @@ Storage::Storage(Device* device, void* ptr, size_t size, bool own)
     : device_(device), ptr_(ptr), size_(size), own_(own) {
 }
 
+Storage::Storage(Device* device, void* ptr, size_t size,
+                 std::shared_ptr<void> holder)
+    : device_(device),
+      ptr_(ptr),
+      size_(size),
+      own_(false),
+      holder_(std::move(holder)) {
+}
+
 Storage::~Storage() {
   if (own_) {
     device_->Free(ptr_);
@@ -44,4 +53,12 @@ std::shared_ptr<Storage> Storage::From(void* ptr, size_t size) {
   return std::shared_ptr<Storage>(new Storage(device, ptr, size, false));
 }
 
+std::shared_ptr<Storage> Storage::From(void* ptr, size_t size,
+                                       std::shared_ptr<void> holder) {
+  Device* device = Device::Shared();
+
+  return std::shared_ptr<Storage>(
+      new Storage(device, ptr, size, std::move(holder)));
+}
+
 }  // namespace kraken
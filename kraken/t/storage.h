@@ -20,9 +20,15 @@ private:
   // whether malloc by device_
   bool own_;
 
+  // Keep the not owned memory alive, like a received ZMQ message.
+  std::shared_ptr<void> holder_;
+
 private:
   Storage(Device* device, void* ptr, size_t size, bool own);
 
+  Storage(Device* device, void* ptr, size_t size,
+          std::shared_ptr<void> holder);
+
   Storage(const Storage&) = delete;
   Storage& operator=(const Storage&) = delete;
   Storage(Storage&&) = delete;
@@ -40,6 +46,10 @@ public:
 public:
   static std::shared_ptr<Storage> Create(size_t size);
   static std::shared_ptr<Storage> From(void* ptr, size_t size);
+
+  // The memory is owned by holder, the Storage keep a reference of it.
+  static std::shared_ptr<Storage> From(void* ptr, size_t size,
+                                       std::shared_ptr<void> holder);
 };
 
 }  // namespace kraken
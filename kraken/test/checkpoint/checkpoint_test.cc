@@ -0,0 +1,158 @@
+#include "checkpoint/checkpoint.h"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "checkpoint/file_writer.h"
+#include "common/error_code.h"
+#include "common/router.h"
+#include "common/serialize.h"
+#include "ps/initializer/initializer.h"
+#include "ps/optim/optim.h"
+#include "test/utils_test.h"
+
+namespace kraken {
+namespace test {
+
+TEST(Checkpoint, ModelMetaDataBinary) {
+  std::string path = TempPath("model_mdata");
+
+  ModelMetaData model_mdata;
+  model_mdata.name = "model";
+  model_mdata.optim_type = OptimType::kSGD;
+  model_mdata.optim_conf["lr"] = "0.5";
+
+  TableMetaData& table_mdata = model_mdata.table_mdatas[1];
+  table_mdata.id = 1;
+  table_mdata.name = "embedding";
+  table_mdata.table_type = TableType::kSparse;
+  table_mdata.element_type = ElementType::From<float>();
+  table_mdata.dimension = 8;
+  table_mdata.init_type = InitializerType::kConstant;
+  table_mdata.table_conf["store_type"] = "float16";
+
+  EXPECT_TRUE(io::Checkpoint::SaveModelMetaDataBinary(path, model_mdata));
+
+  ModelMetaData load_mdata;
+  EXPECT_TRUE(io::Checkpoint::LoadModelMetaDataBinary(path, &load_mdata));
+
+  EXPECT_EQ(load_mdata.name, "model");
+  EXPECT_EQ(load_mdata.table_mdatas.size(), 1);
+  EXPECT_EQ(load_mdata.table_mdatas[1].name, "embedding");
+  EXPECT_EQ(load_mdata.table_mdatas[1].table_conf, table_mdata.table_conf);
+
+  std::filesystem::remove(path);
+}
+
+TEST(Checkpoint, LoadOldModelMetaDataBinary) {
+  std::string path = TempPath("old_model_mdata");
+
+  // The layout before table_conf is added.
+  {
+    io::FileWriter writer(path);
+    Serialize serialize(&writer);
+
+    std::string name = "model";
+    OptimType optim_type = OptimType::kSGD;
+    std::unordered_map<std::string, std::string> optim_conf;
+    uint64_t table_size = 1;
+
+    uint64_t table_id = 1;
+    std::string table_name = "embedding";
+    TableType table_type = TableType::kSparse;
+    ElementType element_type = ElementType::From<float>();
+    Shape shape;
+    int64_t dimension = 8;
+    InitializerType init_type = InitializerType::kConstant;
+    std::unordered_map<std::string, std::string> init_conf;
+
+    EXPECT_TRUE((serialize << name) && (serialize << optim_type) &&
+                (serialize << optim_conf) && (serialize << table_size));
+
+    EXPECT_TRUE((serialize << table_id) && (serialize << table_id) &&
+                (serialize << table_name) && (serialize << table_type) &&
+                (serialize << element_type) && (serialize << shape) &&
+                (serialize << dimension) && (serialize << init_type) &&
+                (serialize << init_conf));
+  }
+
+  ModelMetaData load_mdata;
+  EXPECT_TRUE(io::Checkpoint::LoadModelMetaDataBinary(path, &load_mdata));
+
+  EXPECT_EQ(load_mdata.name, "model");
+  EXPECT_EQ(load_mdata.table_mdatas.size(), 1);
+  EXPECT_EQ(load_mdata.table_mdatas[1].name, "embedding");
+  EXPECT_EQ(load_mdata.table_mdatas[1].dimension, 8);
+  EXPECT_TRUE(load_mdata.table_mdatas[1].table_conf.empty());
+
+  std::filesystem::remove(path);
+}
+
+TEST(Checkpoint, SaveTieredSparseTable) {
+  int64_t dimension = 6;
+  float lr = 0.1;
+
+  std::unique_ptr<Optim> optim = Optim::Create(OptimType::kAdam, {});
+  std::string cold_path = TempPath("checkpoint_tiered");
+  std::string path = TempPath("checkpoint_tiered_table");
+
+  std::vector<uint64_t> sparse_ids;
+  for (uint64_t i = 0; i < 64; ++i) {
+    sparse_ids.emplace_back(i);
+  }
+
+  SparseTable tiered_table(
+      1, "tiered", dimension, ElementType::From<float>(),
+      Initializer::Create(InitializerType::kNormal, {}),
+      {{"slot_count", "4"},
+       {"max_rows", "16"},
+       {"evict_interval_ms", "0"},
+       {"cold_path", cold_path}},
+      optim.get());
+
+  std::vector<Tensor> vals;
+  EXPECT_EQ(ErrorCode::kSuccess, tiered_table.Pull(sparse_ids, &vals));
+
+  std::vector<Tensor> grads;
+  for (size_t i = 0; i < sparse_ids.size(); ++i) {
+    grads.emplace_back(RandomTensor<float>(Shape({dimension})));
+  }
+
+  EXPECT_EQ(ErrorCode::kSuccess,
+            tiered_table.Push(optim.get(), sparse_ids, grads, lr));
+
+  // Spill 48 rows, the saved table must include them.
+  EXPECT_EQ(48u, tiered_table.Evict());
+  EXPECT_TRUE(io::Checkpoint::SaveSparseTable(path, &tiered_table));
+
+  SparseTable table(1, "tiered", dimension, ElementType::From<float>(),
+                    Initializer::Create(InitializerType::kNormal, {}),
+                    {{"slot_count", "4"}}, optim.get());
+
+  Router router;
+  router.Add(0, "ps");
+
+  EXPECT_TRUE(io::Checkpoint::LoadSparseTable(path, &table, 0, router));
+
+  for (auto id : sparse_ids) {
+    EXPECT_TRUE(table.mutable_vals()->Contains(id));
+  }
+
+  std::vector<Tensor> tiered_vals;
+  EXPECT_EQ(ErrorCode::kSuccess, table.Pull(sparse_ids, &vals));
+  EXPECT_EQ(ErrorCode::kSuccess, tiered_table.Pull(sparse_ids, &tiered_vals));
+
+  for (size_t i = 0; i < sparse_ids.size(); ++i) {
+    AssertTensorEQ(vals[i], tiered_vals[i]);
+  }
+
+  std::filesystem::remove(path);
+  std::filesystem::remove_all(cold_path);
+}
+
+}  // namespace test
+}  // namespace kraken
@@ -0,0 +1,204 @@
+#include "common/compress.h"
+
+#include <gtest/gtest.h>
+#include <snappy.h>
+
+#include <string>
+#include <vector>
+
+#include "common/compress_policy.h"
+#include "common/serialize.h"
+#include "common/utils.h"
+#include "protocol/push_sparse_table_prot.h"
+#include "test/utils_test.h"
+
+namespace kraken {
+namespace test {
+
+TEST(Compress, ShuffleUnShuffle) {
+  size_t size = utils::ThreadLocalRandom<size_t>(1, 10000);
+
+  std::string str;
+  for (size_t i = 0; i < size; ++i) {
+    str.push_back(utils::ThreadLocalRandom<char>(-128, 127));
+  }
+
+  size_t p0 = utils::ThreadLocalRandom<size_t>(0, size);
+  std::vector<IOVec> iovs = {{str.data(), p0}, {str.data() + p0, size - p0}};
+
+  for (uint8_t width : {2, 3, 4, 8}) {
+    std::string shuffled(size, 0);
+    Compress::Shuffle(iovs, width, shuffled.data());
+
+    size_t count = size / width;
+    for (size_t i = 0; i < count * width; ++i) {
+      EXPECT_EQ(shuffled[(i % width) * count + i / width], str[i]);
+    }
+
+    std::string unshuffled(size, 0);
+    Compress::UnShuffle(shuffled.data(), size, width, unshuffled.data());
+
+    EXPECT_EQ(unshuffled, str);
+  }
+}
+
+TEST(Compress, CompressUnCompress) {
+  PushSparseTableRequest req;
+  req.router_version = 1;
+  req.table_id = 2;
+  req.lr = 0.5;
+
+  // Make it compressible.
+  for (int64_t i = 0; i < 64; ++i) {
+    req.sparse_ids.emplace_back(i);
+    req.grads.emplace_back(
+        VectorToTensor<float>(std::vector<float>(16, (float)(i % 4))));
+  }
+
+  // Big enough to be a seperate segment.
+  req.grads.emplace_back(RandomTensor<float>(Shape({4096})));
+  req.sparse_ids.emplace_back(64);
+
+  std::vector<CompressType> types = {CompressType::kSnappy, CompressType::kLZ4,
+                                     CompressType::kZSTD};
+
+  for (auto type : types) {
+    for (uint8_t shuffle : {0, 4}) {
+      RequestHeader header;
+      header.timestamp = 3;
+      header.type = 4;
+      header.compress_type = CompressType::kNo;
+
+      IOVecBuffer buf;
+      EXPECT_TRUE(Compress::CompressSeria(
+          header, req, CompressPolicy(type, 0, shuffle), &buf));
+
+      std::vector<IOVec> iovs = buf.IOVecs();
+      EXPECT_EQ(iovs.size(), 1);
+
+      RequestHeader r_header;
+      memcpy(&r_header, iovs[0].ptr, sizeof(r_header));
+
+      EXPECT_EQ(r_header.timestamp, header.timestamp);
+      EXPECT_EQ(r_header.type, header.type);
+      EXPECT_EQ(r_header.compress_type, type);
+
+      PushSparseTableRequest r_req;
+      EXPECT_TRUE(Compress::UnCompressDeser(
+          r_header.compress_type, buf.IOVecs(sizeof(r_header)), &r_req));
+
+      EXPECT_EQ(r_req.router_version, req.router_version);
+      EXPECT_EQ(r_req.table_id, req.table_id);
+      EXPECT_EQ(r_req.lr, req.lr);
+      EXPECT_EQ(r_req.sparse_ids, req.sparse_ids);
+      EXPECT_EQ(r_req.grads.size(), req.grads.size());
+
+      for (size_t i = 0; i < req.grads.size(); ++i) {
+        EXPECT_EQ(TensorToVector<float>(r_req.grads[i]),
+                  TensorToVector<float>(req.grads[i]));
+      }
+    }
+  }
+}
+
+TEST(Compress, SnappyLayout) {
+  std::vector<uint64_t> ids(100, 7);
+
+  MemBuffer raw;
+  {
+    Serialize serialize(&raw);
+    EXPECT_TRUE(serialize << ids);
+  }
+
+  // The snappy body has no prefix, so it can be decoded by the old version.
+  MemBuffer body;
+  EXPECT_TRUE(
+      Compress::CompressBody(CompressPolicy(CompressType::kSnappy, 0, 4),
+                             {{raw.ptr(), raw.offset()}}, &body));
+
+  size_t length;
+  EXPECT_TRUE(
+      snappy::GetUncompressedLength(body.ptr(), body.offset(), &length));
+  EXPECT_EQ(length, raw.offset());
+
+  std::string uncompressed(length, 0);
+  EXPECT_TRUE(
+      snappy::RawUncompress(body.ptr(), body.offset(), uncompressed.data()));
+  EXPECT_EQ(uncompressed, std::string(raw.ptr(), raw.offset()));
+
+  std::shared_ptr<MemBuffer> r_raw;
+  EXPECT_TRUE(Compress::UnCompressBody(CompressType::kSnappy,
+                                       {{body.ptr(), body.offset()}}, &r_raw));
+  EXPECT_EQ(std::string(r_raw->ptr(), r_raw->offset()), uncompressed);
+}
+
+TEST(Compress, BadSizePrefix) {
+  std::vector<uint64_t> ids(100, 7);
+
+  MemBuffer raw;
+  {
+    Serialize serialize(&raw);
+    EXPECT_TRUE(serialize << ids);
+  }
+
+  for (auto type : {CompressType::kLZ4, CompressType::kZSTD}) {
+    MemBuffer body;
+    EXPECT_TRUE(Compress::CompressBody(CompressPolicy(type, 0, 0),
+                                       {{raw.ptr(), raw.offset()}}, &body));
+
+    // The size in the prefix is not the real one, should fail without
+    // allocate it.
+    for (uint64_t size : {(uint64_t)raw.offset() + 1, (uint64_t)1 << 40}) {
+      memcpy(body.ptr() + sizeof(uint8_t), &size, sizeof(size));
+
+      std::shared_ptr<MemBuffer> r_raw;
+      EXPECT_FALSE(Compress::UnCompressBody(
+          type, {{body.ptr(), body.offset()}}, &r_raw));
+    }
+  }
+}
+
+TEST(Compress, MinBytes) {
+  std::vector<uint64_t> ids(100, 0);
+
+  RequestHeader header;
+  header.timestamp = 0;
+  header.type = 0;
+  header.compress_type = CompressType::kNo;
+
+  // Smaller than min_bytes, keep it uncompressed.
+  IOVecBuffer buf;
+  EXPECT_TRUE(Compress::CompressSeria(
+      header, ids, CompressPolicy(CompressType::kLZ4, 4096), &buf));
+
+  RequestHeader r_header;
+  memcpy(&r_header, buf.IOVecs()[0].ptr, sizeof(r_header));
+  EXPECT_EQ(r_header.compress_type, CompressType::kNo);
+
+  std::vector<uint64_t> r_ids;
+  EXPECT_TRUE(Compress::UnCompressDeser(
+      r_header.compress_type, buf.IOVecs(sizeof(r_header)), &r_ids));
+  EXPECT_EQ(r_ids, ids);
+
+  // Compressed.
+  EXPECT_TRUE(Compress::CompressSeria(
+      header, ids, CompressPolicy(CompressType::kLZ4, 128), &buf));
+
+  memcpy(&r_header, buf.IOVecs()[0].ptr, sizeof(r_header));
+  EXPECT_EQ(r_header.compress_type, CompressType::kLZ4);
+
+  // The compress fail, send it uncompressed.
+  EXPECT_TRUE(Compress::CompressSeria(
+      header, ids, CompressPolicy((CompressType)100, 128), &buf));
+
+  memcpy(&r_header, buf.IOVecs()[0].ptr, sizeof(r_header));
+  EXPECT_EQ(r_header.compress_type, CompressType::kNo);
+
+  r_ids.clear();
+  EXPECT_TRUE(Compress::UnCompressDeser(
+      r_header.compress_type, buf.IOVecs(sizeof(r_header)), &r_ids));
+  EXPECT_EQ(r_ids, ids);
+}
+
+}  // namespace test
+}  // namespace kraken
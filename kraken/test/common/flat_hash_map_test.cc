@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+
+#include <unordered_map>
+
+#include "common/flat_hash_map.h"
+#include "common/utils.h"
+
+namespace kraken {
+namespace test {
+
+TEST(FlatHashMap, Test) {
+  {
+    FlatHashMap<uint64_t, int> map;
+
+    EXPECT_EQ(0, map.Size());
+
+    EXPECT_TRUE(map.Insert(1, 1));
+    EXPECT_TRUE(map.Insert(2, 2));
+    EXPECT_TRUE(map.Insert(3, 3));
+    EXPECT_EQ(3, map.Size());
+
+    EXPECT_FALSE(map.Insert(3, 3));
+    EXPECT_EQ(3, map.Size());
+
+    EXPECT_TRUE(map.Contains(1));
+    EXPECT_TRUE(map.Contains(2));
+    EXPECT_TRUE(map.Contains(3));
+    EXPECT_FALSE(map.Contains(4));
+
+    auto it = map.Find(2);
+    EXPECT_TRUE(it.Valid());
+    EXPECT_EQ(2, it.value());
+
+    it.value() = 20;
+    EXPECT_EQ(20, map.Find(2).value());
+
+    EXPECT_FALSE(map.Find(4).Valid());
+
+    EXPECT_TRUE(map.Remove(2));
+    EXPECT_FALSE(map.Remove(2));
+    EXPECT_FALSE(map.Contains(2));
+    EXPECT_EQ(2, map.Size());
+
+    map.Clear();
+    EXPECT_EQ(0, map.Size());
+    EXPECT_FALSE(map.Contains(1));
+  }
+
+  {
+    FlatHashMap<uint64_t, uint64_t> map;
+    std::unordered_map<uint64_t, uint64_t> expect;
+
+    int size = utils::ThreadLocalRandom<int>(1, 100000);
+
+    for (int i = 0; i < size; ++i) {
+      // Same low bits like the sparse id in one slot.
+      uint64_t key = utils::ThreadLocalRandom<uint64_t>(0, 1000000) * 8;
+
+      EXPECT_EQ(expect.emplace(key, i).second, map.Insert(key, i));
+    }
+
+    EXPECT_EQ(expect.size(), map.Size());
+
+    size_t count = 0;
+    for (auto it = map.Begin(); it.Valid(); it.Next()) {
+      EXPECT_EQ(expect[it.key()], it.value());
+      count++;
+    }
+
+    EXPECT_EQ(expect.size(), count);
+
+    size_t removed =
+        map.RemoveIf([](const uint64_t& k, const uint64_t& v) { return v % 2; });
+
+    size_t expect_removed = 0;
+    for (auto it = expect.begin(); it != expect.end();) {
+      if (it->second % 2) {
+        it = expect.erase(it);
+        expect_removed++;
+      } else {
+        ++it;
+      }
+    }
+
+    EXPECT_EQ(expect_removed, removed);
+    EXPECT_EQ(expect.size(), map.Size());
+
+    for (const auto& [k, v] : expect) {
+      auto it = map.Find(k);
+
+      EXPECT_TRUE(it.Valid());
+      EXPECT_EQ(v, it.value());
+    }
+  }
+}
+
+TEST(FlatHashMap, RemoveIfVisitOnce) {
+  for (int round = 0; round < 100; ++round) {
+    FlatHashMap<uint64_t, uint64_t> map;
+
+    // Small maps, the probe chains wrap around the end often.
+    int size = utils::ThreadLocalRandom<int>(1, 64);
+    for (int i = 0; i < size; ++i) {
+      map.Insert(utils::ThreadLocalRandom<uint64_t>(0, 1000000), i);
+    }
+
+    size_t map_size = map.Size();
+
+    std::unordered_map<uint64_t, int> visits;
+    size_t removed =
+        map.RemoveIf([&visits](const uint64_t& k, const uint64_t&) {
+          visits[k]++;
+          return k % 3 == 0;
+        });
+
+    EXPECT_EQ(map_size, visits.size());
+    for (const auto& [k, count] : visits) {
+      EXPECT_EQ(1, count);
+    }
+
+    EXPECT_EQ(map_size - removed, map.Size());
+  }
+}
+
+}  // namespace test
+}  // namespace kraken
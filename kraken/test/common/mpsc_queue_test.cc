@@ -0,0 +1,83 @@
+#include "common/mpsc_queue.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+namespace kraken {
+namespace test {
+
+TEST(MPSCQueue, PushPop) {
+  MPSCQueue<uint64_t> que(5);
+  EXPECT_EQ(que.capacity(), 8);
+
+  uint64_t v;
+  EXPECT_FALSE(que.TryPop(&v));
+
+  for (uint64_t i = 0; i < 8; ++i) {
+    EXPECT_TRUE(que.TryPush(std::move(i)));
+  }
+
+  // Full.
+  uint64_t extra = 8;
+  EXPECT_FALSE(que.TryPush(std::move(extra)));
+
+  for (uint64_t i = 0; i < 8; ++i) {
+    EXPECT_TRUE(que.TryPop(&v));
+    EXPECT_EQ(v, i);
+  }
+
+  EXPECT_FALSE(que.TryPop(&v));
+
+  // Wrap around.
+  for (uint64_t i = 0; i < 100; ++i) {
+    uint64_t u = i;
+    EXPECT_TRUE(que.TryPush(std::move(u)));
+    EXPECT_TRUE(que.TryPop(&v));
+    EXPECT_EQ(v, i);
+  }
+}
+
+TEST(MPSCQueue, MultiProducer) {
+  uint64_t producer_nums = 8;
+  uint64_t count = 10000;
+
+  // Small capacity make the producers wait.
+  MPSCQueue<std::pair<uint64_t, uint64_t>> que(256);
+
+  std::vector<std::thread> producers;
+  for (uint64_t p = 0; p < producer_nums; ++p) {
+    producers.emplace_back([p, count, &que]() {
+      for (uint64_t i = 0; i < count; ++i) {
+        que.Push(std::make_pair(p, i));
+      }
+    });
+  }
+
+  // Every producer's values must be popped in order.
+  std::vector<uint64_t> nexts(producer_nums, 0);
+
+  uint64_t total = 0;
+  while (total < producer_nums * count) {
+    std::pair<uint64_t, uint64_t> v;
+    if (que.TryPop(&v)) {
+      ASSERT_LT(v.first, producer_nums);
+      ASSERT_EQ(v.second, nexts[v.first]);
+
+      nexts[v.first]++;
+      total++;
+    }
+  }
+
+  for (auto& t : producers) {
+    t.join();
+  }
+
+  for (uint64_t p = 0; p < producer_nums; ++p) {
+    EXPECT_EQ(nexts[p], count);
+  }
+}
+
+}  // namespace test
+}  // namespace kraken
@@ -2,10 +2,19 @@
 
 #include <gtest/gtest.h>
 
+#include <cstring>
+#include <memory>
+#include <vector>
+
 #include "common/deserialize.h"
+#include "common/iovec_buffer.h"
+#include "common/iovec_reader.h"
 #include "common/mem_buffer.h"
 #include "common/mem_reader.h"
+#include "common/size_writer.h"
 #include "common/utils.h"
+#include "protocol/pull_sparse_matrix_prot.h"
+#include "protocol/push_dense_table_prot.h"
 #include "test/utils_test.h"
 
 namespace kraken {
@@ -492,5 +501,136 @@ TEST(SerializeDeserializeTest, NotBaseType) {
   }
 }
 
+TEST(SerializeDeserialize, BorrowTensor) {
+  PullSparseMatrixResponse expect;
+  expect.vals = RandomTensor<float>(Shape({64, 16}));
+
+  // Same with the message: [ReplyHeader | body].
+  ReplyHeader header{};
+  auto mem_buf = std::make_shared<MemBuffer>();
+  {
+    Serialize serialize(mem_buf.get());
+    EXPECT_TRUE(serialize << header);
+    EXPECT_TRUE(serialize << expect);
+  }
+
+  const char* body = mem_buf->ptr() + sizeof(header);
+  size_t body_len = mem_buf->offset() - sizeof(header);
+
+  // The matrix data is after the padding and the matrix header.
+  const char* data = body + PullSparseMatrixResponse::kPadding + 26;
+
+  // Alias the buffer and hold it.
+  {
+    PullSparseMatrixResponse val;
+    {
+      MemReader mem_reader(body, body_len, mem_buf);
+      Deserialize deserialize(&mem_reader);
+      EXPECT_TRUE(deserialize >> val);
+    }
+
+    AssertTensorEQ(expect.vals, val.vals);
+    EXPECT_EQ(data, (const char*)val.vals.Ptr());
+    EXPECT_EQ(2, mem_buf.use_count());
+  }
+
+  EXPECT_EQ(1, mem_buf.use_count());
+
+  // Copy if no holder.
+  {
+    PullSparseMatrixResponse val;
+
+    MemReader mem_reader(body, body_len);
+    Deserialize deserialize(&mem_reader);
+    EXPECT_TRUE(deserialize >> val);
+
+    AssertTensorEQ(expect.vals, val.vals);
+    EXPECT_NE(data, (const char*)val.vals.Ptr());
+  }
+
+  // Copy if not aligned.
+  {
+    auto unaligned = std::make_shared<std::vector<char>>(mem_buf->offset() + 1);
+    memcpy(unaligned->data() + 1, mem_buf->ptr(), mem_buf->offset());
+
+    PullSparseMatrixResponse val;
+    {
+      MemReader mem_reader(unaligned->data() + 1 + sizeof(header), body_len,
+                           unaligned);
+      Deserialize deserialize(&mem_reader);
+      EXPECT_TRUE(deserialize >> val);
+    }
+
+    AssertTensorEQ(expect.vals, val.vals);
+    EXPECT_EQ(1, unaligned.use_count());
+  }
+}
+
+TEST(SerializeDeserialize, ScatterGather) {
+  PushDenseTableRequest expect;
+  expect.router_version = 3;
+  expect.table_id = 7;
+  expect.grad = RandomTensor<float>(Shape({128, 64}));
+  expect.lr = 0.1;
+
+  SizeWriter sizer(IOVecBuffer::kMinRefBytes);
+  {
+    Serialize serialize(&sizer);
+    EXPECT_TRUE(serialize << expect);
+  }
+
+  IOVecBuffer buf(sizer.copy_size());
+  {
+    Serialize serialize(&buf);
+    EXPECT_TRUE(serialize << expect);
+  }
+
+  EXPECT_EQ(sizer.size(), buf.size());
+
+  // The grad is referenced, the others are in one inline buffer.
+  auto segments = buf.Segments();
+  EXPECT_EQ(3, segments.size());
+  EXPECT_EQ((const char*)expect.grad.Ptr(), segments[1].ptr);
+  EXPECT_EQ(expect.grad.NumBytes(), segments[1].size);
+  EXPECT_EQ(segments[0].ptr + segments[0].size, segments[2].ptr);
+  EXPECT_EQ(sizer.copy_size(), segments[0].size + segments[2].size);
+
+  // Alias the referenced segment if the holder is set.
+  {
+    PushDenseTableRequest val;
+    IOVecReader reader(buf.IOVecs(), segments[1].holder);
+    Deserialize deserialize(&reader);
+    EXPECT_TRUE(deserialize >> val);
+
+    EXPECT_EQ(expect.router_version, val.router_version);
+    EXPECT_EQ(expect.table_id, val.table_id);
+    EXPECT_EQ(expect.lr, val.lr);
+    AssertTensorEQ(expect.grad, val.grad);
+    EXPECT_EQ(expect.grad.Ptr(), val.grad.Ptr());
+  }
+
+  // A small Tensor is copied, and read across the segments.
+  expect.grad = RandomTensor<float>(Shape({4, 4}));
+
+  MemBuffer mem_buf;
+  {
+    Serialize serialize(&mem_buf);
+    EXPECT_TRUE(serialize << expect);
+  }
+
+  for (size_t i = 0; i <= mem_buf.offset(); ++i) {
+    std::vector<IOVec> iovs = {{mem_buf.ptr(), i},
+                               {mem_buf.ptr() + i, mem_buf.offset() - i}};
+
+    PushDenseTableRequest val;
+    IOVecReader reader(iovs);
+    Deserialize deserialize(&reader);
+    EXPECT_TRUE(deserialize >> val);
+
+    EXPECT_EQ(expect.table_id, val.table_id);
+    AssertTensorEQ(expect.grad, val.grad);
+  }
+}
+
 }  // namespace test
 }  // namespace kraken
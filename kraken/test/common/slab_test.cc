@@ -0,0 +1,61 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <vector>
+
+#include "common/slab.h"
+
+namespace kraken {
+namespace test {
+
+TEST(Slab, Test) {
+  Slab slab(24);
+
+  EXPECT_EQ(24, slab.stride());
+  EXPECT_EQ(0, slab.size());
+  EXPECT_EQ(0, slab.capacity());
+
+  std::vector<char*> rows;
+  for (int i = 0; i < 100000; ++i) {
+    char* row = slab.Allocate();
+    memset(row, i % 128, slab.stride());
+
+    rows.emplace_back(row);
+  }
+
+  EXPECT_EQ(100000, slab.size());
+  EXPECT_TRUE(slab.capacity() >= 100000 * slab.stride());
+
+  // The row's content not be changed by other allocation.
+  for (int i = 0; i < 100000; ++i) {
+    EXPECT_EQ(i % 128, rows[i][slab.stride() - 1]);
+  }
+
+  size_t capacity = slab.capacity();
+
+  // Free half and allocate again, the freed rows will be reused.
+  for (int i = 0; i < 100000; i += 2) {
+    slab.Free(rows[i]);
+  }
+
+  EXPECT_EQ(50000, slab.size());
+
+  for (int i = 0; i < 50000; ++i) {
+    slab.Allocate();
+  }
+
+  EXPECT_EQ(100000, slab.size());
+  EXPECT_EQ(capacity, slab.capacity());
+
+  slab.Clear();
+
+  EXPECT_EQ(0, slab.size());
+  EXPECT_EQ(0, slab.capacity());
+
+  // Stride at least hold a pointer.
+  Slab small(1);
+  EXPECT_EQ(sizeof(char*), small.stride());
+}
+
+}  // namespace test
+}  // namespace kraken
@@ -3,6 +3,7 @@
 #include <gtest/gtest.h>
 
 #include <string>
+#include <vector>
 
 #include "common/utils.h"
 #include "snappy.h"
@@ -30,5 +31,33 @@ TEST(Snappy, CompressUnCompress) {
   EXPECT_EQ(0, memcmp(uc_sink.ptr(), str.data(), str.size()));
 }
 
+TEST(Snappy, CompressSegments) {
+  size_t size = utils::ThreadLocalRandom<size_t>(1, 100000);
+
+  std::string str;
+  for (size_t i = 0; i < size; ++i) {
+    str.push_back(utils::ThreadLocalRandom<char>(-128, 127));
+  }
+
+  // Split to 3 segments, maybe empty.
+  size_t p0 = utils::ThreadLocalRandom<size_t>(0, size);
+  size_t p1 = utils::ThreadLocalRandom<size_t>(p0, size);
+
+  std::vector<IOVec> iovs = {{str.data(), p0},
+                             {str.data() + p0, p1 - p0},
+                             {str.data() + p1, size - p1}};
+
+  SnappySource c_source(iovs);
+  SnappySink c_sink(snappy::MaxCompressedLength(size));
+  EXPECT_TRUE(snappy::Compress(&c_source, &c_sink) > 0);
+
+  SnappySource uc_source(c_sink.ptr(), c_sink.offset());
+  SnappySink uc_sink;
+  EXPECT_TRUE(snappy::Uncompress(&uc_source, &uc_sink));
+
+  EXPECT_EQ(uc_sink.offset(), str.size());
+  EXPECT_EQ(0, memcmp(uc_sink.ptr(), str.data(), str.size()));
+}
+
 }  // namespace test
 }  // namespace kraken
@@ -0,0 +1,57 @@
+#include "common/thread_pool.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+
+namespace kraken {
+namespace test {
+
+TEST(ThreadPool, ParallelFor) {
+  ThreadPool pool(4);
+
+  int64_t n = 1000;
+  std::vector<int64_t> data(n, 0);
+
+  pool.ParallelFor(n, [&data](int64_t i) { data[i] += i; });
+
+  for (int64_t i = 0; i < n; ++i) {
+    EXPECT_EQ(data[i], i);
+  }
+
+  // Call from many threads and nested call in worker.
+  std::atomic_int64_t count(0);
+
+  std::vector<std::thread> threads;
+  for (uint32_t i = 0; i < 8; ++i) {
+    threads.emplace_back(std::thread([&pool, &count]() {
+      pool.ParallelFor(16, [&pool, &count](int64_t) {
+        pool.ParallelFor(8, [&count](int64_t) { count.fetch_add(1); });
+      });
+    }));
+  }
+
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  EXPECT_EQ(8 * 16 * 8, count.load());
+}
+
+TEST(ThreadPool, Enque) {
+  ThreadPool pool(2);
+
+  std::atomic_int64_t count(0);
+  for (uint32_t i = 0; i < 1000; ++i) {
+    pool.Enque([&count]() { count.fetch_add(1); });
+  }
+
+  // Stop will wait all task finish.
+  pool.Stop();
+
+  EXPECT_EQ(1000, count.load());
+}
+
+}  // namespace test
+}  // namespace kraken
@@ -0,0 +1,45 @@
+#include "ps/storage/count_min_sketch.h"
+
+#include <gtest/gtest.h>
+
+#include <cinttypes>
+
+namespace kraken {
+namespace test {
+
+TEST(CountMinSketch, AddEstimate) {
+  CountMinSketch sketch(1024);
+
+  EXPECT_EQ(0u, sketch.Estimate(7));
+
+  for (uint32_t i = 1; i <= 5; ++i) {
+    EXPECT_EQ(i, sketch.Add(7));
+  }
+
+  // Never smaller than the real count.
+  for (uint64_t id = 100; id < 400; ++id) {
+    sketch.Add(id);
+    EXPECT_GE(sketch.Estimate(id), 1u);
+  }
+
+  EXPECT_GE(sketch.Estimate(7), 5u);
+}
+
+TEST(CountMinSketch, Decay) {
+  CountMinSketch sketch(1024);
+
+  for (int i = 0; i < 8; ++i) {
+    sketch.Add(3);
+  }
+
+  sketch.Decay();
+  EXPECT_EQ(4u, sketch.Estimate(3));
+
+  sketch.Decay();
+  sketch.Decay();
+  sketch.Decay();
+  EXPECT_EQ(0u, sketch.Estimate(3));
+}
+
+}  // namespace test
+}  // namespace kraken
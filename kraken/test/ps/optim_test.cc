@@ -0,0 +1,215 @@
+#include <gtest/gtest.h>
+
+#include <cinttypes>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/error_code.h"
+#include "common/utils.h"
+#include "ps/optim/kernel.h"
+#include "ps/optim/optim.h"
+#include "ps/storage/row_layout.h"
+#include "test/utils_test.h"
+
+namespace kraken {
+namespace test {
+
+// Update a batch of rows that have different steps, the result should be same
+// with updating the Values one by one.
+void CheckRowUpdate(
+    OptimType optim_type,
+    const std::unordered_map<std::string, std::string>& optim_conf) {
+  // Not a multiple of the vector width, so the scalar tail also be checked.
+  int64_t dimension = 37;
+  size_t row_count = 6;
+  float lr = 0.01;
+
+  std::unique_ptr<Optim> optim = Optim::Create(optim_type, optim_conf);
+  RowLayout layout(dimension, ElementType::From<float>(), optim->StateTypes());
+
+  std::vector<std::vector<char>> rows(row_count);
+  std::vector<Value> values(row_count);
+
+  for (size_t i = 0; i < row_count; ++i) {
+    rows[i].resize(layout.stride());
+    layout.ZeroStates(rows[i].data());
+
+    values[i].val = RandomTensor<float>(Shape({dimension})) * 0.001;
+    memcpy(layout.Val(rows[i].data()), values[i].val.Ptr(),
+           layout.vec_bytes());
+  }
+
+  for (size_t step = 0; step < row_count; ++step) {
+    // Row i is updated from step i, so the rows in a batch have different
+    // steps.
+    std::vector<char*> batch_rows;
+    std::vector<Tensor> grads;
+
+    for (size_t i = 0; i <= step; ++i) {
+      Tensor grad = RandomTensor<float>(Shape({dimension})) * 0.001;
+
+      EXPECT_EQ(ErrorCode::kSuccess,
+                optim->Update(grad.Clone(), lr, &values[i]));
+
+      batch_rows.emplace_back(rows[i].data());
+      grads.emplace_back(grad);
+    }
+
+    std::vector<const Tensor*> grad_ptrs;
+    for (auto& grad : grads) {
+      grad_ptrs.emplace_back(&grad);
+    }
+
+    EXPECT_EQ(ErrorCode::kSuccess,
+              optim->UpdateBatch(layout, batch_rows, grad_ptrs, lr));
+  }
+
+  for (size_t i = 0; i < row_count; ++i) {
+    EXPECT_EQ((int64_t)(row_count - i),
+              layout.Steps((const char*)rows[i].data()));
+
+    std::vector<float> expect = TensorToVector<float>(values[i].val);
+    std::vector<float> real =
+        TensorToVector<float>(layout.CopyVal(rows[i].data()));
+
+    AssertVectorF32(expect, real);
+  }
+}
+
+TEST(Optim, SGDRowUpdate) {
+  CheckRowUpdate(OptimType::kSGD, {});
+  CheckRowUpdate(OptimType::kSGD, {{"momentum", "0.9"},
+                                   {"dampening", "0.1"},
+                                   {"weight_decay", "0.01"}});
+  CheckRowUpdate(OptimType::kSGD, {{"momentum", "0.9"}, {"nesterov", "true"}});
+}
+
+TEST(Optim, AdagradRowUpdate) {
+  CheckRowUpdate(OptimType::kAdagrad, {});
+  CheckRowUpdate(OptimType::kAdagrad, {{"weight_decay", "0.01"}});
+}
+
+TEST(Optim, RMSpropRowUpdate) {
+  CheckRowUpdate(OptimType::kRMSprop, {});
+  CheckRowUpdate(OptimType::kRMSprop, {{"momentum", "0.9"},
+                                       {"centered", "true"},
+                                       {"weight_decay", "0.01"}});
+}
+
+TEST(Optim, AdamRowUpdate) {
+  CheckRowUpdate(OptimType::kAdam, {});
+  CheckRowUpdate(OptimType::kAdam,
+                 {{"amsgrad", "true"}, {"weight_decay", "0.01"}});
+}
+
+// Update the same rows by every simd the cpu support, the result should be
+// close to the scalar one (AVX-512 may fuse the multiply-add).
+void CheckSimd(
+    OptimType optim_type,
+    const std::unordered_map<std::string, std::string>& optim_conf) {
+  int64_t dimension = 37;
+  size_t row_count = 4;
+  float lr = 0.01;
+
+  std::unique_ptr<Optim> optim = Optim::Create(optim_type, optim_conf);
+  RowLayout layout(dimension, ElementType::From<float>(), optim->StateTypes());
+
+  std::vector<Tensor> vals;
+  std::vector<std::vector<Tensor>> grads(3);
+  for (size_t i = 0; i < row_count; ++i) {
+    vals.emplace_back(RandomTensor<float>(Shape({dimension})) * 0.001);
+
+    for (auto& step_grads : grads) {
+      step_grads.emplace_back(RandomTensor<float>(Shape({dimension})) * 0.001);
+    }
+  }
+
+  auto run = [&](kernel::Simd simd) {
+    kernel::SetSimd(simd);
+    EXPECT_EQ(simd, kernel::CurrentSimd());
+
+    std::vector<std::vector<char>> rows(row_count);
+    std::vector<char*> row_ptrs;
+    for (size_t i = 0; i < row_count; ++i) {
+      rows[i].resize(layout.stride());
+      layout.ZeroStates(rows[i].data());
+      memcpy(layout.Val(rows[i].data()), vals[i].Ptr(), layout.vec_bytes());
+
+      row_ptrs.emplace_back(rows[i].data());
+    }
+
+    for (auto& step_grads : grads) {
+      std::vector<const Tensor*> grad_ptrs;
+      for (auto& grad : step_grads) {
+        grad_ptrs.emplace_back(&grad);
+      }
+
+      EXPECT_EQ(ErrorCode::kSuccess,
+                optim->UpdateBatch(layout, row_ptrs, grad_ptrs, lr));
+    }
+
+    std::vector<std::vector<float>> results;
+    for (size_t i = 0; i < row_count; ++i) {
+      results.emplace_back(
+          TensorToVector<float>(layout.CopyVal(rows[i].data())));
+    }
+
+    return results;
+  };
+
+  kernel::Simd supported = kernel::SupportedSimd();
+
+  std::vector<std::vector<float>> expect = run(kernel::Simd::kScalar);
+
+  for (auto simd : {kernel::Simd::kAvx2, kernel::Simd::kAvx512}) {
+    if (simd > supported) {
+      continue;
+    }
+
+    std::vector<std::vector<float>> real = run(simd);
+
+    for (size_t i = 0; i < row_count; ++i) {
+      for (int64_t j = 0; j < dimension; ++j) {
+        EXPECT_NEAR(expect[i][j], real[i][j], 1e-6);
+      }
+    }
+  }
+
+  kernel::SetSimd(supported);
+}
+
+TEST(Optim, Simd) {
+  // A wider simd than the cpu support is not used.
+  kernel::SetSimd(kernel::Simd::kAvx512);
+  EXPECT_EQ(kernel::SupportedSimd(), kernel::CurrentSimd());
+
+  CheckSimd(OptimType::kSGD, {{"momentum", "0.9"},
+                              {"dampening", "0.1"},
+                              {"weight_decay", "0.01"}});
+  CheckSimd(OptimType::kSGD, {{"momentum", "0.9"}, {"nesterov", "true"}});
+  CheckSimd(OptimType::kAdagrad, {{"weight_decay", "0.01"}});
+  CheckSimd(OptimType::kRMSprop, {{"momentum", "0.9"},
+                                  {"centered", "true"},
+                                  {"weight_decay", "0.01"}});
+  CheckSimd(OptimType::kAdam, {{"amsgrad", "true"}, {"weight_decay", "0.01"}});
+}
+
+TEST(Optim, RowUpdateGradientUnCompatible) {
+  std::unique_ptr<Optim> optim = Optim::Create(OptimType::kAdam, {});
+  RowLayout layout(8, ElementType::From<float>(), optim->StateTypes());
+
+  std::vector<char> row(layout.stride());
+  layout.ZeroStates(row.data());
+
+  Tensor grad = RandomTensor<float>(Shape({4}));
+
+  EXPECT_EQ(ErrorCode::kGradientUnCompatibleError,
+            optim->Update(layout, row.data(), grad, 0.01));
+  EXPECT_EQ(0, layout.Steps((const char*)row.data()));
+}
+
+}  // namespace test
+}  // namespace kraken
@@ -0,0 +1,104 @@
+#include "ps/storage/quantize.h"
+
+#include <gtest/gtest.h>
+
+#include <cinttypes>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace kraken {
+namespace test {
+
+std::vector<float> QuantizeInput() {
+  // Not a multiple of 8, so the scalar tail also be checked.
+  std::vector<float> x;
+  for (int i = 0; i < 37; ++i) {
+    x.emplace_back(std::sin((float)i) * (i + 1) * 0.1);
+  }
+
+  return x;
+}
+
+TEST(Quantize, Half) {
+  std::vector<float> x = QuantizeInput();
+  x.emplace_back(0);
+  x.emplace_back(65504);
+  x.emplace_back(1e-6);
+
+  std::vector<half> h(x.size());
+  std::vector<float> y(x.size());
+
+  quantize::FloatToHalf(x.data(), x.size(), h.data());
+  quantize::HalfToFloat(h.data(), h.size(), y.data());
+
+  for (size_t i = 0; i < x.size(); ++i) {
+    // 10 bits mantissa, and the subnormal keep 2^-24.
+    EXPECT_NEAR(x[i], y[i], std::abs(x[i]) / 1024 + 6e-8);
+  }
+
+  // Overflow to inf.
+  float big = 1e6;
+  half hb;
+  quantize::FloatToHalf(&big, 1, &hb);
+  quantize::HalfToFloat(&hb, 1, &big);
+  EXPECT_EQ(std::numeric_limits<float>::infinity(), big);
+}
+
+TEST(Quantize, BFloat16) {
+  std::vector<float> x = QuantizeInput();
+
+  std::vector<bfloat16> b(x.size());
+  std::vector<float> y(x.size());
+
+  quantize::FloatToBFloat16(x.data(), x.size(), b.data());
+  quantize::BFloat16ToFloat(b.data(), b.size(), y.data());
+
+  for (size_t i = 0; i < x.size(); ++i) {
+    EXPECT_NEAR(x[i], y[i], std::abs(x[i]) / 128);
+  }
+
+  // 1 + 2^-8 is the middle of 1 and 1 + 2^-7, round to the even 1.
+  float mid = 1.00390625;
+  bfloat16 bm;
+  quantize::FloatToBFloat16(&mid, 1, &bm);
+  EXPECT_EQ(0x3F80, bm.value);
+}
+
+TEST(Quantize, Int8) {
+  std::vector<float> x = QuantizeInput();
+
+  float min = x[0];
+  float max = x[0];
+  for (auto v : x) {
+    min = std::min(min, v);
+    max = std::max(max, v);
+  }
+
+  std::vector<int8_t> q(x.size());
+  std::vector<float> y(x.size());
+  float scale;
+  float bias;
+
+  quantize::FloatToInt8(x.data(), x.size(), q.data(), &scale, &bias);
+  quantize::Int8ToFloat(q.data(), q.size(), scale, bias, y.data());
+
+  EXPECT_FLOAT_EQ(min, bias);
+  EXPECT_FLOAT_EQ((max - min) / 255, scale);
+
+  for (size_t i = 0; i < x.size(); ++i) {
+    EXPECT_NEAR(x[i], y[i], scale / 2 + 1e-6);
+  }
+
+  // A constant vector is exact.
+  std::vector<float> c(9, 0.5);
+  quantize::FloatToInt8(c.data(), c.size(), q.data(), &scale, &bias);
+  quantize::Int8ToFloat(q.data(), c.size(), scale, bias, y.data());
+
+  for (size_t i = 0; i < c.size(); ++i) {
+    EXPECT_FLOAT_EQ(0.5, y[i]);
+  }
+}
+
+}  // namespace test
+}  // namespace kraken
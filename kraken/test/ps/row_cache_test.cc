@@ -0,0 +1,111 @@
+#include "ps/storage/row_cache.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cinttypes>
+#include <thread>
+#include <vector>
+
+namespace kraken {
+namespace test {
+
+TEST(RowCache, PutGet) {
+  // 3 floats, not a multiple of uint64_t.
+  RowCache cache(64, sizeof(float) * 3);
+
+  float val[3] = {1, 2, 3};
+  float out[3] = {0, 0, 0};
+
+  EXPECT_FALSE(cache.Get(10, (char*)out));
+
+  cache.Put(10, (const char*)val);
+  EXPECT_TRUE(cache.Get(10, (char*)out));
+  EXPECT_EQ(1, out[0]);
+  EXPECT_EQ(2, out[1]);
+  EXPECT_EQ(3, out[2]);
+
+  val[1] = 5;
+  cache.Update(10, (const char*)val);
+  EXPECT_TRUE(cache.Get(10, (char*)out));
+  EXPECT_EQ(5, out[1]);
+
+  // Update not cache a new id.
+  cache.Update(11, (const char*)val);
+  EXPECT_FALSE(cache.Get(11, (char*)out));
+
+  cache.Remove(10);
+  EXPECT_FALSE(cache.Get(10, (char*)out));
+
+  cache.Put(12, (const char*)val);
+  cache.Put(13, (const char*)val);
+  cache.RemoveIf([](uint64_t sparse_id) { return sparse_id == 12; });
+  EXPECT_FALSE(cache.Get(12, (char*)out));
+  EXPECT_TRUE(cache.Get(13, (char*)out));
+
+  cache.Clear();
+  EXPECT_FALSE(cache.Get(13, (char*)out));
+}
+
+TEST(RowCache, Clock) {
+  RowCache cache(4, sizeof(uint64_t));
+
+  uint64_t hot = 0;
+  uint64_t out = 0;
+
+  cache.Put(hot, (const char*)&hot);
+  for (size_t i = 0; i < 8; ++i) {
+    EXPECT_TRUE(cache.Get(hot, (char*)&out));
+  }
+
+  // The one-time ids should not evict the hot one.
+  for (uint64_t i = 1; i < 8; ++i) {
+    cache.Put(i, (const char*)&i);
+    EXPECT_TRUE(cache.Get(hot, (char*)&out));
+    EXPECT_EQ(hot, out);
+  }
+}
+
+TEST(RowCache, Concurrent) {
+  RowCache cache(16, sizeof(uint64_t) * 4);
+
+  std::atomic_bool stop(false);
+
+  // The writer always write 4 same words, the reader should never see a torn
+  // val.
+  std::thread writer([&]() {
+    for (uint64_t v = 0; v < 100000; ++v) {
+      uint64_t val[4] = {v, v, v, v};
+      cache.Put(v % 32, (const char*)val);
+      cache.Update(v % 32, (const char*)val);
+    }
+
+    stop.store(true);
+  });
+
+  std::vector<std::thread> readers;
+  for (size_t t = 0; t < 4; ++t) {
+    readers.emplace_back([&]() {
+      uint64_t val[4];
+
+      while (stop.load() == false) {
+        for (uint64_t id = 0; id < 32; ++id) {
+          if (cache.Get(id, (char*)val)) {
+            EXPECT_EQ(val[0], val[1]);
+            EXPECT_EQ(val[0], val[2]);
+            EXPECT_EQ(val[0], val[3]);
+            EXPECT_EQ(id, val[0] % 32);
+          }
+        }
+      }
+    });
+  }
+
+  writer.join();
+  for (auto& t : readers) {
+    t.join();
+  }
+}
+
+}  // namespace test
+}  // namespace kraken
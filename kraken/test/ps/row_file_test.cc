@@ -0,0 +1,145 @@
+#include "ps/storage/row_file.h"
+
+#include <gtest/gtest.h>
+
+#include <cinttypes>
+#include <cstring>
+#include <filesystem>
+#include <vector>
+
+#include "test/utils_test.h"
+
+namespace kraken {
+namespace test {
+
+std::vector<char> MakeRow(size_t stride, uint64_t sparse_id, int version) {
+  std::vector<char> row(stride);
+  for (size_t i = 0; i < stride; ++i) {
+    row[i] = (char)(sparse_id * 31 + i + version);
+  }
+
+  return row;
+}
+
+TEST(RowFile, PutFindRemove) {
+  size_t stride = 40;
+  std::string path = TempPath("row_file_put");
+
+  {
+    RowFile file(path, stride);
+    EXPECT_TRUE(std::filesystem::exists(path));
+
+    EXPECT_EQ(nullptr, file.Find(1));
+
+    // Grow the file many times.
+    uint64_t count = 50000;
+    for (uint64_t id = 0; id < count; ++id) {
+      EXPECT_TRUE(file.Put(id, MakeRow(stride, id, 0).data()));
+    }
+
+    EXPECT_EQ(count, file.Size());
+    EXPECT_EQ(0u, file.DeadCount());
+
+    // Put again, the old record is dead.
+    EXPECT_TRUE(file.Put(7, MakeRow(stride, 7, 1).data()));
+    EXPECT_EQ(count, file.Size());
+    EXPECT_EQ(1u, file.DeadCount());
+
+    for (uint64_t id = 0; id < count; ++id) {
+      std::vector<char> expect = MakeRow(stride, id, id == 7 ? 1 : 0);
+      EXPECT_EQ(0, memcmp(expect.data(), file.Find(id), stride));
+    }
+
+    EXPECT_TRUE(file.Remove(8));
+    EXPECT_FALSE(file.Remove(8));
+    EXPECT_EQ(nullptr, file.Find(8));
+    EXPECT_EQ(count - 1, file.Size());
+
+    size_t iterated = 0;
+    EXPECT_TRUE(file.ForEach([&](uint64_t, const char*) {
+      iterated++;
+      return true;
+    }));
+    EXPECT_EQ(count - 1, iterated);
+
+    file.Clear();
+    EXPECT_EQ(0u, file.Size());
+    EXPECT_EQ(nullptr, file.Find(1));
+
+    EXPECT_TRUE(file.Put(1, MakeRow(stride, 1, 2).data()));
+    EXPECT_EQ(0, memcmp(MakeRow(stride, 1, 2).data(), file.Find(1), stride));
+  }
+
+  // Deleted when destroyed.
+  EXPECT_FALSE(std::filesystem::exists(path));
+}
+
+TEST(RowFile, Compact) {
+  size_t stride = 24;
+  std::string path = TempPath("row_file_compact");
+
+  RowFile file(path, stride);
+
+  for (uint64_t id = 0; id < 1000; ++id) {
+    file.Put(id, MakeRow(stride, id, 0).data());
+  }
+
+  for (uint64_t id = 0; id < 1000; id += 2) {
+    file.Remove(id);
+  }
+
+  EXPECT_EQ(500u, file.Size());
+  EXPECT_EQ(500u, file.DeadCount());
+
+  uint64_t version = file.version();
+
+  std::unique_ptr<RowFile> compacted = file.Compact(path + ".compact");
+  EXPECT_TRUE(compacted != nullptr);
+  EXPECT_EQ(version, file.version());
+
+  EXPECT_TRUE(file.Replace(compacted.get()));
+  EXPECT_FALSE(std::filesystem::exists(path + ".compact"));
+  EXPECT_TRUE(std::filesystem::exists(path));
+
+  EXPECT_EQ(500u, file.Size());
+  EXPECT_EQ(0u, file.DeadCount());
+
+  for (uint64_t id = 0; id < 1000; ++id) {
+    if (id % 2 == 0) {
+      EXPECT_EQ(nullptr, file.Find(id));
+    } else {
+      EXPECT_EQ(0, memcmp(MakeRow(stride, id, 0).data(), file.Find(id),
+                          stride));
+    }
+  }
+
+  // Still can append.
+  EXPECT_TRUE(file.Put(2000, MakeRow(stride, 2000, 0).data()));
+  EXPECT_EQ(501u, file.Size());
+
+  // The compacted file is still locked.
+  EXPECT_ANY_THROW(RowFile(path, stride));
+}
+
+TEST(RowFile, InUse) {
+  size_t stride = 16;
+  std::string path = TempPath("row_file_in_use");
+
+  {
+    RowFile file(path, stride);
+    EXPECT_TRUE(file.Put(1, MakeRow(stride, 1, 0).data()));
+
+    // Open the used file fail and not truncate it.
+    EXPECT_ANY_THROW(RowFile(path, stride));
+    EXPECT_TRUE(std::filesystem::exists(path));
+
+    EXPECT_EQ(0, memcmp(MakeRow(stride, 1, 0).data(), file.Find(1), stride));
+  }
+
+  // Released when destroyed.
+  RowFile file(path, stride);
+  EXPECT_EQ(0u, file.Size());
+}
+
+}  // namespace test
+}  // namespace kraken
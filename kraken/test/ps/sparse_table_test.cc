@@ -0,0 +1,891 @@
+#include "ps/sparse_table.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "common/deserialize.h"
+#include "common/error_code.h"
+#include "common/mem_buffer.h"
+#include "common/mem_reader.h"
+#include "ps/initializer/initializer.h"
+#include "ps/optim/optim.h"
+#include "ps/optim/sgd.h"
+#include "ps/storage/row_cache.h"
+#include "test/utils_test.h"
+
+namespace kraken {
+namespace test {
+
+// A reference table and a configured one (the reference's conf with
+// extra_conf), same ops run on both, the configured one should get the same
+// result.
+class TablePair {
+public:
+  Optim* optim;
+
+  SparseTable ref;
+  SparseTable table;
+
+  TablePair(int64_t dimension, InitializerType init_type,
+            const std::unordered_map<std::string, std::string>& conf,
+            const std::unordered_map<std::string, std::string>& extra_conf,
+            Optim* optim)
+      : optim(optim),
+        ref(0, "reference", dimension, ElementType::From<float>(),
+            Initializer::Create(init_type, {}), conf, optim),
+        table(0, "configured", dimension, ElementType::From<float>(),
+              Initializer::Create(init_type, {}), Merge(conf, extra_conf),
+              optim) {
+  }
+
+  static std::unordered_map<std::string, std::string> Merge(
+      std::unordered_map<std::string, std::string> conf,
+      const std::unordered_map<std::string, std::string>& extra_conf) {
+    for (const auto& [k, v] : extra_conf) {
+      conf[k] = v;
+    }
+
+    return conf;
+  }
+
+  // Pull both tables and compare.
+  void Pull(const std::vector<uint64_t>& sparse_ids) {
+    std::vector<Tensor> ref_vals;
+    std::vector<Tensor> vals;
+
+    EXPECT_EQ(ErrorCode::kSuccess, ref.Pull(sparse_ids, &ref_vals));
+    EXPECT_EQ(ErrorCode::kSuccess, table.Pull(sparse_ids, &vals));
+
+    for (size_t i = 0; i < sparse_ids.size(); ++i) {
+      AssertTensorEQ(ref_vals[i], vals[i]);
+    }
+  }
+
+  // Push the same random grads to both tables.
+  void Push(const std::vector<uint64_t>& sparse_ids, float lr) {
+    std::vector<Tensor> grads;
+    for (size_t i = 0; i < sparse_ids.size(); ++i) {
+      grads.emplace_back(RandomTensor<float>(Shape({ref.dimension()})));
+    }
+
+    EXPECT_EQ(ErrorCode::kSuccess, ref.Push(optim, sparse_ids, grads, lr));
+    EXPECT_EQ(ErrorCode::kSuccess, table.Push(optim, sparse_ids, grads, lr));
+  }
+};
+
+// Every test run on both storage backends.
+class SparseTableTest : public ::testing::TestWithParam<std::string> {
+protected:
+  // Add the tested storage_type to the table conf.
+  std::unordered_map<std::string, std::string> Conf(
+      std::unordered_map<std::string, std::string> conf) const {
+    conf["storage_type"] = GetParam();
+
+    return conf;
+  }
+};
+
+TEST_P(SparseTableTest, MergePush) {
+  int64_t dimension = 8;
+  float lr = 0.5;
+
+  std::unique_ptr<Optim> optim = Optim::Create(OptimType::kSGD, {});
+
+  SparseTable table(0, "merge", dimension, ElementType::From<float>(),
+                    Initializer::Create(InitializerType::kConstant, {}),
+                    Conf({{"slot_count", "4"}, {"merge_push", "true"}}),
+                    optim.get());
+
+  std::vector<uint64_t> sparse_ids;
+  for (uint64_t i = 0; i < 64; ++i) {
+    sparse_ids.emplace_back(i);
+  }
+
+  std::vector<Tensor> vals;
+  EXPECT_EQ(ErrorCode::kSuccess, table.Pull(sparse_ids, &vals));
+
+  // Every thread push the same ids many times, SGD without momentum is linear
+  // so the merged result is same with apply them one by one.
+  size_t thread_count = 8;
+  size_t push_count = 100;
+
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < thread_count; ++t) {
+    threads.emplace_back([&]() {
+      std::vector<Tensor> grads;
+      for (size_t i = 0; i < sparse_ids.size(); ++i) {
+        grads.emplace_back(
+            Tensor::Dense({dimension}, ElementType::From<float>()).Constant(1));
+      }
+
+      for (size_t i = 0; i < push_count; ++i) {
+        EXPECT_EQ(ErrorCode::kSuccess,
+                  table.Push(optim.get(), sparse_ids, grads, lr));
+      }
+    });
+  }
+
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  EXPECT_EQ(ErrorCode::kSuccess, table.Pull(sparse_ids, &vals));
+
+  for (size_t i = 0; i < sparse_ids.size(); ++i) {
+    std::vector<float> real = TensorToVector<float>(vals[i]);
+
+    for (auto v : real) {
+      EXPECT_FLOAT_EQ(-lr * thread_count * push_count, v);
+    }
+  }
+
+  // A push with not exist id should fail.
+  std::vector<uint64_t> not_exist_ids = {1000};
+  std::vector<Tensor> grads = {
+      Tensor::Dense({dimension}, ElementType::From<float>()).Constant(1)};
+
+  EXPECT_EQ(ErrorCode::kSparseIdNotExistError,
+            table.Push(optim.get(), not_exist_ids, grads, lr));
+}
+
+TEST_P(SparseTableTest, RepeatedIds) {
+  int64_t dimension = 8;
+  float lr = 0.1;
+
+  std::unique_ptr<Optim> optim = Optim::Create(OptimType::kAdam, {});
+
+  // Push the repeated ids should be same with push the summed grad once, Adam
+  // is not linear and count the steps.
+  for (auto merge_push : {"false", "true"}) {
+    SparseTable repeat(0, "repeat", dimension, ElementType::From<float>(),
+                       Initializer::Create(InitializerType::kConstant, {}),
+                       Conf({{"slot_count", "4"}, {"merge_push", merge_push}}),
+                       optim.get());
+
+    SparseTable once(1, "once", dimension, ElementType::From<float>(),
+                     Initializer::Create(InitializerType::kConstant, {}),
+                     Conf({{"slot_count", "4"}}), optim.get());
+
+    std::vector<uint64_t> repeat_ids = {1, 2, 1, 1};
+    std::vector<uint64_t> once_ids = {1, 2};
+
+    std::vector<Tensor> vals;
+    EXPECT_EQ(ErrorCode::kSuccess, repeat.Pull(once_ids, &vals));
+    EXPECT_EQ(ErrorCode::kSuccess, once.Pull(once_ids, &vals));
+
+    for (size_t i = 0; i < 3; ++i) {
+      std::vector<Tensor> repeat_grads = {
+          VectorToTensor<float>({1, 2, 3, 4, 5, 6, 7, 8}),
+          VectorToTensor<float>({1, 1, 1, 1, 1, 1, 1, 1}),
+          VectorToTensor<float>({-2, 0, 2, 0, -2, 0, 2, 0}),
+          VectorToTensor<float>({0.5, 0.5, 0.5, 0.5, 0.5, 0.5, 0.5, 0.5})};
+
+      std::vector<Tensor> once_grads = {
+          VectorToTensor<float>({-0.5, 2.5, 5.5, 4.5, 3.5, 6.5, 9.5, 8.5}),
+          VectorToTensor<float>({1, 1, 1, 1, 1, 1, 1, 1})};
+
+      EXPECT_EQ(ErrorCode::kSuccess,
+                repeat.Push(optim.get(), repeat_ids, repeat_grads, lr));
+      EXPECT_EQ(ErrorCode::kSuccess,
+                once.Push(optim.get(), once_ids, once_grads, lr));
+    }
+
+    std::vector<Tensor> repeat_vals;
+    std::vector<Tensor> once_vals;
+    EXPECT_EQ(ErrorCode::kSuccess, repeat.Pull(once_ids, &repeat_vals));
+    EXPECT_EQ(ErrorCode::kSuccess, once.Pull(once_ids, &once_vals));
+
+    for (size_t i = 0; i < once_ids.size(); ++i) {
+      AssertVectorF32(TensorToVector<float>(once_vals[i]),
+                      TensorToVector<float>(repeat_vals[i]));
+    }
+  }
+}
+
+TEST_P(SparseTableTest, RowCache) {
+  float lr = 0.1;
+
+  std::unique_ptr<Optim> optim = Optim::Create(OptimType::kAdam, {});
+
+  TablePair pair(9, InitializerType::kConstant, Conf({{"slot_count", "4"}}),
+                 {{"cache_size", "16"}}, optim.get());
+
+  RowCache* cache = pair.table.mutable_vals()->cache();
+  EXPECT_TRUE(cache != nullptr);
+
+  std::vector<uint64_t> sparse_ids;
+  for (uint64_t i = 0; i < 64; ++i) {
+    sparse_ids.emplace_back(i);
+  }
+
+  for (size_t step = 0; step < 10; ++step) {
+    pair.Pull(sparse_ids);
+    pair.Push(sparse_ids, lr);
+  }
+
+  EXPECT_GT(cache->hit_count(), 0u);
+
+  // The removed rows should not be served from the cache.
+  SparseStorage* storage = pair.table.mutable_vals();
+  for (size_t slot = 0; slot < storage->slot_count(); ++slot) {
+    auto h = storage->UniqueSlotHandler(slot);
+    storage->RemoveIf(slot, [](uint64_t, const char*) { return true; });
+  }
+
+  std::vector<Tensor> cached_vals;
+  EXPECT_EQ(ErrorCode::kSuccess, pair.table.Pull(sparse_ids, &cached_vals));
+
+  for (size_t i = 0; i < sparse_ids.size(); ++i) {
+    for (auto v : TensorToVector<float>(cached_vals[i])) {
+      EXPECT_EQ(0, v);
+    }
+  }
+}
+
+TEST_P(SparseTableTest, PullToBuffer) {
+  int64_t dimension = 7;
+
+  std::unique_ptr<Optim> optim = Optim::Create(OptimType::kAdagrad, {});
+
+  for (auto cache_size : {"0", "16"}) {
+    SparseTable table(0, "buffer", dimension, ElementType::From<float>(),
+                      Initializer::Create(InitializerType::kNormal, {}),
+                      Conf({{"slot_count", "4"}, {"cache_size", cache_size}}),
+                      optim.get());
+
+    // Half of the ids exist before pull.
+    std::vector<uint64_t> exist_ids;
+    std::vector<uint64_t> sparse_ids;
+    for (uint64_t i = 0; i < 64; ++i) {
+      if (i % 2 == 0) {
+        exist_ids.emplace_back(i);
+      }
+
+      sparse_ids.emplace_back(i);
+    }
+
+    std::vector<Tensor> exist_vals;
+    EXPECT_EQ(ErrorCode::kSuccess, table.Pull(exist_ids, &exist_vals));
+
+    MemBuffer buf;
+    EXPECT_EQ(ErrorCode::kSuccess, table.Pull(sparse_ids, &buf));
+
+    std::vector<Tensor> buf_vals;
+    {
+      MemReader reader(buf.ptr(), buf.offset());
+      Deserialize deserialize(&reader);
+
+      EXPECT_TRUE(deserialize >> buf_vals);
+    }
+
+    std::vector<Tensor> vals;
+    EXPECT_EQ(ErrorCode::kSuccess, table.Pull(sparse_ids, &vals));
+
+    EXPECT_EQ(sparse_ids.size(), buf_vals.size());
+    for (size_t i = 0; i < sparse_ids.size(); ++i) {
+      AssertTensorEQ(vals[i], buf_vals[i]);
+    }
+
+    for (size_t i = 0; i < exist_ids.size(); ++i) {
+      AssertTensorEQ(exist_vals[i], buf_vals[exist_ids[i]]);
+    }
+
+    // Pull to a matrix.
+    Tensor matrix;
+    EXPECT_EQ(ErrorCode::kSuccess, table.Pull(sparse_ids, &matrix));
+
+    EXPECT_EQ(Shape({(int64_t)sparse_ids.size(), dimension}), matrix.shape());
+    for (size_t i = 0; i < sparse_ids.size(); ++i) {
+      AssertTensorEQ(vals[i], matrix.Vector(i));
+    }
+
+    MemBuffer matrix_buf;
+    EXPECT_EQ(ErrorCode::kSuccess, table.PullMatrix(sparse_ids, &matrix_buf));
+
+    Tensor buf_matrix;
+    {
+      MemReader reader(matrix_buf.ptr(), matrix_buf.offset());
+      Deserialize deserialize(&reader);
+
+      EXPECT_TRUE(deserialize >> buf_matrix);
+    }
+
+    AssertTensorEQ(matrix, buf_matrix);
+  }
+}
+
+size_t RowCount(SparseTable& table) {
+  size_t count = 0;
+
+  for (size_t slot = 0; slot < table.mutable_vals()->slot_count(); ++slot) {
+    auto h = table.mutable_vals()->SharedSlotHandler(slot);
+    count += table.mutable_vals()->Size(slot);
+  }
+
+  return count;
+}
+
+void PushOnes(SparseTable& table, Optim* optim,
+              const std::vector<uint64_t>& sparse_ids) {
+  std::vector<Tensor> grads;
+  for (size_t i = 0; i < sparse_ids.size(); ++i) {
+    grads.emplace_back(
+        Tensor::Dense({table.dimension()}, ElementType::From<float>())
+            .Constant(1));
+  }
+
+  EXPECT_EQ(ErrorCode::kSuccess, table.Push(optim, sparse_ids, grads, 0.1));
+}
+
+// A SGD that throw in UpdateBatch if throw_ is set.
+class ThrowSGD : public SGD {
+public:
+  bool throw_ = false;
+
+  ThrowSGD() : SGD(false, 0, false, 0, false, 0, false) {
+  }
+
+  int32_t UpdateBatch(const RowLayout& layout, const std::vector<char*>& rows,
+                      const std::vector<const Tensor*>& grads,
+                      float lr) const override {
+    if (throw_) {
+      throw std::runtime_error("update error");
+    }
+
+    return SGD::UpdateBatch(layout, rows, grads, lr);
+  }
+};
+
+TEST_P(SparseTableTest, MergePushThrow) {
+  int64_t dimension = 4;
+
+  ThrowSGD optim;
+
+  SparseTable table(0, "merge", dimension, ElementType::From<float>(),
+                    Initializer::Create(InitializerType::kConstant, {}),
+                    Conf({{"slot_count", "4"}, {"merge_push", "true"}}),
+                    &optim);
+
+  std::vector<uint64_t> sparse_ids = {0, 1, 2, 3};
+
+  std::vector<Tensor> vals;
+  EXPECT_EQ(ErrorCode::kSuccess, table.Pull(sparse_ids, &vals));
+
+  optim.throw_ = true;
+  EXPECT_ANY_THROW(PushOnes(table, &optim, sparse_ids));
+
+  // The slots are not left merging, the next Push not hang.
+  optim.throw_ = false;
+  PushOnes(table, &optim, sparse_ids);
+
+  EXPECT_EQ(ErrorCode::kSuccess, table.Pull(sparse_ids, &vals));
+  for (auto v : TensorToVector<float>(vals[0])) {
+    EXPECT_FLOAT_EQ(-0.1, v);
+  }
+}
+
+TEST_P(SparseTableTest, Evict) {
+  int64_t dimension = 4;
+
+  std::unique_ptr<Optim> optim = Optim::Create(OptimType::kSGD, {});
+
+  std::vector<uint64_t> sparse_ids;
+  std::vector<uint64_t> hot_ids;
+  for (uint64_t i = 0; i < 64; ++i) {
+    sparse_ids.emplace_back(i);
+
+    if (i < 16) {
+      hot_ids.emplace_back(i);
+    }
+  }
+
+  std::vector<Tensor> vals;
+
+  // TTL: the rows not pushed in 2 steps are removed.
+  {
+    SparseTable table(0, "ttl", dimension, ElementType::From<float>(),
+                      Initializer::Create(InitializerType::kConstant, {}),
+                      Conf({{"slot_count", "4"},
+                            {"ttl_steps", "2"},
+                            {"evict_interval_ms", "0"}}),
+                      optim.get());
+
+    EXPECT_EQ(ErrorCode::kSuccess, table.Pull(sparse_ids, &vals));
+
+    for (int i = 0; i < 3; ++i) {
+      PushOnes(table, optim.get(), hot_ids);
+    }
+
+    EXPECT_EQ(3, table.step());
+    EXPECT_EQ(48u, table.Evict());
+    EXPECT_EQ(16u, RowCount(table));
+
+    // The evicted rows are skipped by Push.
+    PushOnes(table, optim.get(), sparse_ids);
+    EXPECT_EQ(16u, RowCount(table));
+  }
+
+  // The pulled rows are accessed too, both the cache hit and miss.
+  for (auto cache_size : {"0", "64"}) {
+    SparseTable table(0, "ttl_pull", dimension, ElementType::From<float>(),
+                      Initializer::Create(InitializerType::kConstant, {}),
+                      Conf({{"slot_count", "4"},
+                            {"ttl_steps", "2"},
+                            {"cache_size", cache_size},
+                            {"evict_interval_ms", "0"}}),
+                      optim.get());
+
+    std::vector<uint64_t> pull_ids(sparse_ids.begin() + 16,
+                                   sparse_ids.begin() + 32);
+
+    EXPECT_EQ(ErrorCode::kSuccess, table.Pull(sparse_ids, &vals));
+
+    for (int i = 0; i < 3; ++i) {
+      EXPECT_EQ(ErrorCode::kSuccess, table.Pull(pull_ids, &vals));
+      PushOnes(table, optim.get(), hot_ids);
+    }
+
+    RowCache* cache = table.mutable_vals()->cache();
+    if (cache != nullptr) {
+      EXPECT_GT(cache->hit_count(), 0u);
+    }
+
+    EXPECT_EQ(32u, table.Evict());
+
+    for (auto id : pull_ids) {
+      EXPECT_TRUE(table.mutable_vals()->Contains(id));
+    }
+  }
+
+  // LFU: the rows accessed less than 2 times are removed, the count is halved
+  // after every sweep.
+  {
+    SparseTable table(0, "lfu", dimension, ElementType::From<float>(),
+                      Initializer::Create(InitializerType::kConstant, {}),
+                      Conf({{"slot_count", "4"},
+                            {"lfu_min_count", "2"},
+                            {"evict_interval_ms", "0"}}),
+                      optim.get());
+
+    EXPECT_EQ(ErrorCode::kSuccess, table.Pull(sparse_ids, &vals));
+    PushOnes(table, optim.get(), hot_ids);
+
+    EXPECT_EQ(48u, table.Evict());
+    EXPECT_EQ(16u, table.Evict());
+    EXPECT_EQ(0u, RowCount(table));
+  }
+
+  // Max rows: keep the most recently accessed rows.
+  {
+    SparseTable table(0, "max_rows", dimension, ElementType::From<float>(),
+                      Initializer::Create(InitializerType::kConstant, {}),
+                      Conf({{"slot_count", "4"},
+                            {"max_rows", "16"},
+                            {"evict_interval_ms", "0"}}),
+                      optim.get());
+
+    EXPECT_EQ(ErrorCode::kSuccess, table.Pull(sparse_ids, &vals));
+    PushOnes(table, optim.get(), hot_ids);
+
+    EXPECT_EQ(48u, table.Evict());
+
+    for (auto id : hot_ids) {
+      EXPECT_TRUE(table.mutable_vals()->Contains(id));
+    }
+  }
+
+  // Sweep only evict after evict_interval_ms, 0 means never.
+  for (auto interval : {"0", "10"}) {
+    SparseTable table(0, "sweep", dimension, ElementType::From<float>(),
+                      Initializer::Create(InitializerType::kConstant, {}),
+                      Conf({{"slot_count", "4"},
+                            {"max_rows", "16"},
+                            {"evict_interval_ms", interval}}),
+                      optim.get());
+
+    EXPECT_EQ(ErrorCode::kSuccess, table.Pull(sparse_ids, &vals));
+    PushOnes(table, optim.get(), hot_ids);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    EXPECT_EQ(std::string(interval) == "0" ? 0u : 48u, table.Sweep());
+    EXPECT_EQ(0u, table.Sweep());
+  }
+}
+
+TEST_P(SparseTableTest, Admission) {
+  int64_t dimension = 4;
+
+  std::unique_ptr<Optim> optim = Optim::Create(OptimType::kSGD, {});
+
+  SparseTable table(
+      0, "admit", dimension, ElementType::From<float>(),
+      Initializer::Create(InitializerType::kConstant, {{"value", "1"}}),
+      Conf({{"slot_count", "4"},
+            {"admit_count", "3"},
+            {"evict_interval_ms", "0"}}),
+      optim.get());
+
+  std::vector<uint64_t> sparse_ids = {100};
+  std::vector<Tensor> vals;
+
+  // Not admitted, pulled as zero and the Push is skipped.
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_EQ(ErrorCode::kSuccess, table.Pull(sparse_ids, &vals));
+    EXPECT_FALSE(table.mutable_vals()->Contains(100));
+
+    for (auto v : TensorToVector<float>(vals[0])) {
+      EXPECT_EQ(0, v);
+    }
+
+    PushOnes(table, optim.get(), sparse_ids);
+  }
+
+  EXPECT_EQ(ErrorCode::kSuccess, table.Pull(sparse_ids, &vals));
+  EXPECT_TRUE(table.mutable_vals()->Contains(100));
+
+  for (auto v : TensorToVector<float>(vals[0])) {
+    EXPECT_EQ(1, v);
+  }
+}
+
+TEST_P(SparseTableTest, CompactStore) {
+  int64_t dimension = 13;
+  float lr = 0.05;
+
+  std::unique_ptr<Optim> optim = Optim::Create(OptimType::kAdam, {});
+
+  std::vector<uint64_t> sparse_ids;
+  for (uint64_t i = 0; i < 32; ++i) {
+    sparse_ids.emplace_back(i);
+  }
+
+  std::vector<std::vector<Tensor>> grads(5);
+  for (auto& step_grads : grads) {
+    for (size_t i = 0; i < sparse_ids.size(); ++i) {
+      step_grads.emplace_back(RandomTensor<float>(Shape({dimension})));
+    }
+  }
+
+  // Same ops on the float table and the compact one, the pulled val should be
+  // close.
+  auto run = [&](const std::unordered_map<std::string, std::string>& conf,
+                 std::vector<Tensor>* vals) {
+    SparseTable table(
+        0, "compact", dimension, ElementType::From<float>(),
+        Initializer::Create(InitializerType::kConstant, {{"value", "0.5"}}),
+        Conf(conf), optim.get());
+
+    EXPECT_EQ(ErrorCode::kSuccess, table.Pull(sparse_ids, vals));
+
+    for (auto& step_grads : grads) {
+      EXPECT_EQ(ErrorCode::kSuccess,
+                table.Push(optim.get(), sparse_ids, step_grads, lr));
+    }
+
+    EXPECT_EQ(ErrorCode::kSuccess, table.Pull(sparse_ids, vals));
+
+    // Save and load by Value.
+    std::vector<uint64_t> exist_ids;
+    std::vector<Value> values;
+    table.mutable_vals()->Fetch(sparse_ids, &exist_ids, &values);
+    EXPECT_EQ(sparse_ids.size(), exist_ids.size());
+
+    table.mutable_vals()->Clear();
+    table.mutable_vals()->Insert(exist_ids, values);
+
+    std::vector<Tensor> loaded_vals;
+    EXPECT_EQ(ErrorCode::kSuccess, table.Pull(sparse_ids, &loaded_vals));
+
+    for (size_t i = 0; i < sparse_ids.size(); ++i) {
+      AssertTensorEQ((*vals)[i], loaded_vals[i]);
+    }
+  };
+
+  std::vector<Tensor> expect_vals;
+  run({{"slot_count", "4"}}, &expect_vals);
+
+  std::vector<std::pair<std::string, float>> store_types = {
+      {"float16", 5e-3}, {"bfloat16", 3e-2}, {"int8", 2e-2}};
+
+  for (const auto& [store_type, eps] : store_types) {
+    for (auto cache_size : {"0", "16"}) {
+      std::vector<Tensor> vals;
+      run({{"slot_count", "4"},
+           {"store_type", store_type},
+           {"cache_size", cache_size}},
+          &vals);
+
+      for (size_t i = 0; i < sparse_ids.size(); ++i) {
+        EXPECT_TRUE(vals[i].element_type().Is<float>());
+
+        std::vector<float> expect = TensorToVector<float>(expect_vals[i]);
+        std::vector<float> real = TensorToVector<float>(vals[i]);
+
+        for (size_t j = 0; j < expect.size(); ++j) {
+          EXPECT_NEAR(expect[j], real[j], eps);
+        }
+      }
+    }
+  }
+
+  // Pull in the stored type.
+  SparseTable table(
+      0, "pull_compact", dimension, ElementType::From<float>(),
+      Initializer::Create(InitializerType::kConstant, {{"value", "0.5"}}),
+      Conf({{"store_type", "float16"}, {"pull_compact", "true"}}),
+      optim.get());
+
+  std::vector<Tensor> vals;
+  EXPECT_EQ(ErrorCode::kSuccess, table.Pull(sparse_ids, &vals));
+  EXPECT_TRUE(vals[0].element_type().Is<half>());
+
+  MemBuffer buf;
+  EXPECT_EQ(ErrorCode::kSuccess, table.Pull(sparse_ids, &buf));
+
+  std::vector<Tensor> buf_vals;
+  {
+    MemReader reader(buf.ptr(), buf.offset());
+    Deserialize deserialize(&reader);
+
+    EXPECT_TRUE(deserialize >> buf_vals);
+  }
+
+  EXPECT_EQ(sparse_ids.size(), buf_vals.size());
+  EXPECT_TRUE(buf_vals[0].element_type().Is<half>());
+  EXPECT_EQ(0, memcmp(vals[0].Ptr(), buf_vals[0].Ptr(), dimension * 2));
+}
+
+TEST_P(SparseTableTest, Tiered) {
+  float lr = 0.1;
+
+  std::unique_ptr<Optim> optim = Optim::Create(OptimType::kAdam, {});
+  std::string cold_path = TempPath("tiered");
+
+  std::vector<uint64_t> sparse_ids;
+  for (uint64_t i = 0; i < 64; ++i) {
+    sparse_ids.emplace_back(i);
+  }
+
+  // The tiered one keep 16 rows in memory.
+  TablePair pair(6, InitializerType::kConstant, Conf({{"slot_count", "4"}}),
+                 {{"max_rows", "16"},
+                  {"evict_interval_ms", "0"},
+                  {"cold_path", cold_path}},
+                 optim.get());
+
+  SparseTable& tiered_table = pair.table;
+  SparseStorage* storage = tiered_table.mutable_vals();
+  EXPECT_TRUE(storage->tiered());
+
+  auto cold_count = [storage]() {
+    size_t count = 0;
+    for (size_t slot = 0; slot < storage->slot_count(); ++slot) {
+      auto h = storage->SharedSlotHandler(slot);
+      count += storage->ColdSize(slot);
+    }
+
+    return count;
+  };
+
+  for (size_t step = 0; step < 4; ++step) {
+    pair.Pull(sparse_ids);
+
+    // All rows are faulted back.
+    EXPECT_EQ(64u, RowCount(tiered_table));
+    EXPECT_EQ(0u, cold_count());
+
+    pair.Push(sparse_ids, lr);
+
+    // Spill 48 rows, the dead records of the last step are compacted.
+    EXPECT_EQ(48u, tiered_table.Evict());
+    EXPECT_EQ(16u, RowCount(tiered_table));
+    EXPECT_EQ(48u, cold_count());
+
+    for (auto id : sparse_ids) {
+      EXPECT_TRUE(storage->Contains(id));
+    }
+  }
+
+  // Fetch (used by checkpoint/transfer) see the spilled rows.
+  std::vector<uint64_t> exist_ids;
+  std::vector<Value> values;
+  storage->Fetch(sparse_ids, &exist_ids, &values);
+  EXPECT_EQ(sparse_ids.size(), exist_ids.size());
+
+  // Push fault the spilled rows back too.
+  pair.Push(sparse_ids, lr);
+  EXPECT_EQ(64u, RowCount(tiered_table));
+
+  pair.Pull(sparse_ids);
+
+  // The cold files are separated by node id and table id.
+  EXPECT_TRUE(std::filesystem::exists(std::filesystem::path(cold_path) / "0" /
+                                      "0" / "slot_0.rows"));
+
+  // Spill then fault all back, the cold files only have the dead records.
+  EXPECT_EQ(48u, tiered_table.Evict());
+  pair.Pull(sparse_ids);
+  EXPECT_EQ(0u, cold_count());
+
+  for (size_t slot = 0; slot < storage->slot_count(); ++slot) {
+    EXPECT_TRUE(storage->CompactCold(slot));
+    EXPECT_FALSE(storage->CompactCold(slot));
+  }
+
+  // The compacted files still work.
+  EXPECT_EQ(48u, tiered_table.Evict());
+  EXPECT_EQ(48u, cold_count());
+  pair.Pull(sparse_ids);
+
+  std::filesystem::remove_all(cold_path);
+}
+
+TEST_P(SparseTableTest, TieredColdPath) {
+  std::unique_ptr<Optim> optim = Optim::Create(OptimType::kSGD, {});
+  std::string cold_path = TempPath("tiered_cold_path");
+
+  std::unordered_map<std::string, std::string> table_conf = Conf(
+      {{"slot_count", "4"}, {"max_rows", "16"}, {"cold_path", cold_path}});
+
+  // The same table of 2 nodes share the cold_path.
+  SparseTable table(1, "tiered", 4, ElementType::From<float>(),
+                    Initializer::Create(InitializerType::kConstant, {}),
+                    table_conf, optim.get(), 0);
+
+  SparseTable other_node_table(
+      1, "tiered", 4, ElementType::From<float>(),
+      Initializer::Create(InitializerType::kConstant, {}), table_conf,
+      optim.get(), 1);
+
+  // The same table of the same node can not use the used cold files.
+  EXPECT_ANY_THROW(SparseTable(
+      1, "tiered", 4, ElementType::From<float>(),
+      Initializer::Create(InitializerType::kConstant, {}), table_conf,
+      optim.get(), 0));
+
+  std::filesystem::remove_all(cold_path);
+}
+
+TEST_P(SparseTableTest, DeterministicInit) {
+  int64_t dimension = 10;
+
+  std::unique_ptr<Optim> optim = Optim::Create(OptimType::kSGD, {});
+
+  std::vector<uint64_t> sparse_ids;
+  for (uint64_t i = 0; i < 64; ++i) {
+    sparse_ids.emplace_back(i * 7919);
+  }
+
+  std::vector<uint64_t> reversed_ids(sparse_ids.rbegin(), sparse_ids.rend());
+
+  for (auto init_type :
+       {InitializerType::kNormal, InitializerType::kUniform,
+        InitializerType::kXavierNormal, InitializerType::kXavierUniform}) {
+    // Same table id on different nodes, the rows are created in different
+    // order and batch.
+    SparseTable table(3, "init", dimension, ElementType::From<float>(),
+                      Initializer::Create(init_type, {{"seed", "7"}}),
+                      Conf({{"slot_count", "4"}}), optim.get());
+
+    SparseTable other_table(
+        3, "init", dimension, ElementType::From<float>(),
+        Initializer::Create(init_type, {{"seed", "7"}}),
+        Conf({{"slot_count", "2"}, {"parallel_threshold", "1"}}),
+        optim.get());
+
+    SparseTable other_seed_table(
+        3, "init", dimension, ElementType::From<float>(),
+        Initializer::Create(init_type, {{"seed", "8"}}),
+        Conf({{"slot_count", "4"}}), optim.get());
+
+    std::vector<Tensor> vals;
+    std::vector<Tensor> other_vals;
+    std::vector<Tensor> other_seed_vals;
+
+    EXPECT_EQ(ErrorCode::kSuccess, table.Pull(sparse_ids, &vals));
+    EXPECT_EQ(ErrorCode::kSuccess,
+              other_table.Pull(reversed_ids, &other_vals));
+    EXPECT_EQ(ErrorCode::kSuccess,
+              other_seed_table.Pull(sparse_ids, &other_seed_vals));
+
+    for (size_t i = 0; i < sparse_ids.size(); ++i) {
+      AssertTensorEQ(vals[i], other_vals[sparse_ids.size() - 1 - i]);
+
+      EXPECT_NE(0, memcmp(vals[i].Ptr(), other_seed_vals[i].Ptr(),
+                          vals[i].NumBytes()));
+    }
+
+    // The seed is kept in conf, so the transferred table is same.
+    EXPECT_EQ("7", table.initializer()->conf().at("seed"));
+  }
+}
+
+TEST_P(SparseTableTest, LazyInit) {
+  float lr = 0.1;
+
+  std::unique_ptr<Optim> optim = Optim::Create(OptimType::kAdam, {});
+
+  std::vector<uint64_t> sparse_ids;
+  std::vector<uint64_t> pushed_ids;
+  for (uint64_t i = 0; i < 64; ++i) {
+    sparse_ids.emplace_back(i);
+
+    if (i % 2 == 0) {
+      pushed_ids.emplace_back(i);
+    }
+  }
+
+  for (auto store_type : {"float32", "int8"}) {
+    TablePair pair(9, InitializerType::kNormal,
+                   Conf({{"slot_count", "4"}, {"store_type", store_type}}),
+                   {{"lazy_init", "true"}}, optim.get());
+
+    SparseTable& lazy_table = pair.table;
+
+    // Read only not insert.
+    pair.Pull(sparse_ids);
+    EXPECT_EQ(0u, RowCount(lazy_table));
+
+    // The pushed rows are materialized.
+    for (int step = 0; step < 3; ++step) {
+      pair.Push(pushed_ids, lr);
+    }
+
+    EXPECT_EQ(pushed_ids.size(), RowCount(lazy_table));
+
+    std::vector<Tensor> vals;
+    std::vector<Tensor> lazy_vals;
+
+    MemBuffer buf;
+    EXPECT_EQ(ErrorCode::kSuccess, pair.ref.Pull(sparse_ids, &vals));
+    EXPECT_EQ(ErrorCode::kSuccess, lazy_table.Pull(sparse_ids, &buf));
+
+    {
+      MemReader reader(buf.ptr(), buf.offset());
+      Deserialize deserialize(&reader);
+
+      EXPECT_TRUE(deserialize >> lazy_vals);
+    }
+
+    for (size_t i = 0; i < sparse_ids.size(); ++i) {
+      AssertTensorEQ(vals[i], lazy_vals[i]);
+    }
+
+    EXPECT_EQ(pushed_ids.size(), RowCount(lazy_table));
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(StorageType, SparseTableTest,
+                         ::testing::Values("skip_list", "hash_map"));
+
+}  // namespace test
+}  // namespace kraken
@@ -0,0 +1,111 @@
+#include "t/philox.h"
+
+#include <gtest/gtest.h>
+
+#include <cinttypes>
+#include <cmath>
+#include <vector>
+
+namespace kraken {
+namespace test {
+
+TEST(Philox, KnownAnswer) {
+  // The known answers of the Random123 Philox4x32-10.
+  uint32_t out[4];
+
+  philox::Generate(0, 0, 0, out);
+  EXPECT_EQ(0x6627e8d5u, out[0]);
+  EXPECT_EQ(0xe169c58du, out[1]);
+  EXPECT_EQ(0xbc57ac4cu, out[2]);
+  EXPECT_EQ(0x9b00dbd8u, out[3]);
+
+  // counter: 0x243f6a88 0x85a308d3 0x13198a2e 0x03707344.
+  // key: 0xa4093822 0x299f31d0.
+  philox::Generate(0x299f31d0a4093822, 0x0370734413198a2e, 0x85a308d3243f6a88,
+                   out);
+  EXPECT_EQ(0xd16cfe09u, out[0]);
+  EXPECT_EQ(0x94fdccebu, out[1]);
+  EXPECT_EQ(0x5001e420u, out[2]);
+  EXPECT_EQ(0x24126ea1u, out[3]);
+}
+
+TEST(Philox, GenerateRows) {
+  uint64_t key = 12345;
+  size_t blocks = 3;
+
+  // Not a multiple of the lanes.
+  std::vector<uint64_t> ids;
+  for (uint64_t i = 0; i < 11; ++i) {
+    ids.emplace_back(i * 1000003);
+  }
+
+  std::vector<uint32_t> words(ids.size() * blocks * 4);
+  philox::GenerateRows(key, ids, blocks, words.data());
+
+  for (size_t i = 0; i < ids.size(); ++i) {
+    for (size_t b = 0; b < blocks; ++b) {
+      uint32_t out[4];
+      philox::Generate(key, ids[i], b, out);
+
+      for (size_t k = 0; k < 4; ++k) {
+        EXPECT_EQ(out[k], words[(i * blocks + b) * 4 + k]);
+      }
+    }
+  }
+}
+
+TEST(Philox, Rows) {
+  int64_t dimension = 33;
+  size_t row_count = 1000;
+
+  std::vector<uint64_t> ids;
+  for (uint64_t i = 0; i < row_count; ++i) {
+    ids.emplace_back(i);
+  }
+
+  std::vector<float> data(row_count * dimension);
+  std::vector<float*> rows;
+  for (size_t i = 0; i < row_count; ++i) {
+    rows.emplace_back(data.data() + i * dimension);
+  }
+
+  philox::UniformRows<float>(1, ids, dimension, -2, 3, rows);
+
+  double sum = 0;
+  for (auto v : data) {
+    EXPECT_GE(v, -2);
+    EXPECT_LT(v, 3);
+
+    sum += v;
+  }
+
+  EXPECT_NEAR(0.5, sum / data.size(), 0.05);
+
+  philox::NormalRows<float>(1, ids, dimension, 1, 2, rows);
+
+  sum = 0;
+  double square_sum = 0;
+  for (auto v : data) {
+    sum += v;
+    square_sum += v * v;
+  }
+
+  double mean = sum / data.size();
+  double stddev = std::sqrt(square_sum / data.size() - mean * mean);
+
+  EXPECT_NEAR(1, mean, 0.05);
+  EXPECT_NEAR(2, stddev, 0.05);
+
+  // A row only depend on it's id.
+  std::vector<uint64_t> one_id = {ids[7]};
+  std::vector<float> one(dimension);
+
+  philox::NormalRows<float>(1, one_id, dimension, 1, 2, {one.data()});
+
+  for (int64_t j = 0; j < dimension; ++j) {
+    EXPECT_EQ(rows[7][j], one[j]);
+  }
+}
+
+}  // namespace test
+}  // namespace kraken
@@ -1,9 +1,13 @@
 #pragma once
 
 #include <gtest/gtest.h>
+#include <unistd.h>
 
+#include <filesystem>
+#include <string>
 #include <vector>
 
+#include "common/utils.h"
 #include "t/shape.h"
 #include "t/tensor.h"
 
@@ -44,6 +48,14 @@ Tensor RandomTensor(const Shape& shape) {
   return VectorToTensor<T>(vals).Reshape(shape);
 }
 
+// A path under the temp dir that unique per process.
+inline std::string TempPath(const std::string& name) {
+  std::filesystem::path path = std::filesystem::temp_directory_path();
+  path /= "kraken_" + name + "_" + std::to_string(getpid());
+
+  return path.string();
+}
+
 inline void AssertVectorF32(const std::vector<float>& v1,
                             const std::vector<float>& v2) {
   EXPECT_EQ(v1.size(), v2.size());
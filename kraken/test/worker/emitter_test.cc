@@ -27,11 +27,13 @@ TEST(Emitter, Test) {
   EXPECT_EQ(2, emitter->RegisterSparseTable("SparseTable0", 100,
                                             ElementType::From<float>(),
                                             InitializerType::kConstant,
-                                            {{"value", std::to_string(v0)}}));
+                                            {{"value", std::to_string(v0)}},
+                                            {}));
   EXPECT_EQ(3, emitter->RegisterSparseTable("SparseTable1", 100,
                                             ElementType::From<float>(),
                                             InitializerType::kConstant,
-                                            {{"value", std::to_string(v1)}}));
+                                            {{"value", std::to_string(v1)}},
+                                            {}));
 
   {
     Tensor r0 = emitter->PullDenseTable(0);
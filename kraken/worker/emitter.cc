@@ -2,6 +2,9 @@
 
 #include <assert.h>
 
+#include <cstring>
+
+#include "common/compress_policy.h"
 #include "common/exception.h"
 #include "common/log.h"
 #include "protocol/combine_pull_dense_table_prot.h"
@@ -11,9 +14,9 @@
 #include "protocol/init_model_prot.h"
 #include "protocol/is_all_ps_working_prot.h"
 #include "protocol/pull_dense_table_prot.h"
-#include "protocol/pull_sparse_table_prot.h"
+#include "protocol/pull_sparse_matrix_prot.h"
 #include "protocol/push_dense_table_prot.h"
-#include "protocol/push_sparse_table_prot.h"
+#include "protocol/push_sparse_matrix_prot.h"
 #include "protocol/register_dense_table_prot.h"
 #include "protocol/register_sparse_table_prot.h"
 #include "protocol/rpc_func_type.h"
@@ -22,11 +25,47 @@
 
 namespace kraken {
 
+namespace {
+
+// LZ4 is fast enough for the big messages, the small ones are sent raw. The
+// dense grad is a float array, shuffle it make LZ4 find more matches. See
+// compress_benchmark.
+CompressPolicies EmitterCompressPolicies() {
+  CompressPolicies policies(CompressPolicy(CompressType::kLZ4, 4096));
+  policies.Set(RPCFuncType::kPushDenseTableType,
+               CompressPolicy(CompressType::kLZ4, 4096, sizeof(float)));
+
+  return policies;
+}
+
+// The control RPCs are small and not wait the credits, so they are not
+// blocked by the table RPCs.
+FlowControl EmitterFlowControl(FlowControl flow_control) {
+  for (uint32_t rpc_type :
+       {RPCFuncType::kHeartbeatType, RPCFuncType::kTryJoinType,
+        RPCFuncType::kNotifyNodeJoinType, RPCFuncType::kInitModelType,
+        RPCFuncType::kRegisterDenseTableType,
+        RPCFuncType::kRegisterSparseTableType, RPCFuncType::kCreateModelType,
+        RPCFuncType::kCreateDenseTableType,
+        RPCFuncType::kCreateSparseTableType,
+        RPCFuncType::kFetchModelMetaDataType,
+        RPCFuncType::kNotifyFinishTransferType, RPCFuncType::kFetchRouterType,
+        RPCFuncType::kTrySaveModelType, RPCFuncType::kTryLoadModelType,
+        RPCFuncType::kNotifySaveModelType, RPCFuncType::kNotifyLoadModelType,
+        RPCFuncType::kIsAllPsWorkingType}) {
+    flow_control.SetPriority(rpc_type, RPCPriority::kHigh);
+  }
+
+  return flow_control;
+}
+
+}  // namespace
+
 Emitter::Emitter() : Emitter(EmitterType::kDefault) {
 }
 
 Emitter::Emitter(EmitterType type)
-    : type_(type), initialized_(false), clients_(CompressType::kSnappy) {
+    : type_(type), initialized_(false), clients_(EmitterCompressPolicies()) {
 }
 
 void Emitter::UpdataRouter() {
@@ -128,13 +167,15 @@ int32_t Emitter::PullSparseTableImpl(uint64_t table_id, const Tensor& indices,
   int64_t row = indices_u64.Size();
   uint64_t* ptr = indices_u64.Data<uint64_t>();
 
+  ARGUMENT_CHECK(row > 0, "PullSparseTable need indices is not empty.");
+
   std::unordered_map<uint64_t, std::pair<uint64_t, size_t>> sparse_idx_map;
   sparse_idx_map.reserve(row);
 
-  std::unordered_map<uint64_t /*node id*/, PullSparseTableRequest> reqs;
+  std::unordered_map<uint64_t /*node id*/, PullSparseMatrixRequest> reqs;
   reqs.reserve(router_.nodes().size());
 
-  std::unordered_map<uint64_t, PullSparseTableResponse> replies;
+  std::unordered_map<uint64_t, PullSparseMatrixResponse> replies;
 
   for (int64_t i = 0; i < row; ++i) {
     uint64_t sparse_id = ptr[i];
@@ -154,13 +195,28 @@ int32_t Emitter::PullSparseTableImpl(uint64_t table_id, const Tensor& indices,
   }
 
   auto error_code =
-      clients_.Call(RPCFuncType::kPullSparseTableType, reqs, &replies);
+      clients_.Call(RPCFuncType::kPullSparseMatrixType, reqs, &replies);
   if (error_code != ErrorCode::kSuccess) {
     return error_code;
   }
 
-  std::vector<Tensor> vals;
-  vals.reserve(row);
+  const Tensor& first = replies.begin()->second.vals;
+
+  std::vector<int64_t> dims = indices_u64.shape().dims();
+  int64_t col = first.shape()[-1];
+  dims.emplace_back(col);
+
+  // Only one node and no duplicate id, the reply matrix is the result.
+  if (replies.size() == 1 && (int64_t)first.shape()[0] == row) {
+    *val = first.Reshape(dims);
+
+    return ErrorCode::kSuccess;
+  }
+
+  size_t vec_bytes = col * first.element_type().ByteWidth();
+  Tensor vals = Tensor::Dense({row, col}, first.element_type());
+
+  char* dst = (char*)vals.Ptr();
 
   for (int64_t i = 0; i < row; ++i) {
     uint64_t sparse_id = ptr[i];
@@ -168,16 +224,12 @@ int32_t Emitter::PullSparseTableImpl(uint64_t table_id, const Tensor& indices,
     uint64_t node_id = sparse_idx_map[sparse_id].first;
     size_t val_i = sparse_idx_map[sparse_id].second;
 
-    vals.emplace_back(replies[node_id].vals.at(val_i));
-  }
+    const char* src = (const char*)replies[node_id].vals.Ptr();
 
-  *val = indices_u64.ConcatVector(vals);
-
-  std::vector<int64_t> dims = indices_u64.shape().dims();
-  int64_t col = val->Size() / indices_u64.Size();
-  dims.emplace_back(col);
+    memcpy(dst + i * vec_bytes, src + val_i * vec_bytes, vec_bytes);
+  }
 
-  *val = val->Reshape(dims);
+  *val = vals.Reshape(dims);
 
   return ErrorCode::kSuccess;
 }
@@ -260,8 +312,9 @@ int32_t Emitter::CombinePullSparseTableImpl(
       auto key = std::make_pair(table_id, sparse_id);
       auto pos = sparse_val_idx[key];
 
+      // A view of the row in the reply matrix.
       vecs.emplace_back(
-          replies[pos.first].table_vals.at(table_id).at(pos.second));
+          replies[pos.first].table_vals.at(table_id).Vector(pos.second));
     }
 
     Tensor val = indice_u64s[t].ConcatVector(vecs);
@@ -277,13 +330,20 @@ int32_t Emitter::CombinePullSparseTableImpl(
   return ErrorCode::kSuccess;
 }
 
-void Emitter::Initialize(const std::string& s_addr) {
+void Emitter::Initialize(const std::string& s_addr, size_t socket_nums,
+                         const FlowControl& flow_control) {
   if (initialized_) {
     return;
   }
 
+  FlowControl emitter_flow_control = EmitterFlowControl(flow_control);
+
+  clients_.SetSocketNums(socket_nums);
+  clients_.SetFlowControl(emitter_flow_control);
+
   LOG_INFO("Try to connect scheduler:" << s_addr);
-  s_connecter_.reset(new IndepConnecter(s_addr, CompressType::kNo));
+  s_connecter_.reset(
+      new IndepConnecter(s_addr, CompressType::kNo, emitter_flow_control));
   s_connecter_->Start();
 
   // Fetch router.
@@ -355,13 +415,15 @@ uint64_t Emitter::RegisterDenseTable(const std::string& name,
 uint64_t Emitter::RegisterSparseTable(
     const std::string& name, int64_t dimension, ElementType element_type,
     InitializerType init_type,
-    const std::unordered_map<std::string, std::string>& init_conf) {
+    const std::unordered_map<std::string, std::string>& init_conf,
+    const std::unordered_map<std::string, std::string>& table_conf) {
   RegisterSparseTableRequest req;
   req.name = name;
   req.dimension = dimension;
   req.element_type = element_type;
   req.init_type = init_type;
   req.init_conf = init_conf;
+  req.table_conf = table_conf;
 
   RegisterSparseTableResponse reply;
 
@@ -422,7 +484,9 @@ void Emitter::PushDenseTable(uint64_t table_id, const Tensor& grad) {
   PushDenseTableRequest req;
   req.router_version = router_.version();
   req.table_id = table_id;
-  req.grad = grad;
+  // The grad is referenced when sending and it maybe share memory with torch
+  // that be modified after return, so clone it.
+  req.grad = grad.Clone();
   req.lr = lr_;
 
   // never use.
@@ -510,34 +574,51 @@ void Emitter::PushSparseTable(uint64_t table_id, const Tensor& indices,
   std::unordered_map<uint64_t, std::pair<uint64_t, size_t>> sparse_idx_map;
   sparse_idx_map.reserve(row);
 
-  std::unordered_map<uint64_t, PushSparseTableRequest> reqs;
+  std::unordered_map<uint64_t, PushSparseMatrixRequest> reqs;
   reqs.reserve(router_.nodes().size());
 
+  // Whether indices[i] is the first one of the sparse id.
+  std::vector<bool> firsts(row, false);
+
   for (int64_t i = 0; i < row; ++i) {
     uint64_t sparse_id = ptr[i];
 
-    auto it = sparse_idx_map.find(sparse_id);
-    if (it == sparse_idx_map.end()) {
+    if (sparse_idx_map.find(sparse_id) == sparse_idx_map.end()) {
       uint64_t node_id = router_.Hit(utils::Hash(table_id, sparse_id));
 
       sparse_idx_map[sparse_id] =
           std::make_pair(node_id, reqs[node_id].sparse_ids.size());
-
       reqs[node_id].sparse_ids.emplace_back(sparse_id);
-      reqs[node_id].grads.emplace_back(m_grads.Vector(i).Clone());
-    } else {
-      reqs[it->second.first].grads[it->second.second] += m_grads.Vector(i);
+
+      firsts[i] = true;
     }
   }
 
   for (auto& [_, v] : reqs) {
     v.router_version = router_.version();
     v.table_id = table_id;
+    v.grads = Tensor::Dense({(int64_t)v.sparse_ids.size(), dimension},
+                            grads.element_type());
     v.lr = lr_;
   }
 
+  // Copy the grads into every node's matrix, the same sparse id's grads are
+  // summed.
+  size_t vec_bytes = dimension * grads.element_type().ByteWidth();
+
+  for (int64_t i = 0; i < row; ++i) {
+    auto& pos = sparse_idx_map[ptr[i]];
+    Tensor dst = reqs[pos.first].grads.Vector(pos.second);
+
+    if (firsts[i]) {
+      memcpy(dst.Ptr(), m_grads.Vector(i).Ptr(), vec_bytes);
+    } else {
+      dst += m_grads.Vector(i);
+    }
+  }
+
   auto callback = [](int32_t error_code,
-                     PushSparseTableResponse& /*not care*/) {
+                     PushSparseMatrixResponse& /*not care*/) {
     if (error_code != ErrorCode::kSuccess) {
       LOG_WARNING("PushSparseTable got error code:"
                   << error_code << ", msg:" << ErrorCode::Msg(error_code)
@@ -545,8 +626,8 @@ void Emitter::PushSparseTable(uint64_t table_id, const Tensor& indices,
     }
   };
 
-  clients_.CallAsync<PushSparseTableRequest, PushSparseTableResponse>(
-      RPCFuncType::kPushSparseTableType, reqs, callback);
+  clients_.CallAsync<PushSparseMatrixRequest, PushSparseMatrixResponse>(
+      RPCFuncType::kPushSparseMatrixType, reqs, callback);
 }
 
 void Emitter::CombinePushSparseTable(const std::vector<uint64_t>& table_ids,
@@ -631,6 +712,10 @@ void Emitter::CombinePushSparseTable(const std::vector<uint64_t>& table_ids,
           RPCFuncType::kCombinePushSparseTableType, reqs, callback);
 }
 
+FlowStats Emitter::ConnecterStats() const {
+  return clients_.Stats();
+}
+
 bool Emitter::TrySaveModel() {
   TrySaveModelRequest req;
   TrySaveModelResponse reply;
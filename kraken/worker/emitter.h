@@ -6,6 +6,7 @@
 
 #include "common/info.h"
 #include "common/router.h"
+#include "rpc/flow_control.h"
 #include "rpc/group_connecters.h"
 #include "rpc/indep_connecter.h"
 #include "rpc/protocol.h"
@@ -54,7 +55,11 @@ protected:
                                      std::vector<Tensor>* vals);
 
 public:
-  void Initialize(const std::string& s_addr);
+  // socket_nums is the sockets/IO threads count connect to every Ps node.
+  // flow_control is the in-flight window of every socket, the control RPCs
+  // are always high priority.
+  void Initialize(const std::string& s_addr, size_t socket_nums = 1,
+                  const FlowControl& flow_control = FlowControl());
 
   void Stop();
 
@@ -70,7 +75,8 @@ public:
   uint64_t RegisterSparseTable(
       const std::string& name, int64_t dimension, ElementType element_type,
       InitializerType init_type,
-      const std::unordered_map<std::string, std::string>& init_conf);
+      const std::unordered_map<std::string, std::string>& init_conf,
+      const std::unordered_map<std::string, std::string>& table_conf);
 
   Tensor PullDenseTable(uint64_t table_id);
 
@@ -95,6 +101,9 @@ public:
   bool TrySaveModel();
 
   bool TryLoadModelBlocked(const std::string& load_dir);
+
+  // The queue depth of the connecters to the Ps nodes.
+  FlowStats ConnecterStats() const;
 };
 
 }  // namespace kraken
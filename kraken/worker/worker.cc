@@ -14,7 +14,8 @@ Worker::Worker() {
 }
 
 void Worker::Initialize(const std::string& s_addr, EmitterType emitter_type,
-                        uint64_t life_span, float eta) {
+                        uint64_t life_span, float eta, size_t socket_nums,
+                        const FlowControl& flow_control) {
   if (emitter_type == EmitterType::kDefault) {
     emitter_.reset(new Emitter());
 
@@ -28,7 +29,7 @@ void Worker::Initialize(const std::string& s_addr, EmitterType emitter_type,
     RUNTIME_ERROR("Unsupport EmitterType:" << (uint32_t)emitter_type);
   }
 
-  emitter_->Initialize(s_addr);
+  emitter_->Initialize(s_addr, socket_nums, flow_control);
 }
 
 void Worker::Stop() {
@@ -53,9 +54,10 @@ uint64_t Worker::RegisterDenseTable(const std::string& name,
 uint64_t Worker::RegisterSparseTable(
     const std::string& name, int64_t dimension, ElementType etype,
     InitializerType init_type,
-    const std::unordered_map<std::string, std::string>& init_conf) {
+    const std::unordered_map<std::string, std::string>& init_conf,
+    const std::unordered_map<std::string, std::string>& table_conf) {
   return emitter_->RegisterSparseTable(name, dimension, etype, init_type,
-                                       init_conf);
+                                       init_conf, table_conf);
 }
 
 Tensor Worker::PullDenseTable(uint64_t table_id) {
@@ -100,4 +102,8 @@ bool Worker::TryLoadModelBlocked(const std::string& load_dir) {
   return emitter_->TryLoadModelBlocked(load_dir);
 }
 
+FlowStats Worker::ConnecterStats() const {
+  return emitter_->ConnecterStats();
+}
+
 }  // namespace kraken
@@ -15,7 +15,9 @@ public:
 
   void Initialize(const std::string& s_addr,
                   EmitterType emitter_type = EmitterType::kDefault,
-                  uint64_t life_span = 1000, float eta = 0.75);
+                  uint64_t life_span = 1000, float eta = 0.75,
+                  size_t socket_nums = 1,
+                  const FlowControl& flow_control = FlowControl());
 
   void Stop();
 
@@ -30,7 +32,8 @@ public:
   uint64_t RegisterSparseTable(
       const std::string& name, int64_t dimension, ElementType etype,
       InitializerType init_type,
-      const std::unordered_map<std::string, std::string>& init_conf);
+      const std::unordered_map<std::string, std::string>& init_conf,
+      const std::unordered_map<std::string, std::string>& table_conf);
 
   Tensor PullDenseTable(uint64_t table_id);
 
@@ -55,6 +58,8 @@ public:
   bool TrySaveModel();
 
   bool TryLoadModelBlocked(const std::string& load_dir);
+
+  FlowStats ConnecterStats() const;
 };
 
 }  // namespace kraken